@@ -4,7 +4,10 @@
  * This is a minimal standalone Qt 6 C++ application.
  *
  * WHAT IT DOES:
- * 1.  Runs an OSC Client (listener) on port 9000.
+ * 1.  Runs an OSC Client (listener) on port 9000. Like the Hub, the
+ *     endpoint can be changed with the OSC_ENDPOINT environment variable
+ *     or the first argument, e.g. "local:@mixer-gui" for a Unix domain
+ *     socket.
  * 2.  Listens for OSC messages from the "Hub" (e.g., /track/1/volume).
  * 3.  Updates a simple GUI (a QLabel) when a message is received.
  *
@@ -26,11 +29,21 @@
 #include <QSlider>
 #include <QObject>
 #include <QUdpSocket>
+#include <QSocketNotifier>
+#include <QTimer>
 #include <QDebug>
 
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
 // --- OSC Library (oscpack example) ---
 #include "osc/OscReceivedElements.h"
 #include "osc/OscPacketListener.h"
+#include "osc/OscMessageDecoder.h"
+#include "osc/OscRouteDispatcher.h"
+#include "osc/ScheduledOscPacketListener.h"
+#include "ip/DatagramEndpoint.h"
 
 #define OSC_LISTEN_PORT 9000
 
@@ -39,15 +52,47 @@ class OscListener : public QObject {
     Q_OBJECT
 
 public:
-    OscListener(QObject* parent = nullptr) : QObject(parent) {
-        m_socket = new QUdpSocket(this);
+    OscListener(const DatagramEndpoint& endpoint, QObject* parent = nullptr)
+        : QObject(parent), m_socket(nullptr), m_scheduler(this) {
+
+        // Routes are matched part by part and the track number is parsed
+        // while the address is walked, so any track number works.
+        m_routes.AddRoute("/track/{int}/volume", this, &OscListener::onTrackVolume);
+
+        // Releases bundles the Hub time-tagged ahead of time. Only runs
+        // while something is scheduled. The scheduler runs on the GUI
+        // thread, so it must not spin waiting for a bundle: a 1 ms timer
+        // is precise enough for a fader.
+        m_scheduler.SetSpinThresholdMicroseconds(0);
+        m_releaseTimer = new QTimer(this);
+        m_releaseTimer->setTimerType(Qt::PreciseTimer);
+        m_releaseTimer->setInterval(1);
+        connect(m_releaseTimer, &QTimer::timeout, this, &OscListener::onReleaseTimer);
+
+        if (endpoint.transport == DatagramEndpoint::LOCAL_TRANSPORT) {
+            // Qt has no datagram class for Unix domain sockets, so bind an
+            // oscpack socket and read it when the event loop sees data
+            try {
+                m_localSocket.reset(new LocalReceiveSocket(endpoint.localEndpoint));
+                m_localBuffer.resize(65536);
+                QSocketNotifier* notifier = new QSocketNotifier(
+                        m_localSocket->FileDescriptor(), QSocketNotifier::Read, this);
+                connect(notifier, &QSocketNotifier::activated, this, &OscListener::onLocalReadyRead);
+                qDebug() << "QtGUI: OSC Listener bound to" << endpoint.ToString().c_str();
+            } catch (std::exception& e) {
+                qDebug() << "QtGUI: Failed to bind to" << endpoint.ToString().c_str() << e.what();
+            }
+            return;
+        }
 
         // Bind to the port the Hub is broadcasting to
-        if (m_socket->bind(QHostAddress::LocalHost, OSC_LISTEN_PORT)) {
-            qDebug() << "QtGUI: OSC Listener bound to" << OSC_LISTEN_PORT;
+        m_socket = new QUdpSocket(this);
+        if (m_socket->bind(QHostAddress(static_cast<quint32>(endpoint.ipEndpoint.address)),
+                static_cast<quint16>(endpoint.ipEndpoint.port))) {
+            qDebug() << "QtGUI: OSC Listener bound to" << endpoint.ToString().c_str();
             connect(m_socket, &QUdpSocket::readyRead, this, &OscListener::onReadyRead);
         } else {
-            qDebug() << "QtGUI: Failed to bind to port" << OSC_LISTEN_PORT;
+            qDebug() << "QtGUI: Failed to bind to" << endpoint.ToString().c_str();
         }
     }
 
@@ -64,59 +109,97 @@ private slots:
 
             qDebug() << "QtGUI: Received UDP packet of size" << datagram.size();
 
-            // --- OSC Parsing (oscpack) ---
+            // We must explicitly cast datagram.size() (a qsizetype)
+            // to a type that oscpack understands, like std::size_t.
+            processPacket(datagram.data(), static_cast<std::size_t>(datagram.size()));
+        }
+    }
 
-            try {
-                // We must explicitly cast datagram.size() (a qsizetype)
-                // to a type that oscpack understands, like std::size_t.
-                osc::ReceivedPacket p(datagram.data(), static_cast<std::size_t>(datagram.size()));
-
-                if (p.IsBundle()) {
-                    osc::ReceivedBundle b(p);
-                    for (osc::ReceivedBundle::const_iterator i = b.ElementsBegin();
-                         i != b.ElementsEnd(); ++i) {
-                        if (i->IsMessage()) {
-                            osc::ReceivedMessage m(*i);
-                            // --- Handle message (duplicated from else block) ---
-                            const char* address = m.AddressPattern();
-                            int track_index;
-                            if (sscanf(address, "/track/%d/volume", &track_index) == 1) {
-                                auto it = m.ArgumentsBegin();
-                                if (it != m.ArgumentsEnd() && it->IsFloat()) {
-                                    float volume = it->AsFloat();
-                                    qDebug() << "QtGUI: Parsed OSC:" << address << volume;
-                                    emit volumeChanged(track_index - 1, volume);
-                                }
-                            }
-                            // --- End handle message ---
-                        }
-                    }
-                } else {
-                    // Handle single message
-                    osc::ReceivedMessage m(p);
-                    const char* address = m.AddressPattern();
-
-                    // Example: /track/1/volume
-                    int track_index;
-                    if (sscanf(address, "/track/%d/volume", &track_index) == 1) {
-                        // Get the first argument (the volume)
-                        auto it = m.ArgumentsBegin();
-                        if (it != m.ArgumentsEnd() && it->IsFloat()) {
-                            float volume = it->AsFloat();
-                            qDebug() << "QtGUI: Parsed OSC:" << address << volume;
-                            // Emit our Qt signal
-                            emit volumeChanged(track_index - 1, volume); // Convert back to 0-index
-                        }
-                    }
-                }
-            } catch(osc::Exception& e) {
-                qDebug() << "QtGUI: Error parsing OSC: " << e.what();
+    // The notifier is level triggered, so one datagram is read per
+    // activation and it fires again while more are queued.
+    void onLocalReadyRead() {
+        IpEndpointName remoteEndpoint;
+        std::size_t size = m_localSocket->ReceiveFrom(remoteEndpoint, m_localBuffer.data(), m_localBuffer.size());
+        if (size > 0)
+            processPacket(m_localBuffer.data(), size);
+    }
+
+    void onReleaseTimer() {
+        m_scheduler.TimerExpired();
+        if (m_scheduler.ScheduledBundleCount() == 0)
+            m_releaseTimer->stop();
+    }
+
+private:
+    void processPacket(const char* data, std::size_t size) {
+        // --- OSC Parsing (oscpack) ---
+
+        // TryParse reports malformed packets through an error code, so
+        // junk on the port doesn't cost an exception per datagram.
+        osc::ReceivedPacket p;
+        osc::ParseError error = osc::ReceivedPacket::TryParse(data, size, p);
+
+        if (error == osc::PARSE_OK && p.IsBundle()) {
+            // Bundles are applied at their time tag: the Hub sends
+            // automation a few ms ahead so it lands on time.
+            osc::ReceivedBundle b;
+            error = osc::ReceivedBundle::TryParse(p, b);
+            if (error == osc::PARSE_OK) {
+                m_scheduler.schedule(b);
+                if (m_scheduler.ScheduledBundleCount() > 0 && !m_releaseTimer->isActive())
+                    m_releaseTimer->start();
             }
+        } else if (error == osc::PARSE_OK) {
+            // Handle single message
+            osc::ReceivedMessage m;
+            error = osc::ReceivedMessage::TryParse(p, m);
+            if (error == osc::PARSE_OK)
+                handleMessage(m);
+        }
+
+        if (error != osc::PARSE_OK) {
+            qDebug() << "QtGUI: Error parsing OSC: " << osc::ParseErrorString(error);
         }
     }
 
-private:
-    QUdpSocket* m_socket;
+    void handleMessage(const osc::ReceivedMessage& m) {
+        m_routes.Dispatch(m, IpEndpointName());
+    }
+
+    // Example: /track/1/volume
+    void onTrackVolume(const osc::ReceivedMessage& m, const IpEndpointName&, osc::int32 track) {
+        // Decode the single float argument (the volume)
+        float volume;
+        if (osc::TryDecode(m, volume)) {
+            qDebug() << "QtGUI: Parsed OSC:" << m.AddressPattern() << volume;
+            // Emit our Qt signal
+            emit volumeChanged(track - 1, volume); // Convert back to 0-index
+        }
+    }
+
+    // Holds time-tagged bundles until they are due, then hands their
+    // messages back to handleMessage().
+    class BundleScheduler : public osc::ScheduledOscPacketListener {
+    public:
+        explicit BundleScheduler(OscListener* owner) : m_owner(owner) {}
+
+        void schedule(const osc::ReceivedBundle& b) { ProcessBundle(b, IpEndpointName()); }
+
+    protected:
+        void ProcessMessage(const osc::ReceivedMessage& m, const IpEndpointName&) override {
+            m_owner->handleMessage(m);
+        }
+
+    private:
+        OscListener* m_owner;
+    };
+
+    QUdpSocket* m_socket; // for UDP, or null
+    std::unique_ptr<LocalReceiveSocket> m_localSocket; // for a local endpoint
+    std::vector<char> m_localBuffer;
+    QTimer* m_releaseTimer;
+    osc::RouteDispatcher m_routes;
+    BundleScheduler m_scheduler;
 };
 
 // --- Main Window Class ---
@@ -124,7 +207,7 @@ class MainWindow : public QMainWindow {
     Q_OBJECT
 
 public:
-    MainWindow(QWidget* parent = nullptr) : QMainWindow(parent) {
+    MainWindow(const DatagramEndpoint& endpoint, QWidget* parent = nullptr) : QMainWindow(parent) {
         setWindowTitle("Mixer GUI (Stub)");
 
         // --- Setup GUI ---
@@ -141,7 +224,7 @@ public:
         setCentralWidget(central_widget);
 
         // --- Setup OSC Listener ---
-        m_listener = new OscListener(this);
+        m_listener = new OscListener(endpoint, this);
 
         // --- Connect OSC signal to GUI slot ---
         connect(m_listener, &OscListener::volumeChanged, this, &MainWindow::onVolumeChanged);
@@ -170,7 +253,20 @@ private:
 int main(int argc, char* argv[]) {
     QApplication app(argc, argv);
 
-    MainWindow main_window;
+    // The same endpoint the Hub sends to
+    DatagramEndpoint endpoint(IpEndpointName("127.0.0.1", OSC_LISTEN_PORT));
+    try {
+        if (argc > 1) {
+            endpoint = DatagramEndpoint::FromString(argv[1]);
+        } else if (const char* configured = std::getenv("OSC_ENDPOINT")) {
+            endpoint = DatagramEndpoint::FromString(configured);
+        }
+    } catch (std::exception& e) {
+        qDebug() << "QtGUI: Invalid OSC endpoint:" << e.what();
+        return 1;
+    }
+
+    MainWindow main_window(endpoint);
     main_window.resize(400, 150);
     main_window.show();
 
@@ -7,6 +7,10 @@
  * 1.  Runs a TCP Client to connect to the REAPER Plugin on port 9001.
  * 2.  Listens for simple text messages (e.g., "VOL 0 0.75\n").
  * 3.  Runs an OSC Server on port 9000 (for the Qt GUI to connect to).
+ *     The endpoint can be changed with the OSC_ENDPOINT environment
+ *     variable or the first argument, e.g. "local:@mixer-gui" to use a
+ *     Unix domain socket instead of loopback UDP. The GUI must be given
+ *     the same endpoint.
  * 4.  Translates the text message into an OSC message (e.g., /track/1/volume 0.75f).
  * 5.  Broadcasts the OSC message to all connected GUI clients.
  *
@@ -20,10 +24,12 @@
  */
 
 // --- C/C++ Standard Libraries ---
+#include <cstdlib>
 #include <iostream>
 #include <string>
 #include <thread>
 #include <cstring>
+#include <unordered_map>
 
 // --- OS-specific Networking ---
 #include <sys/socket.h>
@@ -34,23 +40,41 @@
 // --- OSC Library (oscpack example) ---
 // You must have oscpack headers and link the library.
 #include "osc/OscOutboundPacketStream.h"
+#include "osc/OscMessageTemplate.h"
+#include "osc/OscTimeTag.h"
 #include "ip/UdpSocket.h"
+#include "ip/DatagramEndpoint.h"
 
 // --- Globals ---
 #define OSC_BROADCAST_PORT 9000
 #define REAPER_PLUGIN_PORT 9001
 
-UdpTransmitSocket* g_osc_socket = nullptr;
+// Bundles are time-tagged this far ahead so the GUI can apply them at a
+// steady latency instead of whenever the network delivers them.
+#define OSC_SCHEDULE_AHEAD_US 5000
+
+// The socket is unconnected and sends to g_osc_endpoint, so the Hub can
+// start before the GUI and keeps reaching it after the GUI restarts.
+UdpSocket* g_osc_socket = nullptr;
+DatagramEndpoint g_osc_endpoint;
 
 // --- Main Application ---
-int main() {
+int main(int argc, char* argv[]) {
     std::cout << "Starting Hub Application..." << std::endl;
 
     // --- 1. Initialize OSC Server (UdpSocket for broadcasting) ---
-    // This socket will SEND OSC messages to the Qt GUI
+    // This socket will SEND OSC messages to the Qt GUI, over UDP or a
+    // local socket depending on the configured endpoint
     try {
-        g_osc_socket = new UdpTransmitSocket(IpEndpointName("127.0.0.1", OSC_BROADCAST_PORT));
-        std::cout << "Hub: OSC server broadcasting to 127.0.0.1:" << OSC_BROADCAST_PORT << std::endl;
+        g_osc_endpoint = DatagramEndpoint(IpEndpointName("127.0.0.1", OSC_BROADCAST_PORT));
+        if (argc > 1) {
+            g_osc_endpoint = DatagramEndpoint::FromString(argv[1]);
+        } else if (const char* configured = std::getenv("OSC_ENDPOINT")) {
+            g_osc_endpoint = DatagramEndpoint::FromString(configured);
+        }
+
+        g_osc_socket = g_osc_endpoint.CreateSocket();
+        std::cout << "Hub: OSC server broadcasting to " << g_osc_endpoint.ToString() << std::endl;
     } catch (std::exception& e) {
         std::cerr << "Hub: Error initializing OSC socket: " << e.what() << std::endl;
         return 1;
@@ -84,6 +108,10 @@ int main() {
             char read_buffer[1024];
             std::string line_buffer;
 
+            // One pre-encoded bundle per track. Only the time tag and the
+            // volume change between updates, so they're patched in place.
+            std::unordered_map<int, osc::MessageTemplate> volume_templates;
+
             while (true) {
                 int bytes_read = recv(ipc_sock, read_buffer, sizeof(read_buffer) - 1, 0);
                 if (bytes_read <= 0) {
@@ -120,16 +148,20 @@ int main() {
 
                             // --- Use oscpack to send the message ---
 
-                            char osc_buffer[1024];
-                            osc::OutboundPacketStream p(osc_buffer, sizeof(osc_buffer));
+                            auto t = volume_templates.find(track_index);
+                            if (t == volume_templates.end()) {
+                                t = volume_templates.emplace(track_index,
+                                        osc::MessageTemplate(osc_address.c_str(), "f", true)).first;
+                            }
+                            osc::MessageTemplate& p = t->second;
+
+                            osc::uint64 due = osc::CurrentTimeTag()
+                                    + osc::MicrosecondsToTimeTagInterval(OSC_SCHEDULE_AHEAD_US);
 
-                            p << osc::BeginBundleImmediate
-                              << osc::BeginMessage(osc_address.c_str())
-                              << volume
-                              << osc::EndMessage
-                              << osc::EndBundle;
+                            p.SetBundleTimeTag(due);
+                            p.SetFloat(0, volume);
 
-                            g_osc_socket->Send(p.Data(), p.Size());
+                            g_osc_endpoint.SendTo(*g_osc_socket, p.Data(), p.Size());
 
                         }
                     }
@@ -0,0 +1,117 @@
+/*
+	oscpack -- Open Sound Control (OSC) packet manipulation library
+    http://www.rossbencina.com/code/oscpack
+
+    Copyright (c) 2004-2013 Ross Bencina <rossb@audiomulch.com>
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files
+	(the "Software"), to deal in the Software without restriction,
+	including without limitation the rights to use, copy, modify, merge,
+	publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so,
+	subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+	ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+	WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	The text above constitutes the entire oscpack license; however, 
+	the oscpack developer(s) also make the following non-binding requests:
+
+	Any person wishing to distribute modifications to the Software is
+	requested to send the modifications to the original developer so that
+	they can be incorporated into the canonical version. It is also 
+	requested that these non-binding requests be included whenever the
+	above license is reproduced.
+*/
+#include "DatagramEndpoint.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+
+DatagramEndpoint DatagramEndpoint::FromString( const char *s )
+{
+    if( std::strncmp( s, "local:", 6 ) == 0 ){
+        if( s[6] == '\0' || (s[6] == '@' && s[7] == '\0') )
+            throw std::runtime_error("missing local socket name\n");
+        return DatagramEndpoint( LocalEndpointName( s + 6 ) );
+    }
+
+    if( std::strncmp( s, "udp:", 4 ) == 0 )
+        s += 4;
+
+    const char *colon = std::strrchr( s, ':' );
+    if( !colon || colon == s )
+        throw std::runtime_error("expected an endpoint like udp:host:port or local:path\n");
+
+    char *end;
+    long port = std::strtol( colon + 1, &end, 10 );
+    if( *end != '\0' || end == colon + 1 || port <= 0 || port > 65535 )
+        throw std::runtime_error("invalid udp port\n");
+
+    std::string host( s, colon );
+    return DatagramEndpoint( IpEndpointName( host.c_str(), (int)port ) );
+}
+
+
+std::string DatagramEndpoint::ToString() const
+{
+    if( transport == LOCAL_TRANSPORT )
+        return "local:" + localEndpoint.ToString();
+
+    char s[ IpEndpointName::ADDRESS_AND_PORT_STRING_LENGTH ];
+    ipEndpoint.AddressAndPortAsString( s );
+    return std::string( "udp:" ) + s;
+}
+
+
+UdpSocket *DatagramEndpoint::CreateTransmitSocket() const
+{
+    if( transport == LOCAL_TRANSPORT )
+        return new LocalTransmitSocket( localEndpoint );
+    else
+        return new UdpTransmitSocket( ipEndpoint );
+}
+
+
+UdpSocket *DatagramEndpoint::CreateSocket() const
+{
+    if( transport == LOCAL_TRANSPORT )
+        return new LocalDatagramSocket;
+    else
+        return new UdpSocket;
+}
+
+
+void DatagramEndpoint::SendTo( UdpSocket& socket, const char *data, std::size_t size ) const
+{
+    LocalDatagramSocket *localSocket = dynamic_cast<LocalDatagramSocket*>( &socket );
+    if( (transport == LOCAL_TRANSPORT) != (localSocket != 0) )
+        throw std::runtime_error("socket doesn't match the endpoint's transport\n");
+
+    if( localSocket )
+        localSocket->SendTo( localEndpoint, data, size );
+    else
+        socket.SendTo( ipEndpoint, data, size );
+}
+
+
+UdpSocket *DatagramEndpoint::CreateReceiveSocket() const
+{
+    if( transport == LOCAL_TRANSPORT )
+        return new LocalReceiveSocket( localEndpoint );
+    else
+        return new UdpReceiveSocket( ipEndpoint );
+}
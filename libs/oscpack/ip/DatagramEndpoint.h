@@ -0,0 +1,92 @@
+/*
+	oscpack -- Open Sound Control (OSC) packet manipulation library
+    http://www.rossbencina.com/code/oscpack
+
+    Copyright (c) 2004-2013 Ross Bencina <rossb@audiomulch.com>
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files
+	(the "Software"), to deal in the Software without restriction,
+	including without limitation the rights to use, copy, modify, merge,
+	publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so,
+	subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+	ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+	WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	The text above constitutes the entire oscpack license; however, 
+	the oscpack developer(s) also make the following non-binding requests:
+
+	Any person wishing to distribute modifications to the Software is
+	requested to send the modifications to the original developer so that
+	they can be incorporated into the canonical version. It is also 
+	requested that these non-binding requests be included whenever the
+	above license is reproduced.
+*/
+#ifndef INCLUDED_OSCPACK_DATAGRAMENDPOINT_H
+#define INCLUDED_OSCPACK_DATAGRAMENDPOINT_H
+
+#include <string>
+
+#include "IpEndpointName.h"
+#include "LocalDatagramSocket.h"
+
+
+// DatagramEndpoint is an endpoint on either transport, so that a program
+// can be switched between UDP and local sockets by configuration. It is
+// written as:
+//
+//   udp:127.0.0.1:9000 (or 127.0.0.1:9000)
+//   local:/run/mixer/gui.sock
+//   local:@mixer-gui (in the abstract namespace)
+
+class DatagramEndpoint{
+public:
+    enum Transport{ UDP_TRANSPORT, LOCAL_TRANSPORT };
+
+    DatagramEndpoint()
+        : transport( UDP_TRANSPORT ) {}
+    DatagramEndpoint( const IpEndpointName& ipEndpoint_ )
+        : transport( UDP_TRANSPORT ), ipEndpoint( ipEndpoint_ ) {}
+    DatagramEndpoint( const LocalEndpointName& localEndpoint_ )
+        : transport( LOCAL_TRANSPORT ), localEndpoint( localEndpoint_ ) {}
+
+    // throws std::runtime_error if s isn't a valid endpoint
+    static DatagramEndpoint FromString( const char *s );
+    std::string ToString() const;
+
+    Transport transport;
+    IpEndpointName ipEndpoint; // for UDP_TRANSPORT
+    LocalEndpointName localEndpoint; // for LOCAL_TRANSPORT
+
+    // a new socket connected to the endpoint, for Send(), or bound to it.
+    // the caller deletes the socket. throws std::runtime_error like the
+    // socket ctors. a local socket can only connect to a receiver that is
+    // already bound, and stays tied to it: if the receiver restarts, its
+    // sends fail. use CreateSocket() and SendTo() for that case.
+    UdpSocket *CreateTransmitSocket() const;
+    UdpSocket *CreateReceiveSocket() const;
+
+    // a new unconnected socket of the endpoint's transport, for SendTo()
+    UdpSocket *CreateSocket() const;
+
+    // send to the endpoint with a socket from CreateSocket(). the packet is
+    // dropped if nothing is receiving, and the sends reach a receiver that
+    // binds the endpoint later. throws std::runtime_error if the socket
+    // isn't of the endpoint's transport.
+    void SendTo( UdpSocket& socket, const char *data, std::size_t size ) const;
+};
+
+
+#endif /* INCLUDED_OSCPACK_DATAGRAMENDPOINT_H */
@@ -0,0 +1,159 @@
+/*
+	oscpack -- Open Sound Control (OSC) packet manipulation library
+    http://www.rossbencina.com/code/oscpack
+
+    Copyright (c) 2004-2013 Ross Bencina <rossb@audiomulch.com>
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files
+	(the "Software"), to deal in the Software without restriction,
+	including without limitation the rights to use, copy, modify, merge,
+	publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so,
+	subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+	ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+	WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	The text above constitutes the entire oscpack license; however, 
+	the oscpack developer(s) also make the following non-binding requests:
+
+	Any person wishing to distribute modifications to the Software is
+	requested to send the modifications to the original developer so that
+	they can be incorporated into the canonical version. It is also 
+	requested that these non-binding requests be included whenever the
+	above license is reproduced.
+*/
+#ifndef INCLUDED_OSCPACK_LOCALDATAGRAMSOCKET_H
+#define INCLUDED_OSCPACK_LOCALDATAGRAMSOCKET_H
+
+#include <cstring> // size_t
+#include <string>
+
+#include "UdpSocket.h"
+
+
+// LocalEndpointName names a Unix domain (AF_UNIX) datagram socket. It is
+// either a path in the file system, or a name in Linux's abstract
+// namespace, which needs no file and goes away with the socket. Abstract
+// names are written with a leading '@', as ss and netstat show them.
+
+class LocalEndpointName{
+public:
+    LocalEndpointName()
+        : isAbstract( false ) {}
+    LocalEndpointName( const char *name )
+        : path( (name[0] == '@') ? name + 1 : name )
+        , isAbstract( name[0] == '@' ) {}
+    LocalEndpointName( const std::string& path_, bool isAbstract_ )
+        : path( path_ ), isAbstract( isAbstract_ ) {}
+
+    std::string path;
+    bool isAbstract;
+
+    // the name with a leading '@' if it is abstract
+    std::string ToString() const { return (isAbstract) ? "@" + path : path; }
+};
+
+inline bool operator==( const LocalEndpointName& lhs, const LocalEndpointName& rhs )
+{
+    return (lhs.path == rhs.path && lhs.isAbstract == rhs.isAbstract );
+}
+
+inline bool operator!=( const LocalEndpointName& lhs, const LocalEndpointName& rhs )
+{
+    return !(lhs == rhs);
+}
+
+
+// LocalDatagramSocket is a UdpSocket that uses an AF_UNIX SOCK_DGRAM
+// socket, for processes on the same machine. The packets skip the IP
+// stack and aren't reordered. Sends don't block: like UDP, a packet is
+// dropped when the receiver's queue is full. It can be attached to a
+// SocketReceiveMultiplexer like any UdpSocket. The remote endpoint passed
+// to PacketListener is always IpEndpointName(), since the senders have no
+// IP address.
+//
+// Not available on Windows, where the ctor throws std::runtime_error.
+
+class LocalDatagramSocket : public UdpSocket{
+	// the IpEndpointName methods don't apply. Bind(), Connect() and
+	// SendTo() are hidden by the overloads below. called through a
+	// UdpSocket reference they throw std::runtime_error.
+	using UdpSocket::LocalEndpointFor;
+	using UdpSocket::SendToV;
+
+public:
+	LocalDatagramSocket();
+
+	// Connect to a remote endpoint which is used as the target
+	// for calls to Send()
+	void Connect( const LocalEndpointName& remoteEndpoint );
+	void SendTo( const LocalEndpointName& remoteEndpoint, const char *data, std::size_t size );
+
+	// Bind a local endpoint to receive incoming data. A socket file left
+	// at the path by a process that has exited is removed first, and the
+	// file is removed again when the socket is destroyed. Throws
+	// std::runtime_error if another socket is bound to the endpoint.
+	void Bind( const LocalEndpointName& localEndpoint );
+
+	// The socket's file descriptor, for waiting on it in another event
+	// loop (e.g. with a QSocketNotifier) instead of a
+	// SocketReceiveMultiplexer.
+	int FileDescriptor() const;
+};
+
+
+// convenience classes like UdpTransmitSocket, UdpReceiveSocket and
+// UdpListeningReceiveSocket
+
+class LocalTransmitSocket : public LocalDatagramSocket{
+public:
+	LocalTransmitSocket( const LocalEndpointName& remoteEndpoint )
+		{ Connect( remoteEndpoint ); }
+};
+
+
+class LocalReceiveSocket : public LocalDatagramSocket{
+public:
+	LocalReceiveSocket( const LocalEndpointName& localEndpoint )
+		{ Bind( localEndpoint ); }
+};
+
+
+class LocalListeningReceiveSocket : public LocalDatagramSocket{
+    SocketReceiveMultiplexer mux_;
+    PacketListener *listener_;
+public:
+	LocalListeningReceiveSocket( const LocalEndpointName& localEndpoint, PacketListener *listener )
+        : listener_( listener )
+    {
+        Bind( localEndpoint );
+        mux_.AttachSocketListener( this, listener_ );
+    }
+
+    ~LocalListeningReceiveSocket()
+        { mux_.DetachSocketListener( this, listener_ ); }
+
+    // see SocketReceiveMultiplexer for the behaviour of these methods...
+    void SetReceiveBatchSize( int maxPackets ) { mux_.SetReceiveBatchSize( maxPackets ); }
+    void SetWaitStrategy( SocketReceiveMultiplexer::WaitStrategy strategy, int spinMicroseconds=50 )
+        { mux_.SetWaitStrategy( strategy, spinMicroseconds ); }
+    void Run() { mux_.Run(); }
+	void RunUntilSigInt() { mux_.RunUntilSigInt(); }
+    void Break() { mux_.Break(); }
+    void AsynchronousBreak() { mux_.AsynchronousBreak(); }
+};
+
+
+#endif /* INCLUDED_OSCPACK_LOCALDATAGRAMSOCKET_H */
@@ -0,0 +1,206 @@
+/*
+	oscpack -- Open Sound Control (OSC) packet manipulation library
+    http://www.rossbencina.com/code/oscpack
+
+    Copyright (c) 2004-2013 Ross Bencina <rossb@audiomulch.com>
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files
+	(the "Software"), to deal in the Software without restriction,
+	including without limitation the rights to use, copy, modify, merge,
+	publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so,
+	subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+	ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+	WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	The text above constitutes the entire oscpack license; however, 
+	the oscpack developer(s) also make the following non-binding requests:
+
+	Any person wishing to distribute modifications to the Software is
+	requested to send the modifications to the original developer so that
+	they can be incorporated into the canonical version. It is also 
+	requested that these non-binding requests be included whenever the
+	above license is reproduced.
+*/
+#include "PacketBuffer.h"
+
+#include <cassert>
+#include <new>
+
+#if defined(_WIN32)
+#include <windows.h>
+#endif
+
+
+// the buffers are shared between threads, so their counts and the pool's
+// returned list are only changed atomically
+
+#if defined(_WIN32)
+
+static long AtomicLoad( const volatile long *value ) { return InterlockedCompareExchange( const_cast<volatile long*>( value ), 0, 0 ); }
+static long AtomicIncrement( volatile long *value ) { return InterlockedIncrement( value ); }
+static long AtomicDecrement( volatile long *value ) { return InterlockedDecrement( value ); }
+
+static PacketBuffer *AtomicExchange( PacketBuffer *volatile *p, PacketBuffer *value )
+{
+    return (PacketBuffer*)InterlockedExchangePointer( (PVOID volatile*)p, value );
+}
+
+static bool AtomicCompareExchange( PacketBuffer *volatile *p, PacketBuffer *expected, PacketBuffer *value )
+{
+    return InterlockedCompareExchangePointer( (PVOID volatile*)p, value, expected ) == expected;
+}
+
+#else
+
+static long AtomicLoad( const volatile long *value ) { return __atomic_load_n( value, __ATOMIC_ACQUIRE ); }
+static long AtomicIncrement( volatile long *value ) { return __atomic_add_fetch( value, 1, __ATOMIC_ACQ_REL ); }
+static long AtomicDecrement( volatile long *value ) { return __atomic_sub_fetch( value, 1, __ATOMIC_ACQ_REL ); }
+
+static PacketBuffer *AtomicExchange( PacketBuffer *volatile *p, PacketBuffer *value )
+{
+    return __atomic_exchange_n( p, value, __ATOMIC_ACQ_REL );
+}
+
+static bool AtomicCompareExchange( PacketBuffer *volatile *p, PacketBuffer *expected, PacketBuffer *value )
+{
+    return __atomic_compare_exchange_n( p, &expected, value, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED );
+}
+
+#endif
+
+
+PacketBuffer::PacketBuffer( PacketBufferPool *pool, std::size_t storageSize )
+    : pool_( pool )
+    , next_( 0 )
+    , referenceCount_( 0 )
+    , storageSize_( storageSize )
+{
+}
+
+
+void PacketBuffer::AddReference()
+{
+    AtomicIncrement( &referenceCount_ );
+}
+
+
+void PacketBuffer::Release()
+{
+    if( AtomicDecrement( &referenceCount_ ) != 0 )
+        return;
+
+    if( pool_ ){
+        pool_->Return( this );
+    }else{
+        this->~PacketBuffer();
+        delete [] reinterpret_cast<char*>( this );
+    }
+}
+
+
+bool PacketBuffer::IsShared() const
+{
+    return AtomicLoad( &referenceCount_ ) > 1;
+}
+
+
+PacketBuffer *PacketBuffer::Copy( const ReceivedDatagram& datagram )
+{
+    std::size_t size = (datagram.size > 0) ? (std::size_t)datagram.size : 0;
+    char *memory = new char[ HeaderSize() + size ];
+    PacketBuffer *buffer = new (memory) PacketBuffer( 0, size );
+    buffer->referenceCount_ = 1;
+
+    std::memcpy( buffer->Storage(), datagram.data, size );
+    buffer->datagram = datagram;
+    buffer->datagram.data = buffer->Storage();
+    buffer->datagram.buffer = buffer;
+
+    return buffer;
+}
+
+
+PacketBufferPool::PacketBufferPool( std::size_t bufferSize, int buffersPerSlab )
+    : bufferSize_( bufferSize )
+    , stride_( PacketBuffer::HeaderSize() + ((bufferSize + 63) & ~(std::size_t)63) )
+    , buffersPerSlab_( buffersPerSlab )
+    , free_( 0 )
+    , returned_( 0 )
+    , referenceCount_( 1 )
+{
+    assert( buffersPerSlab > 0 );
+}
+
+
+PacketBufferPool::~PacketBufferPool()
+{
+    // the buffers have trivial destructors, so the slabs are just freed
+    for( std::size_t i=0; i < slabs_.size(); ++i )
+        delete [] slabs_[i];
+}
+
+
+PacketBuffer *PacketBufferPool::Acquire()
+{
+    if( !free_ ){
+        // take all the buffers that other threads have returned
+        free_ = AtomicExchange( &returned_, 0 );
+    }
+
+    if( !free_ ){
+        char *slab = new char[ stride_ * buffersPerSlab_ ];
+        slabs_.push_back( slab );
+        for( int i=buffersPerSlab_ - 1; i >= 0; --i ){
+            PacketBuffer *buffer = new (slab + i * stride_) PacketBuffer( this, bufferSize_ );
+            buffer->next_ = free_;
+            free_ = buffer;
+        }
+    }
+
+    PacketBuffer *buffer = free_;
+    free_ = buffer->next_;
+    buffer->next_ = 0;
+    buffer->referenceCount_ = 1;
+
+    AtomicIncrement( &referenceCount_ );
+    return buffer;
+}
+
+
+void PacketBufferPool::Return( PacketBuffer *buffer )
+{
+    // a stack that is only ever taken whole, so there's no ABA problem
+    PacketBuffer *head;
+    do{
+        head = returned_;
+        buffer->next_ = head;
+    }while( !AtomicCompareExchange( &returned_, head, buffer ) );
+
+    ReleaseReference();
+}
+
+
+void PacketBufferPool::ReleaseOwnership()
+{
+    ReleaseReference();
+}
+
+
+void PacketBufferPool::ReleaseReference()
+{
+    if( AtomicDecrement( &referenceCount_ ) == 0 )
+        delete this;
+}
@@ -0,0 +1,182 @@
+/*
+	oscpack -- Open Sound Control (OSC) packet manipulation library
+    http://www.rossbencina.com/code/oscpack
+
+    Copyright (c) 2004-2013 Ross Bencina <rossb@audiomulch.com>
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files
+	(the "Software"), to deal in the Software without restriction,
+	including without limitation the rights to use, copy, modify, merge,
+	publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so,
+	subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+	ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+	WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	The text above constitutes the entire oscpack license; however, 
+	the oscpack developer(s) also make the following non-binding requests:
+
+	Any person wishing to distribute modifications to the Software is
+	requested to send the modifications to the original developer so that
+	they can be incorporated into the canonical version. It is also 
+	requested that these non-binding requests be included whenever the
+	above license is reproduced.
+*/
+#ifndef INCLUDED_OSCPACK_PACKETBUFFER_H
+#define INCLUDED_OSCPACK_PACKETBUFFER_H
+
+#include <cstring> // size_t
+#include <vector>
+
+#include "PacketListener.h"
+
+
+class PacketBufferPool;
+
+
+// PacketBuffer is a buffer that a packet was received into. It is
+// reference counted, so that a listener can keep the packet with a
+// PacketHandle instead of copying it, and goes back to its pool when the
+// last reference is released. References can be released from any thread.
+
+class PacketBuffer{
+    friend class PacketBufferPool;
+
+    PacketBufferPool *pool_; // 0 for a copy, which is deleted instead
+    PacketBuffer *next_; // in the pool's free lists
+    volatile long referenceCount_;
+    std::size_t storageSize_;
+
+    PacketBuffer( PacketBufferPool *pool, std::size_t storageSize );
+
+public:
+    // the received packet, filled in by the receiver. datagram.data
+    // points into Storage(), and datagram.buffer to this buffer.
+    ReceivedDatagram datagram;
+
+    char *Storage() { return reinterpret_cast<char*>( this ) + HeaderSize(); }
+    std::size_t StorageSize() const { return storageSize_; }
+
+    void AddReference();
+    void Release();
+
+    // true if there are other references than the caller's
+    bool IsShared() const;
+
+    // a new buffer with a copy of datagram, for a packet that isn't in a
+    // pooled buffer. its reference count is 1.
+    static PacketBuffer *Copy( const ReceivedDatagram& datagram );
+
+private:
+    static std::size_t HeaderSize() { return (sizeof(PacketBuffer) + 63) & ~(std::size_t)63; }
+};
+
+
+// PacketBufferPool allocates PacketBuffers of one size, a slab at a time,
+// and reuses them. Buffers are acquired by a single receiving thread, but
+// can be released from any thread. The pool is deleted once its owner has
+// called ReleaseOwnership() and every buffer has been released, so the
+// buffers a listener keeps can outlive the multiplexer that received them.
+
+class PacketBufferPool{
+    std::size_t bufferSize_;
+    std::size_t stride_;
+    int buffersPerSlab_;
+    std::vector<char*> slabs_;
+
+    PacketBuffer *free_; // used by the receiving thread only
+    PacketBuffer *volatile returned_; // pushed by the releasing threads
+    volatile long referenceCount_; // the owner's, plus one per acquired buffer
+
+    friend class PacketBuffer;
+    void Return( PacketBuffer *buffer );
+    void ReleaseReference();
+    ~PacketBufferPool();
+
+public:
+    PacketBufferPool( std::size_t bufferSize, int buffersPerSlab=64 );
+
+    std::size_t BufferSize() const { return bufferSize_; }
+
+    // a buffer with a reference count of 1
+    PacketBuffer *Acquire();
+
+    void ReleaseOwnership();
+
+private:
+    PacketBufferPool( const PacketBufferPool& ); // no copy construction
+    PacketBufferPool& operator=( const PacketBufferPool& ); // no assignment
+};
+
+
+// PacketHandle keeps a received packet valid after the listener call it
+// was passed to has returned. Handles can be copied, and passed to and
+// released on other threads. A packet that isn't in a pooled buffer
+// (from the io_uring backend, Windows, or SharedMemoryRingReceiver) is
+// copied once when the first handle is made.
+
+class PacketHandle{
+    PacketBuffer *buffer_;
+
+public:
+    PacketHandle() : buffer_( 0 ) {}
+    explicit PacketHandle( const ReceivedDatagram& datagram )
+        : buffer_( 0 )
+    {
+        if( datagram.buffer ){
+            buffer_ = datagram.buffer;
+            buffer_->AddReference();
+        }else{
+            buffer_ = PacketBuffer::Copy( datagram );
+        }
+    }
+
+    PacketHandle( const PacketHandle& rhs )
+        : buffer_( rhs.buffer_ )
+    {
+        if( buffer_ )
+            buffer_->AddReference();
+    }
+
+    PacketHandle& operator=( const PacketHandle& rhs )
+    {
+        if( rhs.buffer_ )
+            rhs.buffer_->AddReference();
+        Release();
+        buffer_ = rhs.buffer_;
+        return *this;
+    }
+
+    ~PacketHandle() { Release(); }
+
+    void Release()
+    {
+        if( buffer_ ){
+            buffer_->Release();
+            buffer_ = 0;
+        }
+    }
+
+    bool IsNull() const { return buffer_ == 0; }
+
+    const ReceivedDatagram& Datagram() const { return buffer_->datagram; }
+    const char *Data() const { return buffer_->datagram.data; }
+    int Size() const { return buffer_->datagram.size; }
+    const IpEndpointName& RemoteEndpoint() const { return buffer_->datagram.remoteEndpoint; }
+    const PacketTimestamp& Timestamp() const { return buffer_->datagram.timestamp; }
+};
+
+
+#endif /* INCLUDED_OSCPACK_PACKETBUFFER_H */
@@ -37,14 +37,68 @@
 #ifndef INCLUDED_OSCPACK_PACKETLISTENER_H
 #define INCLUDED_OSCPACK_PACKETLISTENER_H
 
+#include <stdint.h>
+
+#include "IpEndpointName.h"
+
+
+class PacketBuffer;
+
+// when the kernel received a packet, for sockets with timestamps enabled
+// (see UdpSocket::SetEnableTimestamps()). a time is 0 if it isn't available.
+struct PacketTimestamp{
+    PacketTimestamp() : softwareNs( 0 ), hardwareNs( 0 ) {}
+
+    // nanoseconds since the Unix epoch, on the same clock as
+    // clock_gettime( CLOCK_REALTIME )
+    uint64_t softwareNs;
+
+    // nanoseconds on the network interface's own clock
+    uint64_t hardwareNs;
+};
+
+
+// one of the packets passed to PacketListener::ProcessPacketBatch()
+struct ReceivedDatagram{
+    ReceivedDatagram() : data( 0 ), size( 0 ), buffer( 0 ) {}
+
+    const char *data;
+    int size;
+    IpEndpointName remoteEndpoint;
+    PacketTimestamp timestamp;
+
+    // the pooled buffer holding the packet, or 0. see PacketHandle for
+    // keeping the packet after the call.
+    PacketBuffer *buffer;
+};
 
-class IpEndpointName;
 
 class PacketListener{
 public:
     virtual ~PacketListener() {}
     virtual void ProcessPacket( const char *data, int size, 
 			const IpEndpointName& remoteEndpoint ) = 0;
+
+    // called by SocketReceiveMultiplexer with the packets received from a
+    // socket in one go, up to its receive batch size. the packet data is
+    // only valid during the call, unless it is kept with a PacketHandle.
+    // the default passes each packet to ProcessTimestampedPacket() in order.
+    virtual void ProcessPacketBatch( const ReceivedDatagram *datagrams, int count )
+    {
+        for( int i=0; i < count; ++i ){
+            ProcessTimestampedPacket( datagrams[i].data, datagrams[i].size,
+                    datagrams[i].remoteEndpoint, datagrams[i].timestamp );
+        }
+    }
+
+    // the timestamp is 0 unless the socket has timestamps enabled. the
+    // default ignores it and calls ProcessPacket().
+    virtual void ProcessTimestampedPacket( const char *data, int size,
+            const IpEndpointName& remoteEndpoint, const PacketTimestamp& timestamp )
+    {
+        (void) timestamp;
+        ProcessPacket( data, size, remoteEndpoint );
+    }
 };
 
 #endif /* INCLUDED_OSCPACK_PACKETLISTENER_H */
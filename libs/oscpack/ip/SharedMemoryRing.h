@@ -0,0 +1,120 @@
+/*
+	oscpack -- Open Sound Control (OSC) packet manipulation library
+    http://www.rossbencina.com/code/oscpack
+
+    Copyright (c) 2004-2013 Ross Bencina <rossb@audiomulch.com>
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files
+	(the "Software"), to deal in the Software without restriction,
+	including without limitation the rights to use, copy, modify, merge,
+	publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so,
+	subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+	ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+	WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	The text above constitutes the entire oscpack license; however, 
+	the oscpack developer(s) also make the following non-binding requests:
+
+	Any person wishing to distribute modifications to the Software is
+	requested to send the modifications to the original developer so that
+	they can be incorporated into the canonical version. It is also 
+	requested that these non-binding requests be included whenever the
+	above license is reproduced.
+*/
+#ifndef INCLUDED_OSCPACK_SHAREDMEMORYRING_H
+#define INCLUDED_OSCPACK_SHAREDMEMORYRING_H
+
+#include <cstring> // size_t
+#include <stdint.h>
+
+
+class PacketListener;
+
+
+// A ring of packets in shared memory, for processes on the same machine
+// that don't want to go through the kernel for each packet. The ring is a
+// memfd, which the transmitter creates and the receivers map. Its file
+// descriptor can be inherited by a child process, passed over a Unix
+// domain socket with SCM_RIGHTS, or opened as /proc/<pid>/fd/<fd>.
+//
+// There is one transmitter and any number of receivers, each of which
+// gets every packet sent after it was created. The transmitter never
+// waits for the receivers. Like a UDP socket whose receive buffer
+// overflowed, a receiver that falls a whole ring behind loses the packets
+// it missed. A sleeping receiver is woken with a futex, and the
+// transmitter only makes that system call when a receiver is asleep.
+//
+// Linux only. Elsewhere the ctors throw std::runtime_error.
+
+class SharedMemoryRingTransmitter{
+    class Implementation;
+    Implementation *impl_;
+
+public:
+    // capacity is the size of the ring in bytes, a power of two of at
+    // least 4096. throws std::runtime_error if the ring can't be created.
+    explicit SharedMemoryRingTransmitter( std::size_t capacity=1<<20 );
+    ~SharedMemoryRingTransmitter();
+
+    // the memfd, for passing to the receiving processes
+    int FileDescriptor() const;
+
+    // the largest packet that can be sent, a quarter of the capacity
+    std::size_t MaxPacketSize() const;
+
+    // like UdpSocket::Send(). throws std::runtime_error if the packet is
+    // larger than MaxPacketSize().
+    void Send( const char *data, std::size_t size );
+
+private:
+    SharedMemoryRingTransmitter( const SharedMemoryRingTransmitter& ); // no copy construction
+    SharedMemoryRingTransmitter& operator=( const SharedMemoryRingTransmitter& ); // no assignment
+};
+
+
+// Receives the packets from a SharedMemoryRingTransmitter and passes them
+// to a PacketListener, with IpEndpointName() as the remote endpoint. The
+// packet data is a copy, so it can't be overwritten during the call.
+
+class SharedMemoryRingReceiver{
+    class Implementation;
+    Implementation *impl_;
+
+public:
+    // maps the ring. the file descriptor isn't kept, so it can be closed
+    // afterwards. throws std::runtime_error if fd isn't a ring.
+    SharedMemoryRingReceiver( int fd, PacketListener *listener );
+    ~SharedMemoryRingReceiver();
+
+    // pass the packets that are waiting to the listener without blocking.
+    // returns the number of packets.
+    int ReceivePackets();
+
+    // the number of times the receiver fell behind and lost packets
+    uint64_t OverrunCount() const;
+
+    // like UdpListeningReceiveSocket
+    void Run();      // loop and block processing packets indefinitely
+    void Break();    // call this from the listener to exit once it returns
+    void AsynchronousBreak(); // call this from another thread to exit Run()
+
+private:
+    SharedMemoryRingReceiver( const SharedMemoryRingReceiver& ); // no copy construction
+    SharedMemoryRingReceiver& operator=( const SharedMemoryRingReceiver& ); // no assignment
+};
+
+
+#endif /* INCLUDED_OSCPACK_SHAREDMEMORYRING_H */
@@ -0,0 +1,286 @@
+/*
+	oscpack -- Open Sound Control (OSC) packet manipulation library
+    http://www.rossbencina.com/code/oscpack
+
+    Copyright (c) 2004-2013 Ross Bencina <rossb@audiomulch.com>
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files
+	(the "Software"), to deal in the Software without restriction,
+	including without limitation the rights to use, copy, modify, merge,
+	publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so,
+	subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+	ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+	WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	The text above constitutes the entire oscpack license; however, 
+	the oscpack developer(s) also make the following non-binding requests:
+
+	Any person wishing to distribute modifications to the Software is
+	requested to send the modifications to the original developer so that
+	they can be incorporated into the canonical version. It is also 
+	requested that these non-binding requests be included whenever the
+	above license is reproduced.
+*/
+#include "TimerWheel.h"
+
+#include <cassert>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+
+namespace{
+
+// the index of the lowest set bit of a non-zero x
+int LowestSetBit( uint64_t x )
+{
+#if defined(__GNUC__)
+    return __builtin_ctzll( x );
+#elif defined(_MSC_VER) && defined(_WIN64)
+    unsigned long index;
+    _BitScanForward64( &index, x );
+    return (int)index;
+#else
+    int index = 0;
+    while( !(x & 1) ){
+        x >>= 1;
+        ++index;
+    }
+    return index;
+#endif
+}
+
+// the distance from slot start to the next occupied slot, wrapping round,
+// or -1 if there are none
+int NextOccupiedSlot( uint64_t occupied, int start )
+{
+    if( occupied == 0 )
+        return -1;
+    uint64_t rotated = ( start == 0 ) ? occupied : ( (occupied >> start) | (occupied << (64 - start)) );
+    return LowestSetBit( rotated );
+}
+
+void InitializeList( TimerWheel::Link& list )
+{
+    list.next = list.prev = &list;
+}
+
+} // namespace
+
+
+TimerWheel::TimerWheel()
+    : currentTick_( 0 )
+    , count_( 0 )
+{
+    for( int level=0; level < LEVEL_COUNT; ++level ){
+        for( int slot=0; slot < SLOT_COUNT; ++slot )
+            InitializeList( slots_[level][slot] );
+        occupied_[level] = 0;
+    }
+    InitializeList( expired_ );
+}
+
+
+void TimerWheel::Clear( uint64_t nowNs )
+{
+    for( int level=0; level < LEVEL_COUNT; ++level ){
+        for( int slot=0; slot < SLOT_COUNT; ++slot ){
+            Link& list = slots_[level][slot];
+            while( list.next != &list )
+                Unlink( static_cast<Timer*>( list.next ) );
+        }
+    }
+    while( expired_.next != &expired_ )
+        Unlink( static_cast<Timer*>( expired_.next ) );
+
+    currentTick_ = nowNs >> TICK_SHIFT;
+}
+
+
+void TimerWheel::Schedule( Timer *timer )
+{
+    if( timer->next )
+        Unlink( timer );
+    Insert( timer );
+}
+
+
+void TimerWheel::Cancel( Timer *timer )
+{
+    if( timer->next )
+        Unlink( timer );
+}
+
+
+void TimerWheel::CollectExpired( uint64_t nowNs )
+{
+    const uint64_t nowTick = nowNs >> TICK_SHIFT;
+
+    if( count_ == 0 && currentTick_ < nowTick )
+        currentTick_ = nowTick;
+
+    for(;;){
+        // level 0 holds the timers for the next SLOT_COUNT ticks, so all of
+        // the current slot's timers are due unless it is the tick of nowNs
+        int index = (int)(currentTick_ & SLOT_MASK);
+        Link& list = slots_[0][index];
+        Link *i = list.next;
+        while( i != &list ){
+            Timer *timer = static_cast<Timer*>( i );
+            i = i->next;
+            if( timer->expiryNs <= nowNs ){
+                Unlink( timer );
+                timer->level = -1;
+                timer->next = &expired_;
+                timer->prev = expired_.prev;
+                expired_.prev->next = timer;
+                expired_.prev = timer;
+                ++count_;
+            }
+        }
+
+        if( currentTick_ >= nowTick )
+            break;
+
+        // skip to the next occupied slot, stopping at the end of level 0
+        // to cascade the upper levels
+        uint64_t nextTick = (currentTick_ | SLOT_MASK) + 1;
+        if( index < SLOT_MASK ){
+            uint64_t later = occupied_[0] & ( ~(uint64_t)0 << (index + 1) );
+            if( later )
+                nextTick = currentTick_ - index + LowestSetBit( later );
+        }
+        currentTick_ = ( nextTick < nowTick ) ? nextTick : nowTick;
+
+        if( (currentTick_ & SLOT_MASK) == 0 ){
+            for( int level=1; level < LEVEL_COUNT; ++level ){
+                unsigned int slot = (unsigned int)( (currentTick_ >> (level * LEVEL_BITS)) & SLOT_MASK );
+                Cascade( level, slot );
+                if( slot != 0 )
+                    break;
+            }
+        }
+    }
+}
+
+
+TimerWheel::Timer *TimerWheel::PopExpired()
+{
+    if( expired_.next == &expired_ )
+        return 0;
+
+    Timer *timer = static_cast<Timer*>( expired_.next );
+    Unlink( timer );
+    return timer;
+}
+
+
+int64_t TimerWheel::NanosecondsUntilNextExpiry( uint64_t nowNs ) const
+{
+    if( expired_.next != &expired_ )
+        return 0;
+    if( count_ == 0 )
+        return -1;
+
+    uint64_t nextNs = ~(uint64_t)0;
+
+    // the earliest timer in the first occupied level 0 slot
+    int index = (int)(currentTick_ & SLOT_MASK);
+    int distance = NextOccupiedSlot( occupied_[0], index );
+    if( distance >= 0 ){
+        const Link& list = slots_[0][ (index + distance) & SLOT_MASK ];
+        for( const Link *i = list.next; i != &list; i = i->next ){
+            const Timer *timer = static_cast<const Timer*>( i );
+            if( timer->expiryNs < nextNs )
+                nextNs = timer->expiryNs;
+        }
+    }
+
+    // the upper levels are woken for when their next occupied slot is
+    // cascaded
+    for( int level=1; level < LEVEL_COUNT; ++level ){
+        int shift = level * LEVEL_BITS;
+        int slot = (int)( (currentTick_ >> shift) & SLOT_MASK );
+        distance = NextOccupiedSlot( occupied_[level], (slot + 1) & SLOT_MASK );
+        if( distance >= 0 ){
+            uint64_t cascadeNs = ( ((currentTick_ >> shift) + distance + 1) << shift ) << TICK_SHIFT;
+            if( cascadeNs < nextNs )
+                nextNs = cascadeNs;
+        }
+    }
+
+    return ( nextNs > nowNs ) ? (int64_t)(nextNs - nowNs) : 0;
+}
+
+
+void TimerWheel::Insert( Timer *timer )
+{
+    uint64_t tick = timer->expiryNs >> TICK_SHIFT;
+    if( tick < currentTick_ )
+        tick = currentTick_;
+
+    // the level is chosen by how far away the timer is, the slot by its
+    // tick at that level's resolution
+    uint64_t delta = tick - currentTick_;
+    int level = 0;
+    while( level < LEVEL_COUNT - 1 && delta >= ((uint64_t)1 << ((level + 1) * LEVEL_BITS)) )
+        ++level;
+    if( delta >= ((uint64_t)1 << (LEVEL_COUNT * LEVEL_BITS)) ){
+        // too far away, it will be filed again when the slot is cascaded
+        tick = currentTick_ + ((uint64_t)1 << (LEVEL_COUNT * LEVEL_BITS)) - 1;
+    }
+
+    int slot = (int)( (tick >> (level * LEVEL_BITS)) & SLOT_MASK );
+    Link& list = slots_[level][slot];
+    timer->level = level;
+    timer->slot = slot;
+    timer->next = &list;
+    timer->prev = list.prev;
+    list.prev->next = timer;
+    list.prev = timer;
+    occupied_[level] |= (uint64_t)1 << slot;
+    ++count_;
+}
+
+
+void TimerWheel::Unlink( Timer *timer )
+{
+    assert( timer->next != 0 );
+
+    timer->prev->next = timer->next;
+    timer->next->prev = timer->prev;
+
+    if( timer->level >= 0 ){
+        Link& list = slots_[ timer->level ][ timer->slot ];
+        if( list.next == &list )
+            occupied_[ timer->level ] &= ~((uint64_t)1 << timer->slot);
+    }
+
+    timer->next = timer->prev = 0;
+    --count_;
+}
+
+
+void TimerWheel::Cascade( int level, unsigned int slot )
+{
+    Link& list = slots_[level][slot];
+    while( list.next != &list ){
+        Timer *timer = static_cast<Timer*>( list.next );
+        Unlink( timer );
+        Insert( timer );
+    }
+}
@@ -0,0 +1,129 @@
+/*
+	oscpack -- Open Sound Control (OSC) packet manipulation library
+    http://www.rossbencina.com/code/oscpack
+
+    Copyright (c) 2004-2013 Ross Bencina <rossb@audiomulch.com>
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files
+	(the "Software"), to deal in the Software without restriction,
+	including without limitation the rights to use, copy, modify, merge,
+	publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so,
+	subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+	ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+	WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	The text above constitutes the entire oscpack license; however, 
+	the oscpack developer(s) also make the following non-binding requests:
+
+	Any person wishing to distribute modifications to the Software is
+	requested to send the modifications to the original developer so that
+	they can be incorporated into the canonical version. It is also 
+	requested that these non-binding requests be included whenever the
+	above license is reproduced.
+*/
+#ifndef INCLUDED_OSCPACK_TIMERWHEEL_H
+#define INCLUDED_OSCPACK_TIMERWHEEL_H
+
+#include <stdint.h>
+
+
+class TimerListener;
+
+
+// TimerWheel holds the periodic timers of a SocketReceiveMultiplexer. It
+// is a hierarchical timing wheel of 4 levels of 64 slots, with ticks of
+// 2^20 ns (about 1 ms). Scheduling, cancelling and expiring a timer take
+// constant time, whatever the number of timers. Timers further away than
+// the wheel spans (about 5 hours) wait in the last level and are filed
+// again when their slot comes round.
+//
+// Times are nanoseconds on a monotonic clock supplied by the caller.
+
+class TimerWheel{
+public:
+    struct Link{
+        Link *next;
+        Link *prev;
+    };
+
+    struct Timer : public Link{
+        Timer( int id, int p, TimerListener *tl )
+            : initialDelayMs( id )
+            , periodMs( p )
+            , listener( tl )
+            , expiryNs( 0 )
+            , level( 0 )
+            , slot( 0 ) { next = prev = 0; }
+        int initialDelayMs;
+        int periodMs;
+        TimerListener *listener;
+        uint64_t expiryNs;
+
+        // where the timer is filed, used by TimerWheel. next is 0 when the
+        // timer isn't scheduled, level is -1 on the expired list.
+        int level;
+        int slot;
+    };
+
+    TimerWheel();
+
+    // unschedules all timers and sets the current time
+    void Clear( uint64_t nowNs );
+
+    // schedules timer to expire at timer->expiryNs. a timer that is
+    // already scheduled is moved.
+    void Schedule( Timer *timer );
+    void Cancel( Timer *timer );
+
+    // moves the timers that have expired by nowNs to the expired list,
+    // where they stay until they are popped or scheduled again
+    void CollectExpired( uint64_t nowNs );
+
+    // returns 0 when the expired list is empty
+    Timer *PopExpired();
+
+    // nanoseconds until a timer may expire, 0 if some already have, or -1
+    // if none are scheduled. the result is never late but may be early
+    // when the next timer is in an upper level.
+    int64_t NanosecondsUntilNextExpiry( uint64_t nowNs ) const;
+
+    bool Empty() const { return count_ == 0; }
+
+private:
+    enum{
+        TICK_SHIFT = 20,
+        LEVEL_BITS = 6,
+        SLOT_COUNT = 1 << LEVEL_BITS,
+        SLOT_MASK = SLOT_COUNT - 1,
+        LEVEL_COUNT = 4
+    };
+
+    Link slots_[ LEVEL_COUNT ][ SLOT_COUNT ];
+    uint64_t occupied_[ LEVEL_COUNT ]; // a bit per non-empty slot
+    Link expired_;
+    uint64_t currentTick_;
+    int count_; // scheduled and expired timers
+
+    void Insert( Timer *timer );
+    void Unlink( Timer *timer );
+    void Cascade( int level, unsigned int slot );
+
+    TimerWheel( const TimerWheel& ); // no copy construction
+    TimerWheel& operator=( const TimerWheel& ); // no assignment
+};
+
+
+#endif /* INCLUDED_OSCPACK_TIMERWHEEL_H */
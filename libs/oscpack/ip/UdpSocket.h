@@ -38,15 +38,19 @@
 #define INCLUDED_OSCPACK_UDPSOCKET_H
 
 #include <cstring> // size_t
+#include <vector>
 
 #include "NetworkingUtils.h"
 #include "IpEndpointName.h"
+#include "IoVector.h"
 
 
 class PacketListener;
 class TimerListener;
+struct PacketTimestamp;
 
 class UdpSocket;
+class UdpSendBatch;
 
 class SocketReceiveMultiplexer{
     class Implementation;
@@ -55,9 +59,25 @@ class SocketReceiveMultiplexer{
 	friend class UdpSocket;
 
 public:
-    SocketReceiveMultiplexer();
+    // how the multiplexer waits for packets and timers. DEFAULT_BACKEND is
+    // epoll on Linux and select() on other POSIX systems. IO_URING_BACKEND
+    // (Linux 6.0 or later) receives with multishot recvmsg into provided
+    // buffers, and falls back to epoll if the kernel doesn't support it.
+    // other unavailable backends fall back to select(). Windows always
+    // uses WaitForMultipleObjects() and reports DEFAULT_BACKEND.
+    enum Backend{
+        DEFAULT_BACKEND,
+        SELECT_BACKEND,
+        EPOLL_BACKEND,
+        IO_URING_BACKEND
+    };
+
+    explicit SocketReceiveMultiplexer( Backend backend=DEFAULT_BACKEND );
     ~SocketReceiveMultiplexer();
 
+    // the backend in use, after any fallback
+    Backend GetBackend() const;
+
 	// only call the attach/detach methods _before_ calling Run
 
     // only one listener per socket, each socket at most once
@@ -69,6 +89,31 @@ public:
             int initialDelayMilliseconds, int periodMilliseconds, TimerListener *listener );
     void DetachPeriodicTimerListener( TimerListener *listener );  
 
+    // drain up to maxPackets packets from each ready socket (with recvmmsg
+    // on Linux) and pass them to PacketListener::ProcessPacketBatch(). the
+    // default of 1 receives one packet per wakeup.
+    //
+    // on POSIX systems other than with the io_uring backend, the packets
+    // are received into buffers from a pool per packet size, so a listener
+    // can keep them with a PacketHandle without a copy.
+    void SetReceiveBatchSize( int maxPackets );
+
+    // how Run() waits for packets. BLOCKING_WAIT (the default) sleeps in
+    // the backend until a socket is ready or a timer is due.
+    // SPIN_THEN_BLOCK_WAIT polls the sockets without sleeping for
+    // spinMicroseconds after each wakeup, then sleeps, which saves the
+    // wakeup latency when packets follow each other closely.
+    // BUSY_POLL_WAIT never sleeps, so it keeps a processor busy and is
+    // meant for a thread with a core of its own. the timers and
+    // AsynchronousBreak() work the same with each. see also
+    // UdpSocket::SetBusyPoll().
+    enum WaitStrategy{
+        BLOCKING_WAIT,
+        SPIN_THEN_BLOCK_WAIT,
+        BUSY_POLL_WAIT
+    };
+    void SetWaitStrategy( WaitStrategy strategy, int spinMicroseconds=50 );
+
     void Run();      // loop and block processing messages indefinitely
 	void RunUntilSigInt();
     void Break();    // call this from a listener to exit once the listener returns
@@ -81,6 +126,13 @@ class UdpSocket{
     Implementation *impl_;
     
 	friend class SocketReceiveMultiplexer::Implementation;
+	friend class UdpReceiveGroup;
+	friend class LocalDatagramSocket;
+
+	// the socket's address family. LocalDatagramSocket uses the same
+	// implementation with an AF_UNIX socket.
+	enum AddressFamily{ INTERNET_FAMILY, LOCAL_FAMILY };
+	explicit UdpSocket( AddressFamily family );
     
 public:
 
@@ -102,6 +154,27 @@ public:
 	// operating systems.
 	void SetAllowReuse( bool allowReuse );
 
+	// Record when the kernel receives each packet, for ReceiveFrom() and
+	// PacketListener::ProcessTimestampedPacket(). Sets SO_TIMESTAMPNS
+	// (SO_TIMESTAMP on systems without it). With includeHardware on Linux
+	// it sets SO_TIMESTAMPING instead, which also reports the network
+	// interface's timestamps if the interface has been configured to make
+	// them (with the SIOCSHWTSTAMP ioctl). Does nothing on Windows.
+	void SetEnableTimestamps( bool enableTimestamps, bool includeHardware=false );
+
+	// Busy-wait on the network device's receive queue for up to
+	// microseconds in blocking receives and polls, instead of waiting for
+	// an interrupt. Sets SO_BUSY_POLL on Linux, where values above the
+	// net.core.busy_read sysctl need CAP_NET_ADMIN. 0 turns it off. Does
+	// nothing on other systems.
+	void SetBusyPoll( int microseconds );
+
+	// The largest packet SocketReceiveMultiplexer receives from the
+	// socket. Longer packets are truncated, as with ReceiveFrom(). The
+	// default is 4098 bytes. Takes effect at the next Run().
+	void SetMaxPacketSize( std::size_t maxPacketSize );
+	std::size_t MaxPacketSize() const;
+
 
 	// The socket is created in an unbound, unconnected state
 	// such a socket can only be used to send to an arbitrary
@@ -119,6 +192,16 @@ public:
 	void Send( const char *data, std::size_t size );
     void SendTo( const IpEndpointName& remoteEndpoint, const char *data, std::size_t size );
 
+	// Send the concatenation of count buffers as a single datagram
+	// (scatter/gather) without copying them together first.
+	void SendV( const IoVector *vectors, std::size_t count );
+	void SendToV( const IpEndpointName& remoteEndpoint, const IoVector *vectors, std::size_t count );
+
+	// Send all the packets queued in batch, with as few system calls as
+	// possible (sendmmsg on Linux). The result of each send is recorded in
+	// its batch entry. Returns the number of packets that were sent.
+	std::size_t SendBatch( UdpSendBatch& batch );
+
 
 	// Bind a local endpoint to receive incoming data. Endpoint
 	// can be 'any' for the system to choose an endpoint
@@ -126,6 +209,59 @@ public:
 	bool IsBound() const;
 
     std::size_t ReceiveFrom( IpEndpointName& remoteEndpoint, char *data, std::size_t size );
+    std::size_t ReceiveFrom( IpEndpointName& remoteEndpoint, char *data, std::size_t size,
+            PacketTimestamp& timestamp );
+};
+
+
+// UdpSendBatch queues packets for UdpSocket::SendBatch(). The packet data
+// is referenced, not copied, so it must stay valid until the batch is sent.
+// A batch can be reused after Clear() without allocating.
+
+class UdpSendBatch{
+public:
+    struct Entry{
+        IpEndpointName remoteEndpoint;
+        bool toConnectedEndpoint;
+        const char *data;
+        std::size_t size;
+
+        // set by UdpSocket::SendBatch(). error is 0 if the packet was sent,
+        // otherwise errno (WSAGetLastError() on Windows).
+        std::size_t bytesSent;
+        int error;
+    };
+
+    void Clear() { entries_.clear(); }
+
+    std::size_t Size() const { return entries_.size(); }
+    bool Empty() const { return entries_.empty(); }
+
+    // queue a packet for the socket's connected endpoint
+    void Add( const char *data, std::size_t size )
+        { Add( IpEndpointName(), true, data, size ); }
+
+    void Add( const IpEndpointName& remoteEndpoint, const char *data, std::size_t size )
+        { Add( remoteEndpoint, false, data, size ); }
+
+    Entry& operator[]( std::size_t index ) { return entries_[index]; }
+    const Entry& operator[]( std::size_t index ) const { return entries_[index]; }
+
+private:
+    void Add( const IpEndpointName& remoteEndpoint, bool toConnectedEndpoint,
+            const char *data, std::size_t size )
+    {
+        Entry e;
+        e.remoteEndpoint = remoteEndpoint;
+        e.toConnectedEndpoint = toConnectedEndpoint;
+        e.data = data;
+        e.size = size;
+        e.bytesSent = 0;
+        e.error = 0;
+        entries_.push_back( e );
+    }
+
+    std::vector<Entry> entries_;
 };
 
 
@@ -166,6 +302,9 @@ public:
         { mux_.DetachSocketListener( this, listener_ ); }
 
     // see SocketReceiveMultiplexer above for the behaviour of these methods...
+    void SetReceiveBatchSize( int maxPackets ) { mux_.SetReceiveBatchSize( maxPackets ); }
+    void SetWaitStrategy( SocketReceiveMultiplexer::WaitStrategy strategy, int spinMicroseconds=50 )
+        { mux_.SetWaitStrategy( strategy, spinMicroseconds ); }
     void Run() { mux_.Run(); }
 	void RunUntilSigInt() { mux_.RunUntilSigInt(); }
     void Break() { mux_.Break(); }
@@ -173,4 +312,66 @@ public:
 };
 
 
+// UdpReceiveGroup receives on one port with several sockets, each with its
+// own multiplexer and thread, so that packet processing is spread over
+// processors. On Linux the sockets share the port with SO_REUSEPORT.
+// Other systems don't balance datagrams between such sockets, so the
+// group has a single socket there.
+//
+// By default the kernel picks the socket from a hash of the source
+// address and port. The steering options attach a classic BPF program
+// to the group instead:
+//
+//   SOURCE_ADDRESS_STEERING - by source address, so that all the ports
+//       of one sender go to the same thread
+//   CPU_STEERING - by the processor that received the packet, best
+//       combined with SetPinThreads( true )
+
+class UdpReceiveGroup{
+    class Implementation;
+    Implementation *impl_;
+
+public:
+    enum Steering{
+        HASH_STEERING,
+        SOURCE_ADDRESS_STEERING,
+        CPU_STEERING
+    };
+
+    // binds a socket to localEndpoint for each listener. the packets of
+    // socket i are passed to listeners[i] on thread i. throws
+    // std::runtime_error if the sockets can't be bound or the steering
+    // program can't be attached.
+    UdpReceiveGroup( const IpEndpointName& localEndpoint,
+            const std::vector<PacketListener*>& listeners, Steering steering=HASH_STEERING );
+    ~UdpReceiveGroup(); // stops the threads
+
+    int Size() const; // the number of sockets and threads
+    UdpSocket& Socket( int index );
+
+    // for attaching timers, or setting the receive batch size or wait
+    // strategy, before Start()
+    SocketReceiveMultiplexer& Multiplexer( int index );
+
+    // pin thread i to processor i (modulo the processor count). takes
+    // effect at the next Start().
+    void SetPinThreads( bool pinThreads );
+
+    // start a thread per socket running its multiplexer. returns once all
+    // the multiplexers are running. if a multiplexer's Run() throws
+    // before then, the threads are stopped and the error is rethrown as
+    // std::runtime_error.
+    void Start();
+
+    // break the multiplexers and wait for the threads to exit. throws
+    // std::runtime_error if a multiplexer's Run() threw since Start().
+    // Start() may be called again afterwards.
+    void Stop();
+
+private:
+    UdpReceiveGroup( const UdpReceiveGroup& ); // no copy construction
+    UdpReceiveGroup& operator=( const UdpReceiveGroup& ); // no assignment
+};
+
+
 #endif /* INCLUDED_OSCPACK_UDPSOCKET_H */
@@ -0,0 +1,455 @@
+/*
+	oscpack -- Open Sound Control (OSC) packet manipulation library
+    http://www.rossbencina.com/code/oscpack
+
+    Copyright (c) 2004-2013 Ross Bencina <rossb@audiomulch.com>
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files
+	(the "Software"), to deal in the Software without restriction,
+	including without limitation the rights to use, copy, modify, merge,
+	publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so,
+	subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+	ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+	WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	The text above constitutes the entire oscpack license; however, 
+	the oscpack developer(s) also make the following non-binding requests:
+
+	Any person wishing to distribute modifications to the Software is
+	requested to send the modifications to the original developer so that
+	they can be incorporated into the canonical version. It is also 
+	requested that these non-binding requests be included whenever the
+	above license is reproduced.
+*/
+#include "ip/SharedMemoryRing.h"
+
+#include <cstring> // for memcpy
+#include <stdexcept>
+#include <vector>
+
+#include "ip/IpEndpointName.h"
+#include "ip/PacketListener.h"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+
+// the memfd holds a page with the RingHeader, then the ring. positions in
+// the ring are byte counts since it was created, so they only grow, and a
+// position's offset in the ring is the position modulo the capacity. the
+// header's words are shared between processes, so they are only accessed
+// with the __atomic builtins.
+struct RingHeader{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t capacity;
+    uint64_t maxPacketSize;
+    char padding0[ 64 - 24 ];
+
+    // a record is written after writeStart moves past it, and before
+    // writeEnd does. a receiver that copied a record from before
+    // writeStart - capacity may have copied overwritten data.
+    uint64_t writeStart;
+    uint64_t writeEnd;
+    char padding1[ 64 - 16 ];
+
+    // the futex that sleeping receivers wait on, and how many there are.
+    // a receiver that dies while asleep leaves the count raised, which
+    // only costs the transmitter unnecessary wakeups.
+    uint32_t wakeSequence;
+    uint32_t sleeperCount;
+};
+
+static const uint32_t RING_MAGIC = 0x5243534f; // "OSCR"
+static const uint32_t RING_VERSION = 1;
+static const std::size_t HEADER_SIZE = 4096;
+
+// a record is its packet's size, 4 unused bytes and the packet, padded to a
+// multiple of 8 bytes. records don't wrap around the end of the ring: the
+// rest of the ring is skipped with a padding record.
+static const uint64_t RECORD_HEADER_SIZE = 8;
+static const uint32_t PADDING_RECORD = 0xFFFFFFFF;
+
+
+static uint64_t RecordSize( uint64_t packetSize )
+{
+    return (RECORD_HEADER_SIZE + packetSize + 7) & ~(uint64_t)7;
+}
+
+
+static void Futex( uint32_t *address, int operation, uint32_t value )
+{
+    // shared, not FUTEX_PRIVATE_FLAG, since the ring is in several processes
+    syscall( SYS_futex, address, operation, value, (void*)0, (void*)0, 0 );
+}
+
+
+class SharedMemoryRingTransmitter::Implementation{
+    int fd_;
+    char *map_;
+    std::size_t mapSize_;
+    RingHeader *header_;
+    char *ring_;
+    uint64_t capacity_;
+    uint64_t maxPacketSize_;
+    uint64_t writePosition_;
+
+public:
+    Implementation( std::size_t capacity )
+        : fd_( -1 )
+        , map_( 0 )
+        , mapSize_( HEADER_SIZE + capacity )
+        , capacity_( capacity )
+        , maxPacketSize_( capacity / 4 )
+        , writePosition_( 0 )
+    {
+        if( capacity < 4096 || (capacity & (capacity - 1)) != 0 )
+            throw std::runtime_error("shared memory ring capacity must be a power of two of at least 4096\n");
+
+        fd_ = memfd_create( "oscpack-ring", MFD_ALLOW_SEALING );
+        if( fd_ < 0 )
+            throw std::runtime_error("unable to create shared memory ring\n");
+
+        // sealed at its size, so the receivers can't be sent SIGBUS by
+        // the file shrinking under them
+        if( ftruncate( fd_, (off_t)mapSize_ ) < 0
+                || fcntl( fd_, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL ) < 0 ){
+            close( fd_ );
+            throw std::runtime_error("unable to size shared memory ring\n");
+        }
+
+        void *map = mmap( 0, mapSize_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0 );
+        if( map == MAP_FAILED ){
+            close( fd_ );
+            throw std::runtime_error("unable to map shared memory ring\n");
+        }
+        map_ = (char*)map;
+        header_ = (RingHeader*)map_;
+        ring_ = map_ + HEADER_SIZE;
+
+        // the file starts zeroed, so only the constants need setting
+        header_->capacity = capacity_;
+        header_->maxPacketSize = maxPacketSize_;
+        header_->version = RING_VERSION;
+        __atomic_store_n( &header_->magic, RING_MAGIC, __ATOMIC_RELEASE );
+    }
+
+    ~Implementation()
+    {
+        munmap( map_, mapSize_ );
+        close( fd_ );
+    }
+
+    int FileDescriptor() const { return fd_; }
+
+    std::size_t MaxPacketSize() const { return (std::size_t)maxPacketSize_; }
+
+    void Send( const char *data, std::size_t size )
+    {
+        if( size > maxPacketSize_ )
+            throw std::runtime_error("packet too large for shared memory ring\n");
+
+        uint64_t recordSize = RecordSize( size );
+        uint64_t offset = writePosition_ & (capacity_ - 1);
+        uint64_t skip = ( offset + recordSize > capacity_ ) ? capacity_ - offset : 0;
+        uint64_t end = writePosition_ + skip + recordSize;
+
+        // a seqlock: writeStart moves before the old records are
+        // overwritten, and writeEnd after the new one is complete
+        __atomic_store_n( &header_->writeStart, end, __ATOMIC_RELAXED );
+        __atomic_thread_fence( __ATOMIC_RELEASE );
+
+        if( skip != 0 ){
+            std::memcpy( ring_ + offset, &PADDING_RECORD, sizeof(PADDING_RECORD) );
+            offset = 0;
+        }
+        uint32_t recordHeader = (uint32_t)size;
+        std::memcpy( ring_ + offset, &recordHeader, sizeof(recordHeader) );
+        std::memcpy( ring_ + offset + RECORD_HEADER_SIZE, data, size );
+
+        writePosition_ = end;
+
+        // sequentially consistent with the receivers' sleeperCount
+        // increment and writeEnd check, so that either the receiver sees
+        // the packet or the transmitter sees the sleeper
+        __atomic_store_n( &header_->writeEnd, end, __ATOMIC_SEQ_CST );
+        if( __atomic_load_n( &header_->sleeperCount, __ATOMIC_SEQ_CST ) != 0 ){
+            __atomic_fetch_add( &header_->wakeSequence, 1, __ATOMIC_SEQ_CST );
+            Futex( &header_->wakeSequence, FUTEX_WAKE, INT_MAX );
+        }
+    }
+};
+
+
+class SharedMemoryRingReceiver::Implementation{
+    PacketListener *listener_;
+    char *map_;
+    std::size_t mapSize_;
+    RingHeader *header_;
+    const char *ring_;
+    uint64_t capacity_;
+    uint64_t maxPacketSize_;
+    uint64_t readPosition_;
+    uint64_t overrunCount_;
+    std::vector<char> packet_;
+
+    volatile bool break_;
+
+public:
+    Implementation( int fd, PacketListener *listener )
+        : listener_( listener )
+        , map_( 0 )
+        , mapSize_( 0 )
+        , overrunCount_( 0 )
+        , break_( false )
+    {
+        struct stat st;
+        if( fstat( fd, &st ) < 0 || (std::size_t)st.st_size <= HEADER_SIZE )
+            throw std::runtime_error("not a shared memory ring\n");
+        mapSize_ = (std::size_t)st.st_size;
+
+        void *map = mmap( 0, mapSize_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+        if( map == MAP_FAILED )
+            throw std::runtime_error("unable to map shared memory ring\n");
+        map_ = (char*)map;
+        header_ = (RingHeader*)map_;
+        ring_ = map_ + HEADER_SIZE;
+        capacity_ = header_->capacity;
+        maxPacketSize_ = header_->maxPacketSize;
+
+        if( __atomic_load_n( &header_->magic, __ATOMIC_ACQUIRE ) != RING_MAGIC
+                || header_->version != RING_VERSION
+                || HEADER_SIZE + capacity_ != mapSize_
+                || (capacity_ & (capacity_ - 1)) != 0
+                || maxPacketSize_ > capacity_ / 4 ){
+            munmap( map_, mapSize_ );
+            throw std::runtime_error("not a shared memory ring\n");
+        }
+
+        packet_.resize( (std::size_t)maxPacketSize_ + 1 );
+
+        // like a socket, the receiver gets the packets sent from now on
+        readPosition_ = __atomic_load_n( &header_->writeEnd, __ATOMIC_ACQUIRE );
+    }
+
+    ~Implementation()
+    {
+        munmap( map_, mapSize_ );
+    }
+
+    int ReceivePackets()
+    {
+        int count = 0;
+        uint64_t end = __atomic_load_n( &header_->writeEnd, __ATOMIC_ACQUIRE );
+        while( readPosition_ != end ){
+            uint64_t offset = readPosition_ & (capacity_ - 1);
+            uint32_t size;
+            std::memcpy( &size, ring_ + offset, sizeof(size) );
+
+            if( size == PADDING_RECORD ){
+                if( !RecordIsIntact() ){
+                    end = SkipOverrun();
+                    continue;
+                }
+                readPosition_ += capacity_ - offset;
+                continue;
+            }
+
+            // the size is only trusted once the record is known to be
+            // intact, so check it can be copied first
+            uint64_t recordSize = RecordSize( size );
+            if( size > maxPacketSize_ || offset + recordSize > capacity_ ){
+                end = SkipOverrun();
+                continue;
+            }
+
+            std::memcpy( &packet_[0], ring_ + offset + RECORD_HEADER_SIZE, size );
+            if( !RecordIsIntact() ){
+                end = SkipOverrun();
+                continue;
+            }
+            readPosition_ += recordSize;
+
+            listener_->ProcessPacket( &packet_[0], (int)size, IpEndpointName() );
+            ++count;
+            if( break_ )
+                break;
+        }
+        return count;
+    }
+
+    uint64_t OverrunCount() const { return overrunCount_; }
+
+    void Run()
+    {
+        break_ = false;
+
+        while( !break_ ){
+            if( ReceivePackets() == 0 && !break_ )
+                Wait();
+        }
+    }
+
+    void Break()
+    {
+        break_ = true;
+    }
+
+    void AsynchronousBreak()
+    {
+        break_ = true;
+
+        // wakes the other receivers too, which just go back to sleep
+        __atomic_fetch_add( &header_->wakeSequence, 1, __ATOMIC_SEQ_CST );
+        Futex( &header_->wakeSequence, FUTEX_WAKE, INT_MAX );
+    }
+
+private:
+    // whether the record at readPosition_ hasn't been overwritten, checked
+    // after copying it
+    bool RecordIsIntact() const
+    {
+        __atomic_thread_fence( __ATOMIC_ACQUIRE );
+        uint64_t writeStart = __atomic_load_n( &header_->writeStart, __ATOMIC_RELAXED );
+        return writeStart - readPosition_ <= capacity_;
+    }
+
+    // the transmitter lapped this receiver. drop everything up to the
+    // latest packet.
+    uint64_t SkipOverrun()
+    {
+        ++overrunCount_;
+        readPosition_ = __atomic_load_n( &header_->writeEnd, __ATOMIC_ACQUIRE );
+        return readPosition_;
+    }
+
+    void Wait()
+    {
+        uint32_t sequence = __atomic_load_n( &header_->wakeSequence, __ATOMIC_SEQ_CST );
+        __atomic_fetch_add( &header_->sleeperCount, 1, __ATOMIC_SEQ_CST );
+
+        // FUTEX_WAIT returns at once if a packet or break incremented the
+        // sequence since it was read
+        if( __atomic_load_n( &header_->writeEnd, __ATOMIC_SEQ_CST ) == readPosition_ && !break_ )
+            Futex( &header_->wakeSequence, FUTEX_WAIT, sequence );
+
+        __atomic_fetch_sub( &header_->sleeperCount, 1, __ATOMIC_SEQ_CST );
+    }
+};
+
+#else /* __linux__ */
+
+// memfd and futex are Linux only
+
+class SharedMemoryRingTransmitter::Implementation{
+public:
+    Implementation( std::size_t capacity )
+    {
+        (void) capacity;
+        throw std::runtime_error("shared memory rings are only supported on Linux\n");
+    }
+
+    int FileDescriptor() const { return -1; }
+    std::size_t MaxPacketSize() const { return 0; }
+    void Send( const char *data, std::size_t size ) { (void) data; (void) size; }
+};
+
+
+class SharedMemoryRingReceiver::Implementation{
+public:
+    Implementation( int fd, PacketListener *listener )
+    {
+        (void) fd;
+        (void) listener;
+        throw std::runtime_error("shared memory rings are only supported on Linux\n");
+    }
+
+    int ReceivePackets() { return 0; }
+    uint64_t OverrunCount() const { return 0; }
+    void Run() {}
+    void Break() {}
+    void AsynchronousBreak() {}
+};
+
+#endif /* __linux__ */
+
+
+SharedMemoryRingTransmitter::SharedMemoryRingTransmitter( std::size_t capacity )
+{
+    impl_ = new Implementation( capacity );
+}
+
+SharedMemoryRingTransmitter::~SharedMemoryRingTransmitter()
+{
+    delete impl_;
+}
+
+int SharedMemoryRingTransmitter::FileDescriptor() const
+{
+    return impl_->FileDescriptor();
+}
+
+std::size_t SharedMemoryRingTransmitter::MaxPacketSize() const
+{
+    return impl_->MaxPacketSize();
+}
+
+void SharedMemoryRingTransmitter::Send( const char *data, std::size_t size )
+{
+    impl_->Send( data, size );
+}
+
+
+SharedMemoryRingReceiver::SharedMemoryRingReceiver( int fd, PacketListener *listener )
+{
+    impl_ = new Implementation( fd, listener );
+}
+
+SharedMemoryRingReceiver::~SharedMemoryRingReceiver()
+{
+    delete impl_;
+}
+
+int SharedMemoryRingReceiver::ReceivePackets()
+{
+    return impl_->ReceivePackets();
+}
+
+uint64_t SharedMemoryRingReceiver::OverrunCount() const
+{
+    return impl_->OverrunCount();
+}
+
+void SharedMemoryRingReceiver::Run()
+{
+    impl_->Run();
+}
+
+void SharedMemoryRingReceiver::Break()
+{
+    impl_->Break();
+}
+
+void SharedMemoryRingReceiver::AsynchronousBreak()
+{
+    impl_->AsynchronousBreak();
+}
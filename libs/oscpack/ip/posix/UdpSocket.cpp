@@ -35,30 +35,64 @@
 	above license is reproduced.
 */
 #include "ip/UdpSocket.h"
+#include "ip/LocalDatagramSocket.h"
 
 #include <pthread.h>
+#include <sched.h> // for sched_yield() and cpu_set_t
 #include <unistd.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <netdb.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
 #include <sys/time.h>
+#include <sys/uio.h> // for iovec
+#include <sys/un.h> // for sockaddr_un
+#ifdef __linux__
+#include <linux/filter.h> // for the reuseport steering programs
+#include <linux/net_tstamp.h> // for SOF_TIMESTAMPING_*
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+// the io_uring backend needs headers with multishot receive (Linux 6.0)
+#if defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#ifdef IORING_RECV_MULTISHOT
+#define OSC_HAVE_IO_URING
+#include <poll.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/utsname.h>
+#endif
+#endif
+#endif
+#endif
 #include <netinet/in.h> // for sockaddr_in
+#include <stddef.h> // for offsetof
 
 #include <signal.h>
+#include <limits.h>
 #include <math.h>
 #include <errno.h>
 #include <string.h> 
 
+#include <time.h>
+
 #include <algorithm>
 #include <cassert>
 #include <cstring> // for memset
+#include <map>
 #include <stdexcept>
+#include <string>
 #include <vector>
 
+#include "ip/PacketBuffer.h"
 #include "ip/PacketListener.h"
 #include "ip/TimerListener.h"
+#include "ip/TimerWheel.h"
 
 
 #if defined(__APPLE__) && !defined(_SOCKLEN_T)
@@ -97,32 +131,146 @@ static IpEndpointName IpEndpointNameFromSockaddr( const struct sockaddr_in& sock
 }
 
 
+// the sender of a received packet, from an address of any family.
+// local sockets' senders have no IP endpoint, and unbound ones no address
+// at all.
+static void IpEndpointNameFromReceivedSockaddr( IpEndpointName& endpoint,
+		const void *receivedAddr, socklen_t length )
+{
+	struct sockaddr_in sockAddr;
+	if( length == sizeof(sockAddr) ){
+		std::memcpy( &sockAddr, receivedAddr, sizeof(sockAddr) );
+		if( sockAddr.sin_family == AF_INET ){
+			endpoint.address = ntohl( sockAddr.sin_addr.s_addr );
+			endpoint.port = ntohs( sockAddr.sin_port );
+			return;
+		}
+	}
+
+	endpoint = IpEndpointName();
+}
+
+
+// returns the length of the address. abstract names start with a 0 byte
+// and aren't terminated.
+static socklen_t SockaddrFromLocalEndpointName( struct sockaddr_un& sockAddr, const LocalEndpointName& endpoint )
+{
+	std::memset( (char *)&sockAddr, 0, sizeof(sockAddr ) );
+	sockAddr.sun_family = AF_UNIX;
+
+	std::size_t offset = (endpoint.isAbstract) ? 1 : 0;
+	if( endpoint.path.empty() || offset + endpoint.path.size() >= sizeof(sockAddr.sun_path) )
+		throw std::runtime_error("invalid local socket name\n");
+
+	std::memcpy( sockAddr.sun_path + offset, endpoint.path.data(), endpoint.path.size() );
+
+	return (socklen_t)( offsetof(struct sockaddr_un, sun_path) + offset + endpoint.path.size()
+			+ ((endpoint.isAbstract) ? 0 : 1) );
+}
+
+
+// room for the largest timestamp control message, which is SO_TIMESTAMPING's
+// three timespecs (software, deprecated, hardware)
+static const std::size_t TIMESTAMP_CONTROL_SIZE = CMSG_SPACE( sizeof(struct timespec) * 3 );
+
+
+static uint64_t NanosecondsFromTimespec( const struct timespec& ts )
+{
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+
+static void TimestampFromControlMessages( struct msghdr& msg, PacketTimestamp& timestamp )
+{
+	timestamp.softwareNs = 0;
+	timestamp.hardwareNs = 0;
+
+	if( msg.msg_controllen == 0 )
+		return;
+
+	for( struct cmsghdr *cmsg = CMSG_FIRSTHDR( &msg ); cmsg; cmsg = CMSG_NXTHDR( &msg, cmsg ) ){
+		if( cmsg->cmsg_level != SOL_SOCKET )
+			continue;
+
+		// the control data may not be aligned for the structures, so copy it out
+#if defined(SCM_TIMESTAMPING)
+		if( cmsg->cmsg_type == SCM_TIMESTAMPING ){
+			struct timespec ts[3];
+			std::memcpy( ts, CMSG_DATA( cmsg ), sizeof(ts) );
+			timestamp.softwareNs = NanosecondsFromTimespec( ts[0] );
+			timestamp.hardwareNs = NanosecondsFromTimespec( ts[2] );
+			continue;
+		}
+#endif
+#if defined(SCM_TIMESTAMPNS)
+		if( cmsg->cmsg_type == SCM_TIMESTAMPNS ){
+			struct timespec ts;
+			std::memcpy( &ts, CMSG_DATA( cmsg ), sizeof(ts) );
+			timestamp.softwareNs = NanosecondsFromTimespec( ts );
+			continue;
+		}
+#endif
+#if defined(SCM_TIMESTAMP)
+		if( cmsg->cmsg_type == SCM_TIMESTAMP ){
+			struct timeval tv;
+			std::memcpy( &tv, CMSG_DATA( cmsg ), sizeof(tv) );
+			timestamp.softwareNs = (uint64_t)tv.tv_sec * 1000000000ULL + (uint64_t)tv.tv_usec * 1000;
+		}
+#endif
+	}
+}
+
+
 class UdpSocket::Implementation{
 	bool isBound_;
 	bool isConnected_;
+	bool timestampsEnabled_;
+	std::size_t maxPacketSize_;
 
+	int family_;
 	int socket_;
+	int sendFlags_; // MSG_DONTWAIT for local sockets
+	std::string boundPath_; // the file of a bound local socket, removed on close
 	struct sockaddr_in connectedAddr_;
 	struct sockaddr_in sendToAddr_;
 
+#ifdef __linux__
+	std::vector<struct mmsghdr> batchMessages_;
+	std::vector<struct iovec> batchIov_;
+	std::vector<struct sockaddr_in> batchAddrs_;
+#endif
+
 public:
 
-	Implementation()
+	Implementation( int family=AF_INET )
 		: isBound_( false )
 		, isConnected_( false )
+		, timestampsEnabled_( false )
+		, maxPacketSize_( 4098 )
+		, family_( family )
 		, socket_( -1 )
+		, sendFlags_( 0 )
 	{
-		if( (socket_ = socket( AF_INET, SOCK_DGRAM, 0 )) == -1 ){
-            throw std::runtime_error("unable to create udp socket\n");
+		if( (socket_ = socket( family, SOCK_DGRAM, 0 )) == -1 ){
+            throw std::runtime_error( (family == AF_UNIX)
+                    ? "unable to create local datagram socket\n" : "unable to create udp socket\n" );
         }
 
 		std::memset( &sendToAddr_, 0, sizeof(sendToAddr_) );
         sendToAddr_.sin_family = AF_INET;
+
+		// a local send blocks while the receiver's queue is full, where
+		// udp would drop the packet. don't wait, so that a receiver that
+		// stops reading can't stall the sender, and the packet is dropped.
+		if( family == AF_UNIX )
+			sendFlags_ = MSG_DONTWAIT;
 	}
 
 	~Implementation()
 	{
 		if (socket_ != -1) close(socket_);
+		if( !boundPath_.empty() )
+			unlink( boundPath_.c_str() );
 	}
 
 	void SetEnableBroadcast( bool enableBroadcast )
@@ -143,9 +291,56 @@ public:
 #endif
 	}
 
+	void SetEnableTimestamps( bool enableTimestamps, bool includeHardware )
+	{
+#if defined(SO_TIMESTAMPING)
+		int flags = 0;
+		if( enableTimestamps && includeHardware ){
+			flags = SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE
+					| SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+		}
+		if( setsockopt(socket_, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) < 0 && flags != 0 )
+			throw std::runtime_error("unable to enable udp socket timestamps\n");
+		includeHardware = (flags != 0);
+#else
+		includeHardware = false;
+#endif
+
+		int enable = (enableTimestamps && !includeHardware) ? 1 : 0; // int on posix
+#if defined(SO_TIMESTAMPNS)
+		int result = setsockopt(socket_, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable));
+#else
+		int result = setsockopt(socket_, SOL_SOCKET, SO_TIMESTAMP, &enable, sizeof(enable));
+#endif
+		if( result < 0 && enable )
+			throw std::runtime_error("unable to enable udp socket timestamps\n");
+
+		timestampsEnabled_ = enableTimestamps;
+	}
+
+	bool TimestampsEnabled() const { return timestampsEnabled_; }
+
+	void SetBusyPoll( int microseconds )
+	{
+		assert( microseconds >= 0 );
+#if defined(SO_BUSY_POLL)
+		if( setsockopt(socket_, SOL_SOCKET, SO_BUSY_POLL, &microseconds, sizeof(microseconds)) < 0 )
+			throw std::runtime_error("unable to set udp socket busy poll\n");
+#endif
+	}
+
+	void SetMaxPacketSize( std::size_t maxPacketSize )
+	{
+		assert( maxPacketSize > 0 );
+		maxPacketSize_ = maxPacketSize;
+	}
+
+	std::size_t MaxPacketSize() const { return maxPacketSize_; }
+
 	IpEndpointName LocalEndpointFor( const IpEndpointName& remoteEndpoint ) const
 	{
 		assert( isBound_ );
+		CheckInternetFamily();
 
 		// first connect the socket to the remote server
         
@@ -190,6 +385,7 @@ public:
 
 	void Connect( const IpEndpointName& remoteEndpoint )
 	{
+		CheckInternetFamily();
 		SockaddrFromIpEndpointName( connectedAddr_, remoteEndpoint );
        
         if (connect(socket_, (struct sockaddr *)&connectedAddr_, sizeof(connectedAddr_)) < 0) {
@@ -203,19 +399,122 @@ public:
 	{
 		assert( isConnected_ );
 
-        send( socket_, data, size, 0 );
+        send( socket_, data, size, sendFlags_ );
 	}
 
     void SendTo( const IpEndpointName& remoteEndpoint, const char *data, std::size_t size )
 	{
+		CheckInternetFamily();
 		sendToAddr_.sin_addr.s_addr = htonl( remoteEndpoint.address );
         sendToAddr_.sin_port = htons( remoteEndpoint.port );
 
         sendto( socket_, data, size, 0, (sockaddr*)&sendToAddr_, sizeof(sendToAddr_) );
 	}
 
+	void SendV( const IoVector *vectors, std::size_t count )
+	{
+		assert( isConnected_ );
+
+		SendMsg( 0, vectors, count );
+	}
+
+	void SendToV( const IpEndpointName& remoteEndpoint, const IoVector *vectors, std::size_t count )
+	{
+		CheckInternetFamily();
+		sendToAddr_.sin_addr.s_addr = htonl( remoteEndpoint.address );
+        sendToAddr_.sin_port = htons( remoteEndpoint.port );
+
+		SendMsg( &sendToAddr_, vectors, count );
+	}
+
+	std::size_t SendBatch( UdpSendBatch& batch )
+	{
+		std::size_t count = batch.Size();
+		if( count == 0 )
+			return 0;
+
+#ifdef __linux__
+		// the message headers are kept between calls to avoid reallocating
+		if( batchMessages_.size() < count ){
+			batchMessages_.resize( count );
+			batchIov_.resize( count );
+			batchAddrs_.resize( count );
+		}
+
+		for( std::size_t i=0; i < count; ++i ){
+			UdpSendBatch::Entry& e = batch[i];
+			struct msghdr& msg = batchMessages_[i].msg_hdr;
+			std::memset( &msg, 0, sizeof(msg) );
+
+			batchIov_[i].iov_base = const_cast<char*>( e.data );
+			batchIov_[i].iov_len = e.size;
+			msg.msg_iov = &batchIov_[i];
+			msg.msg_iovlen = 1;
+
+			if( !e.toConnectedEndpoint ){
+				batchAddrs_[i] = sendToAddr_;
+				batchAddrs_[i].sin_addr.s_addr = htonl( e.remoteEndpoint.address );
+				batchAddrs_[i].sin_port = htons( e.remoteEndpoint.port );
+				msg.msg_name = &batchAddrs_[i];
+				msg.msg_namelen = sizeof(batchAddrs_[i]);
+			}
+		}
+
+		// sendmmsg stops at the first packet that fails, returning the number
+		// sent before it, or -1 if it's the first. record the error and
+		// carry on after the failed packet. the kernel also stops after
+		// UIO_MAXIOV (1024) packets.
+		std::size_t sentCount = 0;
+		std::size_t i = 0;
+		while( i < count ){
+			int result = sendmmsg( socket_, &batchMessages_[i], (unsigned int)(count - i), sendFlags_ );
+			if( result < 0 ){
+				if( errno == EINTR )
+					continue;
+				batch[i].bytesSent = 0;
+				batch[i].error = errno;
+				++i;
+			}else{
+				for( int j=0; j < result; ++j ){
+					batch[i].bytesSent = batchMessages_[i].msg_len;
+					batch[i].error = 0;
+					++i;
+				}
+				sentCount += result;
+			}
+		}
+
+		return sentCount;
+#else
+		std::size_t sentCount = 0;
+		for( std::size_t i=0; i < count; ++i ){
+			UdpSendBatch::Entry& e = batch[i];
+			ssize_t result;
+			if( e.toConnectedEndpoint ){
+				result = send( socket_, e.data, e.size, sendFlags_ );
+			}else{
+				sendToAddr_.sin_addr.s_addr = htonl( e.remoteEndpoint.address );
+				sendToAddr_.sin_port = htons( e.remoteEndpoint.port );
+				result = sendto( socket_, e.data, e.size, 0, (sockaddr*)&sendToAddr_, sizeof(sendToAddr_) );
+			}
+
+			if( result < 0 ){
+				e.bytesSent = 0;
+				e.error = errno;
+			}else{
+				e.bytesSent = (std::size_t)result;
+				e.error = 0;
+				++sentCount;
+			}
+		}
+
+		return sentCount;
+#endif
+	}
+
 	void Bind( const IpEndpointName& localEndpoint )
 	{
+		CheckInternetFamily();
 		struct sockaddr_in bindSockAddr;
 		SockaddrFromIpEndpointName( bindSockAddr, localEndpoint );
 
@@ -232,7 +531,7 @@ public:
 	{
 		assert( isBound_ );
 
-		struct sockaddr_in fromAddr;
+		struct sockaddr_storage fromAddr;
         socklen_t fromAddrLen = sizeof(fromAddr);
              	 
         ssize_t result = recvfrom(socket_, data, size, 0,
@@ -240,13 +539,134 @@ public:
 		if( result < 0 )
 			return 0;
 
-		remoteEndpoint.address = ntohl(fromAddr.sin_addr.s_addr);
-		remoteEndpoint.port = ntohs(fromAddr.sin_port);
+		IpEndpointNameFromReceivedSockaddr( remoteEndpoint, &fromAddr, fromAddrLen );
 
 		return (std::size_t)result;
 	}
 
-	int Socket() { return socket_; }
+	ssize_t ReceiveMessage( IpEndpointName& remoteEndpoint, char *data, std::size_t size,
+			PacketTimestamp& timestamp, int flags )
+	{
+		assert( isBound_ );
+
+		struct sockaddr_storage fromAddr;
+		struct iovec iov;
+		iov.iov_base = data;
+		iov.iov_len = size;
+
+		// aligned for cmsghdr
+		union{ struct cmsghdr align; char buffer[ 128 ]; } control;
+		assert( sizeof(control.buffer) >= TIMESTAMP_CONTROL_SIZE );
+
+		struct msghdr msg;
+		std::memset( &msg, 0, sizeof(msg) );
+		msg.msg_name = &fromAddr;
+		msg.msg_namelen = sizeof(fromAddr);
+		msg.msg_iov = &iov;
+		msg.msg_iovlen = 1;
+		msg.msg_control = control.buffer;
+		msg.msg_controllen = sizeof(control.buffer);
+
+		ssize_t result = recvmsg(socket_, &msg, flags);
+		if( result < 0 )
+			return result;
+
+		IpEndpointNameFromReceivedSockaddr( remoteEndpoint, &fromAddr, msg.msg_namelen );
+		TimestampFromControlMessages( msg, timestamp );
+
+		return result;
+	}
+
+	void ConnectLocal( const LocalEndpointName& remoteEndpoint )
+	{
+		struct sockaddr_un sockAddr;
+		socklen_t length = SockaddrFromLocalEndpointName( sockAddr, remoteEndpoint );
+
+		if (connect(socket_, (struct sockaddr *)&sockAddr, length) < 0) {
+			throw std::runtime_error("unable to connect local datagram socket\n");
+		}
+
+		isConnected_ = true;
+	}
+
+	void SendToLocal( const LocalEndpointName& remoteEndpoint, const char *data, std::size_t size )
+	{
+		struct sockaddr_un sockAddr;
+		socklen_t length = SockaddrFromLocalEndpointName( sockAddr, remoteEndpoint );
+
+		sendto( socket_, data, size, sendFlags_, (struct sockaddr *)&sockAddr, length );
+	}
+
+	void BindLocal( const LocalEndpointName& localEndpoint )
+	{
+		struct sockaddr_un sockAddr;
+		socklen_t length = SockaddrFromLocalEndpointName( sockAddr, localEndpoint );
+
+		if( !localEndpoint.isAbstract ){
+			// a socket file that outlived its process would make bind()
+			// fail. it is stale if connecting to it is refused, otherwise
+			// another socket is bound to it and keeps it.
+			struct stat st;
+			if( lstat( localEndpoint.path.c_str(), &st ) == 0 && S_ISSOCK( st.st_mode ) ){
+				int probe = socket( AF_UNIX, SOCK_DGRAM, 0 );
+				if( probe == -1 )
+					throw std::runtime_error("unable to create local datagram socket\n");
+				int result = connect( probe, (struct sockaddr *)&sockAddr, length );
+				int error = errno;
+				close( probe );
+
+				if( result == 0 )
+					throw std::runtime_error("local datagram socket name is in use\n");
+				if( error == ECONNREFUSED )
+					unlink( localEndpoint.path.c_str() );
+			}
+		}
+
+		if (bind(socket_, (struct sockaddr *)&sockAddr, length) < 0) {
+			throw std::runtime_error("unable to bind local datagram socket\n");
+		}
+
+		if( !localEndpoint.isAbstract )
+			boundPath_ = localEndpoint.path;
+		isBound_ = true;
+	}
+
+	int Socket() const { return socket_; }
+
+private:
+	// the IpEndpointName methods are inherited by LocalDatagramSocket,
+	// and would fail quietly on its socket
+	void CheckInternetFamily() const
+	{
+		if( family_ != AF_INET )
+			throw std::runtime_error("ip endpoint used with a local datagram socket\n");
+	}
+
+	void SendMsg( struct sockaddr_in *toAddr, const IoVector *vectors, std::size_t count )
+	{
+		// most packets are a few parts, so avoid allocating for them
+		struct iovec localIov[16];
+		std::vector<struct iovec> heapIov;
+		struct iovec *iov = localIov;
+		if( count > 16 ){
+			heapIov.resize( count );
+			iov = &heapIov[0];
+		}
+
+		for( std::size_t i=0; i < count; ++i ){
+			iov[i].iov_base = const_cast<void*>( vectors[i].data );
+			iov[i].iov_len = vectors[i].size;
+		}
+
+		struct msghdr msg;
+		std::memset( &msg, 0, sizeof(msg) );
+		msg.msg_name = toAddr;
+		msg.msg_namelen = (toAddr) ? sizeof(*toAddr) : 0;
+		msg.msg_iov = iov;
+		msg.msg_iovlen = count;
+
+		sendmsg( socket_, &msg, sendFlags_ );
+	}
 };
 
 UdpSocket::UdpSocket()
@@ -254,6 +674,11 @@ UdpSocket::UdpSocket()
 	impl_ = new Implementation();
 }
 
+UdpSocket::UdpSocket( AddressFamily family )
+{
+	impl_ = new Implementation( (family == LOCAL_FAMILY) ? AF_UNIX : AF_INET );
+}
+
 UdpSocket::~UdpSocket()
 {
 	delete impl_;
@@ -269,6 +694,26 @@ void UdpSocket::SetAllowReuse( bool allowReuse )
     impl_->SetAllowReuse( allowReuse );
 }
 
+void UdpSocket::SetEnableTimestamps( bool enableTimestamps, bool includeHardware )
+{
+    impl_->SetEnableTimestamps( enableTimestamps, includeHardware );
+}
+
+void UdpSocket::SetBusyPoll( int microseconds )
+{
+    impl_->SetBusyPoll( microseconds );
+}
+
+void UdpSocket::SetMaxPacketSize( std::size_t maxPacketSize )
+{
+    impl_->SetMaxPacketSize( maxPacketSize );
+}
+
+std::size_t UdpSocket::MaxPacketSize() const
+{
+    return impl_->MaxPacketSize();
+}
+
 IpEndpointName UdpSocket::LocalEndpointFor( const IpEndpointName& remoteEndpoint ) const
 {
 	return impl_->LocalEndpointFor( remoteEndpoint );
@@ -289,6 +734,21 @@ void UdpSocket::SendTo( const IpEndpointName& remoteEndpoint, const char *data,
 	impl_->SendTo( remoteEndpoint, data, size );
 }
 
+void UdpSocket::SendV( const IoVector *vectors, std::size_t count )
+{
+	impl_->SendV( vectors, count );
+}
+
+void UdpSocket::SendToV( const IpEndpointName& remoteEndpoint, const IoVector *vectors, std::size_t count )
+{
+	impl_->SendToV( remoteEndpoint, vectors, count );
+}
+
+std::size_t UdpSocket::SendBatch( UdpSendBatch& batch )
+{
+	return impl_->SendBatch( batch );
+}
+
 void UdpSocket::Bind( const IpEndpointName& localEndpoint )
 {
 	impl_->Bind( localEndpoint );
@@ -304,22 +764,37 @@ std::size_t UdpSocket::ReceiveFrom( IpEndpointName& remoteEndpoint, char *data,
 	return impl_->ReceiveFrom( remoteEndpoint, data, size );
 }
 
+std::size_t UdpSocket::ReceiveFrom( IpEndpointName& remoteEndpoint, char *data, std::size_t size,
+		PacketTimestamp& timestamp )
+{
+	ssize_t result = impl_->ReceiveMessage( remoteEndpoint, data, size, timestamp, 0 );
+	return (result < 0) ? 0 : (std::size_t)result;
+}
+
 
-struct AttachedTimerListener{
-	AttachedTimerListener( int id, int p, TimerListener *tl )
-		: initialDelayMs( id )
-		, periodMs( p )
-		, listener( tl ) {}
-	int initialDelayMs;
-	int periodMs;
-	TimerListener *listener;
-};
+LocalDatagramSocket::LocalDatagramSocket()
+	: UdpSocket( LOCAL_FAMILY )
+{
+}
 
+void LocalDatagramSocket::Connect( const LocalEndpointName& remoteEndpoint )
+{
+	impl_->ConnectLocal( remoteEndpoint );
+}
 
-static bool CompareScheduledTimerCalls( 
-		const std::pair< double, AttachedTimerListener > & lhs, const std::pair< double, AttachedTimerListener > & rhs )
+void LocalDatagramSocket::SendTo( const LocalEndpointName& remoteEndpoint, const char *data, std::size_t size )
 {
-	return lhs.first < rhs.first;
+	impl_->SendToLocal( remoteEndpoint, data, size );
+}
+
+void LocalDatagramSocket::Bind( const LocalEndpointName& localEndpoint )
+{
+	impl_->BindLocal( localEndpoint );
+}
+
+int LocalDatagramSocket::FileDescriptor() const
+{
+	return impl_->Socket();
 }
 
 
@@ -333,193 +808,1139 @@ extern "C" /*static*/ void InterruptSignalHandler( int );
 }
 
 
+#ifdef OSC_HAVE_IO_URING
+
+// IoUringReceiveRing is the io_uring used by the IO_URING_BACKEND. It uses
+// the raw system calls, so liburing isn't needed. Each socket has a
+// multishot recvmsg that receives into a shared ring of provided buffers.
+// The sockets and the break eventfd are registered files. Completions
+// that haven't been processed when Run() returns are kept for the next
+// Run().
+
+class IoUringReceiveRing{
+public:
+    // user_data values. receive completions carry the socket index.
+    static const uint64_t BREAK_POLL = ~(uint64_t)0;
+    static const uint64_t TIMEOUT_BASE = (uint64_t)1 << 62;
+    static const uint64_t CANCEL = ~(uint64_t)1;
+
+    // multishot recvmsg needs Linux 6.0 or later. older kernels only fail
+    // the receives, not the ring setup, so check the version up front.
+    static bool IsSupported()
+    {
+        struct utsname name;
+        if( uname( &name ) != 0 )
+            return false;
+
+        int major = 0, minor = 0;
+        if( sscanf( name.release, "%d.%d", &major, &minor ) != 2 )
+            return false;
+        if( major < 6 )
+            return false;
+
+        struct io_uring_params params;
+        std::memset( &params, 0, sizeof(params) );
+        int fd = (int)syscall( __NR_io_uring_setup, 4, &params );
+        if( fd < 0 )
+            return false;
+        close( fd );
+
+        return (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    }
+
+    IoUringReceiveRing( const std::vector<int>& fds, std::size_t bufferSize )
+        : ringFd_( -1 )
+        , ring_( MAP_FAILED )
+        , ringSize_( 0 )
+        , sqes_( (struct io_uring_sqe*)MAP_FAILED )
+        , sqesSize_( 0 )
+        , bufRing_( (struct io_uring_buf_ring*)MAP_FAILED )
+        , bufRingSize_( 0 )
+        , bufferSize_( bufferSize )
+        , buffers_( 0 )
+        , sqTail_( 0 )
+        , toSubmit_( 0 )
+        , bufTail_( 0 )
+    {
+        try{
+            Initialize( fds );
+        }catch(...){
+            Free();
+            throw;
+        }
+    }
+
+    ~IoUringReceiveRing()
+    {
+        Free();
+    }
+
+    void PrepareReceive( int fileIndex, uint64_t userData )
+    {
+        struct io_uring_sqe *sqe = GetSqe();
+        sqe->opcode = IORING_OP_RECVMSG;
+        sqe->flags = IOSQE_FIXED_FILE | IOSQE_BUFFER_SELECT;
+        sqe->ioprio = IORING_RECV_MULTISHOT;
+        sqe->fd = fileIndex;
+        sqe->addr = (uint64_t)(uintptr_t)&receiveMessage_;
+        sqe->len = 1;
+        sqe->buf_group = BUFFER_GROUP;
+        sqe->user_data = userData;
+    }
+
+    void PreparePoll( int fileIndex, uint64_t userData )
+    {
+        struct io_uring_sqe *sqe = GetSqe();
+        sqe->opcode = IORING_OP_POLL_ADD;
+        sqe->flags = IOSQE_FIXED_FILE;
+        sqe->fd = fileIndex;
+        sqe->poll32_events = POLLIN;
+        sqe->user_data = userData;
+    }
+
+    void PrepareTimeout( int64_t timeoutNs, uint64_t userData )
+    {
+        timeout_.tv_sec = (long long)(timeoutNs / 1000000000);
+        timeout_.tv_nsec = (long long)(timeoutNs % 1000000000);
+
+        struct io_uring_sqe *sqe = GetSqe();
+        sqe->opcode = IORING_OP_TIMEOUT;
+        sqe->fd = -1;
+        sqe->addr = (uint64_t)(uintptr_t)&timeout_;
+        sqe->len = 1;
+        sqe->user_data = userData;
+    }
+
+    // submit the prepared entries and wait for at least one completion.
+    // returns false if interrupted by a signal.
+    bool SubmitAndWait()
+    {
+        return Enter( 1, IORING_ENTER_GETEVENTS );
+    }
+
+    // submit the prepared entries, if there are any, without waiting.
+    // the completions can then be polled from user space.
+    bool Submit()
+    {
+        return ( toSubmit_ == 0 ) ? true : Enter( 0, 0 );
+    }
+
+    // the completions are read in order with Completion(), then released
+    // with ConsumeCompletions()
+    unsigned CompletionsHead() const { return *cqHeadPtr_; }
+    unsigned CompletionsTail() const { return __atomic_load_n( cqTailPtr_, __ATOMIC_ACQUIRE ); }
+    const struct io_uring_cqe& Completion( unsigned index ) const { return cqes_[ index & cqMask_ ]; }
+    void ConsumeCompletions( unsigned newHead ) { __atomic_store_n( cqHeadPtr_, newHead, __ATOMIC_RELEASE ); }
+
+    // the packet in a receive completion's buffer. returns false if the
+    // completion doesn't hold a packet.
+    bool GetPacket( const struct io_uring_cqe& cqe, ReceivedDatagram& datagram ) const
+    {
+        if( cqe.res < 0 || !(cqe.flags & IORING_CQE_F_BUFFER) )
+            return false;
+
+        char *buffer = buffers_ + BufferId( cqe ) * bufferSize_;
+        const struct io_uring_recvmsg_out *out = (const struct io_uring_recvmsg_out*)buffer;
+        std::size_t headerSize = sizeof(struct io_uring_recvmsg_out)
+                + receiveMessage_.msg_namelen + receiveMessage_.msg_controllen;
+        if( (std::size_t)cqe.res < headerSize )
+            return false;
+
+        // the payload is truncated to the buffer, like recvfrom(). the
+        // buffer goes back to the ring, so a PacketHandle copies it.
+        datagram.data = buffer + headerSize;
+        datagram.size = (int)( (std::size_t)cqe.res - headerSize );
+        datagram.buffer = 0;
+
+        // namelen is the full length of the address, which is truncated
+        // to a sockaddr_in for local sockets
+        IpEndpointNameFromReceivedSockaddr( datagram.remoteEndpoint,
+                buffer + sizeof(struct io_uring_recvmsg_out), out->namelen );
+
+        // the timestamp control messages follow the address
+        struct msghdr control;
+        std::memset( &control, 0, sizeof(control) );
+        control.msg_control = buffer + sizeof(struct io_uring_recvmsg_out) + receiveMessage_.msg_namelen;
+        control.msg_controllen = out->controllen;
+        TimestampFromControlMessages( control, datagram.timestamp );
+        return true;
+    }
+
+    // give a completion's buffer back to the kernel. takes effect at the
+    // next PublishBuffers().
+    void ReturnBuffer( const struct io_uring_cqe& cqe )
+    {
+        if( cqe.flags & IORING_CQE_F_BUFFER )
+            AddBuffer( BufferId( cqe ) );
+    }
+
+    void PublishBuffers()
+    {
+        __atomic_store_n( &bufRing_->tail, bufTail_, __ATOMIC_RELEASE );
+    }
+
+private:
+    static const int SUBMISSION_ENTRIES = 64;
+    static const unsigned BUFFER_COUNT = 256; // a power of 2
+    static const unsigned short BUFFER_GROUP = 0;
+
+    int ringFd_;
+
+    void *ring_;
+    std::size_t ringSize_;
+    struct io_uring_sqe *sqes_;
+    std::size_t sqesSize_;
+
+    unsigned *sqHeadPtr_;
+    unsigned *sqTailPtr_;
+    unsigned sqMask_;
+    unsigned sqEntries_;
+    unsigned *sqArray_;
+    unsigned *cqHeadPtr_;
+    unsigned *cqTailPtr_;
+    unsigned cqMask_;
+    struct io_uring_cqe *cqes_;
+
+    struct io_uring_buf_ring *bufRing_;
+    std::size_t bufRingSize_;
+    std::size_t bufferSize_;
+    char *buffers_;
+
+    unsigned sqTail_;
+    unsigned toSubmit_;
+    unsigned short bufTail_;
+
+    struct msghdr receiveMessage_;
+    struct __kernel_timespec timeout_;
+
+    static unsigned BufferId( const struct io_uring_cqe& cqe )
+    {
+        return cqe.flags >> IORING_CQE_BUFFER_SHIFT;
+    }
+
+    void Initialize( const std::vector<int>& fds )
+    {
+        struct io_uring_params params;
+        std::memset( &params, 0, sizeof(params) );
+        // room for a completion per buffer, plus the timeout and break poll
+        params.flags = IORING_SETUP_CQSIZE;
+        params.cq_entries = BUFFER_COUNT * 2;
+
+        ringFd_ = (int)syscall( __NR_io_uring_setup, SUBMISSION_ENTRIES, &params );
+        if( ringFd_ < 0 )
+            throw std::runtime_error("io_uring_setup failed\n");
+        if( !(params.features & IORING_FEAT_SINGLE_MMAP) )
+            throw std::runtime_error("io_uring lacks IORING_FEAT_SINGLE_MMAP\n");
+
+        // the submission and completion rings share one mapping
+        ringSize_ = std::max( params.sq_off.array + params.sq_entries * sizeof(unsigned),
+                params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe) );
+        ring_ = mmap( 0, ringSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                ringFd_, IORING_OFF_SQ_RING );
+        if( ring_ == MAP_FAILED )
+            throw std::runtime_error("io_uring ring mmap failed\n");
+
+        sqesSize_ = params.sq_entries * sizeof(struct io_uring_sqe);
+        sqes_ = (struct io_uring_sqe*)mmap( 0, sqesSize_, PROT_READ | PROT_WRITE,
+                MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_SQES );
+        if( sqes_ == MAP_FAILED )
+            throw std::runtime_error("io_uring sqe mmap failed\n");
+
+        char *ring = (char*)ring_;
+        sqHeadPtr_ = (unsigned*)(ring + params.sq_off.head);
+        sqTailPtr_ = (unsigned*)(ring + params.sq_off.tail);
+        sqMask_ = *(unsigned*)(ring + params.sq_off.ring_mask);
+        sqEntries_ = params.sq_entries;
+        sqArray_ = (unsigned*)(ring + params.sq_off.array);
+        cqHeadPtr_ = (unsigned*)(ring + params.cq_off.head);
+        cqTailPtr_ = (unsigned*)(ring + params.cq_off.tail);
+        cqMask_ = *(unsigned*)(ring + params.cq_off.ring_mask);
+        cqes_ = (struct io_uring_cqe*)(ring + params.cq_off.cqes);
+        sqTail_ = *sqTailPtr_;
+
+        if( syscall( __NR_io_uring_register, ringFd_, IORING_REGISTER_FILES,
+                &fds[0], (unsigned)fds.size() ) < 0 )
+            throw std::runtime_error("io_uring file registration failed\n");
+
+        // the provided buffer ring
+        long pageSize = sysconf( _SC_PAGESIZE );
+        bufRingSize_ = ((BUFFER_COUNT * sizeof(struct io_uring_buf) + pageSize - 1) / pageSize) * pageSize;
+        bufRing_ = (struct io_uring_buf_ring*)mmap( 0, bufRingSize_, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+        if( bufRing_ == MAP_FAILED )
+            throw std::runtime_error("io_uring buffer ring mmap failed\n");
+
+        struct io_uring_buf_reg registration;
+        std::memset( &registration, 0, sizeof(registration) );
+        registration.ring_addr = (uint64_t)(uintptr_t)bufRing_;
+        registration.ring_entries = BUFFER_COUNT;
+        registration.bgid = BUFFER_GROUP;
+        if( syscall( __NR_io_uring_register, ringFd_, IORING_REGISTER_PBUF_RING, &registration, 1 ) < 0 )
+            throw std::runtime_error("io_uring buffer ring registration failed\n");
+
+        buffers_ = new char[ BUFFER_COUNT * bufferSize_ ];
+        bufTail_ = 0;
+        for( unsigned i=0; i < BUFFER_COUNT; ++i )
+            AddBuffer( i );
+        PublishBuffers();
+
+        // each received buffer starts with an io_uring_recvmsg_out header,
+        // the sender's address and room for a timestamp
+        std::memset( &receiveMessage_, 0, sizeof(receiveMessage_) );
+        receiveMessage_.msg_namelen = sizeof(struct sockaddr_in);
+        receiveMessage_.msg_controllen = TIMESTAMP_CONTROL_SIZE;
+    }
+
+    bool Enter( unsigned minComplete, unsigned flags )
+    {
+        __atomic_store_n( sqTailPtr_, sqTail_, __ATOMIC_RELEASE );
+
+        int result = (int)syscall( __NR_io_uring_enter, ringFd_, toSubmit_, minComplete,
+                flags, (void*)0, (std::size_t)0 );
+        if( result < 0 ){
+            if( errno == EINTR )
+                return false;
+            throw std::runtime_error("io_uring_enter failed\n");
+        }
+        toSubmit_ -= (unsigned)result;
+        return true;
+    }
+
+    void CancelAndUnregister()
+    {
+        // closing the ring releases the sockets asynchronously, which can
+        // keep their ports bound for a while. cancel the receives and
+        // unregister the sockets first, so they are released now.
+        struct io_uring_sqe *sqe = GetSqe();
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->fd = -1;
+        sqe->cancel_flags = IORING_ASYNC_CANCEL_ANY;
+        sqe->user_data = CANCEL;
+
+        __atomic_store_n( sqTailPtr_, sqTail_, __ATOMIC_RELEASE );
+        bool cancelled = false;
+        while( !cancelled ){
+            int result = (int)syscall( __NR_io_uring_enter, ringFd_, toSubmit_, 1,
+                    IORING_ENTER_GETEVENTS, (void*)0, (std::size_t)0 );
+            if( result < 0 ){
+                if( errno == EINTR )
+                    continue;
+                break;
+            }
+            toSubmit_ -= (unsigned)result;
+
+            unsigned head = CompletionsHead();
+            const unsigned tail = CompletionsTail();
+            for( ; head != tail; ++head ){
+                if( Completion( head ).user_data == CANCEL )
+                    cancelled = true;
+            }
+            ConsumeCompletions( head );
+        }
+
+        syscall( __NR_io_uring_register, ringFd_, IORING_UNREGISTER_FILES, (void*)0, 0 );
+    }
+
+    void Free()
+    {
+        if( ringFd_ != -1 && ring_ != MAP_FAILED && sqes_ != MAP_FAILED ){
+            try{
+                CancelAndUnregister();
+            }catch( std::runtime_error& ){
+            }
+        }
+        if( ringFd_ != -1 )
+            close( ringFd_ ); // also unregisters the buffer ring
+        if( sqes_ != MAP_FAILED )
+            munmap( sqes_, sqesSize_ );
+        if( ring_ != MAP_FAILED )
+            munmap( ring_, ringSize_ );
+        if( bufRing_ != MAP_FAILED )
+            munmap( bufRing_, bufRingSize_ );
+        delete [] buffers_;
+    }
+
+    struct io_uring_sqe *GetSqe()
+    {
+        // the submission queue is only full if the kernel hasn't consumed
+        // earlier entries, so submit them without waiting
+        while( sqTail_ - __atomic_load_n( sqHeadPtr_, __ATOMIC_ACQUIRE ) >= sqEntries_ ){
+            __atomic_store_n( sqTailPtr_, sqTail_, __ATOMIC_RELEASE );
+            int result = (int)syscall( __NR_io_uring_enter, ringFd_, toSubmit_, 0, 0, (void*)0, (std::size_t)0 );
+            if( result < 0 && errno != EINTR )
+                throw std::runtime_error("io_uring_enter failed\n");
+            if( result > 0 )
+                toSubmit_ -= (unsigned)result;
+        }
+
+        unsigned index = sqTail_ & sqMask_;
+        struct io_uring_sqe *sqe = &sqes_[index];
+        std::memset( sqe, 0, sizeof(*sqe) );
+        sqArray_[index] = index;
+        ++sqTail_;
+        ++toSubmit_;
+        return sqe;
+    }
+
+    void AddBuffer( unsigned bufferId )
+    {
+        // the entries start at the beginning of the ring. the header's
+        // flexible bufs member doesn't, when compiled as C++.
+        struct io_uring_buf *buf = (struct io_uring_buf*)bufRing_ + (bufTail_ & (BUFFER_COUNT - 1));
+        buf->addr = (uint64_t)(uintptr_t)(buffers_ + bufferId * bufferSize_);
+        buf->len = (uint32_t)bufferSize_;
+        buf->bid = (uint16_t)bufferId;
+        ++bufTail_;
+    }
+};
+
+#endif /* OSC_HAVE_IO_URING */
+
+
 class SocketReceiveMultiplexer::Implementation{
 	std::vector< std::pair< PacketListener*, UdpSocket* > > socketListeners_;
-	std::vector< AttachedTimerListener > timerListeners_;
+	// the attached timers by listener, and the wheel that schedules them
+	typedef std::multimap< TimerListener*, TimerWheel::Timer* > TimerMap;
+	TimerMap timers_;
+	TimerWheel timerWheel_;
+
+	int receiveBatchSize_;
+	WaitStrategy waitStrategy_;
+	uint64_t spinNs_; // for SPIN_THEN_BLOCK_WAIT
 
 	volatile bool break_;
+
+	Backend backend_;
 	int breakPipe_[2]; // [0] is the reader descriptor and [1] the writer
+#ifdef __linux__
+	int breakEventFd_; // used instead of breakPipe_ by the epoll backend
 
-	double GetCurrentTimeMs() const
+	// the epoll set is kept between calls to Run(), and rebuilt when
+	// listeners have been attached or detached
+	int epollFd_;
+	bool epollSetIsStale_;
+#endif
+
+#ifdef OSC_HAVE_IO_URING
+	// like the epoll set, the ring is kept between calls to Run()
+	IoUringReceiveRing *ioUring_;
+	bool ioUringIsStale_;
+	std::size_t ioUringPacketSize_; // the largest packet the ring's buffers hold
+	uint64_t timeoutSequence_; // identifies the current timer timeout
+#endif
+
+	// the packets are received into buffers from a pool per packet size.
+	// each pool has a buffer ready for each packet of a batch. a buffer
+	// stays ready after its packet has been processed, unless the listener
+	// kept it with a PacketHandle, in which case it is replaced.
+	struct ReceiveBuffers{
+		ReceiveBuffers() : pool( 0 ) {}
+
+		PacketBufferPool *pool;
+		std::vector<PacketBuffer*> ready;
+	};
+	typedef std::map< std::size_t, ReceiveBuffers > ReceiveBuffersMap;
+	ReceiveBuffersMap receiveBuffers_;
+	std::vector<ReceivedDatagram> datagrams_;
+#ifdef __linux__
+	std::vector<struct mmsghdr> messages_;
+	std::vector<struct iovec> iov_;
+	std::vector<struct sockaddr_storage> fromAddrs_;
+	std::vector<char> control_; // TIMESTAMP_CONTROL_SIZE per message
+#endif
+
+	uint64_t GetCurrentTimeNs() const
 	{
-		struct timeval t;
+		// monotonic, so the timers don't jump when the wall clock is set
+		struct timespec t;
 
-		gettimeofday( &t, 0 );
+		clock_gettime( CLOCK_MONOTONIC, &t );
 
-		return ((double)t.tv_sec*1000.) + ((double)t.tv_usec / 1000.);
+		return (uint64_t)t.tv_sec * 1000000000 + (uint64_t)t.tv_nsec;
 	}
 
-public:
-    Implementation()
+	void AllocateReceiveBuffers()
 	{
-		if( pipe(breakPipe_) != 0 )
-			throw std::runtime_error( "creation of asynchronous break pipes failed\n" );
+        const int batchSize = receiveBatchSize_;
+        datagrams_.resize( batchSize );
+#ifdef __linux__
+        messages_.resize( batchSize );
+        iov_.resize( batchSize );
+        fromAddrs_.resize( batchSize );
+        // cmsghdr alignment is taken care of by the allocator, and
+        // TIMESTAMP_CONTROL_SIZE is a multiple of it
+        control_.resize( TIMESTAMP_CONTROL_SIZE * batchSize );
+        std::memset( &messages_[0], 0, sizeof(struct mmsghdr) * batchSize );
+        for( int j=0; j < batchSize; ++j ){
+            messages_[j].msg_hdr.msg_iov = &iov_[j];
+            messages_[j].msg_hdr.msg_iovlen = 1;
+            messages_[j].msg_hdr.msg_name = &fromAddrs_[j];
+        }
+#endif
 	}
 
-    ~Implementation()
+	void FreeReceiveBuffers()
 	{
-		close( breakPipe_[0] );
-		close( breakPipe_[1] );
+        for( ReceiveBuffersMap::iterator i = receiveBuffers_.begin(); i != receiveBuffers_.end(); ++i ){
+            std::vector<PacketBuffer*>& ready = i->second.ready;
+            for( std::size_t j=0; j < ready.size(); ++j ){
+                if( ready[j] )
+                    ready[j]->Release();
+            }
+            ready.clear();
+        }
 	}
 
-    void AttachSocketListener( UdpSocket *socket, PacketListener *listener )
+	// the buffers for a socket's packet size. the pools are kept between
+	// calls to Run(), since the listeners may still hold their buffers.
+	ReceiveBuffers& SocketReceiveBuffers( UdpSocket *socket )
 	{
-		assert( std::find( socketListeners_.begin(), socketListeners_.end(), std::make_pair(listener, socket) ) == socketListeners_.end() );
-		// we don't check that the same socket has been added multiple times, even though this is an error
-		socketListeners_.push_back( std::make_pair( listener, socket ) );
+        const std::size_t packetSize = socket->impl_->MaxPacketSize();
+        ReceiveBuffers& buffers = receiveBuffers_[ packetSize ];
+        if( !buffers.pool )
+            buffers.pool = new PacketBufferPool( packetSize );
+        while( buffers.ready.size() > (std::size_t)receiveBatchSize_ ){
+            if( buffers.ready.back() )
+                buffers.ready.back()->Release();
+            buffers.ready.pop_back();
+        }
+        buffers.ready.resize( receiveBatchSize_, 0 );
+        return buffers;
 	}
 
-    void DetachSocketListener( UdpSocket *socket, PacketListener *listener )
+	PacketBuffer *ReadyBuffer( ReceiveBuffers& buffers, int index )
 	{
-		std::vector< std::pair< PacketListener*, UdpSocket* > >::iterator i = 
-				std::find( socketListeners_.begin(), socketListeners_.end(), std::make_pair(listener, socket) );
-		assert( i != socketListeners_.end() );
+        if( !buffers.ready[index] )
+            buffers.ready[index] = buffers.pool->Acquire();
+        return buffers.ready[index];
+	}
 
-		socketListeners_.erase( i );
+	// receive from a socket that is ready and pass the packets to its
+	// listener. returns false if the listener called Break().
+	bool ReceivePackets( std::size_t index )
+	{
+        UdpSocket *socket = socketListeners_[index].second;
+        PacketListener *listener = socketListeners_[index].first;
+        ReceiveBuffers& buffers = SocketReceiveBuffers( socket );
+        const std::size_t bufferSize = buffers.pool->BufferSize();
+        const int batchSize = receiveBatchSize_;
+        const bool timestamps = socket->impl_->TimestampsEnabled();
+
+        int count = 0;
+        int buffersUsed = 0;
+#ifdef __linux__
+        if( batchSize > 1 ){
+            for( int j=0; j < batchSize; ++j ){
+                iov_[j].iov_base = ReadyBuffer( buffers, j )->Storage();
+                iov_[j].iov_len = bufferSize;
+                messages_[j].msg_hdr.msg_namelen = sizeof(struct sockaddr_storage);
+                messages_[j].msg_hdr.msg_control = (timestamps) ? &control_[ j * TIMESTAMP_CONTROL_SIZE ] : 0;
+                messages_[j].msg_hdr.msg_controllen = (timestamps) ? TIMESTAMP_CONTROL_SIZE : 0;
+            }
+
+            int received = recvmmsg( socket->impl_->Socket(), &messages_[0], batchSize, MSG_DONTWAIT, 0 );
+            for( int j=0; j < received; ++j ){
+                if( messages_[j].msg_len == 0 )
+                    continue;
+                ReceivedDatagram& d = datagrams_[count++];
+                IpEndpointNameFromReceivedSockaddr( d.remoteEndpoint, &fromAddrs_[j], messages_[j].msg_hdr.msg_namelen );
+                TimestampFromControlMessages( messages_[j].msg_hdr, d.timestamp );
+                SetPacket( d, buffers.ready[j], messages_[j].msg_len );
+            }
+            buffersUsed = (received > 0) ? received : 0;
+        }else
+#endif
+        {
+            // the first receive can block, as before. the rest
+            // only take packets that are already queued.
+            for( int j=0; j < batchSize; ++j ){
+                ReceivedDatagram& d = datagrams_[count];
+                PacketBuffer *buffer = ReadyBuffer( buffers, j );
+                ssize_t size;
+                if( timestamps || j > 0 ){
+                    size = socket->impl_->ReceiveMessage( d.remoteEndpoint, buffer->Storage(), bufferSize,
+                            d.timestamp, (j == 0) ? 0 : MSG_DONTWAIT );
+                }else{
+                    size = (ssize_t)socket->ReceiveFrom( d.remoteEndpoint, buffer->Storage(), bufferSize );
+                    d.timestamp = PacketTimestamp();
+                }
+                buffersUsed = j + 1;
+                if( size < 0 )
+                    break;
+                if( size == 0 )
+                    continue;
+                SetPacket( d, buffer, (std::size_t)size );
+                ++count;
+            }
+        }
+
+        if( count > 0 )
+            listener->ProcessPacketBatch( &datagrams_[0], count );
+
+        // replace the buffers that the listener kept
+        for( int j=0; j < buffersUsed; ++j ){
+            if( buffers.ready[j]->IsShared() ){
+                buffers.ready[j]->Release();
+                buffers.ready[j] = 0;
+            }
+        }
+
+        return !( count > 0 && break_ );
 	}
 
-    void AttachPeriodicTimerListener( int periodMilliseconds, TimerListener *listener )
+	static void SetPacket( ReceivedDatagram& d, PacketBuffer *buffer, std::size_t size )
 	{
-		timerListeners_.push_back( AttachedTimerListener( periodMilliseconds, periodMilliseconds, listener ) );
+        d.data = buffer->Storage();
+        d.size = (int)size;
+        d.buffer = buffer;
+        buffer->datagram = d;
 	}
 
-	void AttachPeriodicTimerListener( int initialDelayMilliseconds, int periodMilliseconds, TimerListener *listener )
+	// each Run() starts the timers from their initial delays
+	void RestartTimers()
 	{
-		timerListeners_.push_back( AttachedTimerListener( initialDelayMilliseconds, periodMilliseconds, listener ) );
+        uint64_t currentTimeNs = GetCurrentTimeNs();
+        timerWheel_.Clear( currentTimeNs );
+
+        for( TimerMap::iterator i = timers_.begin(); i != timers_.end(); ++i ){
+            i->second->expiryNs = currentTimeNs + (uint64_t)i->second->initialDelayMs * 1000000;
+            timerWheel_.Schedule( i->second );
+        }
 	}
 
-    void DetachPeriodicTimerListener( TimerListener *listener )
+	// nanoseconds until the next timer expires, or -1 if there are none
+	int64_t TimeoutNs() const
 	{
-		std::vector< AttachedTimerListener >::iterator i = timerListeners_.begin();
-		while( i != timerListeners_.end() ){
-			if( i->listener == listener )
-				break;
-			++i;
-		}
+        return timerWheel_.NanosecondsUntilNextExpiry( GetCurrentTimeNs() );
+	}
 
-		assert( i != timerListeners_.end() );
+	// the time until which the next wait polls without blocking, 0 if it
+	// blocks straight away
+	uint64_t SpinDeadlineNs() const
+	{
+        switch( waitStrategy_ ){
+            case SPIN_THEN_BLOCK_WAIT: return GetCurrentTimeNs() + spinNs_;
+            case BUSY_POLL_WAIT: return ~(uint64_t)0;
+            default: return 0;
+        }
+	}
+
+	// keep polling until the deadline, a break or a timer is due
+	bool IsSpinning( uint64_t spinDeadlineNs ) const
+	{
+        if( spinDeadlineNs == 0 || break_ )
+            return false;
 
-		timerListeners_.erase( i );
+        uint64_t currentTimeNs = GetCurrentTimeNs();
+        return currentTimeNs < spinDeadlineNs
+                && timerWheel_.NanosecondsUntilNextExpiry( currentTimeNs ) != 0;
 	}
 
-    void Run()
+	void RunExpiredTimers()
 	{
-		break_ = false;
-        char *data = 0;
+        timerWheel_.CollectExpired( GetCurrentTimeNs() );
+
+        for( TimerWheel::Timer *timer = timerWheel_.PopExpired(); timer != 0;
+                timer = timerWheel_.PopExpired() ){
+
+            // scheduled before the call, so that the listener can detach itself
+            timer->expiryNs += (uint64_t)timer->periodMs * 1000000;
+            timerWheel_.Schedule( timer );
+
+            timer->listener->TimerExpired();
+            if( break_ )
+                break;
+        }
+	}
+
+	void RunSelect()
+	{
+        // configure the master fd_set for select()
+
+        fd_set masterfds, tempfds;
+        FD_ZERO( &masterfds );
+        FD_ZERO( &tempfds );
         
-        try{
-            
-            // configure the master fd_set for select()
+        // in addition to listening to the inbound sockets we
+        // also listen to the asynchronous break pipe, so that AsynchronousBreak()
+        // can break us out of select() from another thread.
+        FD_SET( breakPipe_[0], &masterfds );
+        int fdmax = breakPipe_[0];		
+
+        for( std::vector< std::pair< PacketListener*, UdpSocket* > >::iterator i = socketListeners_.begin();
+                i != socketListeners_.end(); ++i ){
+
+            if( fdmax < i->second->impl_->Socket() )
+                fdmax = i->second->impl_->Socket();
+            FD_SET( i->second->impl_->Socket(), &masterfds );
+        }
+
+        RestartTimers();
+
+        struct timeval timeout;
+        uint64_t spinDeadlineNs = SpinDeadlineNs();
+
+        while( !break_ ){
+            tempfds = masterfds;
+
+            const bool spinning = IsSpinning( spinDeadlineNs );
+            struct timeval *timeoutPtr = 0;
+            int64_t timeoutNs = ( spinning ) ? 0 : TimeoutNs();
+            if( timeoutNs >= 0 ){
+                timeout.tv_sec = (time_t)(timeoutNs / 1000000000);
+                // round up to whole microseconds, so that the timers don't spin
+                timeout.tv_usec = (suseconds_t)((timeoutNs % 1000000000 + 999) / 1000);
+                timeoutPtr = &timeout;
+            }
 
-            fd_set masterfds, tempfds;
-            FD_ZERO( &masterfds );
-            FD_ZERO( &tempfds );
+            int readyCount = select( fdmax + 1, &tempfds, 0, 0, timeoutPtr );
+            if( readyCount < 0 ){
+                if( break_ ){
+                    break;
+                }else if( errno == EINTR ){
+                    // on returning an error, select() doesn't clear tempfds.
+                    // so tempfds would remain all set, which would cause read( breakPipe_[0]...
+                    // below to block indefinitely. therefore if select returns EINTR we restart
+                    // the while() loop instead of continuing on to below.
+                    continue;
+                }else{
+                    throw std::runtime_error("select failed\n");
+                }
+            }
+
+            if( readyCount == 0 && spinning )
+                continue;
+
+            if( FD_ISSET( breakPipe_[0], &tempfds ) ){
+                // clear pending data from the asynchronous break pipe
+                char c;
+                read( breakPipe_[0], &c, 1 );
+            }
             
-            // in addition to listening to the inbound sockets we
-            // also listen to the asynchronous break pipe, so that AsynchronousBreak()
-            // can break us out of select() from another thread.
-            FD_SET( breakPipe_[0], &masterfds );
-            int fdmax = breakPipe_[0];		
+            if( break_ )
+                break;
 
             for( std::vector< std::pair< PacketListener*, UdpSocket* > >::iterator i = socketListeners_.begin();
                     i != socketListeners_.end(); ++i ){
 
-                if( fdmax < i->second->impl_->Socket() )
-                    fdmax = i->second->impl_->Socket();
-                FD_SET( i->second->impl_->Socket(), &masterfds );
+                if( FD_ISSET( i->second->impl_->Socket(), &tempfds ) ){
+                    if( !ReceivePackets( i - socketListeners_.begin() ) )
+                        break;
+                }
+            }
+
+            // execute any expired timers
+            RunExpiredTimers();
+
+            spinDeadlineNs = SpinDeadlineNs();
+        }
+	}
+
+#ifdef __linux__
+	void UpdateEpollSet()
+	{
+        if( epollFd_ != -1 && !epollSetIsStale_ )
+            return;
+
+        if( epollFd_ != -1 )
+            close( epollFd_ );
+
+        epollFd_ = epoll_create1( EPOLL_CLOEXEC );
+        if( epollFd_ < 0 )
+            throw std::runtime_error("epoll_create1 failed\n");
+
+        // each socket's event carries its index in socketListeners_, so
+        // only the ready sockets are visited. the break eventfd uses an
+        // index past the end.
+        struct epoll_event event;
+        std::memset( &event, 0, sizeof(event) );
+        event.events = EPOLLIN;
+        event.data.u32 = (uint32_t)socketListeners_.size();
+        if( epoll_ctl( epollFd_, EPOLL_CTL_ADD, breakEventFd_, &event ) < 0 )
+            throw std::runtime_error("epoll_ctl failed\n");
+
+        for( std::size_t i=0; i < socketListeners_.size(); ++i ){
+            event.events = EPOLLIN;
+            event.data.u32 = (uint32_t)i;
+            if( epoll_ctl( epollFd_, EPOLL_CTL_ADD, socketListeners_[i].second->impl_->Socket(), &event ) < 0 )
+                throw std::runtime_error("epoll_ctl failed\n");
+        }
+
+        epollSetIsStale_ = false;
+	}
+
+	void RunEpoll()
+	{
+        UpdateEpollSet();
+
+        const uint32_t breakIndex = (uint32_t)socketListeners_.size();
+
+        RestartTimers();
+
+        const int MAX_EVENTS = 64;
+        struct epoll_event events[MAX_EVENTS];
+        uint64_t spinDeadlineNs = SpinDeadlineNs();
+
+        while( !break_ ){
+            const bool spinning = IsSpinning( spinDeadlineNs );
+
+            // epoll_wait() takes whole milliseconds, round up so that the
+            // timers don't spin
+            int64_t timeoutNs = ( spinning ) ? 0 : TimeoutNs();
+            int64_t timeoutMs = ( timeoutNs < 0 ) ? -1 : (timeoutNs + 999999) / 1000000;
+            int timeout = ( timeoutMs > INT_MAX ) ? INT_MAX : (int)timeoutMs;
+
+            int readyCount = epoll_wait( epollFd_, events, MAX_EVENTS, timeout );
+            if( readyCount < 0 ){
+                if( break_ ){
+                    break;
+                }else if( errno == EINTR ){
+                    continue;
+                }else{
+                    throw std::runtime_error("epoll_wait failed\n");
+                }
             }
 
+            if( readyCount == 0 && spinning )
+                continue;
 
-            // configure the timer queue
-            double currentTimeMs = GetCurrentTimeMs();
-
-            // expiry time ms, listener
-            std::vector< std::pair< double, AttachedTimerListener > > timerQueue_;
-            for( std::vector< AttachedTimerListener >::iterator i = timerListeners_.begin();
-                    i != timerListeners_.end(); ++i )
-                timerQueue_.push_back( std::make_pair( currentTimeMs + i->initialDelayMs, *i ) );
-            std::sort( timerQueue_.begin(), timerQueue_.end(), CompareScheduledTimerCalls );
-
-            const int MAX_BUFFER_SIZE = 4098;
-            data = new char[ MAX_BUFFER_SIZE ];
-            IpEndpointName remoteEndpoint;
-
-            struct timeval timeout;
-
-            while( !break_ ){
-                tempfds = masterfds;
-
-                struct timeval *timeoutPtr = 0;
-                if( !timerQueue_.empty() ){
-                    double timeoutMs = timerQueue_.front().first - GetCurrentTimeMs();
-                    if( timeoutMs < 0 )
-                        timeoutMs = 0;
-                
-                    long timoutSecondsPart = (long)(timeoutMs * .001);
-                    timeout.tv_sec = (time_t)timoutSecondsPart;
-                    // 1000000 microseconds in a second
-                    timeout.tv_usec = (suseconds_t)((timeoutMs - (timoutSecondsPart * 1000)) * 1000);
-                    timeoutPtr = &timeout;
+            for( int i=0; i < readyCount; ++i ){
+                if( events[i].data.u32 == breakIndex ){
+                    // clear the asynchronous break eventfd
+                    uint64_t value;
+                    read( breakEventFd_, &value, sizeof(value) );
                 }
+            }
+
+            if( break_ )
+                break;
 
-                if( select( fdmax + 1, &tempfds, 0, 0, timeoutPtr ) < 0 ){
-                    if( break_ ){
+            for( int i=0; i < readyCount; ++i ){
+                uint32_t index = events[i].data.u32;
+                if( index != breakIndex ){
+                    if( !ReceivePackets( index ) )
                         break;
-                    }else if( errno == EINTR ){
-                        // on returning an error, select() doesn't clear tempfds.
-                        // so tempfds would remain all set, which would cause read( breakPipe_[0]...
-                        // below to block indefinitely. therefore if select returns EINTR we restart
-                        // the while() loop instead of continuing on to below.
-                        continue;
-                    }else{
-                        throw std::runtime_error("select failed\n");
-                    }
                 }
+            }
 
-                if( FD_ISSET( breakPipe_[0], &tempfds ) ){
-                    // clear pending data from the asynchronous break pipe
-                    char c;
-                    read( breakPipe_[0], &c, 1 );
-                }
-                
-                if( break_ )
-                    break;
+            // execute any expired timers
+            RunExpiredTimers();
+
+            spinDeadlineNs = SpinDeadlineNs();
+        }
+	}
+#endif /* __linux__ */
+
+#ifdef OSC_HAVE_IO_URING
+	void UpdateIoUring()
+	{
+        // the buffers are shared, so they hold the largest packet of any socket
+        std::size_t packetSize = 0;
+        for( std::size_t i=0; i < socketListeners_.size(); ++i )
+            packetSize = std::max( packetSize, socketListeners_[i].second->impl_->MaxPacketSize() );
+
+        if( ioUring_ && !ioUringIsStale_ && packetSize == ioUringPacketSize_ )
+            return;
+
+        delete ioUring_;
+        ioUring_ = 0;
+
+        // the sockets are registered files 0 to n-1, the break eventfd is n
+        std::vector<int> fds;
+        for( std::size_t i=0; i < socketListeners_.size(); ++i )
+            fds.push_back( socketListeners_[i].second->impl_->Socket() );
+        fds.push_back( breakEventFd_ );
+
+        std::size_t bufferSize = sizeof(struct io_uring_recvmsg_out) + sizeof(struct sockaddr_in)
+                + TIMESTAMP_CONTROL_SIZE + packetSize;
+        ioUring_ = new IoUringReceiveRing( fds, (bufferSize + 63) & ~(std::size_t)63 );
+        ioUringPacketSize_ = packetSize;
+
+        for( std::size_t i=0; i < socketListeners_.size(); ++i )
+            ioUring_->PrepareReceive( (int)i, (uint64_t)i );
+        ioUring_->PreparePoll( (int)socketListeners_.size(), IoUringReceiveRing::BREAK_POLL );
+
+        ioUringIsStale_ = false;
+	}
 
-                for( std::vector< std::pair< PacketListener*, UdpSocket* > >::iterator i = socketListeners_.begin();
-                        i != socketListeners_.end(); ++i ){
+	void PrepareIoUringTimeout()
+	{
+        // a timeout from an earlier call is ignored when it completes
+        ++timeoutSequence_;
+        int64_t timeoutNs = TimeoutNs();
+        if( timeoutNs >= 0 )
+            ioUring_->PrepareTimeout( timeoutNs, IoUringReceiveRing::TIMEOUT_BASE + timeoutSequence_ );
+	}
 
-                    if( FD_ISSET( i->second->impl_->Socket(), &tempfds ) ){
+	void RunIoUring()
+	{
+        UpdateIoUring();
+        IoUringReceiveRing& ring = *ioUring_;
+
+        const uint64_t socketCount = socketListeners_.size();
+        const int batchSize = receiveBatchSize_;
+
+        RestartTimers();
+        PrepareIoUringTimeout();
+        uint64_t spinDeadlineNs = SpinDeadlineNs();
+
+        while( !break_ ){
+            if( IsSpinning( spinDeadlineNs ) ){
+                // the completions are posted while we poll the queue,
+                // so only enter the kernel to submit
+                if( !ring.Submit() || ring.CompletionsHead() == ring.CompletionsTail() )
+                    continue;
+            }else if( !ring.SubmitAndWait() ){
+                // interrupted by a signal
+                continue;
+            }
 
-                        std::size_t size = i->second->ReceiveFrom( remoteEndpoint, data, MAX_BUFFER_SIZE );
-                        if( size > 0 ){
-                            i->first->ProcessPacket( data, (int)size, remoteEndpoint );
-                            if( break_ )
-                                break;
+            unsigned head = ring.CompletionsHead();
+            const unsigned tail = ring.CompletionsTail();
+
+            while( head != tail && !break_ ){
+                const struct io_uring_cqe& cqe = ring.Completion( head );
+                uint64_t userData = cqe.user_data;
+
+                if( userData < socketCount ){
+                    // the consecutive packets from this socket, up to the
+                    // batch size
+                    std::pair< PacketListener*, UdpSocket* >& socketListener = socketListeners_[ userData ];
+                    const int maxPacketSize = (int)socketListener.second->impl_->MaxPacketSize();
+
+                    int count = 0;
+                    bool rearm = false;
+                    unsigned end = head;
+                    while( end != tail && count < batchSize ){
+                        const struct io_uring_cqe& c = ring.Completion( end );
+                        if( c.user_data != userData )
+                            break;
+                        if( ring.GetPacket( c, datagrams_[count] ) ){
+                            // truncated to the socket's size, like recvmsg()
+                            if( datagrams_[count].size > maxPacketSize )
+                                datagrams_[count].size = maxPacketSize;
+                            ++count;
+                        }
+                        if( !(c.flags & IORING_CQE_F_MORE) ){
+                            // the multishot receive has stopped, usually
+                            // because the buffers ran out
+                            if( c.res == -EINVAL || c.res == -EOPNOTSUPP )
+                                throw std::runtime_error("io_uring multishot recvmsg failed\n");
+                            rearm = true;
                         }
+                        ++end;
+                    }
+
+                    if( count > 0 )
+                        socketListener.first->ProcessPacketBatch( &datagrams_[0], count );
+
+                    for( unsigned j=head; j != end; ++j )
+                        ring.ReturnBuffer( ring.Completion( j ) );
+                    ring.PublishBuffers();
+                    if( rearm )
+                        ring.PrepareReceive( (int)userData, userData );
+
+                    head = end;
+                    ring.ConsumeCompletions( head );
+
+                }else if( userData == IoUringReceiveRing::BREAK_POLL ){
+                    // clear the asynchronous break eventfd
+                    ring.ConsumeCompletions( ++head );
+                    uint64_t value;
+                    read( breakEventFd_, &value, sizeof(value) );
+                    ring.PreparePoll( (int)socketCount, IoUringReceiveRing::BREAK_POLL );
+
+                }else{
+                    bool isCurrentTimeout = ( userData == IoUringReceiveRing::TIMEOUT_BASE + timeoutSequence_ );
+                    ring.ConsumeCompletions( ++head );
+                    if( isCurrentTimeout ){
+                        // execute any expired timers
+                        RunExpiredTimers();
+                        PrepareIoUringTimeout();
                     }
                 }
+            }
 
-                // execute any expired timers
-                currentTimeMs = GetCurrentTimeMs();
-                bool resort = false;
-                for( std::vector< std::pair< double, AttachedTimerListener > >::iterator i = timerQueue_.begin();
-                        i != timerQueue_.end() && i->first <= currentTimeMs; ++i ){
+            spinDeadlineNs = SpinDeadlineNs();
+        }
+	}
+#endif /* OSC_HAVE_IO_URING */
 
-                    i->second.listener->TimerExpired();
-                    if( break_ )
-                        break;
+public:
+    Implementation( Backend backend )
+		: receiveBatchSize_( 1 )
+		, waitStrategy_( BLOCKING_WAIT )
+		, spinNs_( 0 )
+		, backend_( backend )
+	{
+		breakPipe_[0] = breakPipe_[1] = -1;
+#ifdef __linux__
+		breakEventFd_ = -1;
+		epollFd_ = -1;
+		epollSetIsStale_ = true;
+
+#ifdef OSC_HAVE_IO_URING
+		ioUring_ = 0;
+		ioUringIsStale_ = true;
+		ioUringPacketSize_ = 0;
+		timeoutSequence_ = 0;
+
+		if( backend_ == IO_URING_BACKEND && !IoUringReceiveRing::IsSupported() )
+			backend_ = EPOLL_BACKEND;
+#else
+		if( backend_ == IO_URING_BACKEND )
+			backend_ = EPOLL_BACKEND;
+#endif
+
+		if( backend_ == DEFAULT_BACKEND )
+			backend_ = EPOLL_BACKEND;
+
+		if( backend_ == EPOLL_BACKEND || backend_ == IO_URING_BACKEND ){
+			breakEventFd_ = eventfd( 0, EFD_CLOEXEC | EFD_NONBLOCK );
+			if( breakEventFd_ < 0 )
+				backend_ = SELECT_BACKEND; // fall back to select() and the break pipe
+		}
+#else
+		// epoll and io_uring are only available on Linux
+		backend_ = SELECT_BACKEND;
+#endif
+
+		if( backend_ == SELECT_BACKEND ){
+			if( pipe(breakPipe_) != 0 )
+				throw std::runtime_error( "creation of asynchronous break pipes failed\n" );
+		}
+	}
+
+    ~Implementation()
+	{
+		if( breakPipe_[0] != -1 ){
+			close( breakPipe_[0] );
+			close( breakPipe_[1] );
+		}
+#ifdef __linux__
+		if( breakEventFd_ != -1 )
+			close( breakEventFd_ );
+		if( epollFd_ != -1 )
+			close( epollFd_ );
+#endif
+#ifdef OSC_HAVE_IO_URING
+		delete ioUring_;
+#endif
+
+		for( TimerMap::iterator i = timers_.begin(); i != timers_.end(); ++i )
+			delete i->second;
+
+		// the pools are deleted once the listeners release their buffers
+		for( ReceiveBuffersMap::iterator i = receiveBuffers_.begin(); i != receiveBuffers_.end(); ++i )
+			i->second.pool->ReleaseOwnership();
+	}
+
+	Backend GetBackend() const { return backend_; }
+
+    void AttachSocketListener( UdpSocket *socket, PacketListener *listener )
+	{
+		assert( std::find( socketListeners_.begin(), socketListeners_.end(), std::make_pair(listener, socket) ) == socketListeners_.end() );
+		// we don't check that the same socket has been added multiple times, even though this is an error
+		socketListeners_.push_back( std::make_pair( listener, socket ) );
+#ifdef __linux__
+		epollSetIsStale_ = true;
+#endif
+#ifdef OSC_HAVE_IO_URING
+		ioUringIsStale_ = true;
+#endif
+	}
+
+    void DetachSocketListener( UdpSocket *socket, PacketListener *listener )
+	{
+		std::vector< std::pair< PacketListener*, UdpSocket* > >::iterator i = 
+				std::find( socketListeners_.begin(), socketListeners_.end(), std::make_pair(listener, socket) );
+		assert( i != socketListeners_.end() );
+
+		socketListeners_.erase( i );
+#ifdef __linux__
+		epollSetIsStale_ = true;
+#endif
+#ifdef OSC_HAVE_IO_URING
+		// the ring holds a reference to the socket, so release it now in
+		// case the socket is about to be closed. packets already completed
+		// on the ring but not yet delivered are dropped.
+		delete ioUring_;
+		ioUring_ = 0;
+		ioUringIsStale_ = true;
+#endif
+	}
+
+    void AttachPeriodicTimerListener( int periodMilliseconds, TimerListener *listener )
+	{
+		AttachPeriodicTimerListener( periodMilliseconds, periodMilliseconds, listener );
+	}
+
+	void AttachPeriodicTimerListener( int initialDelayMilliseconds, int periodMilliseconds, TimerListener *listener )
+	{
+		TimerWheel::Timer *timer = new TimerWheel::Timer( initialDelayMilliseconds, periodMilliseconds, listener );
+		timers_.insert( std::make_pair( listener, timer ) );
+
+		// in case Run() is executing, otherwise Run() schedules it
+		timer->expiryNs = GetCurrentTimeNs() + (uint64_t)initialDelayMilliseconds * 1000000;
+		timerWheel_.Schedule( timer );
+	}
+
+    void DetachPeriodicTimerListener( TimerListener *listener )
+	{
+		// the first timer attached with this listener
+		TimerMap::iterator i = timers_.lower_bound( listener );
+		assert( i != timers_.end() && i->first == listener );
 
-                    i->first += i->second.periodMs;
-                    resort = true;
+		timerWheel_.Cancel( i->second );
+		delete i->second;
+		timers_.erase( i );
+	}
+
+    void SetReceiveBatchSize( int maxPackets )
+	{
+		assert( maxPackets > 0 );
+		receiveBatchSize_ = maxPackets;
+	}
+
+    void SetWaitStrategy( WaitStrategy strategy, int spinMicroseconds )
+	{
+		assert( spinMicroseconds >= 0 );
+		waitStrategy_ = strategy;
+		spinNs_ = (uint64_t)spinMicroseconds * 1000;
+	}
+
+    void Run()
+	{
+		break_ = false;
+        
+        try{
+            AllocateReceiveBuffers();
+
+#ifdef OSC_HAVE_IO_URING
+            if( backend_ == IO_URING_BACKEND ){
+                try{
+                    UpdateIoUring();
+                }catch( std::runtime_error& ){
+                    // the kernel doesn't support the features we need
+                    delete ioUring_;
+                    ioUring_ = 0;
+                    backend_ = EPOLL_BACKEND;
                 }
-                if( resort )
-                    std::sort( timerQueue_.begin(), timerQueue_.end(), CompareScheduledTimerCalls );
             }
+            if( backend_ == IO_URING_BACKEND )
+                RunIoUring();
+            else
+#endif
+#ifdef __linux__
+            if( backend_ == EPOLL_BACKEND )
+                RunEpoll();
+            else
+#endif
+                RunSelect();
 
-            delete [] data;
+            FreeReceiveBuffers();
         }catch(...){
-            if( data )
-                delete [] data;
+            FreeReceiveBuffers();
             throw;
         }
 	}
@@ -533,6 +1954,15 @@ public:
 	{
 		break_ = true;
 
+#ifdef __linux__
+		if( backend_ == EPOLL_BACKEND || backend_ == IO_URING_BACKEND ){
+			// signal the eventfd, so epoll_wait() or io_uring_enter() will return
+			uint64_t value = 1;
+			write( breakEventFd_, &value, sizeof(value) );
+			return;
+		}
+#endif
+
 		// Send a termination message to the asynchronous break pipe, so select() will return
 		write( breakPipe_[1], "!", 1 );
 	}
@@ -540,9 +1970,9 @@ public:
 
 
 
-SocketReceiveMultiplexer::SocketReceiveMultiplexer()
+SocketReceiveMultiplexer::SocketReceiveMultiplexer( Backend backend )
 {
-	impl_ = new Implementation();
+	impl_ = new Implementation( backend );
 }
 
 SocketReceiveMultiplexer::~SocketReceiveMultiplexer()
@@ -575,6 +2005,21 @@ void SocketReceiveMultiplexer::DetachPeriodicTimerListener( TimerListener *liste
 	impl_->DetachPeriodicTimerListener( listener );
 }
 
+SocketReceiveMultiplexer::Backend SocketReceiveMultiplexer::GetBackend() const
+{
+	return impl_->GetBackend();
+}
+
+void SocketReceiveMultiplexer::SetReceiveBatchSize( int maxPackets )
+{
+	impl_->SetReceiveBatchSize( maxPackets );
+}
+
+void SocketReceiveMultiplexer::SetWaitStrategy( WaitStrategy strategy, int spinMicroseconds )
+{
+	impl_->SetWaitStrategy( strategy, spinMicroseconds );
+}
+
 void SocketReceiveMultiplexer::Run()
 {
 	impl_->Run();
@@ -600,3 +2045,265 @@ void SocketReceiveMultiplexer::AsynchronousBreak()
 	impl_->AsynchronousBreak();
 }
 
+
+class UdpReceiveGroup::Implementation{
+
+	// a socket, its multiplexer and its thread
+	struct Member : public TimerListener{
+		UdpSocket socket;
+		SocketReceiveMultiplexer mux;
+		PacketListener *listener;
+		pthread_t thread;
+		bool running; // these two are accessed with __atomic builtins
+		bool failed;
+		std::string error; // the exception Run() threw, written before failed
+
+		// set by a timer that expires as soon as Run() starts, since an
+		// AsynchronousBreak() before then would be lost
+		void TimerExpired() { __atomic_store_n( &running, true, __ATOMIC_RELEASE ); }
+	};
+
+	std::vector<Member*> members_;
+	bool pinThreads_;
+	std::size_t threadCount_; // the threads that are running
+
+	static void *ThreadFunction( void *member )
+	{
+		// an exception must not escape the thread, so it is kept for
+		// Start() or Stop() to rethrow
+		Member *m = static_cast<Member*>( member );
+		try{
+			m->mux.Run();
+		}catch( std::exception& e ){
+			m->error = e.what();
+			__atomic_store_n( &m->failed, true, __ATOMIC_RELEASE );
+		}catch(...){
+			m->error = "receive group thread failed\n";
+			__atomic_store_n( &m->failed, true, __ATOMIC_RELEASE );
+		}
+
+		// Start() and Stop() wait for this, so it must be set even if
+		// Run() ended before the timer expired
+		__atomic_store_n( &m->running, true, __ATOMIC_RELEASE );
+		return 0;
+	}
+
+#ifdef __linux__
+	void AttachSteeringProgram( UdpReceiveGroup::Steering steering )
+	{
+		// the program returns the index of the socket in the group
+		const uint32_t count = (uint32_t)members_.size();
+		struct sock_filter code[3];
+		if( steering == SOURCE_ADDRESS_STEERING ){
+			struct sock_filter loadSourceAddress = BPF_STMT( BPF_LD | BPF_W | BPF_ABS, (uint32_t)(SKF_NET_OFF + 12) );
+			code[0] = loadSourceAddress;
+		}else{
+			struct sock_filter loadCpu = BPF_STMT( BPF_LD | BPF_W | BPF_ABS, (uint32_t)(SKF_AD_OFF + SKF_AD_CPU) );
+			code[0] = loadCpu;
+		}
+		struct sock_filter modulo = BPF_STMT( BPF_ALU | BPF_MOD | BPF_K, count );
+		struct sock_filter result = BPF_STMT( BPF_RET | BPF_A, 0 );
+		code[1] = modulo;
+		code[2] = result;
+
+		struct sock_fprog program;
+		program.len = 3;
+		program.filter = code;
+		if( setsockopt( members_[0]->socket.impl_->Socket(), SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF,
+				&program, sizeof(program) ) < 0 )
+			throw std::runtime_error("unable to attach reuseport steering program\n");
+	}
+#endif
+
+public:
+	Implementation( const IpEndpointName& localEndpoint,
+			const std::vector<PacketListener*>& listeners, UdpReceiveGroup::Steering steering )
+		: pinThreads_( false )
+		, threadCount_( 0 )
+	{
+		assert( !listeners.empty() );
+
+#ifdef __linux__
+		std::size_t count = listeners.size();
+#else
+		// only Linux balances datagrams between SO_REUSEPORT sockets
+		std::size_t count = 1;
+		(void) steering;
+#endif
+
+		try{
+			IpEndpointName endpoint = localEndpoint;
+			for( std::size_t i=0; i < count; ++i ){
+				Member *member = new Member;
+				members_.push_back( member );
+				member->listener = listeners[i];
+				member->running = false;
+				member->failed = false;
+
+#ifdef __linux__
+				int reusePort = 1;
+				setsockopt( member->socket.impl_->Socket(), SOL_SOCKET, SO_REUSEPORT, &reusePort, sizeof(reusePort) );
+#endif
+				member->socket.Bind( endpoint );
+
+				// the other sockets join the port the system chose for the first
+				if( endpoint.port == IpEndpointName::ANY_PORT ){
+					struct sockaddr_in sockAddr;
+					socklen_t length = sizeof(sockAddr);
+					if( getsockname( member->socket.impl_->Socket(), (struct sockaddr *)&sockAddr, &length ) < 0 )
+						throw std::runtime_error("unable to getsockname\n");
+					endpoint.port = ntohs( sockAddr.sin_port );
+				}
+
+				member->mux.AttachSocketListener( &member->socket, member->listener );
+				member->mux.AttachPeriodicTimerListener( 0, INT_MAX, member );
+			}
+
+#ifdef __linux__
+			if( steering != HASH_STEERING )
+				AttachSteeringProgram( steering );
+#endif
+		}catch(...){
+			Free();
+			throw;
+		}
+	}
+
+	~Implementation()
+	{
+		JoinThreads(); // a destructor doesn't throw
+		Free();
+	}
+
+	int Size() const { return (int)members_.size(); }
+	UdpSocket& Socket( int index ) { return members_[index]->socket; }
+	SocketReceiveMultiplexer& Multiplexer( int index ) { return members_[index]->mux; }
+
+	void SetPinThreads( bool pinThreads ) { pinThreads_ = pinThreads; }
+
+	void Start()
+	{
+		assert( threadCount_ == 0 );
+
+#ifdef __linux__
+		long processorCount = sysconf( _SC_NPROCESSORS_ONLN );
+		if( processorCount < 1 )
+			processorCount = 1;
+#endif
+
+		for( std::size_t i=0; i < members_.size(); ++i ){
+			Member *member = members_[i];
+			member->running = false;
+			member->failed = false;
+			member->error.clear();
+			if( pthread_create( &member->thread, 0, ThreadFunction, member ) != 0 ){
+				JoinThreads();
+				throw std::runtime_error("unable to create receive group thread\n");
+			}
+			++threadCount_;
+
+#ifdef __linux__
+			if( pinThreads_ ){
+				cpu_set_t cpus;
+				CPU_ZERO( &cpus );
+				CPU_SET( (int)(i % processorCount), &cpus );
+				pthread_setaffinity_np( member->thread, sizeof(cpus), &cpus );
+			}
+#endif
+		}
+
+		for( std::size_t i=0; i < members_.size(); ++i ){
+			while( !__atomic_load_n( &members_[i]->running, __ATOMIC_ACQUIRE ) )
+				sched_yield();
+		}
+
+		// a multiplexer that failed to start is reported here
+		for( std::size_t i=0; i < members_.size(); ++i ){
+			if( __atomic_load_n( &members_[i]->failed, __ATOMIC_ACQUIRE ) ){
+				Stop();
+				break;
+			}
+		}
+	}
+
+	void Stop()
+	{
+		std::string error = JoinThreads();
+		if( !error.empty() )
+			throw std::runtime_error( error );
+	}
+
+private:
+	// break the multiplexers and wait for the threads to exit. returns
+	// the error of the first thread whose Run() threw, if any.
+	std::string JoinThreads()
+	{
+		for( std::size_t i=0; i < threadCount_; ++i ){
+			// an AsynchronousBreak() before Run() starts would be lost
+			while( !__atomic_load_n( &members_[i]->running, __ATOMIC_ACQUIRE ) )
+				sched_yield();
+			members_[i]->mux.AsynchronousBreak();
+		}
+		for( std::size_t i=0; i < threadCount_; ++i )
+			pthread_join( members_[i]->thread, 0 );
+
+
+		std::string error;
+		for( std::size_t i=0; i < threadCount_ && error.empty(); ++i ){
+			if( members_[i]->failed )
+				error = members_[i]->error;
+		}
+
+		threadCount_ = 0;
+		return error;
+	}
+
+	void Free()
+	{
+		// each multiplexer is destroyed before its socket
+		for( std::size_t i=0; i < members_.size(); ++i )
+			delete members_[i];
+		members_.clear();
+	}
+};
+
+UdpReceiveGroup::UdpReceiveGroup( const IpEndpointName& localEndpoint,
+		const std::vector<PacketListener*>& listeners, Steering steering )
+{
+	impl_ = new Implementation( localEndpoint, listeners, steering );
+}
+
+UdpReceiveGroup::~UdpReceiveGroup()
+{
+	delete impl_;
+}
+
+int UdpReceiveGroup::Size() const
+{
+	return impl_->Size();
+}
+
+UdpSocket& UdpReceiveGroup::Socket( int index )
+{
+	return impl_->Socket( index );
+}
+
+SocketReceiveMultiplexer& UdpReceiveGroup::Multiplexer( int index )
+{
+	return impl_->Multiplexer( index );
+}
+
+void UdpReceiveGroup::SetPinThreads( bool pinThreads )
+{
+	impl_->SetPinThreads( pinThreads );
+}
+
+void UdpReceiveGroup::Start()
+{
+	impl_->Start();
+}
+
+void UdpReceiveGroup::Stop()
+{
+	impl_->Stop();
+}
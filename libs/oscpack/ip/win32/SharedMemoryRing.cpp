@@ -0,0 +1,134 @@
+/*
+	oscpack -- Open Sound Control (OSC) packet manipulation library
+    http://www.rossbencina.com/code/oscpack
+
+    Copyright (c) 2004-2013 Ross Bencina <rossb@audiomulch.com>
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files
+	(the "Software"), to deal in the Software without restriction,
+	including without limitation the rights to use, copy, modify, merge,
+	publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so,
+	subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+	ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+	WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	The text above constitutes the entire oscpack license; however, 
+	the oscpack developer(s) also make the following non-binding requests:
+
+	Any person wishing to distribute modifications to the Software is
+	requested to send the modifications to the original developer so that
+	they can be incorporated into the canonical version. It is also 
+	requested that these non-binding requests be included whenever the
+	above license is reproduced.
+*/
+#include "ip/SharedMemoryRing.h"
+
+#include <stdexcept>
+
+
+// memfd and futex are Linux only
+
+class SharedMemoryRingTransmitter::Implementation{
+public:
+    Implementation( std::size_t capacity )
+    {
+        (void) capacity;
+        throw std::runtime_error("shared memory rings are only supported on Linux\n");
+    }
+
+    int FileDescriptor() const { return -1; }
+    std::size_t MaxPacketSize() const { return 0; }
+    void Send( const char *data, std::size_t size ) { (void) data; (void) size; }
+};
+
+
+class SharedMemoryRingReceiver::Implementation{
+public:
+    Implementation( int fd, PacketListener *listener )
+    {
+        (void) fd;
+        (void) listener;
+        throw std::runtime_error("shared memory rings are only supported on Linux\n");
+    }
+
+    int ReceivePackets() { return 0; }
+    uint64_t OverrunCount() const { return 0; }
+    void Run() {}
+    void Break() {}
+    void AsynchronousBreak() {}
+};
+
+
+SharedMemoryRingTransmitter::SharedMemoryRingTransmitter( std::size_t capacity )
+{
+    impl_ = new Implementation( capacity );
+}
+
+SharedMemoryRingTransmitter::~SharedMemoryRingTransmitter()
+{
+    delete impl_;
+}
+
+int SharedMemoryRingTransmitter::FileDescriptor() const
+{
+    return impl_->FileDescriptor();
+}
+
+std::size_t SharedMemoryRingTransmitter::MaxPacketSize() const
+{
+    return impl_->MaxPacketSize();
+}
+
+void SharedMemoryRingTransmitter::Send( const char *data, std::size_t size )
+{
+    impl_->Send( data, size );
+}
+
+
+SharedMemoryRingReceiver::SharedMemoryRingReceiver( int fd, PacketListener *listener )
+{
+    impl_ = new Implementation( fd, listener );
+}
+
+SharedMemoryRingReceiver::~SharedMemoryRingReceiver()
+{
+    delete impl_;
+}
+
+int SharedMemoryRingReceiver::ReceivePackets()
+{
+    return impl_->ReceivePackets();
+}
+
+uint64_t SharedMemoryRingReceiver::OverrunCount() const
+{
+    return impl_->OverrunCount();
+}
+
+void SharedMemoryRingReceiver::Run()
+{
+    impl_->Run();
+}
+
+void SharedMemoryRingReceiver::Break()
+{
+    impl_->Break();
+}
+
+void SharedMemoryRingReceiver::AsynchronousBreak()
+{
+    impl_->AsynchronousBreak();
+}
@@ -37,7 +37,6 @@
 
 #include <winsock2.h>   // this must come first to prevent errors with MSVC7
 #include <windows.h>
-#include <mmsystem.h>   // for timeGetTime()
 
 #ifndef WINCE
 #include <signal.h>
@@ -45,17 +44,22 @@
 
 #include <algorithm>
 #include <cassert>
+#include <climits>
 #include <cstring> // for memset
+#include <map>
 #include <stdexcept>
+#include <string>
 #include <vector>
 
 #include "ip/UdpSocket.h" // usually I'd include the module header first
                           // but this is causing conflicts with BCB4 due to
                           // std::size_t usage.
+#include "ip/LocalDatagramSocket.h"
 
 #include "ip/NetworkingUtils.h"
 #include "ip/PacketListener.h"
 #include "ip/TimerListener.h"
+#include "ip/TimerWheel.h"
 
 
 typedef int socklen_t;
@@ -96,6 +100,7 @@ class UdpSocket::Implementation{
 
 	bool isBound_;
 	bool isConnected_;
+	std::size_t maxPacketSize_;
 
 	SOCKET socket_;
 	struct sockaddr_in connectedAddr_;
@@ -106,6 +111,7 @@ public:
 	Implementation()
 		: isBound_( false )
 		, isConnected_( false )
+		, maxPacketSize_( 4098 )
 		, socket_( INVALID_SOCKET )
 	{
 		if( (socket_ = socket( AF_INET, SOCK_DGRAM, 0 )) == INVALID_SOCKET ){
@@ -137,6 +143,14 @@ public:
 		setsockopt(socket_, SOL_SOCKET, SO_REUSEADDR, &reuseAddr, sizeof(reuseAddr));
 	}
 
+	void SetMaxPacketSize( std::size_t maxPacketSize )
+	{
+		assert( maxPacketSize > 0 );
+		maxPacketSize_ = maxPacketSize;
+	}
+
+	std::size_t MaxPacketSize() const { return maxPacketSize_; }
+
 	IpEndpointName LocalEndpointFor( const IpEndpointName& remoteEndpoint ) const
 	{
 		assert( isBound_ );
@@ -207,6 +221,50 @@ public:
         sendto( socket_, data, (int)size, 0, (sockaddr*)&sendToAddr_, sizeof(sendToAddr_) );
 	}
 
+	void SendV( const IoVector *vectors, std::size_t count )
+	{
+		assert( isConnected_ );
+
+		SendMsg( 0, vectors, count );
+	}
+
+	void SendToV( const IpEndpointName& remoteEndpoint, const IoVector *vectors, std::size_t count )
+	{
+		sendToAddr_.sin_addr.s_addr = htonl( remoteEndpoint.address );
+        sendToAddr_.sin_port = htons( (short)remoteEndpoint.port );
+
+		SendMsg( &sendToAddr_, vectors, count );
+	}
+
+	std::size_t SendBatch( UdpSendBatch& batch )
+	{
+		// there is no batched send on Windows, so the packets are sent one
+		// at a time
+		std::size_t sentCount = 0;
+		for( std::size_t i=0; i < batch.Size(); ++i ){
+			UdpSendBatch::Entry& e = batch[i];
+			int result;
+			if( e.toConnectedEndpoint ){
+				result = send( socket_, e.data, (int)e.size, 0 );
+			}else{
+				sendToAddr_.sin_addr.s_addr = htonl( e.remoteEndpoint.address );
+				sendToAddr_.sin_port = htons( (short)e.remoteEndpoint.port );
+				result = sendto( socket_, e.data, (int)e.size, 0, (sockaddr*)&sendToAddr_, sizeof(sendToAddr_) );
+			}
+
+			if( result == SOCKET_ERROR ){
+				e.bytesSent = 0;
+				e.error = WSAGetLastError();
+			}else{
+				e.bytesSent = (std::size_t)result;
+				e.error = 0;
+				++sentCount;
+			}
+		}
+
+		return sentCount;
+	}
+
 	void Bind( const IpEndpointName& localEndpoint )
 	{
 		struct sockaddr_in bindSockAddr;
@@ -240,6 +298,31 @@ public:
 	}
 
 	SOCKET& Socket() { return socket_; }
+
+private:
+	void SendMsg( struct sockaddr_in *toAddr, const IoVector *vectors, std::size_t count )
+	{
+		// most packets are a few parts, so avoid allocating for them
+		WSABUF localBuffers[16];
+		std::vector<WSABUF> heapBuffers;
+		WSABUF *buffers = localBuffers;
+		if( count > 16 ){
+			heapBuffers.resize( count );
+			buffers = &heapBuffers[0];
+		}
+
+		for( std::size_t i=0; i < count; ++i ){
+			buffers[i].buf = (CHAR*)const_cast<void*>( vectors[i].data );
+			buffers[i].len = (ULONG)vectors[i].size;
+		}
+
+		DWORD bytesSent = 0;
+		if( toAddr )
+			WSASendTo( socket_, buffers, (DWORD)count, &bytesSent, 0,
+					(sockaddr*)toAddr, sizeof(*toAddr), NULL, NULL );
+		else
+			WSASend( socket_, buffers, (DWORD)count, &bytesSent, 0, NULL, NULL );
+	}
 };
 
 UdpSocket::UdpSocket()
@@ -247,6 +330,15 @@ UdpSocket::UdpSocket()
 	impl_ = new Implementation();
 }
 
+UdpSocket::UdpSocket( AddressFamily family )
+{
+	// Winsock's AF_UNIX only has stream sockets
+	if( family == LOCAL_FAMILY )
+		throw std::runtime_error("local datagram sockets are not supported on Windows\n");
+
+	impl_ = new Implementation();
+}
+
 UdpSocket::~UdpSocket()
 {
 	delete impl_;
@@ -262,6 +354,29 @@ void UdpSocket::SetAllowReuse( bool allowReuse )
     impl_->SetAllowReuse( allowReuse );
 }
 
+void UdpSocket::SetEnableTimestamps( bool enableTimestamps, bool includeHardware )
+{
+    // Winsock has no receive timestamps for UDP, so the timestamps stay 0
+    (void) enableTimestamps;
+    (void) includeHardware;
+}
+
+void UdpSocket::SetBusyPoll( int microseconds )
+{
+    // Winsock has no busy polling for UDP
+    (void) microseconds;
+}
+
+void UdpSocket::SetMaxPacketSize( std::size_t maxPacketSize )
+{
+    impl_->SetMaxPacketSize( maxPacketSize );
+}
+
+std::size_t UdpSocket::MaxPacketSize() const
+{
+    return impl_->MaxPacketSize();
+}
+
 IpEndpointName UdpSocket::LocalEndpointFor( const IpEndpointName& remoteEndpoint ) const
 {
 	return impl_->LocalEndpointFor( remoteEndpoint );
@@ -282,6 +397,21 @@ void UdpSocket::SendTo( const IpEndpointName& remoteEndpoint, const char *data,
 	impl_->SendTo( remoteEndpoint, data, size );
 }
 
+void UdpSocket::SendV( const IoVector *vectors, std::size_t count )
+{
+	impl_->SendV( vectors, count );
+}
+
+void UdpSocket::SendToV( const IpEndpointName& remoteEndpoint, const IoVector *vectors, std::size_t count )
+{
+	impl_->SendToV( remoteEndpoint, vectors, count );
+}
+
+std::size_t UdpSocket::SendBatch( UdpSendBatch& batch )
+{
+	return impl_->SendBatch( batch );
+}
+
 void UdpSocket::Bind( const IpEndpointName& localEndpoint )
 {
 	impl_->Bind( localEndpoint );
@@ -297,22 +427,41 @@ std::size_t UdpSocket::ReceiveFrom( IpEndpointName& remoteEndpoint, char *data,
 	return impl_->ReceiveFrom( remoteEndpoint, data, size );
 }
 
+std::size_t UdpSocket::ReceiveFrom( IpEndpointName& remoteEndpoint, char *data, std::size_t size,
+		PacketTimestamp& timestamp )
+{
+	timestamp = PacketTimestamp();
+	return impl_->ReceiveFrom( remoteEndpoint, data, size );
+}
+
 
-struct AttachedTimerListener{
-	AttachedTimerListener( int id, int p, TimerListener *tl )
-		: initialDelayMs( id )
-		, periodMs( p )
-		, listener( tl ) {}
-	int initialDelayMs;
-	int periodMs;
-	TimerListener *listener;
-};
+// the ctor throws, so these are never called
+
+LocalDatagramSocket::LocalDatagramSocket()
+	: UdpSocket( LOCAL_FAMILY )
+{
+}
+
+void LocalDatagramSocket::Connect( const LocalEndpointName& remoteEndpoint )
+{
+	(void) remoteEndpoint;
+}
 
+void LocalDatagramSocket::SendTo( const LocalEndpointName& remoteEndpoint, const char *data, std::size_t size )
+{
+	(void) remoteEndpoint;
+	(void) data;
+	(void) size;
+}
 
-static bool CompareScheduledTimerCalls( 
-		const std::pair< double, AttachedTimerListener > & lhs, const std::pair< double, AttachedTimerListener > & rhs )
+void LocalDatagramSocket::Bind( const LocalEndpointName& localEndpoint )
 {
-	return lhs.first < rhs.first;
+	(void) localEndpoint;
+}
+
+int LocalDatagramSocket::FileDescriptor() const
+{
+	return -1;
 }
 
 
@@ -332,29 +481,69 @@ class SocketReceiveMultiplexer::Implementation{
     NetworkInitializer networkInitializer_;
 
 	std::vector< std::pair< PacketListener*, UdpSocket* > > socketListeners_;
-	std::vector< AttachedTimerListener > timerListeners_;
+	// the attached timers by listener, and the wheel that schedules them
+	typedef std::multimap< TimerListener*, TimerWheel::Timer* > TimerMap;
+	TimerMap timers_;
+	TimerWheel timerWheel_;
+
+	int receiveBatchSize_;
+	WaitStrategy waitStrategy_;
+	uint64_t spinNs_; // for SPIN_THEN_BLOCK_WAIT
 
 	volatile bool break_;
 	HANDLE breakEvent_;
 
-	double GetCurrentTimeMs() const
+	LARGE_INTEGER performanceFrequency_;
+
+	uint64_t GetCurrentTimeNs() const
 	{
-#ifndef WINCE
-		return timeGetTime(); // FIXME: bad choice if you want to run for more than 40 days
-#else
-        return 0;
-#endif
+		// the performance counter is monotonic and doesn't wrap
+		LARGE_INTEGER counter;
+		QueryPerformanceCounter( &counter );
+
+		uint64_t ticks = (uint64_t)counter.QuadPart;
+		uint64_t frequency = (uint64_t)performanceFrequency_.QuadPart;
+		return (ticks / frequency) * 1000000000 + ((ticks % frequency) * 1000000000) / frequency;
     }
 
+	// the time until which the next wait polls without blocking, 0 if it
+	// blocks straight away
+	uint64_t SpinDeadlineNs() const
+	{
+        switch( waitStrategy_ ){
+            case SPIN_THEN_BLOCK_WAIT: return GetCurrentTimeNs() + spinNs_;
+            case BUSY_POLL_WAIT: return ~(uint64_t)0;
+            default: return 0;
+        }
+	}
+
+	// keep polling until the deadline, a break or a timer is due
+	bool IsSpinning( uint64_t spinDeadlineNs ) const
+	{
+        if( spinDeadlineNs == 0 || break_ )
+            return false;
+
+        uint64_t currentTimeNs = GetCurrentTimeNs();
+        return currentTimeNs < spinDeadlineNs
+                && timerWheel_.NanosecondsUntilNextExpiry( currentTimeNs ) != 0;
+	}
+
 public:
     Implementation()
+		: receiveBatchSize_( 1 )
+		, waitStrategy_( BLOCKING_WAIT )
+		, spinNs_( 0 )
 	{
 		breakEvent_ = CreateEvent( NULL, FALSE, FALSE, NULL );
+		QueryPerformanceFrequency( &performanceFrequency_ );
 	}
 
     ~Implementation()
 	{
 		CloseHandle( breakEvent_ );
+
+		for( TimerMap::iterator i = timers_.begin(); i != timers_.end(); ++i )
+			delete i->second;
 	}
 
     void AttachSocketListener( UdpSocket *socket, PacketListener *listener )
@@ -375,26 +564,41 @@ public:
 
     void AttachPeriodicTimerListener( int periodMilliseconds, TimerListener *listener )
 	{
-		timerListeners_.push_back( AttachedTimerListener( periodMilliseconds, periodMilliseconds, listener ) );
+		AttachPeriodicTimerListener( periodMilliseconds, periodMilliseconds, listener );
 	}
 
 	void AttachPeriodicTimerListener( int initialDelayMilliseconds, int periodMilliseconds, TimerListener *listener )
 	{
-		timerListeners_.push_back( AttachedTimerListener( initialDelayMilliseconds, periodMilliseconds, listener ) );
+		TimerWheel::Timer *timer = new TimerWheel::Timer( initialDelayMilliseconds, periodMilliseconds, listener );
+		timers_.insert( std::make_pair( listener, timer ) );
+
+		// in case Run() is executing, otherwise Run() schedules it
+		timer->expiryNs = GetCurrentTimeNs() + (uint64_t)initialDelayMilliseconds * 1000000;
+		timerWheel_.Schedule( timer );
 	}
 
     void DetachPeriodicTimerListener( TimerListener *listener )
 	{
-		std::vector< AttachedTimerListener >::iterator i = timerListeners_.begin();
-		while( i != timerListeners_.end() ){
-			if( i->listener == listener )
-				break;
-			++i;
-		}
+		// the first timer attached with this listener
+		TimerMap::iterator i = timers_.lower_bound( listener );
+		assert( i != timers_.end() && i->first == listener );
 
-		assert( i != timerListeners_.end() );
+		timerWheel_.Cancel( i->second );
+		delete i->second;
+		timers_.erase( i );
+	}
 
-		timerListeners_.erase( i );
+    void SetReceiveBatchSize( int maxPackets )
+	{
+		assert( maxPackets > 0 );
+		receiveBatchSize_ = maxPackets;
+	}
+
+    void SetWaitStrategy( WaitStrategy strategy, int spinMicroseconds )
+	{
+		assert( spinMicroseconds >= 0 );
+		waitStrategy_ = strategy;
+		spinNs_ = (uint64_t)spinMicroseconds * 1000;
 	}
 
     void Run()
@@ -419,41 +623,68 @@ public:
 		events[ socketListeners_.size() ] = breakEvent_; // last event in the collection is the break event
 
 		
-		// configure the timer queue
-		double currentTimeMs = GetCurrentTimeMs();
-
-		// expiry time ms, listener
-		std::vector< std::pair< double, AttachedTimerListener > > timerQueue_;
-		for( std::vector< AttachedTimerListener >::iterator i = timerListeners_.begin();
-				i != timerListeners_.end(); ++i )
-			timerQueue_.push_back( std::make_pair( currentTimeMs + i->initialDelayMs, *i ) );
-		std::sort( timerQueue_.begin(), timerQueue_.end(), CompareScheduledTimerCalls );
-
-		const int MAX_BUFFER_SIZE = 4098;
-		char *data = new char[ MAX_BUFFER_SIZE ];
+		// start the timers from their initial delays
+		uint64_t currentTimeNs = GetCurrentTimeNs();
+		timerWheel_.Clear( currentTimeNs );
+		for( TimerMap::iterator i = timers_.begin(); i != timers_.end(); ++i ){
+			i->second->expiryNs = currentTimeNs + (uint64_t)i->second->initialDelayMs * 1000000;
+			timerWheel_.Schedule( i->second );
+		}
+
+		// the packets are received into a ring of batchSize buffers in data,
+		// each big enough for the largest packet of any socket. they aren't
+		// pooled, so a PacketHandle copies its packet.
+		std::size_t bufferSize = 0;
+		for( std::size_t i=0; i < socketListeners_.size(); ++i ){
+			if( socketListeners_[i].second->MaxPacketSize() > bufferSize )
+				bufferSize = socketListeners_[i].second->MaxPacketSize();
+		}
+
+		const int batchSize = receiveBatchSize_;
+		char *data = new char[ bufferSize * batchSize ];
 		IpEndpointName remoteEndpoint;
 
+		std::vector<ReceivedDatagram> datagrams( batchSize );
+		uint64_t spinDeadlineNs = SpinDeadlineNs();
+
 		while( !break_ ){
 
-			double currentTimeMs = GetCurrentTimeMs();
+            const bool spinning = IsSpinning( spinDeadlineNs );
 
+            // round up to whole milliseconds, so that the timers don't spin
             DWORD waitTime = INFINITE;
-            if( !timerQueue_.empty() ){
-
-                waitTime = (DWORD)( timerQueue_.front().first >= currentTimeMs
-                            ? timerQueue_.front().first - currentTimeMs
-                            : 0 );
+            int64_t timeoutNs = ( spinning ) ? 0 : timerWheel_.NanosecondsUntilNextExpiry( GetCurrentTimeNs() );
+            if( timeoutNs >= 0 ){
+                int64_t timeoutMs = (timeoutNs + 999999) / 1000000;
+                waitTime = ( timeoutMs < (int64_t)INFINITE ) ? (DWORD)timeoutMs : INFINITE - 1;
             }
 
 			DWORD waitResult = WaitForMultipleObjects( (DWORD)socketListeners_.size() + 1, &events[0], FALSE, waitTime );
 			if( break_ )
 				break;
 
+			if( waitResult == WAIT_TIMEOUT && spinning )
+				continue;
+
 			if( waitResult != WAIT_TIMEOUT ){
 				for( int i = waitResult - WAIT_OBJECT_0; i < (int)socketListeners_.size(); ++i ){
-					std::size_t size = socketListeners_[i].second->ReceiveFrom( remoteEndpoint, data, MAX_BUFFER_SIZE );
-					if( size > 0 ){
-						socketListeners_[i].first->ProcessPacket( data, (int)size, remoteEndpoint );
+					// there is no recvmmsg on Windows, but the sockets are
+					// non-blocking here so ReceiveFrom() returns 0 once the
+					// socket is drained
+					const std::size_t packetSize = socketListeners_[i].second->MaxPacketSize();
+					int count = 0;
+					for( int j=0; j < batchSize; ++j ){
+						char *buffer = data + j * bufferSize;
+						std::size_t size = socketListeners_[i].second->ReceiveFrom( remoteEndpoint, buffer, packetSize );
+						if( size == 0 )
+							break;
+						ReceivedDatagram& d = datagrams[count++];
+						d.data = buffer;
+						d.size = (int)size;
+						d.remoteEndpoint = remoteEndpoint;
+					}
+					if( count > 0 ){
+						socketListeners_[i].first->ProcessPacketBatch( &datagrams[0], count );
 						if( break_ )
 							break;
 					}
@@ -461,20 +692,20 @@ public:
 			}
 
 			// execute any expired timers
-			currentTimeMs = GetCurrentTimeMs();
-			bool resort = false;
-			for( std::vector< std::pair< double, AttachedTimerListener > >::iterator i = timerQueue_.begin();
-					i != timerQueue_.end() && i->first <= currentTimeMs; ++i ){
+			timerWheel_.CollectExpired( GetCurrentTimeNs() );
+			for( TimerWheel::Timer *timer = timerWheel_.PopExpired(); timer != 0;
+					timer = timerWheel_.PopExpired() ){
 
-				i->second.listener->TimerExpired();
+				// scheduled before the call, so that the listener can detach itself
+				timer->expiryNs += (uint64_t)timer->periodMs * 1000000;
+				timerWheel_.Schedule( timer );
+
+				timer->listener->TimerExpired();
 				if( break_ )
 					break;
-
-				i->first += i->second.periodMs;
-				resort = true;
 			}
-			if( resort )
-				std::sort( timerQueue_.begin(), timerQueue_.end(), CompareScheduledTimerCalls );
+
+			spinDeadlineNs = SpinDeadlineNs();
 		}
 
 		delete [] data;
@@ -505,8 +736,9 @@ public:
 
 
 
-SocketReceiveMultiplexer::SocketReceiveMultiplexer()
+SocketReceiveMultiplexer::SocketReceiveMultiplexer( Backend backend )
 {
+	(void) backend; // there is only one backend on Windows
 	impl_ = new Implementation();
 }
 
@@ -540,6 +772,21 @@ void SocketReceiveMultiplexer::DetachPeriodicTimerListener( TimerListener *liste
 	impl_->DetachPeriodicTimerListener( listener );
 }
 
+SocketReceiveMultiplexer::Backend SocketReceiveMultiplexer::GetBackend() const
+{
+	return DEFAULT_BACKEND;
+}
+
+void SocketReceiveMultiplexer::SetReceiveBatchSize( int maxPackets )
+{
+	impl_->SetReceiveBatchSize( maxPackets );
+}
+
+void SocketReceiveMultiplexer::SetWaitStrategy( WaitStrategy strategy, int spinMicroseconds )
+{
+	impl_->SetWaitStrategy( strategy, spinMicroseconds );
+}
+
 void SocketReceiveMultiplexer::Run()
 {
 	impl_->Run();
@@ -569,3 +816,202 @@ void SocketReceiveMultiplexer::AsynchronousBreak()
 	impl_->AsynchronousBreak();
 }
 
+
+class UdpReceiveGroup::Implementation{
+
+	// a socket, its multiplexer and its thread
+	struct Member : public TimerListener{
+		UdpSocket socket;
+		SocketReceiveMultiplexer mux;
+		PacketListener *listener;
+		HANDLE thread;
+		volatile bool running;
+		volatile bool failed;
+		std::string error; // the exception Run() threw, written before failed
+
+		// set by a timer that expires as soon as Run() starts, since an
+		// AsynchronousBreak() before then would be lost
+		void TimerExpired() { running = true; }
+	};
+
+	std::vector<Member*> members_;
+	bool pinThreads_;
+	std::size_t threadCount_; // the threads that are running
+
+	static DWORD WINAPI ThreadFunction( LPVOID member )
+	{
+		// an exception must not escape the thread, so it is kept for
+		// Start() or Stop() to rethrow
+		Member *m = static_cast<Member*>( member );
+		try{
+			m->mux.Run();
+		}catch( std::exception& e ){
+			m->error = e.what();
+			m->failed = true;
+		}catch(...){
+			m->error = "receive group thread failed\n";
+			m->failed = true;
+		}
+
+		// Start() and Stop() wait for this, so it must be set even if
+		// Run() ended before the timer expired
+		m->running = true;
+		return 0;
+	}
+
+public:
+	Implementation( const IpEndpointName& localEndpoint,
+			const std::vector<PacketListener*>& listeners, UdpReceiveGroup::Steering steering )
+		: pinThreads_( false )
+		, threadCount_( 0 )
+	{
+		assert( !listeners.empty() );
+		(void) steering;
+
+		// Windows doesn't balance datagrams between sockets sharing a
+		// port, so there is only one socket
+		Member *member = new Member;
+		members_.push_back( member );
+		member->listener = listeners[0];
+		member->running = false;
+		member->failed = false;
+
+		try{
+			member->socket.Bind( localEndpoint );
+		}catch(...){
+			Free();
+			throw;
+		}
+
+		member->mux.AttachSocketListener( &member->socket, member->listener );
+		member->mux.AttachPeriodicTimerListener( 0, INT_MAX, member );
+	}
+
+	~Implementation()
+	{
+		JoinThreads(); // a destructor doesn't throw
+		Free();
+	}
+
+	int Size() const { return (int)members_.size(); }
+	UdpSocket& Socket( int index ) { return members_[index]->socket; }
+	SocketReceiveMultiplexer& Multiplexer( int index ) { return members_[index]->mux; }
+
+	void SetPinThreads( bool pinThreads ) { pinThreads_ = pinThreads; }
+
+	void Start()
+	{
+		assert( threadCount_ == 0 );
+
+		for( std::size_t i=0; i < members_.size(); ++i ){
+			Member *member = members_[i];
+			member->running = false;
+			member->failed = false;
+			member->error.clear();
+			member->thread = CreateThread( NULL, 0, ThreadFunction, member, 0, NULL );
+			if( member->thread == NULL ){
+				JoinThreads();
+				throw std::runtime_error("unable to create receive group thread\n");
+			}
+			++threadCount_;
+
+			if( pinThreads_ )
+				SetThreadAffinityMask( member->thread, (DWORD_PTR)1 << (i % (sizeof(DWORD_PTR) * 8)) );
+		}
+
+		for( std::size_t i=0; i < members_.size(); ++i ){
+			while( !members_[i]->running )
+				Sleep( 0 );
+		}
+
+		// a multiplexer that failed to start is reported here
+		for( std::size_t i=0; i < members_.size(); ++i ){
+			if( members_[i]->failed ){
+				Stop();
+				break;
+			}
+		}
+	}
+
+	void Stop()
+	{
+		std::string error = JoinThreads();
+		if( !error.empty() )
+			throw std::runtime_error( error );
+	}
+
+private:
+	// break the multiplexers and wait for the threads to exit. returns
+	// the error of the first thread whose Run() threw, if any.
+	std::string JoinThreads()
+	{
+		for( std::size_t i=0; i < threadCount_; ++i ){
+			// an AsynchronousBreak() before Run() starts would be lost
+			while( !members_[i]->running )
+				Sleep( 0 );
+			members_[i]->mux.AsynchronousBreak();
+		}
+		for( std::size_t i=0; i < threadCount_; ++i ){
+			WaitForSingleObject( members_[i]->thread, INFINITE );
+			CloseHandle( members_[i]->thread );
+		}
+
+		std::string error;
+		for( std::size_t i=0; i < threadCount_ && error.empty(); ++i ){
+			if( members_[i]->failed )
+				error = members_[i]->error;
+		}
+
+		threadCount_ = 0;
+		return error;
+	}
+
+	void Free()
+	{
+		// each multiplexer is destroyed before its socket
+		for( std::size_t i=0; i < members_.size(); ++i )
+			delete members_[i];
+		members_.clear();
+	}
+};
+
+UdpReceiveGroup::UdpReceiveGroup( const IpEndpointName& localEndpoint,
+		const std::vector<PacketListener*>& listeners, Steering steering )
+{
+	impl_ = new Implementation( localEndpoint, listeners, steering );
+}
+
+UdpReceiveGroup::~UdpReceiveGroup()
+{
+	delete impl_;
+}
+
+int UdpReceiveGroup::Size() const
+{
+	return impl_->Size();
+}
+
+UdpSocket& UdpReceiveGroup::Socket( int index )
+{
+	return impl_->Socket( index );
+}
+
+SocketReceiveMultiplexer& UdpReceiveGroup::Multiplexer( int index )
+{
+	return impl_->Multiplexer( index );
+}
+
+void UdpReceiveGroup::SetPinThreads( bool pinThreads )
+{
+	impl_->SetPinThreads( pinThreads );
+}
+
+void UdpReceiveGroup::Start()
+{
+	impl_->Start();
+}
+
+void UdpReceiveGroup::Stop()
+{
+	impl_->Stop();
+}
@@ -37,15 +37,23 @@
 #ifndef INCLUDED_OSCPACK_MESSAGEMAPPINGOSCPACKETLISTENER_H
 #define INCLUDED_OSCPACK_MESSAGEMAPPINGOSCPACKETLISTENER_H
 
-#include <cstring>
-#include <map>
+#include <algorithm>
+#include <vector>
 
 #include "OscPacketListener.h"
+#include "OscAddressPatternMatcher.h"
 
 
 
 namespace osc{
 
+/*
+    Dispatches each received message to every registered function whose
+    address is matched by the message's address pattern, including OSC
+    wildcards (see OscAddressPatternMatcher.h). A function registered for
+    "/track/1/mute" receives both "/track/1/mute" and "/track/?/mute".
+*/
+
 template< class T >
 class MessageMappingOscPacketListener : public OscPacketListener{
 public:
@@ -54,25 +62,40 @@ public:
 protected:
     void RegisterMessageFunction( const char *addressPattern, function_type f )
     {
-        functions_.insert( std::make_pair( addressPattern, f ) );
+        // the first function registered for an address is kept
+        uint32 id = matcher_.AddMethod( addressPattern );
+        if( id == functions_.size() )
+            functions_.push_back( f );
     }
 
     virtual void ProcessMessage( const osc::ReceivedMessage& m,
 		const IpEndpointName& remoteEndpoint )
     {
-        typename function_map_type::iterator i = functions_.find( m.AddressPattern() );
-        if( i != functions_.end() )
-            (dynamic_cast<T*>(this)->*(i->second))( m, remoteEndpoint );
+        // the ids are copied, since a function that processes another
+        // message or registers a function reuses the matcher's result.
+        // most messages match a few functions, so they fit on the stack.
+        const std::vector<uint32>& matches = matcher_.Match( m );
+        const std::size_t count = matches.size();
+
+        uint32 localIds[ LOCAL_ID_COUNT ];
+        std::vector<uint32> moreIds;
+        const uint32 *ids = localIds;
+        if( count <= LOCAL_ID_COUNT ){
+            std::copy( matches.begin(), matches.end(), localIds );
+        }else{
+            moreIds = matches;
+            ids = &moreIds[0];
+        }
+
+        for( std::size_t i=0; i < count; ++i )
+            (static_cast<T*>(this)->*(functions_[ ids[i] ]))( m, remoteEndpoint );
     }
     
 private:
-    struct cstr_compare{
-        bool operator()( const char *lhs, const char *rhs ) const
-            { return std::strcmp( lhs, rhs ) < 0; }
-    };
+    enum { LOCAL_ID_COUNT = 16 };
 
-    typedef std::map<const char*, function_type, cstr_compare> function_map_type;
-    function_map_type functions_;
+    AddressPatternMatcher matcher_;
+    std::vector<function_type> functions_;
 };
 
 } // namespace osc
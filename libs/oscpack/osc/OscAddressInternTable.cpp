@@ -0,0 +1,184 @@
+/*
+	oscpack -- Open Sound Control (OSC) packet manipulation library
+    http://www.rossbencina.com/code/oscpack
+
+    Copyright (c) 2004-2013 Ross Bencina <rossb@audiomulch.com>
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files
+	(the "Software"), to deal in the Software without restriction,
+	including without limitation the rights to use, copy, modify, merge,
+	publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so,
+	subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+	ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+	WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	The text above constitutes the entire oscpack license; however, 
+	the oscpack developer(s) also make the following non-binding requests:
+
+	Any person wishing to distribute modifications to the Software is
+	requested to send the modifications to the original developer so that
+	they can be incorporated into the canonical version. It is also 
+	requested that these non-binding requests be included whenever the
+	above license is reproduced.
+*/
+#include "OscAddressInternTable.h"
+
+#include <cstring>
+
+#include "OscReceivedElements.h"
+#include "OscSimd.h"
+
+
+namespace osc{
+
+
+AddressInternTable::AddressInternTable()
+    : slots_( 16, 0 )
+{
+}
+
+
+uint32 AddressInternTable::HashAddressPattern( const char *addressPattern )
+{
+    std::size_t length = std::strlen( addressPattern );
+    std::size_t paddedLength = (length + 4) & ~((std::size_t)0x03);
+
+    // HashStr4() reads the zero padding that follows the terminator in a
+    // received message, so hash a zero padded copy of the string. addresses
+    // are usually short enough to copy on the stack.
+    char stackCopy[256];
+    std::string heapCopy;
+    char *copy = stackCopy;
+    if( paddedLength > sizeof(stackCopy) ){
+        heapCopy.assign( paddedLength, '\0' );
+        copy = &heapCopy[0];
+    }
+    std::memcpy( copy, addressPattern, length );
+    std::memset( copy + length, 0, paddedLength - length );
+
+    return HashStr4( copy, paddedLength );
+}
+
+
+std::size_t AddressInternTable::FindSlot( const char *addressPattern, uint32 hash ) const
+{
+    std::size_t mask = slots_.size() - 1;
+    std::size_t i = hash & mask;
+
+    for(;;){
+        uint32 slot = slots_[i];
+        if( slot == 0 )
+            return i;
+
+        uint32 id = slot - 1;
+        if( hashes_[id] == hash && addresses_[id] == addressPattern )
+            return i;
+
+        i = (i + 1) & mask;
+    }
+}
+
+
+uint32 AddressInternTable::Find( const char *addressPattern, uint32 hash ) const
+{
+    return slots_[ FindSlot( addressPattern, hash ) ] - 1;
+}
+
+
+uint32 AddressInternTable::Find( const char *addressPattern ) const
+{
+    return Find( addressPattern, HashAddressPattern( addressPattern ) );
+}
+
+
+uint32 AddressInternTable::Find( const ReceivedMessage& m ) const
+{
+    return Find( m.AddressPattern(), m.AddressPatternHash() );
+}
+
+
+uint32 AddressInternTable::Intern( const char *addressPattern, uint32 hash )
+{
+    uint32 id = Find( addressPattern, hash );
+    if( id != INVALID_ADDRESS_ID )
+        return id;
+
+    return Add( addressPattern, hash );
+}
+
+
+uint32 AddressInternTable::Intern( const char *addressPattern )
+{
+    return Intern( addressPattern, HashAddressPattern( addressPattern ) );
+}
+
+
+uint32 AddressInternTable::Intern( const ReceivedMessage& m )
+{
+    return Intern( m.AddressPattern(), m.AddressPatternHash() );
+}
+
+
+void AddressInternTable::Clear()
+{
+    addresses_.clear();
+    hashes_.clear();
+    slots_.assign( 16, 0 );
+}
+
+
+uint32 AddressInternTable::Add( const char *addressPattern, uint32 hash )
+{
+    uint32 id = static_cast<uint32>(addresses_.size());
+    addresses_.push_back( addressPattern );
+    hashes_.push_back( hash );
+
+    if( addresses_.size() * 2 > slots_.size() )
+        Grow();
+    else
+        slots_[ FindSlot( addressPattern, hash ) ] = id + 1;
+
+    return id;
+}
+
+
+void AddressInternTable::Grow()
+{
+    // rehash every address, including the one just added
+    std::vector<uint32> slots( slots_.size() * 2, 0 );
+    std::size_t mask = slots.size() - 1;
+
+    for( uint32 id = 0; id < addresses_.size(); ++id ){
+        std::size_t i = hashes_[id] & mask;
+        while( slots[i] != 0 )
+            i = (i + 1) & mask;
+        slots[i] = id + 1;
+    }
+
+    slots_.swap( slots );
+}
+
+
+// defined here rather than in OscReceivedElements.cpp so that programs which
+// don't use interning don't need to link this file
+uint32 ReceivedMessage::AddressPatternId( const AddressInternTable& table ) const
+{
+    return table.Find( *this );
+}
+
+
+} // namespace osc
+
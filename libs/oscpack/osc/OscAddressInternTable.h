@@ -0,0 +1,119 @@
+/*
+	oscpack -- Open Sound Control (OSC) packet manipulation library
+    http://www.rossbencina.com/code/oscpack
+
+    Copyright (c) 2004-2013 Ross Bencina <rossb@audiomulch.com>
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files
+	(the "Software"), to deal in the Software without restriction,
+	including without limitation the rights to use, copy, modify, merge,
+	publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so,
+	subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+	ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+	WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	The text above constitutes the entire oscpack license; however, 
+	the oscpack developer(s) also make the following non-binding requests:
+
+	Any person wishing to distribute modifications to the Software is
+	requested to send the modifications to the original developer so that
+	they can be incorporated into the canonical version. It is also 
+	requested that these non-binding requests be included whenever the
+	above license is reproduced.
+*/
+#ifndef INCLUDED_OSCPACK_OSCADDRESSINTERNTABLE_H
+#define INCLUDED_OSCPACK_OSCADDRESSINTERNTABLE_H
+
+#include <cstddef> // size_t
+#include <string>
+#include <vector>
+
+#include "OscTypes.h"
+
+
+namespace osc{
+
+class ReceivedMessage;
+
+static const uint32 INVALID_ADDRESS_ID = 0xFFFFFFFF;
+
+/*
+    AddressInternTable gives each distinct address pattern a stable id, so
+    that handlers and caches can key on an integer instead of comparing
+    strings. Ids are assigned in the order addresses are interned, starting
+    from 0, and are never reused.
+
+    Received messages are looked up using the hash computed while they were
+    parsed (ReceivedMessage::AddressPatternHash()), so a lookup costs one
+    probe and one string comparison:
+
+        osc::AddressInternTable addresses;
+        const osc::uint32 volumeId = addresses.Intern( "/master/volume" );
+        ...
+        if( m.AddressPatternId( addresses ) == volumeId )
+            ...
+
+    Lookups don't modify the table, so once it's populated it can be shared
+    between threads as long as nothing else is interned.
+*/
+
+class AddressInternTable{
+public:
+    AddressInternTable();
+
+    // return the id of addressPattern, adding it to the table if necessary
+    uint32 Intern( const char *addressPattern );
+    uint32 Intern( const ReceivedMessage& m );
+
+    // as above, where hash is HashAddressPattern( addressPattern )
+    uint32 Intern( const char *addressPattern, uint32 hash );
+
+    // return the id of addressPattern, or INVALID_ADDRESS_ID if it hasn't
+    // been interned
+    uint32 Find( const char *addressPattern ) const;
+    uint32 Find( const ReceivedMessage& m ) const;
+
+    // as above, where hash is HashAddressPattern( addressPattern )
+    uint32 Find( const char *addressPattern, uint32 hash ) const;
+
+    // remove every address. ids are reassigned from 0 afterwards.
+    void Clear();
+
+    uint32 Size() const { return static_cast<uint32>(addresses_.size()); }
+
+    // the address pattern with the given id. id must be less than Size()
+    const char *AddressPattern( uint32 id ) const { return addresses_[id].c_str(); }
+
+    // the hash of a '\0' terminated address pattern, equal to the
+    // ReceivedMessage::AddressPatternHash() of a message with that address
+    static uint32 HashAddressPattern( const char *addressPattern );
+
+private:
+    uint32 Add( const char *addressPattern, uint32 hash );
+    std::size_t FindSlot( const char *addressPattern, uint32 hash ) const;
+    void Grow();
+
+    std::vector<std::string> addresses_;
+    std::vector<uint32> hashes_;
+
+    // open addressing table of id + 1, 0 for empty slots. the size is a
+    // power of 2 and it is kept at most half full.
+    std::vector<uint32> slots_;
+};
+
+} // namespace osc
+
+#endif /* INCLUDED_OSCPACK_OSCADDRESSINTERNTABLE_H */
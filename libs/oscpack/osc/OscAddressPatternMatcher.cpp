@@ -0,0 +1,408 @@
+/*
+	oscpack -- Open Sound Control (OSC) packet manipulation library
+    http://www.rossbencina.com/code/oscpack
+
+    Copyright (c) 2004-2013 Ross Bencina <rossb@audiomulch.com>
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files
+	(the "Software"), to deal in the Software without restriction,
+	including without limitation the rights to use, copy, modify, merge,
+	publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so,
+	subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+	ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+	WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	The text above constitutes the entire oscpack license; however, 
+	the oscpack developer(s) also make the following non-binding requests:
+
+	Any person wishing to distribute modifications to the Software is
+	requested to send the modifications to the original developer so that
+	they can be incorporated into the canonical version. It is also 
+	requested that these non-binding requests be included whenever the
+	above license is reproduced.
+*/
+#include "OscAddressPatternMatcher.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "OscReceivedElements.h"
+
+
+namespace osc{
+
+namespace{
+
+// the end of the part of an address that starts at p: the next '/' or the
+// terminating '\0'
+inline const char *PartEnd( const char *p )
+{
+    while( *p != '/' && *p != '\0' )
+        ++p;
+    return p;
+}
+
+
+inline bool IsWildcard( char c )
+{
+    return c == '*' || c == '?' || c == '[' || c == '{';
+}
+
+
+// match one part of a pattern [p, pend) against one part of an address
+// [s, send). neither range contains '/'.
+bool MatchPart( const char *p, const char *pend, const char *s, const char *send )
+{
+    while( p != pend ){
+        switch( *p ){
+            case '?':
+                if( s == send )
+                    return false;
+                ++p;
+                ++s;
+                break;
+
+            case '*':
+                while( p != pend && *p == '*' )
+                    ++p;
+                if( p == pend )
+                    return true;
+                for(;;){
+                    if( MatchPart( p, pend, s, send ) )
+                        return true;
+                    if( s == send )
+                        return false;
+                    ++s;
+                }
+
+            case '[':
+                {
+                    if( s == send )
+                        return false;
+
+                    const char *q = p + 1;
+                    bool negate = false;
+                    if( q != pend && *q == '!' ){
+                        negate = true;
+                        ++q;
+                    }
+
+                    bool matched = false;
+                    unsigned char c = (unsigned char)*s;
+                    while( q != pend && *q != ']' ){
+                        if( pend - q > 2 && q[1] == '-' && q[2] != ']' ){
+                            if( c >= (unsigned char)q[0] && c <= (unsigned char)q[2] )
+                                matched = true;
+                            q += 3;
+                        }else{
+                            if( c == (unsigned char)*q )
+                                matched = true;
+                            ++q;
+                        }
+                    }
+
+                    if( q == pend || matched == negate )
+                        return false;
+
+                    p = q + 1;
+                    ++s;
+                }
+                break;
+
+            case '{':
+                {
+                    const char *close = p + 1;
+                    while( close != pend && *close != '}' )
+                        ++close;
+                    if( close == pend )
+                        return false;
+
+                    const char *alternative = p + 1;
+                    for(;;){
+                        const char *alternativeEnd = alternative;
+                        while( alternativeEnd != close && *alternativeEnd != ',' )
+                            ++alternativeEnd;
+
+                        std::size_t length = alternativeEnd - alternative;
+                        if( (std::size_t)(send - s) >= length
+                                && std::memcmp( alternative, s, length ) == 0
+                                && MatchPart( close + 1, pend, s + length, send ) )
+                            return true;
+
+                        if( alternativeEnd == close )
+                            return false;
+                        alternative = alternativeEnd + 1;
+                    }
+                }
+
+            default:
+                if( s == send || *p != *s )
+                    return false;
+                ++p;
+                ++s;
+                break;
+        }
+    }
+
+    return s == send;
+}
+
+
+// the character ranges of the set that starts at p ('['), merged so that
+// they don't overlap. returns false if the set can't be used to narrow
+// the search (it is negated or not terminated), in which case ranges is
+// empty.
+bool SetRanges( const char *p, const char *pend,
+        std::vector< std::pair<unsigned char, unsigned char> >& ranges )
+{
+    ranges.clear();
+
+    const char *q = p + 1;
+    if( q != pend && *q == '!' )
+        return false;
+
+    while( q != pend && *q != ']' ){
+        if( pend - q > 2 && q[1] == '-' && q[2] != ']' ){
+            // a reversed range matches nothing
+            if( (unsigned char)q[0] <= (unsigned char)q[2] )
+                ranges.push_back( std::make_pair( (unsigned char)q[0], (unsigned char)q[2] ) );
+            q += 3;
+        }else{
+            ranges.push_back( std::make_pair( (unsigned char)*q, (unsigned char)*q ) );
+            ++q;
+        }
+    }
+
+    if( q == pend ){
+        ranges.clear();
+        return false;
+    }
+
+    std::sort( ranges.begin(), ranges.end() );
+    std::size_t merged = 0;
+    for( std::size_t i=1; i < ranges.size(); ++i ){
+        if( ranges[i].first <= ranges[merged].second + 1 ){
+            ranges[merged].second = std::max( ranges[merged].second, ranges[i].second );
+        }else{
+            ranges[++merged] = ranges[i];
+        }
+    }
+    if( !ranges.empty() )
+        ranges.resize( merged + 1 );
+
+    return true;
+}
+
+
+inline bool HasPrefix( const std::string& s, const std::string& prefix )
+{
+    return s.compare( 0, prefix.size(), prefix ) == 0;
+}
+
+} // anonymous namespace
+
+
+AddressPatternMatcher::AddressPatternMatcher( std::size_t cacheCapacity )
+    : nodes_( 1 )
+    , cacheCapacity_( cacheCapacity )
+    , singleMatch_( 1 )
+{
+}
+
+
+uint32 AddressPatternMatcher::AddMethod( const char *address )
+{
+    uint32 count = methods_.Size();
+    uint32 id = methods_.Intern( address );
+    if( id < count )
+        return id;
+
+    // add a trie node for each part of the address that isn't already
+    // present. an address that begins with '/' starts with an empty part.
+    uint32 node = 0;
+    const char *p = address;
+    for(;;){
+        const char *end = PartEnd( p );
+        part_.assign( p, end );
+
+        std::map<std::string, uint32>::iterator i = nodes_[node].children.find( part_ );
+        if( i != nodes_[node].children.end() ){
+            node = i->second;
+        }else{
+            uint32 child = static_cast<uint32>(nodes_.size());
+            nodes_[node].children.insert( std::make_pair( part_, child ) );
+            nodes_.push_back( Node() );
+            node = child;
+        }
+
+        if( *end == '\0' )
+            break;
+        p = end + 1;
+    }
+    nodes_[node].method = id;
+
+    // cached results don't include the new method
+    cachedPatterns_.Clear();
+    cachedMatches_.clear();
+
+    return id;
+}
+
+
+const std::vector<uint32>& AddressPatternMatcher::Match( const ReceivedMessage& m )
+{
+    return Match( m.AddressPattern(), m.AddressPatternHash() );
+}
+
+
+const std::vector<uint32>& AddressPatternMatcher::Match( const char *pattern )
+{
+    return Match( pattern, AddressInternTable::HashAddressPattern( pattern ) );
+}
+
+
+const std::vector<uint32>& AddressPatternMatcher::Match( const char *pattern, uint32 hash )
+{
+    // method addresses can't contain wildcards, so an exact match is the
+    // only possible match
+    uint32 id = methods_.Find( pattern, hash );
+    if( id != INVALID_ADDRESS_ID ){
+        singleMatch_[0] = id;
+        return singleMatch_;
+    }
+
+    if( !HasWildcards( pattern ) )
+        return noMatch_;
+
+    if( cacheCapacity_ == 0 ){
+        MatchWildcards( pattern, uncachedMatches_ );
+        return uncachedMatches_;
+    }
+
+    uint32 cached = cachedPatterns_.Find( pattern, hash );
+    if( cached != INVALID_ADDRESS_ID )
+        return cachedMatches_[cached];
+
+    if( cachedPatterns_.Size() >= cacheCapacity_ ){
+        cachedPatterns_.Clear();
+        cachedMatches_.clear();
+    }
+
+    cachedPatterns_.Intern( pattern, hash );
+    cachedMatches_.push_back( std::vector<uint32>() );
+    MatchWildcards( pattern, cachedMatches_.back() );
+    return cachedMatches_.back();
+}
+
+
+void AddressPatternMatcher::MatchWildcards( const char *pattern, std::vector<uint32>& result )
+{
+    result.clear();
+
+    // the trie nodes matched by the parts of the pattern seen so far.
+    // each node is reached from only one parent so there are no duplicates.
+    states_.assign( 1, 0 );
+
+    const char *p = pattern;
+    for(;;){
+        const char *end = PartEnd( p );
+        nextStates_.clear();
+
+        if( std::find_if( p, end, IsWildcard ) == end ){
+            part_.assign( p, end );
+            for( std::size_t i=0; i < states_.size(); ++i ){
+                const std::map<std::string, uint32>& children = nodes_[ states_[i] ].children;
+                std::map<std::string, uint32>::const_iterator j = children.find( part_ );
+                if( j != children.end() )
+                    nextStates_.push_back( j->second );
+            }
+        }else{
+            // the part can only match the children that begin with its
+            // literal prefix, and if the prefix is followed by a set, with
+            // a character in one of the set's ranges. the children are
+            // sorted, so these are found with lower_bound().
+            const char *wildcard = std::find_if( p, end, IsWildcard );
+            part_.assign( p, wildcard );
+            bool hasSet = ( *wildcard == '[' && SetRanges( wildcard, end, setRanges_ ) );
+
+            for( std::size_t i=0; i < states_.size(); ++i ){
+                const std::map<std::string, uint32>& children = nodes_[ states_[i] ].children;
+
+                if( !hasSet ){
+                    for( std::map<std::string, uint32>::const_iterator j = children.lower_bound( part_ );
+                            j != children.end() && HasPrefix( j->first, part_ ); ++j ){
+                        const char *s = j->first.data();
+                        if( MatchPart( p, end, s, s + j->first.size() ) )
+                            nextStates_.push_back( j->second );
+                    }
+                    continue;
+                }
+
+                for( std::size_t k=0; k < setRanges_.size(); ++k ){
+                    key_ = part_;
+                    key_ += (char)setRanges_[k].first;
+                    for( std::map<std::string, uint32>::const_iterator j = children.lower_bound( key_ );
+                            j != children.end() && HasPrefix( j->first, part_ )
+                            && (unsigned char)j->first[ part_.size() ] <= setRanges_[k].second; ++j ){
+                        const char *s = j->first.data();
+                        if( MatchPart( p, end, s, s + j->first.size() ) )
+                            nextStates_.push_back( j->second );
+                    }
+                }
+            }
+        }
+
+        states_.swap( nextStates_ );
+        if( states_.empty() || *end == '\0' )
+            break;
+        p = end + 1;
+    }
+
+    for( std::size_t i=0; i < states_.size(); ++i ){
+        uint32 method = nodes_[ states_[i] ].method;
+        if( method != INVALID_ADDRESS_ID )
+            result.push_back( method );
+    }
+    std::sort( result.begin(), result.end() );
+}
+
+
+bool AddressPatternMatcher::PatternMatches( const char *pattern, const char *address )
+{
+    for(;;){
+        const char *patternEnd = PartEnd( pattern );
+        const char *addressEnd = PartEnd( address );
+
+        if( !MatchPart( pattern, patternEnd, address, addressEnd ) )
+            return false;
+
+        if( *patternEnd == '\0' || *addressEnd == '\0' )
+            return *patternEnd == *addressEnd;
+
+        pattern = patternEnd + 1;
+        address = addressEnd + 1;
+    }
+}
+
+
+bool AddressPatternMatcher::HasWildcards( const char *pattern )
+{
+    return std::strpbrk( pattern, "*?[{" ) != 0;
+}
+
+
+} // namespace osc
+
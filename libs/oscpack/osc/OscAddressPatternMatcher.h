@@ -0,0 +1,147 @@
+/*
+	oscpack -- Open Sound Control (OSC) packet manipulation library
+    http://www.rossbencina.com/code/oscpack
+
+    Copyright (c) 2004-2013 Ross Bencina <rossb@audiomulch.com>
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files
+	(the "Software"), to deal in the Software without restriction,
+	including without limitation the rights to use, copy, modify, merge,
+	publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so,
+	subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+	ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+	WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	The text above constitutes the entire oscpack license; however, 
+	the oscpack developer(s) also make the following non-binding requests:
+
+	Any person wishing to distribute modifications to the Software is
+	requested to send the modifications to the original developer so that
+	they can be incorporated into the canonical version. It is also 
+	requested that these non-binding requests be included whenever the
+	above license is reproduced.
+*/
+#ifndef INCLUDED_OSCPACK_OSCADDRESSPATTERNMATCHER_H
+#define INCLUDED_OSCPACK_OSCADDRESSPATTERNMATCHER_H
+
+#include <cstddef> // size_t
+#include <map>
+#include <string>
+#include <vector>
+
+#include "OscTypes.h"
+#include "OscAddressInternTable.h"
+
+
+namespace osc{
+
+class ReceivedMessage;
+
+/*
+    AddressPatternMatcher matches the address pattern of an incoming message
+    against a set of method addresses, supporting the OSC 1.0 wildcards:
+
+        ?           any single character
+        *           any sequence of zero or more characters
+        [abc] [a-z] any character in the set, or not in it if the set
+                    begins with '!'
+        {foo,bar}   any of the comma separated strings
+
+    Wildcards never match '/', so each part of the pattern only matches the
+    corresponding part of a method address.
+
+    Method addresses are compiled into a trie with one level per address
+    part, with the children of each node sorted. A pattern is matched by
+    walking the trie one part at a time, keeping the set of nodes that are
+    still matched. A part without wildcards is a lookup in each node. A
+    part with wildcards is tested against the children of each node that
+    begin with its literal prefix, narrowed by a '[...]' set that follows
+    the prefix. Its cost is the number of children in those ranges, not
+    the number it matches: with tracks 1 to 512, a track part of "*" tests
+    all 512 tracks, "[12]" the 222 that begin with 1 or 2, and "4[01]" the
+    22 that begin with 40 or 41.
+    Patterns without wildcards are looked up directly using the hash
+    computed when the message was parsed, and the results for recently
+    seen wildcard patterns are cached:
+
+        osc::AddressPatternMatcher matcher;
+        matcher.AddMethod( "/track/1/mute" );
+        matcher.AddMethod( "/track/2/mute" );
+        ...
+        const std::vector<osc::uint32>& methods = matcher.Match( m );
+        for( std::size_t i=0; i < methods.size(); ++i )
+            ... methods[i] is 0 or 1 for "/track/{1,2}/mute" ...
+
+    Not thread safe: Match() updates the cache.
+*/
+
+class AddressPatternMatcher{
+public:
+    // cacheCapacity is the number of distinct wildcard patterns whose
+    // results are kept. when it is exceeded the cache is emptied. 0
+    // disables caching.
+    explicit AddressPatternMatcher( std::size_t cacheCapacity = 256 );
+
+    // add a method and return its id. ids are assigned in order starting
+    // from 0. adding an address that is already present returns its
+    // existing id.
+    uint32 AddMethod( const char *address );
+
+    uint32 MethodCount() const { return methods_.Size(); }
+
+    const char *MethodAddress( uint32 id ) const { return methods_.AddressPattern( id ); }
+
+    // the ids of the methods matched by a pattern, in ascending order. the
+    // result remains valid until the next call to Match() or AddMethod().
+    // malformed patterns (an unterminated '[' or '{') match nothing.
+    const std::vector<uint32>& Match( const ReceivedMessage& m );
+    const std::vector<uint32>& Match( const char *pattern );
+
+    // true if the '\0' terminated pattern matches address
+    static bool PatternMatches( const char *pattern, const char *address );
+
+    // true if pattern contains any of the wildcard characters above
+    static bool HasWildcards( const char *pattern );
+
+private:
+    const std::vector<uint32>& Match( const char *pattern, uint32 hash );
+    void MatchWildcards( const char *pattern, std::vector<uint32>& result );
+
+    struct Node{
+        Node() : method( INVALID_ADDRESS_ID ) {}
+
+        // children keyed by the next part of the address
+        std::map<std::string, uint32> children;
+        uint32 method;
+    };
+
+    AddressInternTable methods_;
+    std::vector<Node> nodes_;
+
+    std::size_t cacheCapacity_;
+    AddressInternTable cachedPatterns_;
+    std::vector< std::vector<uint32> > cachedMatches_;
+
+    // scratch space used by Match()
+    std::vector<uint32> states_, nextStates_;
+    std::string part_, key_;
+    std::vector< std::pair<unsigned char, unsigned char> > setRanges_;
+    std::vector<uint32> singleMatch_, noMatch_, uncachedMatches_;
+};
+
+} // namespace osc
+
+#endif /* INCLUDED_OSCPACK_OSCADDRESSPATTERNMATCHER_H */
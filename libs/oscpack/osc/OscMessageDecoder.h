@@ -0,0 +1,273 @@
+/*
+	oscpack -- Open Sound Control (OSC) packet manipulation library
+    http://www.rossbencina.com/code/oscpack
+
+    Copyright (c) 2004-2013 Ross Bencina <rossb@audiomulch.com>
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files
+	(the "Software"), to deal in the Software without restriction,
+	including without limitation the rights to use, copy, modify, merge,
+	publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so,
+	subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+	ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+	WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	The text above constitutes the entire oscpack license; however, 
+	the oscpack developer(s) also make the following non-binding requests:
+
+	Any person wishing to distribute modifications to the Software is
+	requested to send the modifications to the original developer so that
+	they can be incorporated into the canonical version. It is also 
+	requested that these non-binding requests be included whenever the
+	above license is reproduced.
+*/
+#ifndef INCLUDED_OSCPACK_OSCMESSAGEDECODER_H
+#define INCLUDED_OSCPACK_OSCMESSAGEDECODER_H
+
+#include <cstddef> // size_t
+#include <cstring> // memcmp, memcpy
+#include <tuple>
+
+#include "OscTypes.h"
+#include "OscReceivedElements.h"
+
+/*
+    Typed decoding of received messages whose argument types are known at
+    compile time (requires C++11).
+
+    The expected type tag string is built at compile time from the argument
+    types. It is compared with the received type tags using a single memcmp,
+    and the arguments are then decoded directly from the offsets recorded by
+    ReceivedMessage, without any per-argument type checks:
+
+        float volume;
+        if( osc::TryDecode( m, volume ) )
+            ...
+
+        std::tuple<osc::int32, const char*> t = osc::Decode<osc::int32, const char*>( m );
+
+    Supported argument types are int32, float, char, RgbaColor, MidiMessage,
+    int64, TimeTag, double, const char* (string), Symbol, Blob, NilType and
+    InfinitumType. bool is not supported because it is encoded as one of two
+    type tags ('T' or 'F'); use the argument iterator for messages with bools.
+    Arrays are not supported.
+*/
+
+namespace osc{
+
+namespace detail{
+
+inline uint32 ReadBigEndianUInt32( const char *p )
+{
+    const unsigned char *u = reinterpret_cast<const unsigned char*>(p);
+    return ((uint32)u[0] << 24) | ((uint32)u[1] << 16) | ((uint32)u[2] << 8) | (uint32)u[3];
+}
+
+inline uint64 ReadBigEndianUInt64( const char *p )
+{
+    return ((uint64)ReadBigEndianUInt32( p ) << 32) | (uint64)ReadBigEndianUInt32( p + 4 );
+}
+
+} // namespace detail
+
+
+// ArgumentTraits<T> maps a C++ argument type to its OSC type tag and decodes
+// it from the argument data without checking the type tag.
+
+template< typename T >
+struct ArgumentTraits; // unsupported argument type
+
+template<>
+struct ArgumentTraits< int32 >{
+    static const char TYPE_TAG = INT32_TYPE_TAG;
+    static int32 Decode( const char *p ) { return (int32)detail::ReadBigEndianUInt32( p ); }
+};
+
+template<>
+struct ArgumentTraits< float >{
+    static const char TYPE_TAG = FLOAT_TYPE_TAG;
+    static float Decode( const char *p )
+    {
+        uint32 u = detail::ReadBigEndianUInt32( p );
+        float result;
+        std::memcpy( &result, &u, 4 );
+        return result;
+    }
+};
+
+template<>
+struct ArgumentTraits< char >{
+    static const char TYPE_TAG = CHAR_TYPE_TAG;
+    static char Decode( const char *p ) { return (char)detail::ReadBigEndianUInt32( p ); }
+};
+
+template<>
+struct ArgumentTraits< RgbaColor >{
+    static const char TYPE_TAG = RGBA_COLOR_TYPE_TAG;
+    static RgbaColor Decode( const char *p ) { return RgbaColor( detail::ReadBigEndianUInt32( p ) ); }
+};
+
+template<>
+struct ArgumentTraits< MidiMessage >{
+    static const char TYPE_TAG = MIDI_MESSAGE_TYPE_TAG;
+    static MidiMessage Decode( const char *p ) { return MidiMessage( detail::ReadBigEndianUInt32( p ) ); }
+};
+
+template<>
+struct ArgumentTraits< int64 >{
+    static const char TYPE_TAG = INT64_TYPE_TAG;
+    static int64 Decode( const char *p ) { return (int64)detail::ReadBigEndianUInt64( p ); }
+};
+
+template<>
+struct ArgumentTraits< TimeTag >{
+    static const char TYPE_TAG = TIME_TAG_TYPE_TAG;
+    static TimeTag Decode( const char *p ) { return TimeTag( detail::ReadBigEndianUInt64( p ) ); }
+};
+
+template<>
+struct ArgumentTraits< double >{
+    static const char TYPE_TAG = DOUBLE_TYPE_TAG;
+    static double Decode( const char *p )
+    {
+        uint64 u = detail::ReadBigEndianUInt64( p );
+        double result;
+        std::memcpy( &result, &u, 8 );
+        return result;
+    }
+};
+
+template<>
+struct ArgumentTraits< const char* >{
+    static const char TYPE_TAG = STRING_TYPE_TAG;
+    static const char *Decode( const char *p ) { return p; }
+};
+
+template<>
+struct ArgumentTraits< Symbol >{
+    static const char TYPE_TAG = SYMBOL_TYPE_TAG;
+    static Symbol Decode( const char *p ) { return Symbol( p ); }
+};
+
+template<>
+struct ArgumentTraits< Blob >{
+    static const char TYPE_TAG = BLOB_TYPE_TAG;
+    static Blob Decode( const char *p )
+    {
+        return Blob( p + OSC_SIZEOF_INT32, (osc_bundle_element_size_t)detail::ReadBigEndianUInt32( p ) );
+    }
+};
+
+template<>
+struct ArgumentTraits< NilType >{
+    static const char TYPE_TAG = NIL_TYPE_TAG;
+    static NilType Decode( const char * ) { return NilType(); }
+};
+
+template<>
+struct ArgumentTraits< InfinitumType >{
+    static const char TYPE_TAG = INFINITUM_TYPE_TAG;
+    static InfinitumType Decode( const char * ) { return InfinitumType(); }
+};
+
+
+// the '\0' terminated type tag string for a list of argument types,
+// e.g. TypeTagString<int32, float>::value is "if"
+template< typename... Args >
+struct TypeTagString{
+    static constexpr char value[] = { ArgumentTraits<Args>::TYPE_TAG..., '\0' };
+};
+
+template< typename... Args >
+constexpr char TypeTagString<Args...>::value[];
+
+
+namespace detail{
+
+template< std::size_t... I >
+struct IndexSequence{};
+
+template< std::size_t N, std::size_t... I >
+struct MakeIndexSequence : MakeIndexSequence< N - 1, N - 1, I... >{};
+
+template< std::size_t... I >
+struct MakeIndexSequence< 0, I... >{
+    typedef IndexSequence< I... > type;
+};
+
+template< typename... Args >
+inline bool TypeTagsMatch( const ReceivedMessage& m )
+{
+    return m.ArgumentCount() == sizeof...(Args)
+            && ( sizeof...(Args) == 0
+                || std::memcmp( m.TypeTags(), TypeTagString<Args...>::value, sizeof...(Args) ) == 0 );
+}
+
+template< typename... Args, std::size_t... I >
+inline void DecodeArguments( const ReceivedMessage& m, IndexSequence<I...>, Args&... args )
+{
+    int expand[] = { 0, ( args = ArgumentTraits<Args>::Decode( m.ArgumentDataUnchecked( I ) ), 0 )... };
+    (void) expand;
+    (void) m;
+}
+
+template< typename... Args, std::size_t... I >
+inline void DecodeArguments( const ReceivedMessage& m, IndexSequence<I...> indices, std::tuple<Args...>& result )
+{
+    DecodeArguments( m, indices, std::get<I>( result )... );
+}
+
+} // namespace detail
+
+
+// If the type tags of m are exactly those of Args, decode the arguments into
+// args and return true. Otherwise leave args unchanged and return false.
+template< typename... Args >
+inline bool TryDecode( const ReceivedMessage& m, Args&... args )
+{
+    if( !detail::TypeTagsMatch<Args...>( m ) )
+        return false;
+
+    detail::DecodeArguments( m, typename detail::MakeIndexSequence< sizeof...(Args) >::type(), args... );
+    return true;
+}
+
+
+// Decode the arguments of m into a tuple.
+// Throws MissingArgumentException or ExcessArgumentException if m has too
+// few or too many arguments, and WrongArgumentTypeException if the type tags
+// don't match Args.
+template< typename... Args >
+inline std::tuple<Args...> Decode( const ReceivedMessage& m )
+{
+    std::tuple<Args...> result;
+
+    if( !detail::TypeTagsMatch<Args...>( m ) ){
+        if( m.ArgumentCount() < sizeof...(Args) )
+            throw MissingArgumentException();
+        else if( m.ArgumentCount() > sizeof...(Args) )
+            throw ExcessArgumentException();
+        else
+            throw WrongArgumentTypeException();
+    }
+
+    detail::DecodeArguments( m, typename detail::MakeIndexSequence< sizeof...(Args) >::type(), result );
+    return result;
+}
+
+} // namespace osc
+
+#endif /* INCLUDED_OSCPACK_OSCMESSAGEDECODER_H */
@@ -0,0 +1,125 @@
+/*
+	oscpack -- Open Sound Control (OSC) packet manipulation library
+    http://www.rossbencina.com/code/oscpack
+
+    Copyright (c) 2004-2013 Ross Bencina <rossb@audiomulch.com>
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files
+	(the "Software"), to deal in the Software without restriction,
+	including without limitation the rights to use, copy, modify, merge,
+	publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so,
+	subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+	ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+	WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	The text above constitutes the entire oscpack license; however, 
+	the oscpack developer(s) also make the following non-binding requests:
+
+	Any person wishing to distribute modifications to the Software is
+	requested to send the modifications to the original developer so that
+	they can be incorporated into the canonical version. It is also 
+	requested that these non-binding requests be included whenever the
+	above license is reproduced.
+*/
+#include "OscMessageTemplate.h"
+
+
+namespace osc{
+
+MessageTemplate::MessageTemplate()
+    : inBundle_( false )
+{
+}
+
+
+MessageTemplate::MessageTemplate( const char *addressPattern, const char *typeTags, bool inBundle )
+    : typeTags_( typeTags )
+    , inBundle_( inBundle )
+{
+    // encode the message with zero arguments using OutboundPacketStream so
+    // that the packet is exactly what it would produce
+    GrowableOutboundPacketStream p( 256 );
+
+    if( inBundle )
+        p << BeginBundleImmediate;
+
+    p << BeginMessage( addressPattern );
+    for( std::size_t i=0; i < typeTags_.size(); ++i ){
+        switch( typeTags_[i] ){
+            case INT32_TYPE_TAG: p << (int32)0; break;
+            case FLOAT_TYPE_TAG: p << 0.f; break;
+            case CHAR_TYPE_TAG: p << (char)0; break;
+            case RGBA_COLOR_TYPE_TAG: p << RgbaColor( 0 ); break;
+            case MIDI_MESSAGE_TYPE_TAG: p << MidiMessage( 0 ); break;
+            case INT64_TYPE_TAG: p << (int64)0; break;
+            case TIME_TAG_TYPE_TAG: p << TimeTag( 0 ); break;
+            case DOUBLE_TYPE_TAG: p << 0.; break;
+            case TRUE_TYPE_TAG:
+            case FALSE_TYPE_TAG:
+                typeTags_[i] = FALSE_TYPE_TAG;
+                p << false;
+                break;
+            case NIL_TYPE_TAG: p << OscNil; break;
+            case INFINITUM_TYPE_TAG: p << Infinitum; break;
+            case ARRAY_BEGIN_TYPE_TAG: p << BeginArray; break;
+            case ARRAY_END_TYPE_TAG: p << EndArray; break;
+            default:
+                throw WrongArgumentTypeException( "argument type can't be used in a message template" );
+        }
+    }
+    p << EndMessage;
+
+    if( inBundle )
+        p << EndBundle;
+
+    data_.assign( p.Data(), p.Data() + p.Size() );
+
+    // find the arguments. a bundle adds its 16 byte header and the
+    // message's size slot.
+    std::size_t typeTagsOffset = ( inBundle ? 20 : 0 )
+            + ((std::strlen( addressPattern ) + 4) & ~((std::size_t)0x03));
+    std::size_t argumentOffset = typeTagsOffset
+            + ((typeTags_.size() + 2 + 3) & ~((std::size_t)0x03));
+
+    offsets_.resize( typeTags_.size() );
+    for( std::size_t i=0; i < typeTags_.size(); ++i ){
+        switch( typeTags_[i] ){
+            case INT32_TYPE_TAG:
+            case FLOAT_TYPE_TAG:
+            case CHAR_TYPE_TAG:
+            case RGBA_COLOR_TYPE_TAG:
+            case MIDI_MESSAGE_TYPE_TAG:
+                offsets_[i] = static_cast<uint32>(argumentOffset);
+                argumentOffset += 4;
+                break;
+            case INT64_TYPE_TAG:
+            case TIME_TAG_TYPE_TAG:
+            case DOUBLE_TYPE_TAG:
+                offsets_[i] = static_cast<uint32>(argumentOffset);
+                argumentOffset += 8;
+                break;
+            case FALSE_TYPE_TAG:
+                offsets_[i] = static_cast<uint32>(typeTagsOffset + 1 + i); // after ','
+                break;
+            default:
+                offsets_[i] = static_cast<uint32>(argumentOffset);
+                break;
+        }
+    }
+}
+
+} // namespace osc
+
@@ -0,0 +1,179 @@
+/*
+	oscpack -- Open Sound Control (OSC) packet manipulation library
+    http://www.rossbencina.com/code/oscpack
+
+    Copyright (c) 2004-2013 Ross Bencina <rossb@audiomulch.com>
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files
+	(the "Software"), to deal in the Software without restriction,
+	including without limitation the rights to use, copy, modify, merge,
+	publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so,
+	subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+	ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+	WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	The text above constitutes the entire oscpack license; however, 
+	the oscpack developer(s) also make the following non-binding requests:
+
+	Any person wishing to distribute modifications to the Software is
+	requested to send the modifications to the original developer so that
+	they can be incorporated into the canonical version. It is also 
+	requested that these non-binding requests be included whenever the
+	above license is reproduced.
+*/
+#ifndef INCLUDED_OSCPACK_OSCMESSAGETEMPLATE_H
+#define INCLUDED_OSCPACK_OSCMESSAGETEMPLATE_H
+
+#include <cstddef> // size_t
+#include <cstring> // memcpy
+#include <string>
+#include <vector>
+
+#include "OscTypes.h"
+#include "OscReceivedElements.h" // exceptions
+#include "OscOutboundPacketStream.h"
+
+
+namespace osc{
+
+/*
+    MessageTemplate holds a message that is sent repeatedly with the same
+    address and type tags but different argument values. The address, type
+    tags and padding are encoded once, and each argument is a slot that is
+    written in place in network byte order, so updating and re-sending a
+    message costs a few stores:
+
+        osc::MessageTemplate volume( "/track/1/volume", "f" );
+        ...
+        volume.SetFloat( 0, 0.75f );
+        socket.Send( volume.Data(), volume.Size() );
+
+    The message can optionally be wrapped in a bundle, whose time tag is
+    patched in the same way with SetBundleTimeTag().
+
+    Only arguments with a fixed size can be patched: int32, float, char,
+    RgbaColor, MidiMessage, int64, TimeTag and double ("ifcrmhtd"). Bool
+    arguments ('T' or 'F') are patched by rewriting their type tag. Nil,
+    infinitum and array markers are allowed but have nothing to set.
+
+    The encoded packet is identical to the one OutboundPacketStream would
+    produce for the same message. Arguments are initially zero (or false).
+*/
+
+class MessageTemplate{
+public:
+    // an empty template, with no data
+    MessageTemplate();
+
+    // throws WrongArgumentTypeException if typeTags contains a type that
+    // can't be patched
+    MessageTemplate( const char *addressPattern, const char *typeTags, bool inBundle=false );
+
+    // the encoded packet: the message, or the bundle containing it
+    const char *Data() const { return data_.empty() ? 0 : &data_[0]; }
+    std::size_t Size() const { return data_.size(); }
+
+    bool IsInBundle() const { return inBundle_; }
+
+    // the number of type tags, including array markers
+    std::size_t ArgumentCount() const { return typeTags_.size(); }
+
+    // argument setters. index is the position of the argument's type tag.
+    // throws MissingArgumentException if index is out of range and
+    // WrongArgumentTypeException if the argument has a different type.
+    void SetInt32( std::size_t index, int32 value ) { StoreUInt32( Slot( index, INT32_TYPE_TAG ), (uint32)value ); }
+    void SetFloat( std::size_t index, float value );
+    void SetChar( std::size_t index, char value ) { StoreUInt32( Slot( index, CHAR_TYPE_TAG ), (uint32)(int32)value ); }
+    void SetRgbaColor( std::size_t index, uint32 value ) { StoreUInt32( Slot( index, RGBA_COLOR_TYPE_TAG ), value ); }
+    void SetMidiMessage( std::size_t index, uint32 value ) { StoreUInt32( Slot( index, MIDI_MESSAGE_TYPE_TAG ), value ); }
+    void SetInt64( std::size_t index, int64 value ) { StoreUInt64( Slot( index, INT64_TYPE_TAG ), (uint64)value ); }
+    void SetTimeTag( std::size_t index, uint64 value ) { StoreUInt64( Slot( index, TIME_TAG_TYPE_TAG ), value ); }
+    void SetDouble( std::size_t index, double value );
+    void SetBool( std::size_t index, bool value );
+
+    // the time tag of the enclosing bundle. throws BundleNotInProgressException
+    // if the template isn't in a bundle.
+    void SetBundleTimeTag( uint64 timeTag )
+    {
+        if( !inBundle_ )
+            throw BundleNotInProgressException( "message template is not in a bundle" );
+        StoreUInt64( &data_[8], timeTag ); // after "#bundle\0"
+    }
+
+private:
+    char *Slot( std::size_t index, char typeTag )
+    {
+        if( index >= typeTags_.size() )
+            throw MissingArgumentException();
+        if( typeTags_[index] != typeTag )
+            throw WrongArgumentTypeException();
+        return &data_[ offsets_[index] ];
+    }
+
+    static void StoreUInt32( char *p, uint32 x )
+    {
+        p[0] = (char)(x >> 24);
+        p[1] = (char)(x >> 16);
+        p[2] = (char)(x >> 8);
+        p[3] = (char)x;
+    }
+
+    static void StoreUInt64( char *p, uint64 x )
+    {
+        StoreUInt32( p, (uint32)(x >> 32) );
+        StoreUInt32( p + 4, (uint32)x );
+    }
+
+    std::vector<char> data_;
+    std::string typeTags_;
+
+    // offset in data_ of each argument, or of the type tag for bools
+    std::vector<uint32> offsets_;
+
+    bool inBundle_;
+};
+
+
+inline void MessageTemplate::SetFloat( std::size_t index, float value )
+{
+    uint32 bits;
+    std::memcpy( &bits, &value, 4 );
+    StoreUInt32( Slot( index, FLOAT_TYPE_TAG ), bits );
+}
+
+
+inline void MessageTemplate::SetDouble( std::size_t index, double value )
+{
+    uint64 bits;
+    std::memcpy( &bits, &value, 8 );
+    StoreUInt64( Slot( index, DOUBLE_TYPE_TAG ), bits );
+}
+
+
+inline void MessageTemplate::SetBool( std::size_t index, bool value )
+{
+    if( index >= typeTags_.size() )
+        throw MissingArgumentException();
+    if( typeTags_[index] != TRUE_TYPE_TAG && typeTags_[index] != FALSE_TYPE_TAG )
+        throw WrongArgumentTypeException();
+
+    typeTags_[index] = value ? TRUE_TYPE_TAG : FALSE_TYPE_TAG;
+    data_[ offsets_[index] ] = typeTags_[index];
+}
+
+} // namespace osc
+
+#endif /* INCLUDED_OSCPACK_OSCMESSAGETEMPLATE_H */
@@ -160,6 +160,7 @@ OutboundPacketStream::OutboundPacketStream( char *buffer, std::size_t capacity )
     , argumentCurrent_( data_ )
     , elementSizePtr_( 0 )
     , messageIsInProgress_( false )
+    , typeTagsAreEncoded_( false )
 {
     // sanity check integer types declared in OscTypes.h 
     // you'll need to fix OscTypes.h if any of these asserts fail
@@ -219,6 +220,12 @@ void OutboundPacketStream::EndElement( char *endPtr )
         // assert( d >= 4 && d <= 0x7FFFFFFF ); // assume packets smaller than 2Gb
 
         uint32 elementSize = static_cast<uint32>(d - 4);
+
+        // plus any external blobs in the element, which are always its last
+        // external blobs
+        if( !externalBlobs_.empty() )
+            elementSize += static_cast<uint32>( ExternalBlobsSizeFrom(
+                    (reinterpret_cast<char*>(elementSizePtr_) + 4) - data_ ) );
         FromUInt32( reinterpret_cast<char*>(elementSizePtr_), elementSize );
 
         // finally, we reset the element size ptr to the containing element
@@ -233,34 +240,81 @@ bool OutboundPacketStream::ElementSizeSlotRequired() const
 }
 
 
+std::size_t OutboundPacketStream::ExternalBlobsSizeFrom( std::size_t offset ) const
+{
+    std::size_t result = 0;
+    for( std::vector<ExternalBlobReference>::const_reverse_iterator i = externalBlobs_.rbegin();
+            i != externalBlobs_.rend() && i->offset >= offset; ++i )
+        result += i->size;
+    return result;
+}
+
+
 void OutboundPacketStream::CheckForAvailableBundleSpace()
 {
     std::size_t required = Size() + ((ElementSizeSlotRequired())?4:0) + 16;
 
     if( required > Capacity() )
-        throw OutOfBufferMemoryException();
+        Grow( required );
 }
 
 
-void OutboundPacketStream::CheckForAvailableMessageSpace( const char *addressPattern )
+void OutboundPacketStream::CheckForAvailableMessageSpace( std::size_t headerSize )
 {
-    // plus 4 for at least four bytes of type tag
-    std::size_t required = Size() + ((ElementSizeSlotRequired())?4:0)
-            + RoundUp4(std::strlen(addressPattern) + 1) + 4;
+    // headerSize is the padded address plus at least four bytes of type tag
+    std::size_t required = Size() + ((ElementSizeSlotRequired())?4:0) + headerSize;
 
     if( required > Capacity() )
-        throw OutOfBufferMemoryException();
+        Grow( required );
 }
 
 
 void OutboundPacketStream::CheckForAvailableArgumentSpace( std::size_t argumentLength )
 {
-    // plus three for extra type tag, comma and null terminator
-    std::size_t required = (argumentCurrent_ - data_) + argumentLength
-            + RoundUp4( (end_ - typeTagsCurrent_) + 3 );
+    // plus three for extra type tag, comma and null terminator. if the type
+    // tags are already encoded they only need to be recorded.
+    std::size_t typeTagsSpace = typeTagsAreEncoded_
+            ? (end_ - typeTagsCurrent_) + 1
+            : RoundUp4( (end_ - typeTagsCurrent_) + 3 );
+    std::size_t required = (argumentCurrent_ - data_) + argumentLength + typeTagsSpace;
 
     if( required > Capacity() )
-        throw OutOfBufferMemoryException();
+        Grow( required );
+}
+
+
+void OutboundPacketStream::Grow( std::size_t requiredCapacity )
+{
+    (void) requiredCapacity;
+    throw OutOfBufferMemoryException();
+}
+
+
+void OutboundPacketStream::SetBuffer( char *buffer, std::size_t capacity )
+{
+    // the packet so far is at the start of the buffer, and the type tags of
+    // the message in progress are at the end, in reverse order
+    std::size_t used = argumentCurrent_ - data_;
+    std::size_t typeTagsCount = end_ - typeTagsCurrent_;
+    assert( used + typeTagsCount <= capacity );
+
+    char *end = buffer + capacity;
+    if( used )
+        std::memcpy( buffer, data_, used );
+    if( typeTagsCount )
+        std::memcpy( end - typeTagsCount, typeTagsCurrent_, typeTagsCount );
+
+    // element size slots hold offsets from data_ so only the pointer to
+    // the innermost one needs to be moved
+    if( elementSizePtr_ != 0 )
+        elementSizePtr_ = reinterpret_cast<uint32*>(buffer + (reinterpret_cast<char*>(elementSizePtr_) - data_));
+
+    messageCursor_ = buffer + (messageCursor_ - data_);
+    argumentCurrent_ = buffer + used;
+    typeTagsCurrent_ = end - typeTagsCount;
+
+    data_ = buffer;
+    end_ = end;
 }
 
 
@@ -271,6 +325,8 @@ void OutboundPacketStream::Clear()
     argumentCurrent_ = data_;
     elementSizePtr_ = 0;
     messageIsInProgress_ = false;
+    typeTagsAreEncoded_ = false;
+    externalBlobs_.clear();
 }
 
 
@@ -283,7 +339,7 @@ std::size_t OutboundPacketStream::Capacity() const
 std::size_t OutboundPacketStream::Size() const
 {
     std::size_t result = argumentCurrent_ - data_;
-    if( IsMessageInProgress() ){
+    if( IsMessageInProgress() && !typeTagsAreEncoded_ ){
         // account for the length of the type tag string. the total type tag
         // includes an initial comma, plus at least one terminating \0
         result += RoundUp4( (end_ - typeTagsCurrent_) + 2 );
@@ -299,6 +355,27 @@ const char *OutboundPacketStream::Data() const
 }
 
 
+std::size_t OutboundPacketStream::PacketSize() const
+{
+    return Size() + ExternalBlobsSizeFrom( 0 );
+}
+
+
+void OutboundPacketStream::GetIoVectors( IoVector *vectors ) const
+{
+    assert( IsReady() );
+
+    std::size_t offset = 0;
+    for( std::vector<ExternalBlobReference>::const_iterator i = externalBlobs_.begin();
+            i != externalBlobs_.end(); ++i ){
+        *vectors++ = IoVector( data_ + offset, i->offset - offset );
+        *vectors++ = IoVector( i->data, i->size );
+        offset = i->offset;
+    }
+    *vectors = IoVector( data_ + offset, (argumentCurrent_ - data_) - offset );
+}
+
+
 bool OutboundPacketStream::IsReady() const
 {
     return (!IsMessageInProgress() && !IsBundleInProgress());
@@ -356,7 +433,7 @@ OutboundPacketStream& OutboundPacketStream::operator<<( const BeginMessage& rhs
     if( IsMessageInProgress() )
         throw MessageInProgressException();
 
-    CheckForAvailableMessageSpace( rhs.addressPattern );
+    CheckForAvailableMessageSpace( RoundUp4(std::strlen(rhs.addressPattern) + 1) + 4 );
 
     messageCursor_ = BeginElement( messageCursor_ );
 
@@ -380,6 +457,30 @@ OutboundPacketStream& OutboundPacketStream::operator<<( const BeginMessage& rhs
 }
 
 
+OutboundPacketStream& OutboundPacketStream::operator<<( const BeginEncodedMessage& rhs )
+{
+    if( IsMessageInProgress() )
+        throw MessageInProgressException();
+
+    bool hasTypeTags = ( rhs.size > rhs.addressSize );
+    CheckForAvailableMessageSpace( hasTypeTags ? rhs.size : rhs.addressSize + 4 );
+
+    messageCursor_ = BeginElement( messageCursor_ );
+
+    std::memcpy( messageCursor_, rhs.data, rhs.size );
+
+    // messageCursor_ is left at the type tags, as for BeginMessage
+    messageCursor_ += rhs.addressSize;
+    argumentCurrent_ = messageCursor_ + (rhs.size - rhs.addressSize);
+    typeTagsCurrent_ = end_;
+
+    messageIsInProgress_ = true;
+    typeTagsAreEncoded_ = hasTypeTags;
+
+    return *this;
+}
+
+
 OutboundPacketStream& OutboundPacketStream::operator<<( const MessageTerminator& rhs )
 {
     (void) rhs;
@@ -389,7 +490,24 @@ OutboundPacketStream& OutboundPacketStream::operator<<( const MessageTerminator&
 
     std::size_t typeTagsCount = end_ - typeTagsCurrent_;
 
-    if( typeTagsCount ){
+    if( typeTagsAreEncoded_ ){
+        // the encoded type tags are ",tags\0", the recorded ones are in
+        // reverse order
+        const char *encoded = messageCursor_ + 1;
+        for( std::size_t i=0; i < typeTagsCount; ++i ){
+            if( encoded[i] != typeTagsCurrent_[ (typeTagsCount-1) - i ] )
+                throw MessageTypeTagsMismatchException();
+        }
+        if( encoded[typeTagsCount] != '\0' )
+            throw MessageTypeTagsMismatchException();
+
+        typeTagsCurrent_ = end_;
+        typeTagsAreEncoded_ = false;
+
+        // advance messageCursor_ for next message
+        messageCursor_ = argumentCurrent_;
+
+    }else if( typeTagsCount ){
 
         char *tempTypeTags = (char*)alloca(typeTagsCount);
         std::memcpy( tempTypeTags, typeTagsCurrent_, typeTagsCount );
@@ -401,6 +519,12 @@ OutboundPacketStream& OutboundPacketStream::operator<<( const MessageTerminator&
 
         std::memmove( messageCursor_ + typeTagSlotSize, messageCursor_, argumentsSize );
 
+        // external blobs in the arguments move with them
+        std::size_t argumentsOffset = messageCursor_ - data_;
+        for( std::vector<ExternalBlobReference>::reverse_iterator i = externalBlobs_.rbegin();
+                i != externalBlobs_.rend() && i->offset >= argumentsOffset; ++i )
+            i->offset += typeTagSlotSize;
+
         messageCursor_[0] = ',';
         // copy type tags in reverse (really forward) order
         for( std::size_t i=0; i < typeTagsCount; ++i )
@@ -658,6 +782,42 @@ OutboundPacketStream& OutboundPacketStream::operator<<( const Blob& rhs )
     return *this;
 }
 
+OutboundPacketStream& OutboundPacketStream::operator<<( const ExternalBlob& rhs )
+{
+    // the whole words of the blob are referenced. the last 0-3 bytes are
+    // copied with the padding, which keeps the buffer 4-byte aligned for
+    // the element size slots.
+    std::size_t referencedSize = rhs.size & ~((std::size_t)0x03);
+    std::size_t copiedSize = rhs.size - referencedSize;
+    CheckForAvailableArgumentSpace( 4 + RoundUp4(copiedSize) );
+
+    *(--typeTagsCurrent_) = BLOB_TYPE_TAG;
+    FromUInt32( argumentCurrent_, rhs.size );
+    argumentCurrent_ += 4;
+
+    if( referencedSize > 0 ){
+        ExternalBlobReference r;
+        r.offset = argumentCurrent_ - data_;
+        r.data = rhs.data;
+        r.size = referencedSize;
+        externalBlobs_.push_back( r );
+    }
+
+    if( copiedSize > 0 ){
+        std::memcpy( argumentCurrent_, static_cast<const char*>(rhs.data) + referencedSize, copiedSize );
+        argumentCurrent_ += copiedSize;
+
+        // zero pad to 4-byte boundary
+        while( copiedSize & 0x3 ){
+            *argumentCurrent_++ = '\0';
+            ++copiedSize;
+        }
+    }
+
+    return *this;
+}
+
+
 OutboundPacketStream& OutboundPacketStream::operator<<( const ArrayInitiator& rhs )
 {
     (void) rhs;
@@ -678,6 +838,47 @@ OutboundPacketStream& OutboundPacketStream::operator<<( const ArrayTerminator& r
     return *this;
 }
 
+
+GrowableOutboundPacketStream::GrowableOutboundPacketStream(
+        std::size_t initialCapacity, std::size_t chunkSize )
+    : OutboundPacketStream( 0, 0 )
+    , buffer_( 0 )
+    , chunkSize_( ( chunkSize < 4 ) ? 4 : RoundUp4( chunkSize ) )
+{
+    Reserve( initialCapacity );
+}
+
+
+GrowableOutboundPacketStream::~GrowableOutboundPacketStream()
+{
+    delete [] buffer_;
+}
+
+
+void GrowableOutboundPacketStream::Reserve( std::size_t capacity )
+{
+    if( capacity <= Capacity() )
+        return;
+
+    char *buffer = new char[capacity];
+    SetBuffer( buffer, capacity );
+
+    delete [] buffer_;
+    buffer_ = buffer;
+}
+
+
+void GrowableOutboundPacketStream::Grow( std::size_t requiredCapacity )
+{
+    // at least double the capacity so that building a large packet only
+    // copies it a few times
+    std::size_t capacity = Capacity() * 2;
+    if( capacity < requiredCapacity )
+        capacity = requiredCapacity;
+
+    Reserve( ((capacity + chunkSize_ - 1) / chunkSize_) * chunkSize_ );
+}
+
 } // namespace osc
 
 
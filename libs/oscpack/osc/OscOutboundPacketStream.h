@@ -38,9 +38,11 @@
 #define INCLUDED_OSCPACK_OSCOUTBOUNDPACKETSTREAM_H
 
 #include <cstring> // size_t
+#include <vector>
 
 #include "OscTypes.h"
 #include "OscException.h"
+#include "../ip/IoVector.h"
 
 
 namespace osc{
@@ -73,10 +75,33 @@ public:
 };
 
 
+class MessageTypeTagsMismatchException : public Exception{
+public:
+    MessageTypeTagsMismatchException(
+            const char *w="message arguments don't match its pre-encoded type tags" )
+        : Exception( w ) {}
+};
+
+
+// Begins a message whose address, and optionally type tags, have already
+// been encoded, with padding, into size bytes at data. The first
+// addressSize bytes are the address. If size > addressSize the rest are the
+// type tag string, and the arguments streamed before EndMessage must match
+// it. Normally created from a StaticAddress or StaticMessageHeader (see
+// OscStaticAddress.h) rather than directly.
+struct BeginEncodedMessage{
+    BeginEncodedMessage( const char *data_, std::size_t addressSize_, std::size_t size_ )
+        : data( data_ ), addressSize( addressSize_ ), size( size_ ) {}
+    const char *data;
+    std::size_t addressSize;
+    std::size_t size;
+};
+
+
 class OutboundPacketStream{
 public:
 	OutboundPacketStream( char *buffer, std::size_t capacity );
-	~OutboundPacketStream();
+	virtual ~OutboundPacketStream();
 
     void Clear();
 
@@ -87,6 +112,24 @@ public:
 
     const char *Data() const;
 
+    // ExternalBlob arguments are referenced rather than copied into the
+    // buffer, so once a packet contains any, Data() and Size() only cover
+    // the stream's own bytes. PacketSize() includes the external blobs, and
+    // GetIoVectors() fills IoVectorCount() vectors that describe the whole
+    // packet, for sending with UdpSocket::SendV() or SendToV():
+    //
+    //    p << osc::BeginBundle( t ) << osc::BeginMessage( "/meters" )
+    //        << osc::ExternalBlob( frame, frameSize ) << osc::EndMessage << osc::EndBundle;
+    //    std::vector<IoVector> v( p.IoVectorCount() );
+    //    p.GetIoVectors( &v[0] );
+    //    socket.SendV( &v[0], v.size() );
+    //
+    // only call GetIoVectors() when the stream IsReady().
+    bool HasExternalBlobs() const { return !externalBlobs_.empty(); }
+    std::size_t PacketSize() const;
+    std::size_t IoVectorCount() const { return externalBlobs_.size() * 2 + 1; }
+    void GetIoVectors( IoVector *vectors ) const;
+
     // indicates that all messages have been closed with a matching EndMessage
     // and all bundles have been closed with a matching EndBundle
     bool IsReady() const;
@@ -98,6 +141,7 @@ public:
     OutboundPacketStream& operator<<( const BundleTerminator& rhs );
     
     OutboundPacketStream& operator<<( const BeginMessage& rhs );
+    OutboundPacketStream& operator<<( const BeginEncodedMessage& rhs );
     OutboundPacketStream& operator<<( const MessageTerminator& rhs );
 
     OutboundPacketStream& operator<<( bool rhs );
@@ -120,10 +164,23 @@ public:
     OutboundPacketStream& operator<<( const char* rhs );
     OutboundPacketStream& operator<<( const Symbol& rhs );
     OutboundPacketStream& operator<<( const Blob& rhs );
+    OutboundPacketStream& operator<<( const ExternalBlob& rhs );
 
     OutboundPacketStream& operator<<( const ArrayInitiator& rhs );
     OutboundPacketStream& operator<<( const ArrayTerminator& rhs );
 
+protected:
+    // called when an element doesn't fit in the buffer. derived classes can
+    // move the stream to a buffer of at least requiredCapacity bytes by
+    // calling SetBuffer(). the default throws OutOfBufferMemoryException.
+    virtual void Grow( std::size_t requiredCapacity );
+
+    // copy the contents of the stream, including any message in progress,
+    // to buffer and continue writing there. capacity must be at least Size()
+    // plus the type tags of the message in progress; in practice, at least
+    // Capacity(). the old buffer is no longer referenced.
+    void SetBuffer( char *buffer, std::size_t capacity );
+
 private:
 
     char *BeginElement( char *beginPtr );
@@ -131,9 +188,11 @@ private:
 
     bool ElementSizeSlotRequired() const;
     void CheckForAvailableBundleSpace();
-    void CheckForAvailableMessageSpace( const char *addressPattern );
+    void CheckForAvailableMessageSpace( std::size_t headerSize );
     void CheckForAvailableArgumentSpace( std::size_t argumentLength );
 
+    std::size_t ExternalBlobsSizeFrom( std::size_t offset ) const;
+
     char *data_;
     char *end_;
 
@@ -147,6 +206,58 @@ private:
     uint32 *elementSizePtr_;
 
     bool messageIsInProgress_;
+
+    // true if the type tags of the message in progress were written by
+    // BeginEncodedMessage. they are still recorded at the end of the buffer
+    // as arguments are added, and checked by EndMessage.
+    bool typeTagsAreEncoded_;
+
+    // the referenced parts of the external blobs, in order. offset is where
+    // the data belongs in the buffer (after the blob's size, before its
+    // copied tail and padding), relative to data_.
+    struct ExternalBlobReference{
+        std::size_t offset;
+        const void *data;
+        std::size_t size;
+    };
+    std::vector<ExternalBlobReference> externalBlobs_;
+};
+
+
+/*
+    An OutboundPacketStream that owns its buffer and grows it, to at least
+    twice its size and in multiples of chunkSize bytes, instead of throwing
+    OutOfBufferMemoryException. The
+    buffer is kept by Clear(), so a stream that is reused for packets of a
+    similar size stops allocating once it has grown to fit them:
+
+        osc::GrowableOutboundPacketStream p; // reuse between packets
+        ...
+        p.Clear();
+        p << osc::BeginBundleImmediate << ... << osc::EndBundle;
+        socket.Send( p.Data(), p.Size() );
+
+    The packets produced are identical to those of OutboundPacketStream.
+    Data() may change whenever the stream grows.
+*/
+
+class GrowableOutboundPacketStream : public OutboundPacketStream{
+public:
+    explicit GrowableOutboundPacketStream( std::size_t initialCapacity=1024, std::size_t chunkSize=1024 );
+    virtual ~GrowableOutboundPacketStream();
+
+    // make sure the buffer is at least capacity bytes
+    void Reserve( std::size_t capacity );
+
+protected:
+    virtual void Grow( std::size_t requiredCapacity );
+
+private:
+    GrowableOutboundPacketStream( const GrowableOutboundPacketStream& ); // not copyable
+    GrowableOutboundPacketStream& operator=( const GrowableOutboundPacketStream& );
+
+    char *buffer_;
+    std::size_t chunkSize_;
 };
 
 } // namespace osc
@@ -0,0 +1,227 @@
+/*
+	oscpack -- Open Sound Control (OSC) packet manipulation library
+    http://www.rossbencina.com/code/oscpack
+
+    Copyright (c) 2004-2013 Ross Bencina <rossb@audiomulch.com>
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files
+	(the "Software"), to deal in the Software without restriction,
+	including without limitation the rights to use, copy, modify, merge,
+	publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so,
+	subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+	ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+	WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	The text above constitutes the entire oscpack license; however, 
+	the oscpack developer(s) also make the following non-binding requests:
+
+	Any person wishing to distribute modifications to the Software is
+	requested to send the modifications to the original developer so that
+	they can be incorporated into the canonical version. It is also 
+	requested that these non-binding requests be included whenever the
+	above license is reproduced.
+*/
+#include "OscReceivedBatch.h"
+
+
+namespace osc{
+
+
+static inline uint32 ToUInt32( const char *p )
+{
+    const unsigned char *u = reinterpret_cast<const unsigned char*>(p);
+    return ((uint32)u[0] << 24) | ((uint32)u[1] << 16) | ((uint32)u[2] << 8) | (uint32)u[3];
+}
+
+
+static inline uint64 ToUInt64( const char *p )
+{
+    return ((uint64)ToUInt32( p ) << 32) | (uint64)ToUInt32( p + 4 );
+}
+
+
+ReceivedBatch::ReceivedBatch()
+    : data_( 0 )
+{
+}
+
+
+void ReceivedBatch::Clear()
+{
+    data_ = 0;
+    addressOffsets_.Resize( 0 );
+    addressLengths_.Resize( 0 );
+    typeTagsOffsets_.Resize( 0 );
+    argumentsBegin_.Resize( 0 );
+    timeTags_.Resize( 0 );
+    argumentOffsets_.Resize( 0 );
+    frames_.clear();
+}
+
+
+ParseError ReceivedBatch::DecodeMessage( const char *message, osc_bundle_element_size_t size, uint64 timeTag )
+{
+    detail::MessageLayout layout;
+    ParseError error = detail::ScanMessageHeader( message, size, layout );
+    if( error != PARSE_OK )
+        return error;
+
+    uint32 argumentCount = 0;
+    uint32 typeTagsOffset = 0;
+
+    if( layout.typeTagsBegin != 0 ){
+        // there is at most one type tag per byte of the packet, so the
+        // space reserved by Decode() is enough for MaxArgumentCount()
+        uint32 *offsets = argumentOffsets_.End();
+
+        error = detail::ScanMessageArguments( layout, offsets );
+        if( error != PARSE_OK )
+            return error;
+
+        argumentCount = static_cast<uint32>(layout.typeTagsEnd - layout.typeTagsBegin);
+        argumentOffsets_.Resize( argumentOffsets_.Size() + argumentCount );
+
+        // make the offsets relative to data_ rather than to the message's arguments
+        uint32 argumentsOffset = static_cast<uint32>(layout.arguments - data_);
+        for( uint32 i = 0; i < argumentCount; ++i )
+            offsets[i] += argumentsOffset;
+
+        typeTagsOffset = static_cast<uint32>(layout.typeTagsBegin - data_);
+    }
+
+    // the address pattern is followed by 1 to 4 zero bytes, which are the
+    // only zero bytes in its last 4-byte word. counting them rather than
+    // scanning back avoids a data dependent branch. a leading zero is a
+    // SuperCollider integer address, which we report as empty.
+    const char *addressEnd = layout.addressEnd;
+    if( message[0] == '\0' ){
+        addressEnd = message;
+    }else{
+        const char *w = addressEnd - 4;
+        addressEnd -= (w[0] == '\0') + (w[1] == '\0') + (w[2] == '\0') + (w[3] == '\0');
+    }
+
+    addressOffsets_.Append( static_cast<uint32>(message - data_) );
+    addressLengths_.Append( static_cast<uint32>(addressEnd - message) );
+    typeTagsOffsets_.Append( typeTagsOffset );
+    argumentsBegin_.Append( argumentsBegin_.Back() + argumentCount );
+    timeTags_.Append( timeTag );
+
+    return PARSE_OK;
+}
+
+
+ParseError ReceivedBatch::Decode( const char *data, std::size_t size )
+{
+    ReceivedPacket packet;
+    ParseError error = ReceivedPacket::TryParse( data, size, packet );
+    if( error != PARSE_OK ){
+        Clear();
+        return error;
+    }
+
+    return Decode( packet );
+}
+
+
+ParseError ReceivedBatch::Decode( const ReceivedPacket& packet )
+{
+    Clear();
+
+    data_ = packet.Contents();
+
+    // a message takes at least 4 bytes and each bundle element at least 8,
+    // so a packet can't hold more than size / 4 messages. there is at most
+    // one argument per byte of type tags.
+    std::size_t size = static_cast<std::size_t>(packet.Size());
+    std::size_t maxMessageCount = size / 4;
+    addressOffsets_.Reset( maxMessageCount );
+    addressLengths_.Reset( maxMessageCount );
+    typeTagsOffsets_.Reset( maxMessageCount );
+    argumentsBegin_.Reset( maxMessageCount + 1 );
+    timeTags_.Reset( maxMessageCount );
+    argumentOffsets_.Reset( size );
+
+    argumentsBegin_.Append( 0 );
+
+    ParseError error;
+
+    if( packet.IsMessage() ){
+        error = DecodeMessage( data_, packet.Size(), 1 );
+
+    }else{
+        error = detail::ScanBundleHeader( data_, packet.Size() );
+
+        if( error == PARSE_OK ){
+            Frame outer = { data_ + packet.Size(), ToUInt64( data_ + 8 ) };
+            frames_.push_back( outer );
+        }
+
+        // walk the elements of the bundle and any nested bundles using an
+        // explicit stack, so deeply nested packets can't overflow the call stack.
+        const char *p = data_ + 16;
+
+        while( error == PARSE_OK && !frames_.empty() ){
+            const Frame& frame = frames_.back();
+
+            if( p == frame.end ){
+                frames_.pop_back();
+                continue;
+            }
+
+            if( frame.end - p < osc::OSC_SIZEOF_INT32 ){
+                error = PARSE_BUNDLE_TOO_SHORT_FOR_ELEMENT_SIZE;
+                break;
+            }
+
+            // treat element size as an unsigned int for the purposes of this calculation
+            uint32 elementSize = ToUInt32( p );
+            if( (elementSize & ((uint32)0x03)) != 0 ){
+                error = PARSE_BUNDLE_ELEMENT_SIZE_NOT_MULTIPLE_OF_4;
+                break;
+            }
+
+            p += osc::OSC_SIZEOF_INT32;
+            if( elementSize > (uint32)(frame.end - p) ){
+                error = PARSE_BUNDLE_TOO_SHORT_FOR_ELEMENT;
+                break;
+            }
+
+            const char *element = p;
+
+            if( elementSize > 0 && element[0] == '#' ){
+                error = detail::ScanBundleHeader( element, (osc_bundle_element_size_t)elementSize );
+                if( error == PARSE_OK ){
+                    Frame nested = { element + elementSize, ToUInt64( element + 8 ) };
+                    frames_.push_back( nested ); // invalidates frame
+                    p = element + 16;
+                }
+            }else{
+                error = DecodeMessage( element, (osc_bundle_element_size_t)elementSize, frame.timeTag );
+                p = element + elementSize;
+            }
+        }
+    }
+
+    if( error != PARSE_OK )
+        Clear();
+
+    return error;
+}
+
+
+} // namespace osc
+
@@ -0,0 +1,191 @@
+/*
+	oscpack -- Open Sound Control (OSC) packet manipulation library
+    http://www.rossbencina.com/code/oscpack
+
+    Copyright (c) 2004-2013 Ross Bencina <rossb@audiomulch.com>
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files
+	(the "Software"), to deal in the Software without restriction,
+	including without limitation the rights to use, copy, modify, merge,
+	publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so,
+	subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+	ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+	WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	The text above constitutes the entire oscpack license; however, 
+	the oscpack developer(s) also make the following non-binding requests:
+
+	Any person wishing to distribute modifications to the Software is
+	requested to send the modifications to the original developer so that
+	they can be incorporated into the canonical version. It is also 
+	requested that these non-binding requests be included whenever the
+	above license is reproduced.
+*/
+#ifndef INCLUDED_OSCPACK_OSCRECEIVEDBATCH_H
+#define INCLUDED_OSCPACK_OSCRECEIVEDBATCH_H
+
+#include <cstddef> // size_t
+#include <vector>
+
+#include "OscTypes.h"
+#include "OscReceivedElements.h"
+
+
+namespace osc{
+
+/*
+    ReceivedBatch decodes every message in a packet, including the messages
+    in nested bundles, in a single pass over the data. The result is stored
+    as a structure of arrays indexed by message number, so a consumer can
+    loop over all the messages in a datagram without constructing a
+    ReceivedBundle or ReceivedMessage for each element:
+
+        osc::ReceivedBatch batch; // reuse between packets
+        if( batch.Decode( data, size ) == osc::PARSE_OK ){
+            for( osc::uint32 i=0; i < batch.MessageCount(); ++i )
+                ... batch.AddressPattern( i ), batch.TimeTags()[i] ...
+        }
+
+    Messages are validated exactly as ReceivedMessage does. All offsets are
+    relative to Data(), which must remain valid while the batch is in use.
+    Storage is reused between calls to Decode(), so once the batch has seen
+    a packet of a given shape decoding doesn't allocate.
+*/
+
+class ReceivedBatch{
+public:
+    ReceivedBatch();
+
+    // decode data, discarding any previous contents. returns PARSE_OK on
+    // success, otherwise an error code and the batch is left empty.
+    ParseError Decode( const char *data, std::size_t size );
+    ParseError Decode( const ReceivedPacket& packet );
+
+    void Clear();
+
+    const char *Data() const { return data_; }
+
+    uint32 MessageCount() const { return static_cast<uint32>(addressOffsets_.Size()); }
+
+    // per-message arrays, each with MessageCount() entries
+
+    // offset and length (excluding the terminator) of the address pattern
+    const uint32 *AddressOffsets() const { return addressOffsets_.Begin(); }
+    const uint32 *AddressLengths() const { return addressLengths_.Begin(); }
+
+    // offset of the first type tag (after the ','), or 0 if the message
+    // has no type tags. offset 0 is always an address so can't be a type tag.
+    const uint32 *TypeTagsOffsets() const { return typeTagsOffsets_.Begin(); }
+
+    // index of the message's first entry in ArgumentOffsets(). this array
+    // has MessageCount() + 1 entries so that message i's arguments are
+    // ArgumentsBegin()[i] to ArgumentsBegin()[i + 1]
+    const uint32 *ArgumentsBegin() const { return argumentsBegin_.Begin(); }
+
+    // time tag of the innermost bundle containing the message, or 1
+    // (immediately) for a packet that is a single message
+    const uint64 *TimeTags() const { return timeTags_.Begin(); }
+
+    // offset of the data for each argument of all messages, in order.
+    // one entry per type tag, including array begin and end markers.
+    const uint32 *ArgumentOffsets() const { return argumentOffsets_.Begin(); }
+    uint32 TotalArgumentCount() const { return static_cast<uint32>(argumentOffsets_.Size()); }
+
+    // convenience accessors for a single message
+
+    const char *AddressPattern( uint32 i ) const { return data_ + addressOffsets_[i]; }
+
+    const char *TypeTags( uint32 i ) const
+    {
+        return ( typeTagsOffsets_[i] == 0 ) ? 0 : data_ + typeTagsOffsets_[i];
+    }
+
+    uint32 ArgumentCount( uint32 i ) const { return argumentsBegin_[i + 1] - argumentsBegin_[i]; }
+
+    // the j-th argument of the i-th message. doesn't check that i and j are in range.
+    ReceivedMessageArgument ArgumentAt( uint32 i, uint32 j ) const
+    {
+        return ReceivedMessageArgument( data_ + typeTagsOffsets_[i] + j,
+                data_ + argumentOffsets_[ argumentsBegin_[i] + j ] );
+    }
+
+private:
+    ReceivedBatch( const ReceivedBatch& ); // not copyable
+    ReceivedBatch& operator=( const ReceivedBatch& );
+
+    ParseError DecodeMessage( const char *message, osc_bundle_element_size_t size, uint64 timeTag );
+
+    // storage for one of the arrays above. Decode() reserves room for the
+    // largest number of entries the packet could produce before it starts,
+    // so appending doesn't need a capacity check and reserving doesn't
+    // touch the memory.
+    template< typename T >
+    class Column{
+    public:
+        Column() : data_( 0 ), size_( 0 ), capacity_( 0 ) {}
+        ~Column() { delete [] data_; }
+
+        // discard existing entries and make room for at least capacity entries
+        void Reset( std::size_t capacity )
+        {
+            size_ = 0;
+            if( capacity > capacity_ ){
+                delete [] data_;
+                data_ = new T[ capacity ];
+                capacity_ = capacity;
+            }
+        }
+
+        void Append( T value ) { data_[size_++] = value; }
+        T *End() { return data_ + size_; }
+        void Resize( std::size_t size ) { size_ = size; }
+
+        std::size_t Size() const { return size_; }
+        const T *Begin() const { return data_; }
+        const T& operator[]( std::size_t i ) const { return data_[i]; }
+        const T& Back() const { return data_[size_ - 1]; }
+
+    private:
+        Column( const Column& );
+        Column& operator=( const Column& );
+
+        T *data_;
+        std::size_t size_;
+        std::size_t capacity_;
+    };
+
+    // an enclosing bundle while decoding nested bundles
+    struct Frame{
+        const char *end;
+        uint64 timeTag;
+    };
+
+    const char *data_;
+
+    Column<uint32> addressOffsets_;
+    Column<uint32> addressLengths_;
+    Column<uint32> typeTagsOffsets_;
+    Column<uint32> argumentsBegin_;
+    Column<uint64> timeTags_;
+    Column<uint32> argumentOffsets_;
+
+    std::vector<Frame> frames_;
+};
+
+} // namespace osc
+
+
+#endif /* INCLUDED_OSCPACK_OSCRECEIVEDBATCH_H */
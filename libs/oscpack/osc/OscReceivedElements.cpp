@@ -37,6 +37,7 @@
 #include "OscReceivedElements.h"
 
 #include "OscHostEndianness.h"
+#include "OscSimd.h"
 
 #include <cstddef> // ptrdiff_t
 
@@ -60,27 +61,9 @@ static inline const char* FindStr4End( const char *p )
 }
 
 
-// return the first 4 byte boundary after the end of a str4
-// returns 0 if p == end or if the string is unterminated
-static inline const char* FindStr4End( const char *p, const char *end )
-{
-    if( p >= end )
-        return 0;
-
-	if( p[0] == '\0' )    // special case for SuperCollider integer address pattern
-		return p + 4;
-
-    p += 3;
-    end -= 1;
-
-    while( p < end && *p )
-        p += 4;
-
-    if( *p )
-        return 0;
-    else
-        return p + 1;
-}
+// the bounded version FindStr4End( p, end ), which returns 0 if p == end or
+// if the string is unterminated or incorrectly padded, is declared in
+// OscSimd.h and dispatches to a vectorized implementation where available.
 
 
 // round up to the next highest multiple of 4. unless x is already a multiple of 4
@@ -179,6 +162,54 @@ static inline uint64 ToUInt64( const char *p )
 
 //------------------------------------------------------------------------------
 
+const char *ParseErrorString( ParseError error )
+{
+    switch( error ){
+        case PARSE_OK: return "no error";
+
+        case PARSE_INVALID_PACKET_SIZE: return "invalid packet size";
+        case PARSE_ZERO_LENGTH_ELEMENT: return "zero length elements not permitted";
+        case PARSE_ELEMENT_SIZE_NOT_MULTIPLE_OF_4: return "element size must be multiple of four";
+
+        case PARSE_INVALID_MESSAGE_SIZE: return "invalid message size";
+        case PARSE_ZERO_LENGTH_MESSAGE: return "zero length messages not permitted";
+        case PARSE_MESSAGE_SIZE_NOT_MULTIPLE_OF_4: return "message size must be multiple of four";
+        case PARSE_UNTERMINATED_ADDRESS_PATTERN: return "unterminated address pattern";
+        case PARSE_TYPE_TAGS_NOT_PRESENT: return "type tags not present";
+        case PARSE_UNTERMINATED_TYPE_TAGS: return "type tags were not terminated before end of message";
+        case PARSE_ARGUMENTS_EXCEED_MESSAGE_SIZE: return "arguments exceed message size";
+        case PARSE_UNTERMINATED_STRING_ARGUMENT: return "unterminated string argument";
+        case PARSE_UNKNOWN_TYPE_TAG: return "unknown type tag";
+        case PARSE_UNTERMINATED_ARRAY: return "array was not terminated before end of message (expected ']' end of array tag)";
+
+        case PARSE_INVALID_BUNDLE_SIZE: return "invalid bundle size";
+        case PARSE_BUNDLE_TOO_SHORT: return "packet too short for bundle";
+        case PARSE_BUNDLE_SIZE_NOT_MULTIPLE_OF_4: return "bundle size must be multiple of four";
+        case PARSE_BAD_BUNDLE_ADDRESS_PATTERN: return "bad bundle address pattern";
+        case PARSE_BUNDLE_TOO_SHORT_FOR_ELEMENT_SIZE: return "packet too short for elementSize";
+        case PARSE_BUNDLE_ELEMENT_SIZE_NOT_MULTIPLE_OF_4: return "bundle element size must be multiple of four";
+        case PARSE_BUNDLE_TOO_SHORT_FOR_ELEMENT: return "packet too short for bundle element";
+        case PARSE_BUNDLE_CONTENTS: return "bundle contents ";
+    }
+
+    return "unknown parse error";
+}
+
+
+void ThrowParseError( ParseError error )
+{
+    assert( error != PARSE_OK );
+
+    if( error < PARSE_INVALID_MESSAGE_SIZE )
+        throw MalformedPacketException( ParseErrorString( error ) );
+    else if( error < PARSE_INVALID_BUNDLE_SIZE )
+        throw MalformedMessageException( ParseErrorString( error ) );
+    else
+        throw MalformedBundleException( ParseErrorString( error ) );
+}
+
+//------------------------------------------------------------------------------
+
 bool ReceivedPacket::IsBundle() const
 {
     return (Size() > 0 && Contents()[0] == '#');
@@ -482,6 +513,56 @@ std::size_t ReceivedMessageArgument::ComputeArrayItemCount() const
     return result;
 }
 
+
+std::size_t ReceivedMessageArgument::HomogeneousArrayItemCount( char typeTag ) const
+{
+    if( !IsArrayBegin() )
+        throw WrongArgumentTypeException();
+
+    // ReceivedMessage::Init has already checked that the array is closed
+    // and that the data for all its items is present.
+    const char *p = typeTagPtr_ + 1;
+    while( *p == typeTag )
+        ++p;
+
+    if( *p != ARRAY_END_TYPE_TAG )
+        throw WrongArgumentTypeException();
+
+    return static_cast<std::size_t>(p - (typeTagPtr_ + 1));
+}
+
+
+std::size_t ReceivedMessageArgument::AsInt32Array( int32 *buffer, std::size_t capacity ) const
+{
+    std::size_t count = HomogeneousArrayItemCount( INT32_TYPE_TAG );
+    CopyBigEndian32( buffer, argumentPtr_, (count < capacity) ? count : capacity );
+    return count;
+}
+
+
+std::size_t ReceivedMessageArgument::AsFloatArray( float *buffer, std::size_t capacity ) const
+{
+    std::size_t count = HomogeneousArrayItemCount( FLOAT_TYPE_TAG );
+    CopyBigEndian32( buffer, argumentPtr_, (count < capacity) ? count : capacity );
+    return count;
+}
+
+
+std::size_t ReceivedMessageArgument::AsInt64Array( int64 *buffer, std::size_t capacity ) const
+{
+    std::size_t count = HomogeneousArrayItemCount( INT64_TYPE_TAG );
+    CopyBigEndian64( buffer, argumentPtr_, (count < capacity) ? count : capacity );
+    return count;
+}
+
+
+std::size_t ReceivedMessageArgument::AsDoubleArray( double *buffer, std::size_t capacity ) const
+{
+    std::size_t count = HomogeneousArrayItemCount( DOUBLE_TYPE_TAG );
+    CopyBigEndian64( buffer, argumentPtr_, (count < capacity) ? count : capacity );
+    return count;
+}
+
 //------------------------------------------------------------------------------
 
 void ReceivedMessageArgumentIterator::Advance()
@@ -556,17 +637,84 @@ void ReceivedMessageArgumentIterator::Advance()
 
 //------------------------------------------------------------------------------
 
+ReceivedMessage::ArgumentIndex::ArgumentIndex( const ArgumentIndex& rhs )
+    : offsets_( inlineOffsets_ )
+    , size_( 0 )
+{
+    *this = rhs;
+}
+
+
+ReceivedMessage::ArgumentIndex& ReceivedMessage::ArgumentIndex::operator=( const ArgumentIndex& rhs )
+{
+    if( this != &rhs ){
+        Reset( rhs.size_ );
+        std::memcpy( offsets_, rhs.offsets_, rhs.size_ * sizeof(uint32) );
+        size_ = rhs.size_;
+    }
+
+    return *this;
+}
+
+
+void ReceivedMessage::ArgumentIndex::Reset( std::size_t capacity )
+{
+    if( offsets_ != inlineOffsets_ ){
+        delete [] offsets_;
+        offsets_ = inlineOffsets_;
+    }
+
+    if( capacity > INLINE_CAPACITY )
+        offsets_ = new uint32[ capacity ];
+
+    size_ = 0;
+}
+
+//------------------------------------------------------------------------------
+
 ReceivedMessage::ReceivedMessage( const ReceivedPacket& packet )
-    : addressPattern_( packet.Contents() )
 {
-    Init( packet.Contents(), packet.Size() );
+    ParseError error = Init( packet.Contents(), packet.Size() );
+    if( error != PARSE_OK )
+        ThrowParseError( error );
 }
 
 
 ReceivedMessage::ReceivedMessage( const ReceivedBundleElement& bundleElement )
-    : addressPattern_( bundleElement.Contents() )
 {
-    Init( bundleElement.Contents(), bundleElement.Size() );
+    ParseError error = Init( bundleElement.Contents(), bundleElement.Size() );
+    if( error != PARSE_OK )
+        ThrowParseError( error );
+}
+
+
+ReceivedMessage::ReceivedMessage()
+    : addressPattern_( 0 )
+    , addressHash_( 0 )
+    , typeTagsBegin_( 0 )
+    , typeTagsEnd_( 0 )
+    , arguments_( 0 )
+{
+}
+
+
+ParseError ReceivedMessage::TryParse( const ReceivedPacket& packet, ReceivedMessage& result )
+{
+    ParseError error = result.Init( packet.Contents(), packet.Size() );
+    if( error != PARSE_OK )
+        result = ReceivedMessage();
+
+    return error;
+}
+
+
+ParseError ReceivedMessage::TryParse( const ReceivedBundleElement& bundleElement, ReceivedMessage& result )
+{
+    ParseError error = result.Init( bundleElement.Contents(), bundleElement.Size() );
+    if( error != PARSE_OK )
+        result = ReceivedMessage();
+
+    return error;
 }
 
 
@@ -582,182 +730,273 @@ uint32 ReceivedMessage::AddressPatternAsUInt32() const
 }
 
 
-void ReceivedMessage::Init( const char *message, osc_bundle_element_size_t size )
+namespace detail{
+
+ParseError ScanMessageHeader( const char *message, osc_bundle_element_size_t size, MessageLayout& layout )
 {
     if( !IsValidElementSizeValue(size) )
-        throw MalformedMessageException( "invalid message size" );
+        return PARSE_INVALID_MESSAGE_SIZE;
 
     if( size == 0 )
-        throw MalformedMessageException( "zero length messages not permitted" );
+        return PARSE_ZERO_LENGTH_MESSAGE;
 
     if( !IsMultipleOf4(size) )
-        throw MalformedMessageException( "message size must be multiple of four" );
+        return PARSE_MESSAGE_SIZE_NOT_MULTIPLE_OF_4;
 
     const char *end = message + size;
+    layout.end = end;
+    layout.typeTagsEnd = 0;
 
-    typeTagsBegin_ = FindStr4End( addressPattern_, end );
-    if( typeTagsBegin_ == 0 ){
+    const char *typeTags = FindStr4EndHash( message, end, &layout.addressHash );
+    if( typeTags == 0 ){
         // address pattern was not terminated before end
-        throw MalformedMessageException( "unterminated address pattern" );
+        return PARSE_UNTERMINATED_ADDRESS_PATTERN;
     }
 
-    if( typeTagsBegin_ == end ){
+    layout.addressEnd = typeTags;
+
+    if( typeTags == end ){
         // message consists of only the address pattern - no arguments or type tags.
-        typeTagsBegin_ = 0;
-        typeTagsEnd_ = 0;
-        arguments_ = 0;
+        layout.typeTagsBegin = 0;
+        layout.arguments = 0;
             
     }else{
-        if( *typeTagsBegin_ != ',' )
-            throw MalformedMessageException( "type tags not present" );
+        if( *typeTags != ',' )
+            return PARSE_TYPE_TAGS_NOT_PRESENT;
 
-        if( *(typeTagsBegin_ + 1) == '\0' ){
+        if( *(typeTags + 1) == '\0' ){
             // zero length type tags
-            typeTagsBegin_ = 0;
-            typeTagsEnd_ = 0;
-            arguments_ = 0;
+            layout.typeTagsBegin = 0;
+            layout.arguments = 0;
 
         }else{
-            // check that all arguments are present and well formed
-                
-            arguments_ = FindStr4End( typeTagsBegin_, end );
-            if( arguments_ == 0 ){
-                throw MalformedMessageException( "type tags were not terminated before end of message" );
+            layout.arguments = FindStr4End( typeTags, end );
+            if( layout.arguments == 0 ){
+                // type tags were not terminated before end of message
+                return PARSE_UNTERMINATED_TYPE_TAGS;
             }
 
-            ++typeTagsBegin_; // advance past initial ','
+            layout.typeTagsBegin = typeTags + 1; // advance past initial ','
+        }
+    }
+
+    return PARSE_OK;
+}
+
+
+ParseError ScanMessageArguments( MessageLayout& layout, uint32 *argumentOffsets )
+{
+    // check that all arguments are present and well formed
+
+    const char *end = layout.end;
+    const char *typeTag = layout.typeTagsBegin;
+    const char *argument = layout.arguments;
+    unsigned int arrayLevel = 0;
+
+    do{
+        *argumentOffsets++ = static_cast<uint32>(argument - layout.arguments);
+
+        switch( *typeTag ){
+            case TRUE_TYPE_TAG:
+            case FALSE_TYPE_TAG:
+            case NIL_TYPE_TAG:
+            case INFINITUM_TYPE_TAG:
+                // zero length
+                break;
+
+            //    [ Indicates the beginning of an array. The tags following are for
+            //        data in the Array until a close brace tag is reached.
+            //    ] Indicates the end of an array.
+            case ARRAY_BEGIN_TYPE_TAG:
+                ++arrayLevel;
+                // (zero length argument data)
+                break;
+
+            case ARRAY_END_TYPE_TAG:
+                --arrayLevel;
+                // (zero length argument data)
+                break;
+
+            case INT32_TYPE_TAG:
+            case FLOAT_TYPE_TAG:
+            case CHAR_TYPE_TAG:
+            case RGBA_COLOR_TYPE_TAG:
+            case MIDI_MESSAGE_TYPE_TAG:
+
+                if( end - argument < 4 )
+                    return PARSE_ARGUMENTS_EXCEED_MESSAGE_SIZE;
+                argument += 4;
+                break;
+
+            case INT64_TYPE_TAG:
+            case TIME_TAG_TYPE_TAG:
+            case DOUBLE_TYPE_TAG:
+
+                if( end - argument < 8 )
+                    return PARSE_ARGUMENTS_EXCEED_MESSAGE_SIZE;
+                argument += 8;
+                break;
+
+            case STRING_TYPE_TAG: 
+            case SYMBOL_TYPE_TAG:
             
-            const char *typeTag = typeTagsBegin_;
-            const char *argument = arguments_;
-            unsigned int arrayLevel = 0;
-                        
-            do{
-                switch( *typeTag ){
-                    case TRUE_TYPE_TAG:
-                    case FALSE_TYPE_TAG:
-                    case NIL_TYPE_TAG:
-                    case INFINITUM_TYPE_TAG:
-                        // zero length
-                        break;
-
-                    //    [ Indicates the beginning of an array. The tags following are for
-                    //        data in the Array until a close brace tag is reached.
-                    //    ] Indicates the end of an array.
-                    case ARRAY_BEGIN_TYPE_TAG:
-                        ++arrayLevel;
-                        // (zero length argument data)
-                        break;
-
-                    case ARRAY_END_TYPE_TAG:
-                        --arrayLevel;
-                        // (zero length argument data)
-                        break;
-
-                    case INT32_TYPE_TAG:
-                    case FLOAT_TYPE_TAG:
-                    case CHAR_TYPE_TAG:
-                    case RGBA_COLOR_TYPE_TAG:
-                    case MIDI_MESSAGE_TYPE_TAG:
-
-                        if( argument == end )
-                            throw MalformedMessageException( "arguments exceed message size" );
-                        argument += 4;
-                        if( argument > end )
-                            throw MalformedMessageException( "arguments exceed message size" );
-                        break;
-
-                    case INT64_TYPE_TAG:
-                    case TIME_TAG_TYPE_TAG:
-                    case DOUBLE_TYPE_TAG:
-
-                        if( argument == end )
-                            throw MalformedMessageException( "arguments exceed message size" );
-                        argument += 8;
-                        if( argument > end )
-                            throw MalformedMessageException( "arguments exceed message size" );
-                        break;
-
-                    case STRING_TYPE_TAG: 
-                    case SYMBOL_TYPE_TAG:
-                    
-                        if( argument == end )
-                            throw MalformedMessageException( "arguments exceed message size" );
-                        argument = FindStr4End( argument, end );
-                        if( argument == 0 )
-                            throw MalformedMessageException( "unterminated string argument" );
-                        break;
-
-                    case BLOB_TYPE_TAG:
-                        {
-                            if( argument + osc::OSC_SIZEOF_INT32 > end )
-                                MalformedMessageException( "arguments exceed message size" );
-                                
-                            // treat blob size as an unsigned int for the purposes of this calculation
-                            uint32 blobSize = ToUInt32( argument );
-                            argument = argument + osc::OSC_SIZEOF_INT32 + RoundUp4( blobSize );
-                            if( argument > end )
-                                MalformedMessageException( "arguments exceed message size" );
-                        }
-                        break;
+                if( argument == end )
+                    return PARSE_ARGUMENTS_EXCEED_MESSAGE_SIZE;
+                argument = FindStr4End( argument, end );
+                if( argument == 0 )
+                    return PARSE_UNTERMINATED_STRING_ARGUMENT;
+                break;
+
+            case BLOB_TYPE_TAG:
+                {
+                    if( end - argument < osc::OSC_SIZEOF_INT32 )
+                        return PARSE_ARGUMENTS_EXCEED_MESSAGE_SIZE;
                         
-                    default:
-                        throw MalformedMessageException( "unknown type tag" );
+                    // treat blob size as an unsigned int for the purposes of this calculation.
+                    // compare before rounding so that huge sizes can't wrap around.
+                    uint32 blobSize = ToUInt32( argument );
+                    argument += osc::OSC_SIZEOF_INT32;
+                    if( blobSize > (uint32)(end - argument) )
+                        return PARSE_ARGUMENTS_EXCEED_MESSAGE_SIZE;
+                    argument += RoundUp4( blobSize );
                 }
+                break;
+                
+            default:
+                return PARSE_UNKNOWN_TYPE_TAG;
+        }
 
-            }while( *++typeTag != '\0' );
-            typeTagsEnd_ = typeTag;
+    }while( *++typeTag != '\0' );
+    layout.typeTagsEnd = typeTag;
 
-            if( arrayLevel !=  0 )
-                throw MalformedMessageException( "array was not terminated before end of message (expected ']' end of array tag)" );
-        }
+    if( arrayLevel !=  0 )
+        return PARSE_UNTERMINATED_ARRAY;
+
+    return PARSE_OK;
+}
+
+
+ParseError ScanBundleHeader( const char *bundle, osc_bundle_element_size_t size )
+{
+    if( !IsValidElementSizeValue(size) )
+        return PARSE_INVALID_BUNDLE_SIZE;
+
+    if( size < 16 )
+        return PARSE_BUNDLE_TOO_SHORT;
+
+    if( !IsMultipleOf4(size) )
+        return PARSE_BUNDLE_SIZE_NOT_MULTIPLE_OF_4;
+
+    if( bundle[0] != '#'
+        || bundle[1] != 'b'
+        || bundle[2] != 'u'
+        || bundle[3] != 'n'
+        || bundle[4] != 'd'
+        || bundle[5] != 'l'
+        || bundle[6] != 'e'
+        || bundle[7] != '\0' )
+            return PARSE_BAD_BUNDLE_ADDRESS_PATTERN;
+
+    return PARSE_OK;
+}
+
+} // namespace detail
+
+
+ParseError ReceivedMessage::Init( const char *message, osc_bundle_element_size_t size )
+{
+    addressPattern_ = message;
+    argumentIndex_.Reset( 0 );
+
+    detail::MessageLayout layout;
+    ParseError error = detail::ScanMessageHeader( message, size, layout );
+    if( error != PARSE_OK )
+        return error;
+
+    addressHash_ = layout.addressHash;
 
-        // These invariants should be guaranteed by the above code.
-        // we depend on them in the implementation of ArgumentCount()
+    if( layout.typeTagsBegin == 0 ){
+        typeTagsBegin_ = 0;
+        typeTagsEnd_ = 0;
+        arguments_ = 0;
+        return PARSE_OK;
+    }
+
+    typeTagsBegin_ = layout.typeTagsBegin;
+    arguments_ = layout.arguments;
+
+    argumentIndex_.Reset( detail::MaxArgumentCount( layout ) );
+    error = detail::ScanMessageArguments( layout, argumentIndex_.Data() );
+    if( error != PARSE_OK )
+        return error;
+
+    typeTagsEnd_ = layout.typeTagsEnd;
+    argumentIndex_.Resize( static_cast<uint32>(typeTagsEnd_ - typeTagsBegin_) );
+
+    // These invariants should be guaranteed by the above code.
+    // we depend on them in the implementation of ArgumentCount()
 #ifndef NDEBUG
-        std::ptrdiff_t argumentCount = typeTagsEnd_ - typeTagsBegin_;
-        assert( argumentCount >= 0 );
-        assert( argumentCount <= OSC_INT32_MAX );
+    std::ptrdiff_t argumentCount = typeTagsEnd_ - typeTagsBegin_;
+    assert( argumentCount >= 0 );
+    assert( argumentCount <= OSC_INT32_MAX );
 #endif
-    }
+
+    return PARSE_OK;
 }
 
 //------------------------------------------------------------------------------
 
 ReceivedBundle::ReceivedBundle( const ReceivedPacket& packet )
-    : elementCount_( 0 )
 {
-    Init( packet.Contents(), packet.Size() );
+    ParseError error = Init( packet.Contents(), packet.Size() );
+    if( error != PARSE_OK )
+        ThrowParseError( error );
 }
 
 
 ReceivedBundle::ReceivedBundle( const ReceivedBundleElement& bundleElement )
-    : elementCount_( 0 )
 {
-    Init( bundleElement.Contents(), bundleElement.Size() );
+    ParseError error = Init( bundleElement.Contents(), bundleElement.Size() );
+    if( error != PARSE_OK )
+        ThrowParseError( error );
 }
 
 
-void ReceivedBundle::Init( const char *bundle, osc_bundle_element_size_t size )
+ReceivedBundle::ReceivedBundle()
+    : timeTag_( 0 )
+    , end_( 0 )
+    , elementCount_( 0 )
 {
+}
 
-    if( !IsValidElementSizeValue(size) )
-        throw MalformedBundleException( "invalid bundle size" );
 
-    if( size < 16 )
-        throw MalformedBundleException( "packet too short for bundle" );
+ParseError ReceivedBundle::TryParse( const ReceivedPacket& packet, ReceivedBundle& result )
+{
+    ParseError error = result.Init( packet.Contents(), packet.Size() );
+    if( error != PARSE_OK )
+        result = ReceivedBundle();
 
-    if( !IsMultipleOf4(size) )
-        throw MalformedBundleException( "bundle size must be multiple of four" );
+    return error;
+}
 
-    if( bundle[0] != '#'
-        || bundle[1] != 'b'
-        || bundle[2] != 'u'
-        || bundle[3] != 'n'
-        || bundle[4] != 'd'
-        || bundle[5] != 'l'
-        || bundle[6] != 'e'
-        || bundle[7] != '\0' )
-            throw MalformedBundleException( "bad bundle address pattern" );    
+
+ParseError ReceivedBundle::TryParse( const ReceivedBundleElement& bundleElement, ReceivedBundle& result )
+{
+    ParseError error = result.Init( bundleElement.Contents(), bundleElement.Size() );
+    if( error != PARSE_OK )
+        result = ReceivedBundle();
+
+    return error;
+}
+
+
+ParseError ReceivedBundle::Init( const char *bundle, osc_bundle_element_size_t size )
+{
+    elementCount_ = 0;
+
+    ParseError error = detail::ScanBundleHeader( bundle, size );
+    if( error != PARSE_OK )
+        return error;
 
     end_ = bundle + size;
 
@@ -766,23 +1005,26 @@ void ReceivedBundle::Init( const char *bundle, osc_bundle_element_size_t size )
     const char *p = timeTag_ + 8;
         
     while( p < end_ ){
-        if( p + osc::OSC_SIZEOF_INT32 > end_ )
-            throw MalformedBundleException( "packet too short for elementSize" );
+        if( end_ - p < osc::OSC_SIZEOF_INT32 )
+            return PARSE_BUNDLE_TOO_SHORT_FOR_ELEMENT_SIZE;
 
         // treat element size as an unsigned int for the purposes of this calculation
         uint32 elementSize = ToUInt32( p );
         if( (elementSize & ((uint32)0x03)) != 0 )
-            throw MalformedBundleException( "bundle element size must be multiple of four" );
+            return PARSE_BUNDLE_ELEMENT_SIZE_NOT_MULTIPLE_OF_4;
 
-        p += osc::OSC_SIZEOF_INT32 + elementSize;
-        if( p > end_ )
-            throw MalformedBundleException( "packet too short for bundle element" );
+        p += osc::OSC_SIZEOF_INT32;
+        if( elementSize > (uint32)(end_ - p) )
+            return PARSE_BUNDLE_TOO_SHORT_FOR_ELEMENT;
+        p += elementSize;
 
         ++elementCount_;
     }
 
     if( p != end_ )
-        throw MalformedBundleException( "bundle contents " );
+        return PARSE_BUNDLE_CONTENTS;
+
+    return PARSE_OK;
 }
 
 
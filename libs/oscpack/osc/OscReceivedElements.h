@@ -85,6 +85,84 @@ public:
 };
 
 
+// Error codes returned by the non-throwing TryParse() functions below. The
+// throwing constructors report the same conditions as exceptions whose
+// what() string is ParseErrorString( error ).
+enum ParseError{
+    PARSE_OK = 0,
+
+    // reported as MalformedPacketException
+    PARSE_INVALID_PACKET_SIZE,
+    PARSE_ZERO_LENGTH_ELEMENT,
+    PARSE_ELEMENT_SIZE_NOT_MULTIPLE_OF_4,
+
+    // reported as MalformedMessageException
+    PARSE_INVALID_MESSAGE_SIZE,
+    PARSE_ZERO_LENGTH_MESSAGE,
+    PARSE_MESSAGE_SIZE_NOT_MULTIPLE_OF_4,
+    PARSE_UNTERMINATED_ADDRESS_PATTERN,
+    PARSE_TYPE_TAGS_NOT_PRESENT,
+    PARSE_UNTERMINATED_TYPE_TAGS,
+    PARSE_ARGUMENTS_EXCEED_MESSAGE_SIZE,
+    PARSE_UNTERMINATED_STRING_ARGUMENT,
+    PARSE_UNKNOWN_TYPE_TAG,
+    PARSE_UNTERMINATED_ARRAY,
+
+    // reported as MalformedBundleException
+    PARSE_INVALID_BUNDLE_SIZE,
+    PARSE_BUNDLE_TOO_SHORT,
+    PARSE_BUNDLE_SIZE_NOT_MULTIPLE_OF_4,
+    PARSE_BAD_BUNDLE_ADDRESS_PATTERN,
+    PARSE_BUNDLE_TOO_SHORT_FOR_ELEMENT_SIZE,
+    PARSE_BUNDLE_ELEMENT_SIZE_NOT_MULTIPLE_OF_4,
+    PARSE_BUNDLE_TOO_SHORT_FOR_ELEMENT,
+    PARSE_BUNDLE_CONTENTS
+};
+
+const char *ParseErrorString( ParseError error );
+
+// throw the Malformed*Exception corresponding to error. error must not be PARSE_OK
+void ThrowParseError( ParseError error );
+
+
+namespace detail{
+
+// Lower level validation shared by ReceivedMessage, ReceivedBundle and
+// ReceivedBatch. These functions don't allocate or throw.
+
+// the parts of a message located by ScanMessageHeader(). typeTagsBegin
+// points past the initial ',' and, like arguments, is 0 if the message
+// has no type tags. typeTagsEnd is set by ScanMessageArguments().
+struct MessageLayout{
+    const char *addressEnd;
+    uint32 addressHash; // HashStr4() of the address pattern
+    const char *typeTagsBegin;
+    const char *typeTagsEnd;
+    const char *arguments;
+    const char *end;
+};
+
+// check the size, address pattern and type tag string of a message
+ParseError ScanMessageHeader( const char *message, osc_bundle_element_size_t size, MessageLayout& layout );
+
+// an upper bound on the number of offsets ScanMessageArguments() writes
+inline std::size_t MaxArgumentCount( const MessageLayout& layout )
+{
+    return ( layout.typeTagsBegin == 0 ) ? 0
+            : static_cast<std::size_t>(layout.arguments - layout.typeTagsBegin - 1);
+}
+
+// check that the arguments described by the type tags are present and well
+// formed, writing the offset of each argument relative to layout.arguments
+// to argumentOffsets. layout.typeTagsBegin must not be 0.
+ParseError ScanMessageArguments( MessageLayout& layout, uint32 *argumentOffsets );
+
+// check the size and "#bundle" marker of a bundle, but not its elements
+ParseError ScanBundleHeader( const char *bundle, osc_bundle_element_size_t size );
+
+} // namespace detail
+
+
 class ReceivedPacket{
 public:
     // Although the OSC spec is not entirely clear on this, we only support
@@ -106,6 +184,26 @@ public:
         , size_( ValidateSize( (osc_bundle_element_size_t)size ) ) {}
 #endif
 
+    // an empty packet, for use with TryParse()
+    ReceivedPacket()
+        : contents_( 0 )
+        , size_( 0 ) {}
+
+    // non-throwing alternative to the constructors above. on success result
+    // refers to contents and PARSE_OK is returned, otherwise result is
+    // unchanged.
+    static ParseError TryParse( const char *contents, std::size_t size, ReceivedPacket& result )
+    {
+        ParseError error = ( size > (std::size_t)OSC_BUNDLE_ELEMENT_SIZE_MAX )
+                ? PARSE_INVALID_PACKET_SIZE
+                : CheckSize( (osc_bundle_element_size_t)size );
+        if( error == PARSE_OK ){
+            result.contents_ = contents;
+            result.size_ = (osc_bundle_element_size_t)size;
+        }
+        return error;
+    }
+
     bool IsMessage() const { return !IsBundle(); }
     bool IsBundle() const;
 
@@ -116,7 +214,7 @@ private:
     const char *contents_;
     osc_bundle_element_size_t size_;
 
-    static osc_bundle_element_size_t ValidateSize( osc_bundle_element_size_t size )
+    static ParseError CheckSize( osc_bundle_element_size_t size )
     {
         // sanity check integer types declared in OscTypes.h 
         // you'll need to fix OscTypes.h if any of these asserts fail
@@ -126,13 +224,22 @@ private:
         assert( sizeof(osc::uint64) == 8 );
 
         if( !IsValidElementSizeValue(size) )
-            throw MalformedPacketException( "invalid packet size" );
+            return PARSE_INVALID_PACKET_SIZE;
 
         if( size == 0 )
-            throw MalformedPacketException( "zero length elements not permitted" );
+            return PARSE_ZERO_LENGTH_ELEMENT;
 
         if( !IsMultipleOf4(size) )
-            throw MalformedPacketException( "element size must be multiple of four" );
+            return PARSE_ELEMENT_SIZE_NOT_MULTIPLE_OF_4;
+
+        return PARSE_OK;
+    }
+
+    static osc_bundle_element_size_t ValidateSize( osc_bundle_element_size_t size )
+    {
+        ParseError error = CheckSize( size );
+        if( error != PARSE_OK )
+            ThrowParseError( error );
 
         return size;
     }
@@ -278,7 +385,20 @@ public:
     // Only valid at array start. Will throw an exception if IsArrayStart() == false.
     std::size_t ComputeArrayItemCount() const;
 
+    // Bulk decoding of arrays whose items all have the same type, such as
+    // [ffff]. Only valid at array start. The item count is returned and up
+    // to capacity items are converted to host byte order in buffer, so
+    // passing a capacity of 0 just counts the items. Throws
+    // WrongArgumentTypeException if this isn't the start of an array or if
+    // any item has a different type (including a nested array).
+    std::size_t AsInt32Array( int32 *buffer, std::size_t capacity ) const;
+    std::size_t AsFloatArray( float *buffer, std::size_t capacity ) const;
+    std::size_t AsInt64Array( int64 *buffer, std::size_t capacity ) const;
+    std::size_t AsDoubleArray( double *buffer, std::size_t capacity ) const;
+
 private:
+    std::size_t HomogeneousArrayItemCount( char typeTag ) const;
+
 	const char *typeTagPtr_;
 	const char *argumentPtr_;
 };
@@ -471,22 +591,57 @@ public:
 };
 
 
+class AddressInternTable;
+
 class ReceivedMessage{
-    void Init( const char *bundle, osc_bundle_element_size_t size );
+    ParseError Init( const char *message, osc_bundle_element_size_t size );
 public:
     explicit ReceivedMessage( const ReceivedPacket& packet );
     explicit ReceivedMessage( const ReceivedBundleElement& bundleElement );
 
+    // an empty message (no address pattern), for use with TryParse()
+    ReceivedMessage();
+
+    // non-throwing alternatives to the constructors above. return PARSE_OK
+    // on success, otherwise an error code and result is left empty.
+    static ParseError TryParse( const ReceivedPacket& packet, ReceivedMessage& result );
+    static ParseError TryParse( const ReceivedBundleElement& bundleElement, ReceivedMessage& result );
+
 	const char *AddressPattern() const { return addressPattern_; }
 
+    // a hash of the address pattern, computed while the message was
+    // validated. see HashStr4() in OscSimd.h.
+    uint32 AddressPatternHash() const { return addressHash_; }
+
+    // the id of the address pattern in table, or INVALID_ADDRESS_ID if it
+    // hasn't been interned. uses the hash above, so only the matching
+    // entry is compared with the address pattern.
+    uint32 AddressPatternId( const AddressInternTable& table ) const;
+
 	// Support for non-standard SuperCollider integer address patterns:
 	bool AddressPatternIsUInt32() const;
 	uint32 AddressPatternAsUInt32() const;
 
-	uint32 ArgumentCount() const { return static_cast<uint32>(typeTagsEnd_ - typeTagsBegin_); }
+    // the number of type tags, including array begin and end markers
+	uint32 ArgumentCount() const { return argumentIndex_.Size(); }
 
     const char *TypeTags() const { return typeTagsBegin_; }
 
+    // random access to the argument corresponding to the i-th type tag.
+    // the argument offsets are recorded while the message is validated,
+    // so this doesn't need to walk the preceding arguments.
+    // throws MissingArgumentException if i >= ArgumentCount()
+    ReceivedMessageArgument ArgumentAt( uint32 i ) const
+    {
+        if( i >= argumentIndex_.Size() )
+            throw MissingArgumentException();
+
+        return ReceivedMessageArgument( typeTagsBegin_ + i, arguments_ + argumentIndex_[i] );
+    }
+
+    // pointer to the data of the i-th argument. doesn't check that i is in range.
+    const char *ArgumentDataUnchecked( uint32 i ) const { return arguments_ + argumentIndex_[i]; }
+
 
     typedef ReceivedMessageArgumentIterator const_iterator;
     
@@ -506,23 +661,73 @@ public:
     }
 
 private:
+    // offsets of each argument relative to arguments_, stored inline for
+    // typical messages and on the heap for messages with many arguments.
+    class ArgumentIndex{
+    public:
+        enum { INLINE_CAPACITY = 16 };
+
+        ArgumentIndex() : offsets_( inlineOffsets_ ), size_( 0 ) {}
+        ArgumentIndex( const ArgumentIndex& rhs );
+        ~ArgumentIndex()
+        {
+            if( offsets_ != inlineOffsets_ )
+                delete [] offsets_;
+        }
+        ArgumentIndex& operator=( const ArgumentIndex& rhs );
+
+        // discard existing entries and make room for at least capacity entries
+        void Reset( std::size_t capacity );
+
+        // storage for the entries, filled in by detail::ScanMessageArguments()
+        uint32 *Data() { return offsets_; }
+        void Resize( uint32 size ) { size_ = size; }
+
+        uint32 Size() const { return size_; }
+        uint32 operator[]( uint32 i ) const { return offsets_[i]; }
+
+    private:
+        uint32 inlineOffsets_[INLINE_CAPACITY];
+        uint32 *offsets_;
+        uint32 size_;
+    };
+
 	const char *addressPattern_;
+    uint32 addressHash_;
 	const char *typeTagsBegin_;
 	const char *typeTagsEnd_;
     const char *arguments_;
+    ArgumentIndex argumentIndex_;
 };
 
 
 class ReceivedBundle{
-    void Init( const char *message, osc_bundle_element_size_t size );
+    ParseError Init( const char *bundle, osc_bundle_element_size_t size );
 public:
     explicit ReceivedBundle( const ReceivedPacket& packet );
     explicit ReceivedBundle( const ReceivedBundleElement& bundleElement );
 
+    // an empty bundle, for use with TryParse()
+    ReceivedBundle();
+
+    // non-throwing alternatives to the constructors above. return PARSE_OK
+    // on success, otherwise an error code and result is left empty.
+    // as with the constructors, nested elements are validated when they
+    // are parsed, not here.
+    static ParseError TryParse( const ReceivedPacket& packet, ReceivedBundle& result );
+    static ParseError TryParse( const ReceivedBundleElement& bundleElement, ReceivedBundle& result );
+
     uint64 TimeTag() const;
 
     uint32 ElementCount() const { return elementCount_; }
 
+    // the whole bundle, starting with the "#bundle" marker
+    const char *Contents() const { return ( timeTag_ == 0 ) ? 0 : timeTag_ - 8; }
+    osc_bundle_element_size_t Size() const
+    {
+        return ( timeTag_ == 0 ) ? 0 : (osc_bundle_element_size_t)(end_ - (timeTag_ - 8));
+    }
+
     typedef ReceivedBundleElementIterator const_iterator;
     
 	ReceivedBundleElementIterator ElementsBegin() const
@@ -0,0 +1,291 @@
+/*
+	oscpack -- Open Sound Control (OSC) packet manipulation library
+    http://www.rossbencina.com/code/oscpack
+
+    Copyright (c) 2004-2013 Ross Bencina <rossb@audiomulch.com>
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files
+	(the "Software"), to deal in the Software without restriction,
+	including without limitation the rights to use, copy, modify, merge,
+	publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so,
+	subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+	ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+	WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	The text above constitutes the entire oscpack license; however, 
+	the oscpack developer(s) also make the following non-binding requests:
+
+	Any person wishing to distribute modifications to the Software is
+	requested to send the modifications to the original developer so that
+	they can be incorporated into the canonical version. It is also 
+	requested that these non-binding requests be included whenever the
+	above license is reproduced.
+*/
+#include "OscRouteDispatcher.h"
+
+#include <cstring>
+
+
+namespace osc{
+
+namespace{
+
+const uint32 NO_INDEX = 0xFFFFFFFF;
+
+// the end of the part of an address that starts at p: the next '/' or the
+// terminating '\0'
+inline const char *PartEnd( const char *p )
+{
+    while( *p != '/' && *p != '\0' )
+        ++p;
+    return p;
+}
+
+
+// the capture type of a route part, 0 for a literal part or -1 if the part
+// is malformed
+int CaptureType( const char *p, const char *end )
+{
+    std::size_t length = end - p;
+    if( length == 0 || *p != '{' )
+        return 0;
+
+    if( length == 5 && std::memcmp( p, "{int}", 5 ) == 0 )
+        return 'i';
+    if( length == 8 && std::memcmp( p, "{string}", 8 ) == 0 )
+        return 's';
+
+    return -1;
+}
+
+
+// parse [p, end) as a decimal int32 with an optional leading '-'
+bool ParseInt32( const char *p, const char *end, int32 *result )
+{
+    bool negative = false;
+    if( p != end && *p == '-' ){
+        negative = true;
+        ++p;
+    }
+
+    if( p == end || end - p > 10 )
+        return false;
+
+    int64 value = 0;
+    for( ; p != end; ++p ){
+        if( *p < '0' || *p > '9' )
+            return false;
+        value = value * 10 + (*p - '0');
+    }
+
+    if( negative )
+        value = -value;
+
+    if( value < -(int64)0x80000000LL || value > (int64)0x7FFFFFFFLL )
+        return false;
+
+    *result = (int32)value;
+    return true;
+}
+
+} // anonymous namespace
+
+
+RouteDispatcher::Node::Node()
+    : intChild( NO_INDEX )
+    , stringChild( NO_INDEX )
+    , route( NO_INDEX )
+{
+}
+
+
+RouteDispatcher::RouteDispatcher()
+    : nodes_( 1 )
+{
+}
+
+
+RouteDispatcher::~RouteDispatcher()
+{
+    for( std::size_t i=0; i < routes_.size(); ++i )
+        delete routes_[i].handler;
+}
+
+
+void RouteDispatcher::AddRoute( const char *route, const char *captureTypes, detail::RouteHandler *handler )
+{
+    // check the route before modifying the trie
+    std::string routeCaptureTypes;
+    for( const char *p = route; ; ){
+        const char *end = PartEnd( p );
+        int type = CaptureType( p, end );
+        if( type < 0 ){
+            delete handler;
+            throw MalformedRouteException();
+        }
+        if( type > 0 )
+            routeCaptureTypes += (char)type;
+
+        if( *end == '\0' )
+            break;
+        p = end + 1;
+    }
+
+    if( routeCaptureTypes != captureTypes ){
+        delete handler;
+        throw MalformedRouteException( "route captures don't match handler arguments" );
+    }
+
+    // add a trie node for each part of the route that isn't already present.
+    // a route that begins with '/' starts with an empty part.
+    uint32 node = 0;
+    for( const char *p = route; ; ){
+        const char *end = PartEnd( p );
+        int type = CaptureType( p, end );
+
+        uint32 child = NO_INDEX;
+        if( type == 'i' ){
+            child = nodes_[node].intChild;
+        }else if( type == 's' ){
+            child = nodes_[node].stringChild;
+        }else{
+            std::size_t length = end - p;
+            const std::vector<LiteralChild>& literals = nodes_[node].literals;
+            for( std::size_t i=0; i < literals.size(); ++i ){
+                if( literals[i].part.size() == length
+                        && std::memcmp( literals[i].part.data(), p, length ) == 0 ){
+                    child = literals[i].node;
+                    break;
+                }
+            }
+        }
+
+        if( child == NO_INDEX ){
+            child = static_cast<uint32>(nodes_.size());
+            nodes_.push_back( Node() );
+
+            if( type == 'i' ){
+                nodes_[node].intChild = child;
+            }else if( type == 's' ){
+                nodes_[node].stringChild = child;
+            }else{
+                LiteralChild literal;
+                literal.part.assign( p, end );
+                literal.node = child;
+                nodes_[node].literals.push_back( literal );
+            }
+        }
+        node = child;
+
+        if( *end == '\0' )
+            break;
+        p = end + 1;
+    }
+
+    if( nodes_[node].route != NO_INDEX ){
+        Route& existing = routes_[ nodes_[node].route ];
+        delete existing.handler;
+        existing.handler = handler;
+        return;
+    }
+
+    Route r;
+    r.captureTypes = captureTypes;
+    r.hasStringCaptures = ( r.captureTypes.find( 's' ) != std::string::npos );
+    r.handler = handler;
+
+    nodes_[node].route = static_cast<uint32>(routes_.size());
+    routes_.push_back( r );
+}
+
+
+bool RouteDispatcher::MatchChild( uint32 child, const char *address, const char *end,
+        detail::RouteCapture *captures, std::size_t captureCount, uint32 *route ) const
+{
+    if( *end == '\0' ){
+        if( nodes_[child].route == NO_INDEX )
+            return false;
+        *route = nodes_[child].route;
+        return true;
+    }
+
+    return MatchPart( child, address, end + 1, captures, captureCount, route );
+}
+
+
+bool RouteDispatcher::MatchPart( uint32 node, const char *address, const char *p,
+        detail::RouteCapture *captures, std::size_t captureCount, uint32 *route ) const
+{
+    const char *end = PartEnd( p );
+    std::size_t length = end - p;
+    const Node& n = nodes_[node];
+
+    // literal parts take precedence. parts are unique so at most one matches.
+    for( std::size_t i=0; i < n.literals.size(); ++i ){
+        const LiteralChild& literal = n.literals[i];
+        if( literal.part.size() == length && std::memcmp( literal.part.data(), p, length ) == 0 ){
+            if( MatchChild( literal.node, address, end, captures, captureCount, route ) )
+                return true;
+            break;
+        }
+    }
+
+    // the number of capture nodes on any path is limited to
+    // MAX_ROUTE_CAPTURES by AddRoute(), so captureCount can't overflow
+    if( n.intChild != NO_INDEX && ParseInt32( p, end, &captures[captureCount].intValue ) ){
+        if( MatchChild( n.intChild, address, end, captures, captureCount + 1, route ) )
+            return true;
+    }
+
+    if( n.stringChild != NO_INDEX && length > 0 ){
+        captures[captureCount].offset = static_cast<uint32>(p - address);
+        captures[captureCount].length = static_cast<uint32>(length);
+        if( MatchChild( n.stringChild, address, end, captures, captureCount + 1, route ) )
+            return true;
+    }
+
+    return false;
+}
+
+
+bool RouteDispatcher::Dispatch( const ReceivedMessage& m, const IpEndpointName& remoteEndpoint )
+{
+    const char *address = m.AddressPattern();
+
+    detail::RouteCapture captures[MAX_ROUTE_CAPTURES];
+    uint32 routeIndex;
+    if( !MatchPart( 0, address, address, captures, 0, &routeIndex ) )
+        return false;
+
+    const Route& r = routes_[routeIndex];
+    if( r.hasStringCaptures ){
+        // terminate each {string} capture in a copy of the address
+        strings_.assign( address );
+        for( std::size_t i=0; i < r.captureTypes.size(); ++i ){
+            if( r.captureTypes[i] == 's' ){
+                strings_[ captures[i].offset + captures[i].length ] = '\0';
+                captures[i].stringValue = strings_.c_str() + captures[i].offset;
+            }
+        }
+    }
+
+    r.handler->Invoke( m, remoteEndpoint, captures );
+    return true;
+}
+
+
+} // namespace osc
+
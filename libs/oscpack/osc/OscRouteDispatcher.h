@@ -0,0 +1,223 @@
+/*
+	oscpack -- Open Sound Control (OSC) packet manipulation library
+    http://www.rossbencina.com/code/oscpack
+
+    Copyright (c) 2004-2013 Ross Bencina <rossb@audiomulch.com>
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files
+	(the "Software"), to deal in the Software without restriction,
+	including without limitation the rights to use, copy, modify, merge,
+	publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so,
+	subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+	ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+	WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	The text above constitutes the entire oscpack license; however, 
+	the oscpack developer(s) also make the following non-binding requests:
+
+	Any person wishing to distribute modifications to the Software is
+	requested to send the modifications to the original developer so that
+	they can be incorporated into the canonical version. It is also 
+	requested that these non-binding requests be included whenever the
+	above license is reproduced.
+*/
+#ifndef INCLUDED_OSCPACK_OSCROUTEDISPATCHER_H
+#define INCLUDED_OSCPACK_OSCROUTEDISPATCHER_H
+
+#include <cstddef> // size_t
+#include <string>
+#include <vector>
+
+#include "OscTypes.h"
+#include "OscException.h"
+#include "OscReceivedElements.h"
+#include "OscMessageDecoder.h"
+#include "../ip/IpEndpointName.h"
+
+/*
+    RouteDispatcher calls member functions for messages whose addresses
+    match a route (requires C++11). A route is an address in which whole
+    parts may be replaced by a typed capture:
+
+        {int}       a decimal int32, passed to the handler as int32
+        {string}    any non-empty part, passed as a '\0' terminated const char*
+
+    The captured values are passed to the handler after the message and
+    endpoint, in order:
+
+        void Mixer::TrackVolume( const osc::ReceivedMessage& m,
+                const IpEndpointName& remoteEndpoint, osc::int32 track );
+
+        osc::RouteDispatcher routes;
+        routes.AddRoute( "/track/{int}/volume", &mixer, &Mixer::TrackVolume );
+        ...
+        routes.Dispatch( m, remoteEndpoint );
+
+    Routes are compiled into a trie with one level per address part, and
+    integers are parsed while the address is walked, so dispatching doesn't
+    depend on the number of routes and doesn't use RTTI. Where several
+    routes could match, literal parts are preferred to {int}, and {int} to
+    {string}. Incoming addresses are matched literally: OSC wildcards are
+    not expanded (see OscAddressPatternMatcher.h for that).
+
+    The const char* captures point into a buffer owned by the dispatcher,
+    so they are only valid during the call and Dispatch() must not be
+    called again from a handler.
+*/
+
+namespace osc{
+
+class MalformedRouteException : public Exception{
+public:
+    MalformedRouteException( const char *w="malformed route" )
+        : Exception( w ) {}
+};
+
+
+static const std::size_t MAX_ROUTE_CAPTURES = 8;
+
+
+namespace detail{
+
+struct RouteCapture{
+    int32 intValue;
+    const char *stringValue;
+
+    // position of a {string} capture within the address
+    uint32 offset, length;
+};
+
+template< typename T >
+struct RouteCaptureTraits; // only int32 and const char* can be captured
+
+template<>
+struct RouteCaptureTraits< int32 >{
+    static const char TYPE = 'i';
+    static int32 Get( const RouteCapture& c ) { return c.intValue; }
+};
+
+template<>
+struct RouteCaptureTraits< const char* >{
+    static const char TYPE = 's';
+    static const char *Get( const RouteCapture& c ) { return c.stringValue; }
+};
+
+
+class RouteHandler{
+public:
+    virtual ~RouteHandler() {}
+    virtual void Invoke( const ReceivedMessage& m, const IpEndpointName& remoteEndpoint,
+            const RouteCapture *captures ) = 0;
+};
+
+template< class T, typename... Captures >
+class MemberRouteHandler : public RouteHandler{
+public:
+    typedef void (T::*function_type)( const ReceivedMessage&, const IpEndpointName&, Captures... );
+
+    MemberRouteHandler( T *object, function_type f )
+        : object_( object ), f_( f ) {}
+
+    virtual void Invoke( const ReceivedMessage& m, const IpEndpointName& remoteEndpoint,
+            const RouteCapture *captures )
+    {
+        Invoke( m, remoteEndpoint, captures,
+                typename MakeIndexSequence< sizeof...(Captures) >::type() );
+    }
+
+private:
+    template< std::size_t... I >
+    void Invoke( const ReceivedMessage& m, const IpEndpointName& remoteEndpoint,
+            const RouteCapture *captures, IndexSequence<I...> )
+    {
+        (void) captures;
+        (object_->*f_)( m, remoteEndpoint, RouteCaptureTraits<Captures>::Get( captures[I] )... );
+    }
+
+    T *object_;
+    function_type f_;
+};
+
+} // namespace detail
+
+
+class RouteDispatcher{
+public:
+    RouteDispatcher();
+    ~RouteDispatcher();
+
+    // add a route calling (object->*f)( m, remoteEndpoint, captures... ).
+    // the capture types must match the {int} and {string} parts of the route,
+    // otherwise MalformedRouteException is thrown. adding a route that
+    // already exists replaces its handler.
+    template< class T, typename... Captures >
+    void AddRoute( const char *route, T *object,
+            void (T::*f)( const ReceivedMessage&, const IpEndpointName&, Captures... ) )
+    {
+        static_assert( sizeof...(Captures) <= MAX_ROUTE_CAPTURES, "too many route captures" );
+        static const char captureTypes[] = { detail::RouteCaptureTraits<Captures>::TYPE..., '\0' };
+
+        AddRoute( route, captureTypes, new detail::MemberRouteHandler<T, Captures...>( object, f ) );
+    }
+
+    uint32 RouteCount() const { return static_cast<uint32>(routes_.size()); }
+
+    // call the handler of the route matching m's address. returns false if
+    // no route matches.
+    bool Dispatch( const ReceivedMessage& m, const IpEndpointName& remoteEndpoint );
+
+private:
+    RouteDispatcher( const RouteDispatcher& ); // not copyable
+    RouteDispatcher& operator=( const RouteDispatcher& );
+
+    // takes ownership of handler
+    void AddRoute( const char *route, const char *captureTypes, detail::RouteHandler *handler );
+
+    bool MatchPart( uint32 node, const char *address, const char *p,
+            detail::RouteCapture *captures, std::size_t captureCount, uint32 *route ) const;
+    bool MatchChild( uint32 child, const char *address, const char *end,
+            detail::RouteCapture *captures, std::size_t captureCount, uint32 *route ) const;
+
+    struct LiteralChild{
+        std::string part;
+        uint32 node;
+    };
+
+    struct Node{
+        Node();
+
+        std::vector<LiteralChild> literals;
+        uint32 intChild;
+        uint32 stringChild;
+        uint32 route;
+    };
+
+    struct Route{
+        std::string captureTypes;
+        bool hasStringCaptures;
+        detail::RouteHandler *handler;
+    };
+
+    std::vector<Node> nodes_;
+    std::vector<Route> routes_;
+
+    // copy of the address that {string} captures point into
+    std::string strings_;
+};
+
+} // namespace osc
+
+#endif /* INCLUDED_OSCPACK_OSCROUTEDISPATCHER_H */
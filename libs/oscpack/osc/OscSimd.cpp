@@ -0,0 +1,666 @@
+/*
+	oscpack -- Open Sound Control (OSC) packet manipulation library
+    http://www.rossbencina.com/code/oscpack
+
+    Copyright (c) 2004-2013 Ross Bencina <rossb@audiomulch.com>
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files
+	(the "Software"), to deal in the Software without restriction,
+	including without limitation the rights to use, copy, modify, merge,
+	publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so,
+	subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+	ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+	WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	The text above constitutes the entire oscpack license; however, 
+	the oscpack developer(s) also make the following non-binding requests:
+
+	Any person wishing to distribute modifications to the Software is
+	requested to send the modifications to the original developer so that
+	they can be incorporated into the canonical version. It is also 
+	requested that these non-binding requests be included whenever the
+	above license is reproduced.
+*/
+#include "OscSimd.h"
+
+#include <cstring> // memcpy
+
+#include "OscHostEndianness.h"
+
+#if !defined(OSC_NO_SIMD) && (defined(__GNUC__) || defined(__clang__)) \
+        && (defined(__x86_64__) || defined(__i386__))
+#define OSC_SIMD_X86 1
+#include <immintrin.h>
+#define OSC_TARGET_SSE2 __attribute__((target("sse2")))
+#define OSC_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+
+namespace osc{
+
+// check that the bytes following the terminating '\0' at nul are zero up to
+// the next 4 byte boundary (measured from the start of the string at p),
+// and return that boundary. returns 0 if the padding is invalid.
+static inline const char *CheckStr4Padding( const char *p, const char *nul )
+{
+    const char *q = nul + 1;
+    while( (q - p) & 0x03 ){
+        if( *q )
+            return 0;
+        ++q;
+    }
+
+    return q;
+}
+
+
+// scalar scan of [q, end) where q is a 4 byte boundary of the string at p
+static inline const char *FindStr4EndTail( const char *p, const char *q, const char *end )
+{
+    while( q < end && *q )
+        ++q;
+
+    if( q == end )
+        return 0;
+
+    return CheckStr4Padding( p, q );
+}
+
+
+const char *FindStr4EndScalar( const char *p, const char *end )
+{
+    if( p >= end )
+        return 0;
+
+    if( p[0] == '\0' )    // special case for SuperCollider integer address pattern
+        return p + 4;
+
+    return FindStr4EndTail( p, p, end );
+}
+
+
+// HashStr4() processes the string in 8 byte chunks from its start, the last
+// chunk being 4 bytes if the padded length isn't a multiple of 8. the vector
+// kernels hash each block they have scanned, and since their blocks are
+// multiples of 8 bytes the chunks, and so the hash, are the same for all
+// kernels.
+
+static const uint64 HASH_SEED = 0xCBF29CE484222325ULL;
+static const uint64 HASH_MULTIPLIER = 0x9E3779B97F4A7C15ULL;
+
+static inline uint64 HashChunk( uint64 h, uint64 chunk )
+{
+    h = (h ^ chunk) * HASH_MULTIPLIER;
+    return h ^ (h >> 29);
+}
+
+
+static inline uint64 Load64( const char *p )
+{
+    uint64 result;
+    std::memcpy( &result, p, 8 );
+    return result;
+}
+
+
+static inline uint64 Load32( const char *p )
+{
+    uint32 result;
+    std::memcpy( &result, p, 4 );
+    return result;
+}
+
+
+// hash [p, end), where (end - p) is a multiple of 4
+static inline uint64 HashRange( uint64 h, const char *p, const char *end )
+{
+    for( ; end - p >= 8; p += 8 )
+        h = HashChunk( h, Load64( p ) );
+
+    if( p != end )
+        h = HashChunk( h, Load32( p ) );
+
+    return h;
+}
+
+
+static inline uint32 FinishHash( uint64 h )
+{
+    return (uint32)(h ^ (h >> 32));
+}
+
+
+uint32 HashStr4( const char *p, std::size_t paddedLength )
+{
+    return FinishHash( HashRange( HASH_SEED, p, p + paddedLength ) );
+}
+
+
+// true if any byte of x is zero
+static inline bool HasZeroByte( uint64 x )
+{
+    return ((x - 0x0101010101010101ULL) & ~x & 0x8080808080808080ULL) != 0;
+}
+
+
+// scalar scan and hash of [q, end) where q is a multiple of 8 bytes from
+// the start of the string at p, and h is the hash of [p, q)
+static inline const char *FindStr4EndHashTail( const char *p, const char *q, const char *end,
+        uint64 h, uint32 *hash )
+{
+    while( end - q >= 8 ){
+        uint64 chunk = Load64( q );
+        if( HasZeroByte( chunk ) )
+            break;
+        h = HashChunk( h, chunk );
+        q += 8;
+    }
+
+    const char *result = FindStr4EndTail( p, q, end );
+    if( result )
+        *hash = FinishHash( HashRange( h, q, result ) );
+
+    return result;
+}
+
+
+const char *FindStr4EndHashScalar( const char *p, const char *end, uint32 *hash )
+{
+    if( p >= end )
+        return 0;
+
+    if( p[0] == '\0' ){    // special case for SuperCollider integer address pattern
+        *hash = HashStr4( p, 4 );
+        return p + 4;
+    }
+
+    return FindStr4EndHashTail( p, p, end, HASH_SEED, hash );
+}
+
+
+void CopyBigEndian32Scalar( void *dst, const char *src, std::size_t count )
+{
+#ifdef OSC_HOST_LITTLE_ENDIAN
+    char *d = static_cast<char*>(dst);
+    for( std::size_t i=0; i < count; ++i, src += 4, d += 4 ){
+        d[0] = src[3];
+        d[1] = src[2];
+        d[2] = src[1];
+        d[3] = src[0];
+    }
+#else
+    std::memcpy( dst, src, count * 4 );
+#endif
+}
+
+
+void CopyBigEndian64Scalar( void *dst, const char *src, std::size_t count )
+{
+#ifdef OSC_HOST_LITTLE_ENDIAN
+    char *d = static_cast<char*>(dst);
+    for( std::size_t i=0; i < count; ++i, src += 8, d += 8 ){
+        d[0] = src[7];
+        d[1] = src[6];
+        d[2] = src[5];
+        d[3] = src[4];
+        d[4] = src[3];
+        d[5] = src[2];
+        d[6] = src[1];
+        d[7] = src[0];
+    }
+#else
+    std::memcpy( dst, src, count * 8 );
+#endif
+}
+
+
+#ifdef OSC_SIMD_X86
+
+// given the zero-byte mask of a block at q (which is 4 byte aligned relative
+// to the start of the string), return the end of the string, verifying
+// its padding using the same mask. mask must be non-zero.
+static inline const char *Str4EndFromZeroMask( const char *q, uint64 mask )
+{
+    unsigned int n = (unsigned int)__builtin_ctzll( mask );
+    unsigned int boundary = (n + 4) & ~0x03u;
+
+    // blocks are a multiple of 4 bytes long so the padding never spans two blocks
+    uint64 paddingBits = (((uint64)1 << boundary) - 1) & ~(((uint64)1 << n) - 1);
+    if( (mask & paddingBits) != paddingBits )
+        return 0;
+
+    return q + boundary;
+}
+
+
+OSC_TARGET_SSE2 const char *FindStr4EndSse2( const char *p, const char *end )
+{
+    if( p >= end )
+        return 0;
+
+    if( p[0] == '\0' )    // special case for SuperCollider integer address pattern
+        return p + 4;
+
+    const __m128i zero = _mm_setzero_si128();
+    const char *q = p;
+
+    while( end - q >= 16 ){
+        __m128i block = _mm_loadu_si128( reinterpret_cast<const __m128i*>(q) );
+        unsigned int mask = (unsigned int)_mm_movemask_epi8( _mm_cmpeq_epi8( block, zero ) );
+        if( mask )
+            return Str4EndFromZeroMask( q, mask );
+        q += 16;
+    }
+
+    return FindStr4EndTail( p, q, end );
+}
+
+
+OSC_TARGET_AVX2 const char *FindStr4EndAvx2( const char *p, const char *end )
+{
+    if( p >= end )
+        return 0;
+
+    if( p[0] == '\0' )    // special case for SuperCollider integer address pattern
+        return p + 4;
+
+    const __m256i zero = _mm256_setzero_si256();
+    const char *q = p;
+
+    while( end - q >= 32 ){
+        __m256i block = _mm256_loadu_si256( reinterpret_cast<const __m256i*>(q) );
+        uint32 mask = (uint32)_mm256_movemask_epi8( _mm256_cmpeq_epi8( block, zero ) );
+        if( mask )
+            return Str4EndFromZeroMask( q, mask );
+        q += 32;
+    }
+
+    if( end - q >= 16 ){
+        __m128i block = _mm_loadu_si128( reinterpret_cast<const __m128i*>(q) );
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(
+                _mm_cmpeq_epi8( block, _mm_setzero_si128() ) );
+        if( mask )
+            return Str4EndFromZeroMask( q, mask );
+        q += 16;
+    }
+
+    return FindStr4EndTail( p, q, end );
+}
+
+
+
+OSC_TARGET_SSE2 const char *FindStr4EndHashSse2( const char *p, const char *end, uint32 *hash )
+{
+    if( p >= end )
+        return 0;
+
+    if( p[0] == '\0' ){    // special case for SuperCollider integer address pattern
+        *hash = HashStr4( p, 4 );
+        return p + 4;
+    }
+
+    const __m128i zero = _mm_setzero_si128();
+    const char *q = p;
+    uint64 h = HASH_SEED;
+
+    while( end - q >= 16 ){
+        __m128i block = _mm_loadu_si128( reinterpret_cast<const __m128i*>(q) );
+        unsigned int mask = (unsigned int)_mm_movemask_epi8( _mm_cmpeq_epi8( block, zero ) );
+        if( mask ){
+            const char *result = Str4EndFromZeroMask( q, mask );
+            if( result )
+                *hash = FinishHash( HashRange( h, q, result ) );
+            return result;
+        }
+        h = HashChunk( HashChunk( h, Load64( q ) ), Load64( q + 8 ) );
+        q += 16;
+    }
+
+    return FindStr4EndHashTail( p, q, end, h, hash );
+}
+
+
+OSC_TARGET_AVX2 const char *FindStr4EndHashAvx2( const char *p, const char *end, uint32 *hash )
+{
+    if( p >= end )
+        return 0;
+
+    if( p[0] == '\0' ){    // special case for SuperCollider integer address pattern
+        *hash = HashStr4( p, 4 );
+        return p + 4;
+    }
+
+    const __m256i zero = _mm256_setzero_si256();
+    const char *q = p;
+    uint64 h = HASH_SEED;
+
+    while( end - q >= 32 ){
+        __m256i block = _mm256_loadu_si256( reinterpret_cast<const __m256i*>(q) );
+        uint32 mask = (uint32)_mm256_movemask_epi8( _mm256_cmpeq_epi8( block, zero ) );
+        if( mask ){
+            const char *result = Str4EndFromZeroMask( q, mask );
+            if( result )
+                *hash = FinishHash( HashRange( h, q, result ) );
+            return result;
+        }
+        h = HashChunk( HashChunk( h, Load64( q ) ), Load64( q + 8 ) );
+        h = HashChunk( HashChunk( h, Load64( q + 16 ) ), Load64( q + 24 ) );
+        q += 32;
+    }
+
+    // the scalar tail handles the remaining (less than 32) bytes 8 at a time
+    return FindStr4EndHashTail( p, q, end, h, hash );
+}
+
+
+// sse2 has no byte shuffle, so swap the bytes of each 16 bit word with
+// shifts and then reverse the words with the word shuffles
+
+OSC_TARGET_SSE2 static inline __m128i SwapBytesInWords( __m128i x )
+{
+    return _mm_or_si128( _mm_slli_epi16( x, 8 ), _mm_srli_epi16( x, 8 ) );
+}
+
+
+OSC_TARGET_SSE2 void CopyBigEndian32Sse2( void *dst, const char *src, std::size_t count )
+{
+    char *d = static_cast<char*>(dst);
+    std::size_t i = 0;
+
+    for( ; i + 4 <= count; i += 4, src += 16, d += 16 ){
+        __m128i x = SwapBytesInWords( _mm_loadu_si128( reinterpret_cast<const __m128i*>(src) ) );
+        x = _mm_shufflelo_epi16( x, _MM_SHUFFLE( 2, 3, 0, 1 ) );
+        x = _mm_shufflehi_epi16( x, _MM_SHUFFLE( 2, 3, 0, 1 ) );
+        _mm_storeu_si128( reinterpret_cast<__m128i*>(d), x );
+    }
+
+    CopyBigEndian32Scalar( d, src, count - i );
+}
+
+
+OSC_TARGET_SSE2 void CopyBigEndian64Sse2( void *dst, const char *src, std::size_t count )
+{
+    char *d = static_cast<char*>(dst);
+    std::size_t i = 0;
+
+    for( ; i + 2 <= count; i += 2, src += 16, d += 16 ){
+        __m128i x = SwapBytesInWords( _mm_loadu_si128( reinterpret_cast<const __m128i*>(src) ) );
+        x = _mm_shufflelo_epi16( x, _MM_SHUFFLE( 0, 1, 2, 3 ) );
+        x = _mm_shufflehi_epi16( x, _MM_SHUFFLE( 0, 1, 2, 3 ) );
+        _mm_storeu_si128( reinterpret_cast<__m128i*>(d), x );
+    }
+
+    CopyBigEndian64Scalar( d, src, count - i );
+}
+
+
+OSC_TARGET_AVX2 void CopyBigEndian32Avx2( void *dst, const char *src, std::size_t count )
+{
+    const __m256i reverse = _mm256_setr_epi8(
+            3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+            3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12 );
+    char *d = static_cast<char*>(dst);
+    std::size_t i = 0;
+
+    for( ; i + 8 <= count; i += 8, src += 32, d += 32 ){
+        __m256i x = _mm256_loadu_si256( reinterpret_cast<const __m256i*>(src) );
+        _mm256_storeu_si256( reinterpret_cast<__m256i*>(d), _mm256_shuffle_epi8( x, reverse ) );
+    }
+
+    CopyBigEndian32Scalar( d, src, count - i );
+}
+
+
+OSC_TARGET_AVX2 void CopyBigEndian64Avx2( void *dst, const char *src, std::size_t count )
+{
+    const __m256i reverse = _mm256_setr_epi8(
+            7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+            7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8 );
+    char *d = static_cast<char*>(dst);
+    std::size_t i = 0;
+
+    for( ; i + 4 <= count; i += 4, src += 32, d += 32 ){
+        __m256i x = _mm256_loadu_si256( reinterpret_cast<const __m256i*>(src) );
+        _mm256_storeu_si256( reinterpret_cast<__m256i*>(d), _mm256_shuffle_epi8( x, reverse ) );
+    }
+
+    CopyBigEndian64Scalar( d, src, count - i );
+}
+
+#else /* OSC_SIMD_X86 */
+
+// the vector kernels aren't available on this platform, keep the symbols
+// so that callers link. FindStr4EndFunctionFor() never returns these.
+
+const char *FindStr4EndSse2( const char *p, const char *end )
+{
+    return FindStr4EndScalar( p, end );
+}
+
+
+const char *FindStr4EndAvx2( const char *p, const char *end )
+{
+    return FindStr4EndScalar( p, end );
+}
+
+
+const char *FindStr4EndHashSse2( const char *p, const char *end, uint32 *hash )
+{
+    return FindStr4EndHashScalar( p, end, hash );
+}
+
+
+const char *FindStr4EndHashAvx2( const char *p, const char *end, uint32 *hash )
+{
+    return FindStr4EndHashScalar( p, end, hash );
+}
+
+
+void CopyBigEndian32Sse2( void *dst, const char *src, std::size_t count )
+{
+    CopyBigEndian32Scalar( dst, src, count );
+}
+
+
+void CopyBigEndian32Avx2( void *dst, const char *src, std::size_t count )
+{
+    CopyBigEndian32Scalar( dst, src, count );
+}
+
+
+void CopyBigEndian64Sse2( void *dst, const char *src, std::size_t count )
+{
+    CopyBigEndian64Scalar( dst, src, count );
+}
+
+
+void CopyBigEndian64Avx2( void *dst, const char *src, std::size_t count )
+{
+    CopyBigEndian64Scalar( dst, src, count );
+}
+
+#endif /* OSC_SIMD_X86 */
+
+//------------------------------------------------------------------------------
+
+const char *SimdInstructionSetName( SimdInstructionSet instructionSet )
+{
+    switch( instructionSet ){
+        case SIMD_SSE2: return "sse2";
+        case SIMD_AVX2: return "avx2";
+        default: return "scalar";
+    }
+}
+
+
+bool IsSimdInstructionSetSupported( SimdInstructionSet instructionSet )
+{
+    switch( instructionSet ){
+        case SIMD_SCALAR:
+            return true;
+
+#ifdef OSC_SIMD_X86
+        case SIMD_SSE2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports( "sse2" ) != 0;
+
+        case SIMD_AVX2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports( "avx2" ) != 0;
+#endif
+
+        default:
+            return false;
+    }
+}
+
+
+SimdInstructionSet DetectSimdInstructionSet()
+{
+    if( IsSimdInstructionSetSupported( SIMD_AVX2 ) )
+        return SIMD_AVX2;
+    else if( IsSimdInstructionSetSupported( SIMD_SSE2 ) )
+        return SIMD_SSE2;
+    else
+        return SIMD_SCALAR;
+}
+
+
+FindStr4EndFunction FindStr4EndFunctionFor( SimdInstructionSet instructionSet )
+{
+    if( !IsSimdInstructionSetSupported( instructionSet ) )
+        return 0;
+
+    switch( instructionSet ){
+        case SIMD_SSE2: return FindStr4EndSse2;
+        case SIMD_AVX2: return FindStr4EndAvx2;
+        default: return FindStr4EndScalar;
+    }
+}
+
+
+FindStr4EndHashFunction FindStr4EndHashFunctionFor( SimdInstructionSet instructionSet )
+{
+    if( !IsSimdInstructionSetSupported( instructionSet ) )
+        return 0;
+
+    switch( instructionSet ){
+        case SIMD_SSE2: return FindStr4EndHashSse2;
+        case SIMD_AVX2: return FindStr4EndHashAvx2;
+        default: return FindStr4EndHashScalar;
+    }
+}
+
+
+CopyBigEndianFunction CopyBigEndian32FunctionFor( SimdInstructionSet instructionSet )
+{
+    if( !IsSimdInstructionSetSupported( instructionSet ) )
+        return 0;
+
+    switch( instructionSet ){
+        case SIMD_SSE2: return CopyBigEndian32Sse2;
+        case SIMD_AVX2: return CopyBigEndian32Avx2;
+        default: return CopyBigEndian32Scalar;
+    }
+}
+
+
+CopyBigEndianFunction CopyBigEndian64FunctionFor( SimdInstructionSet instructionSet )
+{
+    if( !IsSimdInstructionSetSupported( instructionSet ) )
+        return 0;
+
+    switch( instructionSet ){
+        case SIMD_SSE2: return CopyBigEndian64Sse2;
+        case SIMD_AVX2: return CopyBigEndian64Avx2;
+        default: return CopyBigEndian64Scalar;
+    }
+}
+
+
+static std::atomic<SimdInstructionSet> activeInstructionSet_( SIMD_SCALAR );
+
+
+static void SelectKernels( SimdInstructionSet instructionSet )
+{
+    // threads resolving at the same time store the same values
+    activeInstructionSet_.store( instructionSet, std::memory_order_relaxed );
+    detail::findStr4End_.store( FindStr4EndFunctionFor( instructionSet ), std::memory_order_relaxed );
+    detail::findStr4EndHash_.store( FindStr4EndHashFunctionFor( instructionSet ), std::memory_order_relaxed );
+    detail::copyBigEndian32_.store( CopyBigEndian32FunctionFor( instructionSet ), std::memory_order_relaxed );
+    detail::copyBigEndian64_.store( CopyBigEndian64FunctionFor( instructionSet ), std::memory_order_relaxed );
+}
+
+
+// the kernel pointers initially point to these trampolines, which select the
+// best kernels on first use. this avoids depending on static initialization
+// order when packets are parsed from other static constructors, since the
+// atomics are constant initialized.
+static const char *ResolveFindStr4End( const char *p, const char *end )
+{
+    SelectKernels( DetectSimdInstructionSet() );
+    return FindStr4End( p, end );
+}
+
+
+static const char *ResolveFindStr4EndHash( const char *p, const char *end, uint32 *hash )
+{
+    SelectKernels( DetectSimdInstructionSet() );
+    return FindStr4EndHash( p, end, hash );
+}
+
+
+static void ResolveCopyBigEndian32( void *dst, const char *src, std::size_t count )
+{
+    SelectKernels( DetectSimdInstructionSet() );
+    CopyBigEndian32( dst, src, count );
+}
+
+
+static void ResolveCopyBigEndian64( void *dst, const char *src, std::size_t count )
+{
+    SelectKernels( DetectSimdInstructionSet() );
+    CopyBigEndian64( dst, src, count );
+}
+
+
+namespace detail{
+    std::atomic<FindStr4EndFunction> findStr4End_( ResolveFindStr4End );
+    std::atomic<FindStr4EndHashFunction> findStr4EndHash_( ResolveFindStr4EndHash );
+    std::atomic<CopyBigEndianFunction> copyBigEndian32_( ResolveCopyBigEndian32 );
+    std::atomic<CopyBigEndianFunction> copyBigEndian64_( ResolveCopyBigEndian64 );
+} // namespace detail
+
+
+SimdInstructionSet ActiveSimdInstructionSet()
+{
+    if( detail::findStr4End_.load( std::memory_order_relaxed ) == ResolveFindStr4End )
+        SelectKernels( DetectSimdInstructionSet() );
+
+    return activeInstructionSet_.load( std::memory_order_relaxed );
+}
+
+
+bool SetActiveSimdInstructionSet( SimdInstructionSet instructionSet )
+{
+    if( !IsSimdInstructionSetSupported( instructionSet ) )
+        return false;
+
+    SelectKernels( instructionSet );
+    return true;
+}
+
+} // namespace osc
@@ -0,0 +1,168 @@
+/*
+	oscpack -- Open Sound Control (OSC) packet manipulation library
+    http://www.rossbencina.com/code/oscpack
+
+    Copyright (c) 2004-2013 Ross Bencina <rossb@audiomulch.com>
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files
+	(the "Software"), to deal in the Software without restriction,
+	including without limitation the rights to use, copy, modify, merge,
+	publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so,
+	subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+	ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+	WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	The text above constitutes the entire oscpack license; however, 
+	the oscpack developer(s) also make the following non-binding requests:
+
+	Any person wishing to distribute modifications to the Software is
+	requested to send the modifications to the original developer so that
+	they can be incorporated into the canonical version. It is also 
+	requested that these non-binding requests be included whenever the
+	above license is reproduced.
+*/
+#ifndef INCLUDED_OSCPACK_OSCSIMD_H
+#define INCLUDED_OSCPACK_OSCSIMD_H
+
+#include <atomic>
+#include <cstddef> // size_t
+
+#include "OscTypes.h"
+
+
+namespace osc{
+
+// Runtime selection of the vectorized kernels used by the parsing code.
+//
+// On x86 and x86_64 with gcc or clang the SSE2 and AVX2 kernels are compiled
+// in and the best one supported by the host cpu is chosen the first time a
+// kernel is called. On other platforms (or if OSC_NO_SIMD is defined) only
+// the scalar kernels are available.
+
+enum SimdInstructionSet{
+    SIMD_SCALAR = 0,
+    SIMD_SSE2,
+    SIMD_AVX2
+};
+
+const char *SimdInstructionSetName( SimdInstructionSet instructionSet );
+
+// returns true if the kernels for instructionSet were compiled in and the
+// host cpu supports them
+bool IsSimdInstructionSetSupported( SimdInstructionSet instructionSet );
+
+// the best instruction set supported by the host
+SimdInstructionSet DetectSimdInstructionSet();
+
+// the instruction set currently used by the dispatched kernels below
+SimdInstructionSet ActiveSimdInstructionSet();
+
+// force the dispatched kernels to use a particular instruction set. this is
+// mainly intended for testing and benchmarking. returns false (and leaves the
+// current selection unchanged) if the instruction set is not supported.
+// threads that are parsing switch kernels at their next call.
+bool SetActiveSimdInstructionSet( SimdInstructionSet instructionSet );
+
+
+// Scan the OSC-string starting at p and return the first 4 byte boundary
+// after its terminating '\0', or 0 if the string is not terminated before
+// end or if any of its padding bytes are non-zero. A leading '\0' is treated
+// as a 4 byte SuperCollider integer address pattern and skipped without
+// checking its padding. Never reads at or beyond end.
+//
+// (end - p) must be a multiple of 4.
+
+typedef const char* (*FindStr4EndFunction)( const char *p, const char *end );
+
+const char *FindStr4EndScalar( const char *p, const char *end );
+const char *FindStr4EndSse2( const char *p, const char *end );
+const char *FindStr4EndAvx2( const char *p, const char *end );
+
+// returns the FindStr4End kernel for instructionSet, or 0 if it isn't supported
+FindStr4EndFunction FindStr4EndFunctionFor( SimdInstructionSet instructionSet );
+
+
+// As FindStr4End, but also compute HashStr4() of the string in the same pass
+// and store it in *hash. *hash is only written if the string is valid.
+
+typedef const char* (*FindStr4EndHashFunction)( const char *p, const char *end, uint32 *hash );
+
+const char *FindStr4EndHashScalar( const char *p, const char *end, uint32 *hash );
+const char *FindStr4EndHashSse2( const char *p, const char *end, uint32 *hash );
+const char *FindStr4EndHashAvx2( const char *p, const char *end, uint32 *hash );
+
+// returns the FindStr4EndHash kernel for instructionSet, or 0 if it isn't supported
+FindStr4EndHashFunction FindStr4EndHashFunctionFor( SimdInstructionSet instructionSet );
+
+// the hash of the OSC-string at p, including its zero padding. paddedLength
+// must be a multiple of 4. every kernel computes the same value, but it
+// depends on the host byte order so shouldn't be sent to other machines.
+uint32 HashStr4( const char *p, std::size_t paddedLength );
+
+
+// Copy count big-endian 32 bit (or 64 bit) values from src to dst in host
+// byte order. Used to decode runs of int32/float (or int64/double) array
+// items. Neither pointer needs to be aligned and the ranges must not overlap.
+
+typedef void (*CopyBigEndianFunction)( void *dst, const char *src, std::size_t count );
+
+void CopyBigEndian32Scalar( void *dst, const char *src, std::size_t count );
+void CopyBigEndian32Sse2( void *dst, const char *src, std::size_t count );
+void CopyBigEndian32Avx2( void *dst, const char *src, std::size_t count );
+
+void CopyBigEndian64Scalar( void *dst, const char *src, std::size_t count );
+void CopyBigEndian64Sse2( void *dst, const char *src, std::size_t count );
+void CopyBigEndian64Avx2( void *dst, const char *src, std::size_t count );
+
+// return the kernels for instructionSet, or 0 if it isn't supported
+CopyBigEndianFunction CopyBigEndian32FunctionFor( SimdInstructionSet instructionSet );
+CopyBigEndianFunction CopyBigEndian64FunctionFor( SimdInstructionSet instructionSet );
+
+
+// the kernel pointers are atomic since they are replaced on first use, which
+// may happen on several threads at once. relaxed loads compile to plain
+// loads, and any kernel a thread sees gives the same result.
+namespace detail{
+    extern std::atomic<FindStr4EndFunction> findStr4End_;
+    extern std::atomic<FindStr4EndHashFunction> findStr4EndHash_;
+    extern std::atomic<CopyBigEndianFunction> copyBigEndian32_;
+    extern std::atomic<CopyBigEndianFunction> copyBigEndian64_;
+} // namespace detail
+
+// the dispatched kernels
+inline const char *FindStr4End( const char *p, const char *end )
+{
+    return detail::findStr4End_.load( std::memory_order_relaxed )( p, end );
+}
+
+inline const char *FindStr4EndHash( const char *p, const char *end, uint32 *hash )
+{
+    return detail::findStr4EndHash_.load( std::memory_order_relaxed )( p, end, hash );
+}
+
+inline void CopyBigEndian32( void *dst, const char *src, std::size_t count )
+{
+    detail::copyBigEndian32_.load( std::memory_order_relaxed )( dst, src, count );
+}
+
+inline void CopyBigEndian64( void *dst, const char *src, std::size_t count )
+{
+    detail::copyBigEndian64_.load( std::memory_order_relaxed )( dst, src, count );
+}
+
+} // namespace osc
+
+#endif /* INCLUDED_OSCPACK_OSCSIMD_H */
@@ -0,0 +1,215 @@
+/*
+	oscpack -- Open Sound Control (OSC) packet manipulation library
+    http://www.rossbencina.com/code/oscpack
+
+    Copyright (c) 2004-2013 Ross Bencina <rossb@audiomulch.com>
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files
+	(the "Software"), to deal in the Software without restriction,
+	including without limitation the rights to use, copy, modify, merge,
+	publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so,
+	subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+	ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+	WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	The text above constitutes the entire oscpack license; however, 
+	the oscpack developer(s) also make the following non-binding requests:
+
+	Any person wishing to distribute modifications to the Software is
+	requested to send the modifications to the original developer so that
+	they can be incorporated into the canonical version. It is also 
+	requested that these non-binding requests be included whenever the
+	above license is reproduced.
+*/
+#ifndef INCLUDED_OSCPACK_OSCSTATICADDRESS_H
+#define INCLUDED_OSCPACK_OSCSTATICADDRESS_H
+
+#include <cstddef> // size_t
+
+#include "OscTypes.h"
+#include "OscException.h"
+#include "OscOutboundPacketStream.h"
+
+// requires C++14 (loops in constexpr constructors)
+
+
+namespace osc{
+
+/*
+    StaticAddress and StaticMessageHeader encode an address pattern, and
+    optionally its type tag string, with their padding at compile time.
+    Streaming one into an OutboundPacketStream begins a message by copying
+    the constant block instead of measuring and padding the address on
+    every send:
+
+        static constexpr auto PLAY = osc::MakeStaticAddress( "/transport/play" );
+        static constexpr auto STATS = osc::MakeMessageHeader( "/hub/stats", "ii" );
+
+        p << PLAY << osc::EndMessage;
+        p << STATS << clients << packets << osc::EndMessage;
+
+    An address that doesn't begin with '/', or a type tag that isn't an OSC
+    type, is a compile error when the object is constexpr (and throws
+    MalformedStaticHeaderException otherwise).
+
+    The arguments streamed after a StaticMessageHeader must match its type
+    tags, otherwise EndMessage throws MessageTypeTagsMismatchException.
+    MinimumMessageSize() is a constant expression, so the space needed by a
+    message can be checked against a buffer with static_assert.
+*/
+
+class MalformedStaticHeaderException : public Exception{
+public:
+    MalformedStaticHeaderException( const char *w="malformed static address or type tags" )
+        : Exception( w ) {}
+};
+
+
+namespace detail{
+
+constexpr std::size_t StaticRoundUp4( std::size_t x )
+{
+    return (x + 3) & ~((std::size_t)0x03);
+}
+
+// the space used by an argument, excluding its type tag. strings and blobs
+// take at least four bytes.
+constexpr std::size_t StaticArgumentSize( char typeTag )
+{
+    return ( typeTag == TRUE_TYPE_TAG || typeTag == FALSE_TYPE_TAG
+                || typeTag == NIL_TYPE_TAG || typeTag == INFINITUM_TYPE_TAG
+                || typeTag == ARRAY_BEGIN_TYPE_TAG || typeTag == ARRAY_END_TYPE_TAG ) ? 0
+        : ( typeTag == INT32_TYPE_TAG || typeTag == FLOAT_TYPE_TAG
+                || typeTag == CHAR_TYPE_TAG || typeTag == RGBA_COLOR_TYPE_TAG
+                || typeTag == MIDI_MESSAGE_TYPE_TAG || typeTag == STRING_TYPE_TAG
+                || typeTag == SYMBOL_TYPE_TAG || typeTag == BLOB_TYPE_TAG ) ? 4
+        : ( typeTag == INT64_TYPE_TAG || typeTag == TIME_TAG_TYPE_TAG
+                || typeTag == DOUBLE_TYPE_TAG ) ? 8
+        : throw MalformedStaticHeaderException( "unknown type tag in static type tags" );
+}
+
+template< std::size_t LENGTH >
+constexpr void EncodeStaticAddress( char *dest, const char (&addressPattern)[LENGTH + 1] )
+{
+    if( addressPattern[0] != '/' )
+        throw MalformedStaticHeaderException( "static address pattern doesn't begin with '/'" );
+
+    for( std::size_t i=0; i < LENGTH; ++i ){
+        if( addressPattern[i] == '\0' )
+            throw MalformedStaticHeaderException( "static address pattern contains a null character" );
+        dest[i] = addressPattern[i];
+    }
+    // the padding is left zero by the caller
+}
+
+} // namespace detail
+
+
+template< std::size_t LENGTH >
+class StaticAddress{
+public:
+    static constexpr std::size_t SIZE = detail::StaticRoundUp4( LENGTH + 1 );
+
+    constexpr explicit StaticAddress( const char (&addressPattern)[LENGTH + 1] )
+        : data_()
+    {
+        detail::EncodeStaticAddress<LENGTH>( data_, addressPattern );
+    }
+
+    constexpr const char *Data() const { return data_; }
+    constexpr std::size_t Size() const { return SIZE; }
+
+    // the message size with no arguments: the address plus ",\0\0\0"
+    constexpr std::size_t MinimumMessageSize() const { return SIZE + 4; }
+
+private:
+    char data_[SIZE];
+};
+
+template< std::size_t LENGTH >
+constexpr std::size_t StaticAddress<LENGTH>::SIZE;
+
+
+template< std::size_t ADDRESS_LENGTH, std::size_t TYPE_TAG_COUNT >
+class StaticMessageHeader{
+public:
+    static constexpr std::size_t ADDRESS_SIZE = detail::StaticRoundUp4( ADDRESS_LENGTH + 1 );
+    // slot size includes comma and null terminator
+    static constexpr std::size_t SIZE = ADDRESS_SIZE + detail::StaticRoundUp4( TYPE_TAG_COUNT + 2 );
+
+    constexpr StaticMessageHeader( const char (&addressPattern)[ADDRESS_LENGTH + 1],
+            const char (&typeTags)[TYPE_TAG_COUNT + 1] )
+        : data_()
+        , argumentsSize_( 0 )
+    {
+        detail::EncodeStaticAddress<ADDRESS_LENGTH>( data_, addressPattern );
+
+        data_[ADDRESS_SIZE] = ',';
+        for( std::size_t i=0; i < TYPE_TAG_COUNT; ++i ){
+            argumentsSize_ += detail::StaticArgumentSize( typeTags[i] );
+            data_[ADDRESS_SIZE + 1 + i] = typeTags[i];
+        }
+    }
+
+    constexpr const char *Data() const { return data_; }
+    constexpr std::size_t Size() const { return SIZE; }
+    constexpr std::size_t AddressSize() const { return ADDRESS_SIZE; }
+
+    // the message size, counting strings and blobs as empty
+    constexpr std::size_t MinimumMessageSize() const { return SIZE + argumentsSize_; }
+
+private:
+    char data_[SIZE];
+    std::size_t argumentsSize_;
+};
+
+template< std::size_t ADDRESS_LENGTH, std::size_t TYPE_TAG_COUNT >
+constexpr std::size_t StaticMessageHeader<ADDRESS_LENGTH, TYPE_TAG_COUNT>::ADDRESS_SIZE;
+
+template< std::size_t ADDRESS_LENGTH, std::size_t TYPE_TAG_COUNT >
+constexpr std::size_t StaticMessageHeader<ADDRESS_LENGTH, TYPE_TAG_COUNT>::SIZE;
+
+
+template< std::size_t N >
+constexpr StaticAddress<N - 1> MakeStaticAddress( const char (&addressPattern)[N] )
+{
+    return StaticAddress<N - 1>( addressPattern );
+}
+
+template< std::size_t N, std::size_t M >
+constexpr StaticMessageHeader<N - 1, M - 1> MakeMessageHeader(
+        const char (&addressPattern)[N], const char (&typeTags)[M] )
+{
+    return StaticMessageHeader<N - 1, M - 1>( addressPattern, typeTags );
+}
+
+
+template< std::size_t LENGTH >
+inline OutboundPacketStream& operator<<( OutboundPacketStream& p, const StaticAddress<LENGTH>& rhs )
+{
+    return p << BeginEncodedMessage( rhs.Data(), rhs.Size(), rhs.Size() );
+}
+
+template< std::size_t ADDRESS_LENGTH, std::size_t TYPE_TAG_COUNT >
+inline OutboundPacketStream& operator<<( OutboundPacketStream& p,
+        const StaticMessageHeader<ADDRESS_LENGTH, TYPE_TAG_COUNT>& rhs )
+{
+    return p << BeginEncodedMessage( rhs.Data(), rhs.AddressSize(), rhs.Size() );
+}
+
+} // namespace osc
+
+#endif /* INCLUDED_OSCPACK_OSCSTATICADDRESS_H */
@@ -0,0 +1,87 @@
+/*
+	oscpack -- Open Sound Control (OSC) packet manipulation library
+    http://www.rossbencina.com/code/oscpack
+
+    Copyright (c) 2004-2013 Ross Bencina <rossb@audiomulch.com>
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files
+	(the "Software"), to deal in the Software without restriction,
+	including without limitation the rights to use, copy, modify, merge,
+	publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so,
+	subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+	ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+	WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	The text above constitutes the entire oscpack license; however, 
+	the oscpack developer(s) also make the following non-binding requests:
+
+	Any person wishing to distribute modifications to the Software is
+	requested to send the modifications to the original developer so that
+	they can be incorporated into the canonical version. It is also 
+	requested that these non-binding requests be included whenever the
+	above license is reproduced.
+*/
+#ifndef INCLUDED_OSCPACK_OSCTIMETAG_H
+#define INCLUDED_OSCPACK_OSCTIMETAG_H
+
+#include <chrono>
+
+#include "OscTypes.h"
+
+/*
+    Helpers for OSC time tags (requires C++11).
+
+    A time tag is an NTP timestamp: the high 32 bits are seconds since
+    1 January 1900 and the low 32 bits are fractions of a second. The
+    special value 1 means "immediately".
+*/
+
+namespace osc{
+
+enum { IMMEDIATE_TIME_TAG = 1 };
+
+// seconds between the NTP epoch (1900) and the unix epoch (1970)
+static const uint64 NTP_UNIX_EPOCH_OFFSET_SECONDS = 2208988800UL;
+
+// the time tag for the current system time
+inline uint64 CurrentTimeTag()
+{
+    using namespace std::chrono;
+
+    uint64 ns = static_cast<uint64>( duration_cast<nanoseconds>(
+            system_clock::now().time_since_epoch() ).count() );
+    uint64 seconds = ns / 1000000000 + NTP_UNIX_EPOCH_OFFSET_SECONDS;
+    uint64 fraction = ( (ns % 1000000000) << 32 ) / 1000000000;
+
+    return (seconds << 32) | fraction;
+}
+
+// the length of a time tag interval, in time tag units (2^-32 seconds)
+inline uint64 MicrosecondsToTimeTagInterval( uint64 microseconds )
+{
+    return ( (microseconds / 1000000) << 32 )
+            + ( ( (microseconds % 1000000) << 32 ) / 1000000 );
+}
+
+inline uint64 TimeTagIntervalToMicroseconds( uint64 interval )
+{
+    return (interval >> 32) * 1000000
+            + ( ( (interval & 0xFFFFFFFFUL) * 1000000 ) >> 32 );
+}
+
+} // namespace osc
+
+#endif /* INCLUDED_OSCPACK_OSCTIMETAG_H */
@@ -224,6 +224,17 @@ struct Blob{
     osc_bundle_element_size_t size;
 };
 
+// a blob that OutboundPacketStream references rather than copies (apart
+// from its last 0-3 bytes). the data must stay valid until the packet has
+// been sent.
+struct ExternalBlob{
+    ExternalBlob() {}
+    explicit ExternalBlob( const void* data_, osc_bundle_element_size_t size_ )
+            : data( data_ ), size( size_ ) {}
+    const void* data;
+    osc_bundle_element_size_t size;
+};
+
 struct ArrayInitiator{
 };
 
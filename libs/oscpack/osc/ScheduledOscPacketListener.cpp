@@ -0,0 +1,304 @@
+/*
+	oscpack -- Open Sound Control (OSC) packet manipulation library
+    http://www.rossbencina.com/code/oscpack
+
+    Copyright (c) 2004-2013 Ross Bencina <rossb@audiomulch.com>
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files
+	(the "Software"), to deal in the Software without restriction,
+	including without limitation the rights to use, copy, modify, merge,
+	publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so,
+	subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+	ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+	WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	The text above constitutes the entire oscpack license; however, 
+	the oscpack developer(s) also make the following non-binding requests:
+
+	Any person wishing to distribute modifications to the Software is
+	requested to send the modifications to the original developer so that
+	they can be incorporated into the canonical version. It is also 
+	requested that these non-binding requests be included whenever the
+	above license is reproduced.
+*/
+#include "ScheduledOscPacketListener.h"
+
+#include <algorithm>
+
+#include "OscTimeTag.h"
+
+
+namespace osc{
+
+
+ScheduledOscPacketListener::ScheduledOscPacketListener()
+    : currentTick_( 0 )
+    , nextSequence_( 0 )
+    , scheduledCount_( 0 )
+    , spinThreshold_( MicrosecondsToTimeTagInterval( 1000 ) )
+{
+}
+
+
+ScheduledOscPacketListener::~ScheduledOscPacketListener()
+{
+    for( std::vector<Entry*>::iterator i = allEntries_.begin(); i != allEntries_.end(); ++i )
+        delete *i;
+}
+
+
+bool ScheduledOscPacketListener::EntryIsEarlier( const Entry *lhs, const Entry *rhs )
+{
+    return ( lhs->timeTag < rhs->timeTag )
+            || ( lhs->timeTag == rhs->timeTag && lhs->sequence < rhs->sequence );
+}
+
+
+bool ScheduledOscPacketListener::EntryIsLater( const Entry *lhs, const Entry *rhs )
+{
+    return EntryIsEarlier( rhs, lhs );
+}
+
+
+void ScheduledOscPacketListener::SetSpinThresholdMicroseconds( unsigned int microseconds )
+{
+    spinThreshold_ = MicrosecondsToTimeTagInterval( microseconds );
+}
+
+
+uint64 ScheduledOscPacketListener::CurrentTime() const
+{
+    return CurrentTimeTag();
+}
+
+
+void ScheduledOscPacketListener::ProcessBundle( const osc::ReceivedBundle& b,
+        const IpEndpointName& remoteEndpoint )
+{
+    uint64 timeTag = b.TimeTag();
+
+    // immediate bundles don't need to look at the clock
+    if( timeTag != IMMEDIATE_TIME_TAG ){
+        uint64 now = CurrentTime();
+        if( timeTag > now ){
+            Schedule( b, remoteEndpoint, now );
+            return;
+        }
+    }
+
+    DispatchElements( b, remoteEndpoint );
+}
+
+
+void ScheduledOscPacketListener::DispatchElements( const osc::ReceivedBundle& b,
+        const IpEndpointName& remoteEndpoint )
+{
+    for( ReceivedBundle::const_iterator i = b.ElementsBegin(); i != b.ElementsEnd(); ++i ){
+        if( i->IsBundle() ){
+            ReceivedBundle nested;
+            if( ReceivedBundle::TryParse( *i, nested ) == PARSE_OK )
+                ProcessBundle( nested, remoteEndpoint );
+        }else{
+            ReceivedMessage m;
+            if( ReceivedMessage::TryParse( *i, m ) == PARSE_OK )
+                ProcessMessage( m, remoteEndpoint );
+        }
+    }
+}
+
+
+void ScheduledOscPacketListener::Schedule( const osc::ReceivedBundle& b,
+        const IpEndpointName& remoteEndpoint, uint64 now )
+{
+    Entry *entry;
+    if( freeEntries_.empty() ){
+        entry = new Entry;
+        allEntries_.push_back( entry );
+    }else{
+        entry = freeEntries_.back();
+        freeEntries_.pop_back();
+    }
+
+    // the packet buffer is reused once we return, so keep a copy
+    entry->timeTag = b.TimeTag();
+    entry->sequence = nextSequence_++;
+    entry->remoteEndpoint = remoteEndpoint;
+    entry->data.assign( b.Contents(), b.Contents() + b.Size() );
+
+    // when nothing is scheduled the wheel can start from the current time
+    if( scheduledCount_ == 0 )
+        currentTick_ = now >> SLOT_SHIFT;
+
+    Insert( entry );
+    ++scheduledCount_;
+}
+
+
+void ScheduledOscPacketListener::Insert( Entry *entry )
+{
+    uint64 tick = entry->timeTag >> SLOT_SHIFT;
+
+    if( tick >= currentTick_ + SLOT_COUNT ){
+        overflow_.push_back( entry );
+        std::push_heap( overflow_.begin(), overflow_.end(), EntryIsLater );
+    }else{
+        // if the clock has gone backwards the entry may be earlier than
+        // the current slot. put it there so it's released on the next tick.
+        if( tick < currentTick_ )
+            tick = currentTick_;
+        slots_[ tick & (SLOT_COUNT - 1) ].push_back( entry );
+    }
+}
+
+
+void ScheduledOscPacketListener::ReleaseDueBundles()
+{
+    ReleaseDueBundles( CurrentTime() );
+}
+
+
+void ScheduledOscPacketListener::ReleaseDueBundles( uint64 now )
+{
+    if( scheduledCount_ == 0 )
+        return;
+
+    uint64 nowTick = now >> SLOT_SHIFT;
+
+    // if more than a rotation has passed every slot only needs visiting
+    // once. if the clock has gone backwards only the current slot can hold
+    // anything that is due (see Insert()).
+    uint64 tickCount = ( nowTick >= currentTick_ )
+            ? std::min( nowTick - currentTick_ + 1, (uint64)SLOT_COUNT ) : 1;
+
+    for( uint64 t = 0; t < tickCount; ++t ){
+        std::vector<Entry*>& slot = slots_[ (currentTick_ + t) & (SLOT_COUNT - 1) ];
+
+        for( std::size_t i = 0; i < slot.size(); ){
+            if( slot[i]->timeTag <= now ){
+                due_.push_back( slot[i] );
+                slot[i] = slot.back();
+                slot.pop_back();
+            }else{
+                ++i;
+            }
+        }
+    }
+
+    if( nowTick > currentTick_ )
+        currentTick_ = nowTick;
+
+    // move bundles that have come within range of the wheel out of the overflow heap
+    while( !overflow_.empty()
+            && (overflow_.front()->timeTag >> SLOT_SHIFT) < currentTick_ + SLOT_COUNT ){
+        Entry *entry = overflow_.front();
+        std::pop_heap( overflow_.begin(), overflow_.end(), EntryIsLater );
+        overflow_.pop_back();
+
+        if( entry->timeTag <= now )
+            due_.push_back( entry );
+        else
+            Insert( entry );
+    }
+
+    if( due_.empty() )
+        return;
+
+    scheduledCount_ -= due_.size();
+    std::sort( due_.begin(), due_.end(), EntryIsEarlier );
+
+    // dispatching can schedule nested bundles, but never touches due_
+    std::size_t dueCount = due_.size();
+    for( std::size_t i = 0; i < dueCount; ++i )
+        Dispatch( due_[i] );
+
+    due_.clear();
+}
+
+
+void ScheduledOscPacketListener::Dispatch( Entry *entry )
+{
+    // the data was validated when the bundle arrived
+    ReceivedPacket p;
+    ReceivedBundle b;
+    if( ReceivedPacket::TryParse( &entry->data[0], entry->data.size(), p ) == PARSE_OK
+            && ReceivedBundle::TryParse( p, b ) == PARSE_OK )
+        DispatchElements( b, entry->remoteEndpoint );
+
+    freeEntries_.push_back( entry );
+}
+
+
+uint64 ScheduledOscPacketListener::EarliestBefore( uint64 limit ) const
+{
+    uint64 result = limit;
+
+    if( scheduledCount_ == 0 )
+        return result;
+
+    // slots are visited in time order so the first non-empty one holds the
+    // earliest entry in the wheel
+    uint64 lastTick = std::min( limit >> SLOT_SHIFT, currentTick_ + SLOT_COUNT - 1 );
+    for( uint64 tick = currentTick_; tick <= lastTick; ++tick ){
+        const std::vector<Entry*>& slot = slots_[ tick & (SLOT_COUNT - 1) ];
+        if( !slot.empty() ){
+            for( std::size_t i = 0; i < slot.size(); ++i )
+                result = std::min( result, slot[i]->timeTag );
+            break;
+        }
+    }
+
+    if( !overflow_.empty() )
+        result = std::min( result, overflow_.front()->timeTag );
+
+    return result;
+}
+
+
+uint64 ScheduledOscPacketListener::NextDueTime() const
+{
+    if( scheduledCount_ == 0 )
+        return 0;
+
+    return EarliestBefore( ~(uint64)0 );
+}
+
+
+void ScheduledOscPacketListener::TimerExpired()
+{
+    uint64 now = CurrentTime();
+    ReleaseDueBundles( now );
+
+    if( spinThreshold_ == 0 )
+        return;
+
+    // bundles due before the next tick are released on time by spinning
+    uint64 limit = now + spinThreshold_;
+    for(;;){
+        uint64 next = EarliestBefore( limit );
+        if( next >= limit )
+            break;
+
+        do{
+            now = CurrentTime();
+        }while( now < next );
+
+        ReleaseDueBundles( now );
+    }
+}
+
+
+} // namespace osc
+
@@ -0,0 +1,152 @@
+/*
+	oscpack -- Open Sound Control (OSC) packet manipulation library
+    http://www.rossbencina.com/code/oscpack
+
+    Copyright (c) 2004-2013 Ross Bencina <rossb@audiomulch.com>
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files
+	(the "Software"), to deal in the Software without restriction,
+	including without limitation the rights to use, copy, modify, merge,
+	publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so,
+	subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+	ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+	WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	The text above constitutes the entire oscpack license; however, 
+	the oscpack developer(s) also make the following non-binding requests:
+
+	Any person wishing to distribute modifications to the Software is
+	requested to send the modifications to the original developer so that
+	they can be incorporated into the canonical version. It is also 
+	requested that these non-binding requests be included whenever the
+	above license is reproduced.
+*/
+#ifndef INCLUDED_OSCPACK_SCHEDULEDOSCPACKETLISTENER_H
+#define INCLUDED_OSCPACK_SCHEDULEDOSCPACKETLISTENER_H
+
+#include <cstddef> // size_t
+#include <vector>
+
+#include "OscPacketListener.h"
+#include "../ip/IpEndpointName.h"
+#include "../ip/TimerListener.h"
+
+
+namespace osc{
+
+/*
+    ScheduledOscPacketListener dispatches bundles at the time given by their
+    time tag instead of when they arrive. Bundles tagged "immediately", or
+    whose time has already passed, are dispatched straight away as with
+    OscPacketListener. Future bundles are copied into a timer wheel and
+    released by ReleaseDueBundles().
+
+    With a SocketReceiveMultiplexer, attach the listener as both the packet
+    listener and a 1ms periodic timer listener:
+
+        mux.AttachSocketListener( &socket, &listener );
+        mux.AttachPeriodicTimerListener( 1, &listener );
+
+    Timers only fire every millisecond or so, so a bundle that is due
+    within the spin threshold of the current time is waited for by spinning
+    on the clock and released at its exact time. This gives sub-millisecond
+    release jitter at the cost of keeping the receive thread busy for up to
+    the spin threshold per tick when bundles are pending. The default
+    threshold of 1000us is for a dedicated receive thread. On a UI or
+    event-loop thread it would block the loop for up to a millisecond per
+    tick, so set it to 0 there.
+
+    Unlike OscPacketListener, malformed elements inside a bundle are skipped
+    rather than thrown, because scheduled bundles are released from a timer
+    callback where there is nobody to catch the exception.
+
+    The listener isn't thread safe: ProcessPacket() and ReleaseDueBundles()
+    must be called from the same thread.
+*/
+
+class ScheduledOscPacketListener : public OscPacketListener, public TimerListener{
+public:
+    ScheduledOscPacketListener();
+    virtual ~ScheduledOscPacketListener();
+
+    // release the bundles that are due at the current time
+    void ReleaseDueBundles();
+
+    // release the bundles due at or before now, which is a time tag
+    void ReleaseDueBundles( uint64 now );
+
+    std::size_t ScheduledBundleCount() const { return scheduledCount_; }
+
+    // time tag of the earliest scheduled bundle, or 0 if none are scheduled
+    uint64 NextDueTime() const;
+
+    // bundles due within this many microseconds of a timer tick are spun
+    // for rather than left to the next tick. 0 disables spinning.
+    void SetSpinThresholdMicroseconds( unsigned int microseconds );
+
+    virtual void TimerExpired();
+
+protected:
+    virtual void ProcessBundle( const osc::ReceivedBundle& b,
+            const IpEndpointName& remoteEndpoint );
+
+    // the clock used for scheduling, CurrentTimeTag() by default
+    virtual uint64 CurrentTime() const;
+
+private:
+    ScheduledOscPacketListener( const ScheduledOscPacketListener& ); // not copyable
+    ScheduledOscPacketListener& operator=( const ScheduledOscPacketListener& );
+
+    // the wheel has SLOT_COUNT slots of 2^SLOT_SHIFT time tag units (just
+    // under 1ms each), so it covers about one second ahead. bundles further
+    // in the future wait in the overflow heap until they come into range.
+    enum { SLOT_SHIFT = 22, SLOT_COUNT = 1024 };
+
+    // a scheduled bundle. entries are recycled through freeEntries_ so
+    // their data buffers are only allocated while the pool grows.
+    struct Entry{
+        uint64 timeTag;
+        uint64 sequence; // arrival order, to keep equal time tags in order
+        IpEndpointName remoteEndpoint;
+        std::vector<char> data;
+    };
+
+    static bool EntryIsEarlier( const Entry *lhs, const Entry *rhs );
+    static bool EntryIsLater( const Entry *lhs, const Entry *rhs );
+
+    void Schedule( const osc::ReceivedBundle& b, const IpEndpointName& remoteEndpoint, uint64 now );
+    void Insert( Entry *entry );
+    void DispatchElements( const osc::ReceivedBundle& b, const IpEndpointName& remoteEndpoint );
+    void Dispatch( Entry *entry );
+
+    // the earliest time tag before limit, or limit if there is none
+    uint64 EarliestBefore( uint64 limit ) const;
+
+    std::vector<Entry*> slots_[SLOT_COUNT];
+    std::vector<Entry*> overflow_; // heap ordered by EntryIsLater
+    std::vector<Entry*> due_;
+    std::vector<Entry*> freeEntries_;
+    std::vector<Entry*> allEntries_;
+
+    uint64 currentTick_;
+    uint64 nextSequence_;
+    std::size_t scheduledCount_;
+    uint64 spinThreshold_;
+};
+
+} // namespace osc
+
+#endif /* INCLUDED_OSCPACK_SCHEDULEDOSCPACKETLISTENER_H */
@@ -0,0 +1,597 @@
+/*
+	oscpack -- Open Sound Control (OSC) packet manipulation library
+    http://www.rossbencina.com/code/oscpack
+
+    Copyright (c) 2004-2013 Ross Bencina <rossb@audiomulch.com>
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files
+	(the "Software"), to deal in the Software without restriction,
+	including without limitation the rights to use, copy, modify, merge,
+	publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so,
+	subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+	ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+	WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	The text above constitutes the entire oscpack license; however, 
+	the oscpack developer(s) also make the following non-binding requests:
+
+	Any person wishing to distribute modifications to the Software is
+	requested to send the modifications to the original developer so that
+	they can be incorporated into the canonical version. It is also 
+	requested that these non-binding requests be included whenever the
+	above license is reproduced.
+*/
+#include "OscReceiveBenchmarks.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "osc/OscReceivedElements.h"
+#include "osc/OscReceivedBatch.h"
+#include "osc/OscAddressInternTable.h"
+#include "osc/OscAddressPatternMatcher.h"
+#include "osc/OscRouteDispatcher.h"
+#include "osc/OscOutboundPacketStream.h"
+#include "osc/OscSimd.h"
+#include "osc/OscTimeTag.h"
+#include "osc/ScheduledOscPacketListener.h"
+
+namespace osc{
+
+// keeps the optimizer from discarding the benchmarked work
+static volatile std::size_t sink_;
+
+static const int ITERATIONS = 2000000;
+
+
+class BenchmarkTimer{
+    std::chrono::steady_clock::time_point start_;
+public:
+    BenchmarkTimer() : start_( std::chrono::steady_clock::now() ) {}
+
+    double ElapsedNanoseconds() const
+    {
+        return std::chrono::duration<double, std::nano>(
+                std::chrono::steady_clock::now() - start_ ).count();
+    }
+};
+
+
+static void PrintResult( const char *name, const char *variant, double totalNs, int iterations )
+{
+    std::cout << std::left << std::setw(36) << name
+            << std::setw(8) << variant
+            << std::right << std::fixed << std::setprecision(2)
+            << std::setw(10) << (totalNs / iterations) << " ns/op\n";
+}
+
+
+// build a message with the given address pattern and one float argument
+static std::size_t BuildMessage( char *buffer, std::size_t capacity, const char *addressPattern )
+{
+    OutboundPacketStream p( buffer, capacity );
+    p << BeginMessage( addressPattern ) << 0.5f << EndMessage;
+    return p.Size();
+}
+
+
+static void BenchmarkFindStr4End( const char *name, const char *data, std::size_t size )
+{
+    static const SimdInstructionSet sets[] = { SIMD_SCALAR, SIMD_SSE2, SIMD_AVX2 };
+
+    for( std::size_t i=0; i < sizeof(sets) / sizeof(sets[0]); ++i ){
+        FindStr4EndFunction f = FindStr4EndFunctionFor( sets[i] );
+        if( !f )
+            continue;
+
+        std::size_t total = 0;
+        BenchmarkTimer t;
+        for( int j=0; j < ITERATIONS; ++j )
+            total += f( data, data + size ) - data;
+        PrintResult( name, SimdInstructionSetName( sets[i] ), t.ElapsedNanoseconds(), ITERATIONS );
+        sink_ = total;
+    }
+}
+
+
+static void BenchmarkFindStr4EndHash( const char *name, const char *data, std::size_t size )
+{
+    static const SimdInstructionSet sets[] = { SIMD_SCALAR, SIMD_SSE2, SIMD_AVX2 };
+
+    for( std::size_t i=0; i < sizeof(sets) / sizeof(sets[0]); ++i ){
+        FindStr4EndHashFunction f = FindStr4EndHashFunctionFor( sets[i] );
+        if( !f )
+            continue;
+
+        std::size_t total = 0;
+        uint32 hash = 0;
+        BenchmarkTimer t;
+        for( int j=0; j < ITERATIONS; ++j ){
+            total += f( data, data + size, &hash ) - data;
+            total += hash;
+        }
+        PrintResult( name, SimdInstructionSetName( sets[i] ), t.ElapsedNanoseconds(), ITERATIONS );
+        sink_ = total;
+    }
+}
+
+
+static void BenchmarkParseMessage( const char *name, const char *data, std::size_t size )
+{
+    static const SimdInstructionSet sets[] = { SIMD_SCALAR, SIMD_SSE2, SIMD_AVX2 };
+
+    SimdInstructionSet previous = ActiveSimdInstructionSet();
+
+    for( std::size_t i=0; i < sizeof(sets) / sizeof(sets[0]); ++i ){
+        if( !SetActiveSimdInstructionSet( sets[i] ) )
+            continue;
+
+        std::size_t total = 0;
+        BenchmarkTimer t;
+        for( int j=0; j < ITERATIONS; ++j ){
+            ReceivedMessage m( ReceivedPacket( data, size ) );
+            total += m.ArgumentCount();
+        }
+        PrintResult( name, SimdInstructionSetName( sets[i] ), t.ElapsedNanoseconds(), ITERATIONS );
+        sink_ = total;
+    }
+
+    SetActiveSimdInstructionSet( previous );
+}
+
+
+// parse a packet as a message using the throwing interface
+static void BenchmarkThrowingParse( const char *name, const char *data, std::size_t size )
+{
+    std::size_t total = 0;
+    BenchmarkTimer t;
+    for( int j=0; j < ITERATIONS; ++j ){
+        try{
+            ReceivedMessage m( ReceivedPacket( data, size ) );
+            total += m.ArgumentCount();
+        }catch( Exception& ){
+            ++total;
+        }
+    }
+    PrintResult( name, "throw", t.ElapsedNanoseconds(), ITERATIONS );
+    sink_ = total;
+}
+
+
+// parse a packet as a message using TryParse
+static void BenchmarkTryParse( const char *name, const char *data, std::size_t size )
+{
+    std::size_t total = 0;
+    BenchmarkTimer t;
+    for( int j=0; j < ITERATIONS; ++j ){
+        ReceivedPacket p;
+        ReceivedMessage m;
+        if( ReceivedPacket::TryParse( data, size, p ) == PARSE_OK
+                && ReceivedMessage::TryParse( p, m ) == PARSE_OK )
+            total += m.ArgumentCount();
+        else
+            ++total;
+    }
+    PrintResult( name, "try", t.ElapsedNanoseconds(), ITERATIONS );
+    sink_ = total;
+}
+
+
+// build a bundle of count /track/N/volume messages
+static std::size_t BuildBundle( char *buffer, std::size_t capacity, int count )
+{
+    OutboundPacketStream p( buffer, capacity );
+    p << BeginBundleImmediate;
+    for( int i=0; i < count; ++i ){
+        char address[32];
+        std::snprintf( address, sizeof(address), "/track/%d/volume", i + 1 );
+        p << BeginMessage( address ) << 0.5f << EndMessage;
+    }
+    p << EndBundle;
+    return p.Size();
+}
+
+
+// visit every message of a bundle using ReceivedBundle and ReceivedMessage
+static void BenchmarkBundleElements( const char *name, const char *data, std::size_t size, int iterations )
+{
+    std::size_t total = 0;
+    BenchmarkTimer t;
+    for( int j=0; j < iterations; ++j ){
+        ReceivedBundle b( ReceivedPacket( data, size ) );
+        for( ReceivedBundle::const_iterator i = b.ElementsBegin(); i != b.ElementsEnd(); ++i ){
+            ReceivedMessage m( *i );
+            total += m.ArgumentCount();
+        }
+    }
+    PrintResult( name, "element", t.ElapsedNanoseconds(), iterations );
+    sink_ = total;
+}
+
+
+// visit every message of a bundle using ReceivedBatch
+static void BenchmarkBundleBatch( const char *name, const char *data, std::size_t size, int iterations )
+{
+    ReceivedBatch batch;
+    std::size_t total = 0;
+    BenchmarkTimer t;
+    for( int j=0; j < iterations; ++j ){
+        batch.Decode( data, size );
+        total += batch.TotalArgumentCount();
+    }
+    PrintResult( name, "batch", t.ElapsedNanoseconds(), iterations );
+    sink_ = total;
+}
+
+
+// records how late each scheduled bundle is released. every message
+// carries its time tag as an int64 argument.
+class LatenessListener : public ScheduledOscPacketListener{
+public:
+    uint64 maxLateness;
+    uint64 totalLateness;
+    int count;
+
+    LatenessListener() : maxLateness( 0 ), totalLateness( 0 ), count( 0 ) {}
+
+protected:
+    virtual void ProcessMessage( const osc::ReceivedMessage& m, const IpEndpointName& remoteEndpoint )
+    {
+        (void)remoteEndpoint;
+        uint64 now = CurrentTimeTag();
+        uint64 due = (uint64)m.ArgumentsBegin()->AsInt64();
+        uint64 lateness = ( now > due ) ? now - due : 0;
+        maxLateness = std::max( maxLateness, lateness );
+        totalLateness += lateness;
+        ++count;
+    }
+};
+
+
+// schedule bundles a few ms ahead and drive the listener from a fixed rate
+// 1ms timer, as SocketReceiveMultiplexer's periodic timers would
+static void BenchmarkScheduledRelease( unsigned int spinThresholdMicroseconds )
+{
+    LatenessListener listener;
+    listener.SetSpinThresholdMicroseconds( spinThresholdMicroseconds );
+
+    std::chrono::steady_clock::time_point tick = std::chrono::steady_clock::now();
+
+    char buffer[64];
+    const int bundleCount = 200;
+    for( int i=0; i < bundleCount; ++i ){
+        if( i % 4 == 0 ){
+            uint64 now = CurrentTimeTag();
+            for( int j=0; j < 4; ++j ){
+                // spread the time tags so they don't line up with the ticks
+                uint64 due = now + MicrosecondsToTimeTagInterval( 2000 + 317 * j );
+                OutboundPacketStream ps( buffer, sizeof(buffer) );
+                ps << BeginBundle( due ) << BeginMessage( "/automation" ) << (int64)due << EndMessage << EndBundle;
+                listener.ProcessPacket( ps.Data(), (int)ps.Size(), IpEndpointName() );
+            }
+        }
+        tick += std::chrono::milliseconds( 1 );
+        std::this_thread::sleep_until( tick );
+        listener.TimerExpired();
+    }
+    while( listener.ScheduledBundleCount() > 0 ){
+        tick += std::chrono::milliseconds( 1 );
+        std::this_thread::sleep_until( tick );
+        listener.TimerExpired();
+    }
+
+    std::cout << std::left << std::setw(36) << "scheduled release lateness"
+            << "spin " << std::setw(6) << spinThresholdMicroseconds
+            << std::right << std::fixed << std::setprecision(1)
+            << "mean " << std::setw(8) << (double)TimeTagIntervalToMicroseconds( listener.totalLateness ) / listener.count
+            << " us, max " << std::setw(8) << (double)TimeTagIntervalToMicroseconds( listener.maxLateness ) << " us\n";
+}
+
+
+// decode a float array item by item with the argument iterator
+static void BenchmarkFloatArrayItems( const char *name, const ReceivedMessage& m, float *buffer )
+{
+    std::size_t total = 0;
+    BenchmarkTimer t;
+    for( int j=0; j < ITERATIONS / 10; ++j ){
+        ReceivedMessage::const_iterator i = m.ArgumentsBegin();
+        std::size_t n = 0;
+        for( ++i; !i->IsArrayEnd(); ++i )
+            buffer[n++] = i->AsFloat();
+        total += n;
+    }
+    PrintResult( name, "items", t.ElapsedNanoseconds(), ITERATIONS / 10 );
+    sink_ = total;
+}
+
+
+// decode a float array with AsFloatArray for each instruction set
+static void BenchmarkFloatArrayBulk( const char *name, const ReceivedMessage& m, float *buffer, std::size_t capacity )
+{
+    static const SimdInstructionSet sets[] = { SIMD_SCALAR, SIMD_SSE2, SIMD_AVX2 };
+
+    SimdInstructionSet previous = ActiveSimdInstructionSet();
+
+    for( std::size_t i=0; i < sizeof(sets) / sizeof(sets[0]); ++i ){
+        if( !SetActiveSimdInstructionSet( sets[i] ) )
+            continue;
+
+        std::size_t total = 0;
+        BenchmarkTimer t;
+        for( int j=0; j < ITERATIONS / 10; ++j )
+            total += m.ArgumentsBegin()->AsFloatArray( buffer, capacity );
+        PrintResult( name, SimdInstructionSetName( sets[i] ), t.ElapsedNanoseconds(), ITERATIONS / 10 );
+        sink_ = total;
+    }
+
+    SetActiveSimdInstructionSet( previous );
+}
+
+
+// find the index of a message's address in a list of known addresses by
+// comparing strings, as a chain of handlers would
+static void BenchmarkAddressStrcmp( const char *name, const ReceivedMessage& m,
+        const std::vector<std::string>& addresses )
+{
+    std::size_t total = 0;
+    BenchmarkTimer t;
+    for( int j=0; j < ITERATIONS; ++j ){
+        std::size_t k = 0;
+        while( k < addresses.size() && std::strcmp( m.AddressPattern(), addresses[k].c_str() ) != 0 )
+            ++k;
+        total += k;
+    }
+    PrintResult( name, "strcmp", t.ElapsedNanoseconds(), ITERATIONS );
+    sink_ = total;
+}
+
+
+// the same lookup using the address pattern hash and an AddressInternTable
+static void BenchmarkAddressId( const char *name, const ReceivedMessage& m,
+        const AddressInternTable& table )
+{
+    std::size_t total = 0;
+    BenchmarkTimer t;
+    for( int j=0; j < ITERATIONS; ++j )
+        total += m.AddressPatternId( table );
+    PrintResult( name, "id", t.ElapsedNanoseconds(), ITERATIONS );
+    sink_ = total;
+}
+
+
+// match a wildcard pattern by testing every method address in turn
+static void BenchmarkPatternLinear( const char *name, const ReceivedMessage& m,
+        const std::vector<std::string>& addresses )
+{
+    std::size_t total = 0;
+    BenchmarkTimer t;
+    for( int j=0; j < ITERATIONS / 100; ++j ){
+        for( std::size_t k=0; k < addresses.size(); ++k )
+            total += AddressPatternMatcher::PatternMatches( m.AddressPattern(), addresses[k].c_str() );
+    }
+    PrintResult( name, "linear", t.ElapsedNanoseconds(), ITERATIONS / 100 );
+    sink_ = total;
+}
+
+
+// the same match using an AddressPatternMatcher
+static void BenchmarkPatternMatcher( const char *name, const char *variant,
+        const ReceivedMessage& m, AddressPatternMatcher& matcher )
+{
+    std::size_t total = 0;
+    BenchmarkTimer t;
+    for( int j=0; j < ITERATIONS / 100; ++j )
+        total += matcher.Match( m ).size();
+    PrintResult( name, variant, t.ElapsedNanoseconds(), ITERATIONS / 100 );
+    sink_ = total;
+}
+
+
+class BenchmarkRouteHandlers{
+public:
+    std::size_t total;
+
+    BenchmarkRouteHandlers() : total( 0 ) {}
+
+    void TrackVolume( const ReceivedMessage&, const IpEndpointName&, int32 track )
+        { total += track; }
+    void TrackPan( const ReceivedMessage&, const IpEndpointName&, int32 track )
+        { total += track + 1; }
+};
+
+
+// extract the track number from the address with sscanf, as the gui used to
+static void BenchmarkRouteSscanf( const char *name, const ReceivedMessage& m )
+{
+    std::size_t total = 0;
+    BenchmarkTimer t;
+    for( int j=0; j < ITERATIONS; ++j ){
+        int track;
+        if( std::sscanf( m.AddressPattern(), "/track/%d/volume", &track ) == 1 )
+            total += track;
+    }
+    PrintResult( name, "sscanf", t.ElapsedNanoseconds(), ITERATIONS );
+    sink_ = total;
+}
+
+
+static void BenchmarkRouteDispatcher( const char *name, const ReceivedMessage& m )
+{
+    BenchmarkRouteHandlers handlers;
+    RouteDispatcher routes;
+    routes.AddRoute( "/track/{int}/pan", &handlers, &BenchmarkRouteHandlers::TrackPan );
+    routes.AddRoute( "/track/{int}/volume", &handlers, &BenchmarkRouteHandlers::TrackVolume );
+
+    IpEndpointName endpoint;
+    BenchmarkTimer t;
+    for( int j=0; j < ITERATIONS; ++j )
+        routes.Dispatch( m, endpoint );
+    PrintResult( name, "routes", t.ElapsedNanoseconds(), ITERATIONS );
+    sink_ = handlers.total;
+}
+
+
+void RunReceiveBenchmarks()
+{
+    std::cout << "detected instruction set: "
+            << SimdInstructionSetName( DetectSimdInstructionSet() ) << "\n\n";
+
+    const std::size_t capacity = 1024;
+    char shortMessage[capacity];
+    char longMessage[capacity];
+
+    std::size_t shortSize = BuildMessage( shortMessage, capacity, "/track/1/volume" );
+    std::size_t longSize = BuildMessage( longMessage, capacity,
+            "/mixer/bus/17/insert/3/parameter/frequency/automation/envelope/point/42/value" );
+
+    BenchmarkFindStr4End( "FindStr4End short address", shortMessage, shortSize );
+    BenchmarkFindStr4End( "FindStr4End long address", longMessage, longSize );
+    BenchmarkFindStr4EndHash( "FindStr4EndHash short address", shortMessage, shortSize );
+    BenchmarkFindStr4EndHash( "FindStr4EndHash long address", longMessage, longSize );
+    BenchmarkParseMessage( "ReceivedMessage short address", shortMessage, shortSize );
+    BenchmarkParseMessage( "ReceivedMessage long address", longMessage, longSize );
+
+    std::cout << "\n";
+
+    // the addresses of a 64 track mixer, looking up the last track
+    std::vector<std::string> trackAddresses;
+    AddressInternTable trackTable;
+    for( int i=1; i <= 64; ++i ){
+        trackAddresses.push_back( "/track/" + std::to_string( i ) + "/volume" );
+        trackTable.Intern( trackAddresses.back().c_str() );
+    }
+    char trackMessage[capacity];
+    std::size_t trackSize = BuildMessage( trackMessage, capacity, "/track/64/volume" );
+    ReceivedMessage track( ReceivedPacket( trackMessage, trackSize ) );
+    BenchmarkAddressStrcmp( "address lookup, 64 addresses", track, trackAddresses );
+    BenchmarkAddressId( "address lookup, 64 addresses", track, trackTable );
+    BenchmarkRouteSscanf( "/track/{int}/volume", track );
+    BenchmarkRouteDispatcher( "/track/{int}/volume", track );
+
+    std::cout << "\n";
+
+    // 8 parameters for each of 64 tracks, matched against a pattern that
+    // selects one parameter of every track
+    static const char *parameters[] = { "volume", "pan", "mute", "solo", "arm", "phase", "width", "name" };
+    std::vector<std::string> methodAddresses;
+    AddressPatternMatcher cachedMatcher;
+    AddressPatternMatcher uncachedMatcher( 0 );
+    for( int i=1; i <= 64; ++i ){
+        for( std::size_t k=0; k < sizeof(parameters) / sizeof(parameters[0]); ++k ){
+            methodAddresses.push_back( "/track/" + std::to_string( i ) + "/" + parameters[k] );
+            cachedMatcher.AddMethod( methodAddresses.back().c_str() );
+            uncachedMatcher.AddMethod( methodAddresses.back().c_str() );
+        }
+    }
+    char patternMessage[capacity];
+    std::size_t patternSize = BuildMessage( patternMessage, capacity, "/track/*/mute" );
+    ReceivedMessage pattern( ReceivedPacket( patternMessage, patternSize ) );
+    BenchmarkPatternLinear( "/track/*/mute, 512 methods", pattern, methodAddresses );
+    BenchmarkPatternMatcher( "/track/*/mute, 512 methods", "trie", pattern, uncachedMatcher );
+    BenchmarkPatternMatcher( "/track/*/mute, 512 methods", "cached", pattern, cachedMatcher );
+
+    std::cout << "\n";
+
+    // one method for each of 512 tracks, matched against patterns that
+    // select a few of them. the trie only tests the tracks in the ranges
+    // selected by a part's literal prefix and set, all of them for '*'
+    std::vector<std::string> muteAddresses;
+    AddressPatternMatcher muteMatcher( 0 );
+    for( int i=1; i <= 512; ++i ){
+        muteAddresses.push_back( "/track/" + std::to_string( i ) + "/mute" );
+        muteMatcher.AddMethod( muteAddresses.back().c_str() );
+    }
+    static const char *trackPatterns[] = { "/track/*/mute", "/track/[12]/mute", "/track/4[01]/mute" };
+    for( std::size_t k=0; k < sizeof(trackPatterns) / sizeof(trackPatterns[0]); ++k ){
+        std::string name = std::string( trackPatterns[k] ) + ", 512 tracks";
+        char trackPatternMessage[capacity];
+        std::size_t trackPatternSize = BuildMessage( trackPatternMessage, capacity, trackPatterns[k] );
+        ReceivedMessage trackPattern( ReceivedPacket( trackPatternMessage, trackPatternSize ) );
+        BenchmarkPatternLinear( name.c_str(), trackPattern, muteAddresses );
+        BenchmarkPatternMatcher( name.c_str(), "trie", trackPattern, muteMatcher );
+    }
+
+    std::cout << "\n";
+
+    // truncating the type tags turns the message into junk that is only
+    // rejected after the address pattern has been scanned
+    char malformedMessage[capacity];
+    std::memcpy( malformedMessage, shortMessage, shortSize );
+    std::memset( malformedMessage + 16, 'f', shortSize - 16 );
+
+    BenchmarkThrowingParse( "valid message", shortMessage, shortSize );
+    BenchmarkTryParse( "valid message", shortMessage, shortSize );
+    BenchmarkThrowingParse( "malformed message", malformedMessage, shortSize );
+    BenchmarkTryParse( "malformed message", malformedMessage, shortSize );
+
+    std::cout << "\n";
+
+    const std::size_t bundleCapacity = 65536;
+    char *bundle = new char[bundleCapacity];
+
+    std::size_t smallBundleSize = BuildBundle( bundle, bundleCapacity, 8 );
+    BenchmarkBundleElements( "bundle of 8 messages", bundle, smallBundleSize, ITERATIONS / 10 );
+    BenchmarkBundleBatch( "bundle of 8 messages", bundle, smallBundleSize, ITERATIONS / 10 );
+
+    std::size_t largeBundleSize = BuildBundle( bundle, bundleCapacity, 512 );
+    BenchmarkBundleElements( "bundle of 512 messages", bundle, largeBundleSize, ITERATIONS / 500 );
+    BenchmarkBundleBatch( "bundle of 512 messages", bundle, largeBundleSize, ITERATIONS / 500 );
+
+    delete [] bundle;
+
+    std::cout << "\n";
+
+    // a meter update: one float array of 128 levels
+    const std::size_t meterCount = 128;
+    char meters[capacity];
+    OutboundPacketStream meterStream( meters, capacity );
+    meterStream << BeginMessage( "/meters" ) << BeginArray;
+    for( std::size_t i=0; i < meterCount; ++i )
+        meterStream << (float)i / meterCount;
+    meterStream << EndArray << EndMessage;
+
+    ReceivedMessage meterMessage( ReceivedPacket( meterStream.Data(), meterStream.Size() ) );
+    float levels[meterCount];
+    BenchmarkFloatArrayItems( "128 item float array", meterMessage, levels );
+    BenchmarkFloatArrayBulk( "128 item float array", meterMessage, levels, meterCount );
+
+    std::cout << "\n";
+
+    BenchmarkScheduledRelease( 0 );
+    BenchmarkScheduledRelease( 1500 );
+}
+
+} // namespace osc
+
+
+#ifndef NO_OSC_TEST_MAIN
+
+int main(int argc, char* argv[])
+{
+    (void)argc;
+    (void)argv;
+
+    osc::RunReceiveBenchmarks();
+}
+
+#endif
@@ -0,0 +1,816 @@
+/*
+	oscpack -- Open Sound Control (OSC) packet manipulation library
+    http://www.rossbencina.com/code/oscpack
+
+    Copyright (c) 2004-2013 Ross Bencina <rossb@audiomulch.com>
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files
+	(the "Software"), to deal in the Software without restriction,
+	including without limitation the rights to use, copy, modify, merge,
+	publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so,
+	subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+	ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+	WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	The text above constitutes the entire oscpack license; however, 
+	the oscpack developer(s) also make the following non-binding requests:
+
+	Any person wishing to distribute modifications to the Software is
+	requested to send the modifications to the original developer so that
+	they can be incorporated into the canonical version. It is also 
+	requested that these non-binding requests be included whenever the
+	above license is reproduced.
+*/
+#include "OscSocketBenchmarks.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "osc/OscOutboundPacketStream.h"
+#include "ip/UdpSocket.h"
+#include "ip/IpEndpointName.h"
+#include "ip/DatagramEndpoint.h"
+#include "ip/SharedMemoryRing.h"
+#include "ip/PacketBuffer.h"
+#include "ip/PacketListener.h"
+#include "ip/TimerWheel.h"
+
+namespace osc{
+
+// loopback ports used by the benchmark receivers
+static const int BASE_PORT = 7110;
+static const int SUBSCRIBER_COUNT = 4;
+static const int TRACK_COUNT = 32;
+
+static const int ITERATIONS = 2000;
+
+
+class BenchmarkTimer{
+    std::chrono::steady_clock::time_point start_;
+public:
+    BenchmarkTimer() : start_( std::chrono::steady_clock::now() ) {}
+
+    double ElapsedNanoseconds() const
+    {
+        return std::chrono::duration<double, std::nano>(
+                std::chrono::steady_clock::now() - start_ ).count();
+    }
+};
+
+
+static void PrintResult( const char *name, const char *variant, double totalNs, int iterations,
+        const char *unit="packet" )
+{
+    std::cout << std::left << std::setw(36) << name
+            << std::setw(12) << variant
+            << std::right << std::fixed << std::setprecision(2)
+            << std::setw(10) << (totalNs / iterations) << " ns/" << unit << "\n";
+}
+
+
+// one volume message per track, as the hub sends them
+static void BuildTrackMessages( std::vector< std::vector<char> >& messages )
+{
+    messages.resize( TRACK_COUNT );
+    for( int i=0; i < TRACK_COUNT; ++i ){
+        char address[64];
+        std::sprintf( address, "/track/%d/volume", i + 1 );
+
+        char buffer[128];
+        OutboundPacketStream p( buffer, sizeof(buffer) );
+        p << BeginMessage( address ) << (float)i / TRACK_COUNT << EndMessage;
+        messages[i].assign( p.Data(), p.Data() + p.Size() );
+    }
+}
+
+
+static void BenchmarkSendTo( const std::vector< std::vector<char> >& messages,
+        const std::vector<IpEndpointName>& subscribers )
+{
+    UdpSocket socket;
+
+    BenchmarkTimer t;
+    for( int j=0; j < ITERATIONS; ++j ){
+        for( std::size_t i=0; i < messages.size(); ++i ){
+            for( std::size_t k=0; k < subscribers.size(); ++k )
+                socket.SendTo( subscribers[k], &messages[i][0], messages[i].size() );
+        }
+    }
+    PrintResult( "track volumes to subscribers", "SendTo", t.ElapsedNanoseconds(),
+            ITERATIONS * (int)(messages.size() * subscribers.size()) );
+}
+
+
+static void BenchmarkSendBatch( const std::vector< std::vector<char> >& messages,
+        const std::vector<IpEndpointName>& subscribers )
+{
+    UdpSocket socket;
+    UdpSendBatch batch;
+
+    std::size_t failed = 0;
+    BenchmarkTimer t;
+    for( int j=0; j < ITERATIONS; ++j ){
+        batch.Clear();
+        for( std::size_t i=0; i < messages.size(); ++i ){
+            for( std::size_t k=0; k < subscribers.size(); ++k )
+                batch.Add( subscribers[k], &messages[i][0], messages[i].size() );
+        }
+        failed += batch.Size() - socket.SendBatch( batch );
+    }
+    PrintResult( "track volumes to subscribers", "batch", t.ElapsedNanoseconds(),
+            ITERATIONS * (int)(messages.size() * subscribers.size()) );
+
+    if( failed )
+        std::cout << "    " << failed << " packets failed to send\n";
+}
+
+
+static void BenchmarkConnectedSend( const std::vector< std::vector<char> >& messages,
+        const IpEndpointName& subscriber )
+{
+    UdpTransmitSocket socket( subscriber );
+
+    BenchmarkTimer t;
+    for( int j=0; j < ITERATIONS; ++j ){
+        for( std::size_t i=0; i < messages.size(); ++i )
+            socket.Send( &messages[i][0], messages[i].size() );
+    }
+    PrintResult( "track volumes to connected socket", "Send", t.ElapsedNanoseconds(),
+            ITERATIONS * (int)messages.size() );
+
+    UdpSendBatch batch;
+    for( std::size_t i=0; i < messages.size(); ++i )
+        batch.Add( &messages[i][0], messages[i].size() );
+
+    BenchmarkTimer bt;
+    for( int j=0; j < ITERATIONS; ++j )
+        socket.SendBatch( batch );
+    PrintResult( "track volumes to connected socket", "batch", bt.ElapsedNanoseconds(),
+            ITERATIONS * (int)messages.size() );
+}
+
+
+class BurstCountingListener : public PacketListener{
+    SocketReceiveMultiplexer& mux_;
+public:
+    BurstCountingListener( SocketReceiveMultiplexer& mux )
+        : mux_( mux ), expected( 0 ), received( 0 ) {}
+
+    int expected;
+    int received;
+
+    virtual void ProcessPacket( const char *data, int size, const IpEndpointName& remoteEndpoint )
+    {
+        (void)data;
+        (void)size;
+        (void)remoteEndpoint;
+        Count();
+    }
+
+    virtual void ProcessPacketBatch( const ReceivedDatagram *datagrams, int count )
+    {
+        (void)datagrams;
+        for( int i=0; i < count; ++i )
+            Count();
+    }
+
+private:
+    void Count()
+    {
+        if( ++received == expected )
+            mux_.Break();
+    }
+};
+
+
+static const char *BackendName( SocketReceiveMultiplexer::Backend backend )
+{
+    switch( backend ){
+        case SocketReceiveMultiplexer::SELECT_BACKEND: return "select";
+        case SocketReceiveMultiplexer::EPOLL_BACKEND: return "epoll";
+        case SocketReceiveMultiplexer::IO_URING_BACKEND: return "io_uring";
+        default: return "default";
+    }
+}
+
+
+// a burst of packets is queued on the receive socket, then drained by
+// the multiplexer. the idle sockets are attached but never receive. with
+// io_uring the packets are copied into the ring's buffers during the send,
+// so only the delivery is timed.
+static void BenchmarkReceiveBurst( const std::vector< std::vector<char> >& messages,
+        SocketReceiveMultiplexer::Backend backend, int batchSize, int idleSocketCount )
+{
+    // small enough to fit in the default socket receive buffer, since a
+    // dropped packet would leave Run() waiting
+    const int BURST_ROUNDS = 2;
+    const int burstSize = BURST_ROUNDS * (int)messages.size();
+    const int rounds = ITERATIONS / 20;
+
+    IpEndpointName endpoint( "127.0.0.1", BASE_PORT + SUBSCRIBER_COUNT );
+    UdpReceiveSocket receiveSocket( endpoint );
+    UdpTransmitSocket transmitSocket( endpoint );
+
+    UdpSendBatch burst;
+    for( int k=0; k < BURST_ROUNDS; ++k ){
+        for( std::size_t i=0; i < messages.size(); ++i )
+            burst.Add( &messages[i][0], messages[i].size() );
+    }
+
+    SocketReceiveMultiplexer mux( backend );
+    mux.SetReceiveBatchSize( batchSize );
+    BurstCountingListener listener( mux );
+
+    std::vector<UdpReceiveSocket*> idleSockets;
+    for( int i=0; i < idleSocketCount; ++i ){
+        idleSockets.push_back( new UdpReceiveSocket( IpEndpointName( "127.0.0.1", IpEndpointName::ANY_PORT ) ) );
+        mux.AttachSocketListener( idleSockets.back(), &listener );
+    }
+    mux.AttachSocketListener( &receiveSocket, &listener );
+
+    double totalNs = 0;
+    for( int j=0; j < rounds; ++j ){
+        transmitSocket.SendBatch( burst );
+        listener.expected = listener.received + burstSize;
+
+        BenchmarkTimer t;
+        mux.Run();
+        totalNs += t.ElapsedNanoseconds();
+    }
+
+    char name[64];
+    std::sprintf( name, "receive burst, %d idle sockets", idleSocketCount );
+    char variant[32];
+    std::sprintf( variant, "%s/%d", BackendName( mux.GetBackend() ), batchSize );
+    PrintResult( name, variant, totalNs, listener.received );
+
+    mux.DetachSocketListener( &receiveSocket, &listener );
+    for( std::size_t i=0; i < idleSockets.size(); ++i ){
+        mux.DetachSocketListener( idleSockets[i], &listener );
+        delete idleSockets[i];
+    }
+}
+
+
+// keeps every packet it receives, either with a PacketHandle or by
+// copying it, as a listener that hands packets to another thread would
+class KeepingListener : public PacketListener{
+    SocketReceiveMultiplexer& mux_;
+public:
+    KeepingListener( SocketReceiveMultiplexer& mux, bool useHandles )
+        : mux_( mux ), useHandles_( useHandles ), expected( 0 ), received( 0 ) {}
+
+    bool useHandles_;
+    int expected;
+    int received;
+    std::vector<PacketHandle> handles;
+    std::vector< std::vector<char> > copies;
+
+    virtual void ProcessPacket( const char *data, int size, const IpEndpointName& remoteEndpoint )
+    {
+        (void)data;
+        (void)size;
+        (void)remoteEndpoint;
+    }
+
+    virtual void ProcessPacketBatch( const ReceivedDatagram *datagrams, int count )
+    {
+        for( int i=0; i < count; ++i ){
+            if( useHandles_ )
+                handles.push_back( PacketHandle( datagrams[i] ) );
+            else
+                copies.push_back( std::vector<char>( datagrams[i].data, datagrams[i].data + datagrams[i].size ) );
+        }
+        received += count;
+        if( received == expected )
+            mux_.Break();
+    }
+};
+
+
+// like BenchmarkReceiveBurst(), with the listener keeping the packets
+// until the burst has been received
+static void BenchmarkKeepPackets( const std::vector< std::vector<char> >& messages,
+        SocketReceiveMultiplexer::Backend backend, bool useHandles )
+{
+    const int BURST_ROUNDS = 2;
+    const int burstSize = BURST_ROUNDS * (int)messages.size();
+    const int rounds = ITERATIONS / 20;
+
+    IpEndpointName endpoint( "127.0.0.1", BASE_PORT + SUBSCRIBER_COUNT );
+    UdpReceiveSocket receiveSocket( endpoint );
+    UdpTransmitSocket transmitSocket( endpoint );
+
+    UdpSendBatch burst;
+    for( int k=0; k < BURST_ROUNDS; ++k ){
+        for( std::size_t i=0; i < messages.size(); ++i )
+            burst.Add( &messages[i][0], messages[i].size() );
+    }
+
+    SocketReceiveMultiplexer mux( backend );
+    mux.SetReceiveBatchSize( 8 );
+    KeepingListener listener( mux, useHandles );
+    listener.handles.reserve( burstSize );
+    listener.copies.reserve( burstSize );
+    mux.AttachSocketListener( &receiveSocket, &listener );
+
+    double totalNs = 0;
+    for( int j=0; j < rounds; ++j ){
+        transmitSocket.SendBatch( burst );
+        listener.expected = listener.received + burstSize;
+
+        // the packets are released at the end of each round, which is timed
+        // too since it returns the buffers to the pool
+        BenchmarkTimer t;
+        mux.Run();
+        listener.handles.clear();
+        listener.copies.clear();
+        totalNs += t.ElapsedNanoseconds();
+    }
+
+    char variant[32];
+    std::sprintf( variant, "%s/%s", BackendName( mux.GetBackend() ), (useHandles) ? "handle" : "copy" );
+    PrintResult( "receive burst, keeping packets", variant, totalNs, listener.received );
+
+    mux.DetachSocketListener( &receiveSocket, &listener );
+}
+
+
+// measures how long each packet waited between arriving at the socket
+// and reaching the listener, from the kernel's receive timestamps
+class QueueingDelayListener : public PacketListener{
+    SocketReceiveMultiplexer& mux_;
+public:
+    QueueingDelayListener( SocketReceiveMultiplexer& mux )
+        : mux_( mux ), expected( 0 ), received( 0 ), totalDelayNs( 0 ), maxDelayNs( 0 ) {}
+
+    int expected;
+    int received;
+    double totalDelayNs;
+    double maxDelayNs;
+
+    virtual void ProcessPacket( const char *data, int size, const IpEndpointName& remoteEndpoint )
+    {
+        ProcessTimestampedPacket( data, size, remoteEndpoint, PacketTimestamp() );
+    }
+
+    virtual void ProcessTimestampedPacket( const char *data, int size,
+            const IpEndpointName& remoteEndpoint, const PacketTimestamp& timestamp )
+    {
+        (void)data;
+        (void)size;
+        (void)remoteEndpoint;
+
+        if( timestamp.softwareNs != 0 ){
+            // system_clock is the same clock as the timestamps
+            double nowNs = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::system_clock::now().time_since_epoch() ).count();
+            double delayNs = nowNs - (double)timestamp.softwareNs;
+            totalDelayNs += delayNs;
+            if( delayNs > maxDelayNs )
+                maxDelayNs = delayNs;
+        }
+
+        if( ++received == expected )
+            mux_.Break();
+    }
+};
+
+
+// the time the packets of a burst spend queued on the socket before their
+// listener sees them. the whole burst is sent before Run(), so this
+// includes the rest of the send, and the later packets also wait for the
+// earlier ones to be delivered.
+static void BenchmarkQueueingDelay( const std::vector< std::vector<char> >& messages,
+        SocketReceiveMultiplexer::Backend backend, int batchSize )
+{
+    const int BURST_ROUNDS = 2;
+    const int burstSize = BURST_ROUNDS * (int)messages.size();
+    const int rounds = ITERATIONS / 20;
+
+    IpEndpointName endpoint( "127.0.0.1", BASE_PORT + SUBSCRIBER_COUNT );
+    UdpReceiveSocket receiveSocket( endpoint );
+    receiveSocket.SetEnableTimestamps( true );
+    UdpTransmitSocket transmitSocket( endpoint );
+
+    UdpSendBatch burst;
+    for( int k=0; k < BURST_ROUNDS; ++k ){
+        for( std::size_t i=0; i < messages.size(); ++i )
+            burst.Add( &messages[i][0], messages[i].size() );
+    }
+
+    SocketReceiveMultiplexer mux( backend );
+    mux.SetReceiveBatchSize( batchSize );
+    QueueingDelayListener listener( mux );
+    mux.AttachSocketListener( &receiveSocket, &listener );
+
+    for( int j=0; j < rounds; ++j ){
+        transmitSocket.SendBatch( burst );
+        listener.expected = listener.received + burstSize;
+        mux.Run();
+    }
+
+    char variant[32];
+    std::sprintf( variant, "%s/%d", BackendName( mux.GetBackend() ), batchSize );
+    PrintResult( "queueing delay, mean", variant, listener.totalDelayNs, listener.received );
+    PrintResult( "queueing delay, max", variant, listener.maxDelayNs, 1 );
+
+    mux.DetachSocketListener( &receiveSocket, &listener );
+}
+
+
+// a message sent to an echo thread and back, one at a time, as between the
+// hub and the GUI. "there" and "back" are the endpoints each way.
+static void BenchmarkRoundTrip( const std::vector<char>& message,
+        const char *there, const char *back, const char *variant )
+{
+    DatagramEndpoint thereEndpoint = DatagramEndpoint::FromString( there );
+    DatagramEndpoint backEndpoint = DatagramEndpoint::FromString( back );
+
+    // the receive sockets are bound before the transmit sockets connect,
+    // which local sockets need
+    UdpSocket *echoReceiveSocket = thereEndpoint.CreateReceiveSocket();
+    UdpSocket *receiveSocket = backEndpoint.CreateReceiveSocket();
+    UdpSocket *transmitSocket = thereEndpoint.CreateTransmitSocket();
+    UdpSocket *echoTransmitSocket = backEndpoint.CreateTransmitSocket();
+
+    const int iterations = ITERATIONS;
+
+    std::thread echo( [&]{
+        char buffer[ 256 ];
+        IpEndpointName remoteEndpoint;
+        for( int i=0; i < iterations; ++i ){
+            std::size_t size = echoReceiveSocket->ReceiveFrom( remoteEndpoint, buffer, sizeof(buffer) );
+            echoTransmitSocket->Send( buffer, size );
+        }
+    } );
+
+    char buffer[ 256 ];
+    IpEndpointName remoteEndpoint;
+    BenchmarkTimer t;
+    for( int i=0; i < iterations; ++i ){
+        transmitSocket->Send( &message[0], message.size() );
+        receiveSocket->ReceiveFrom( remoteEndpoint, buffer, sizeof(buffer) );
+    }
+    double totalNs = t.ElapsedNanoseconds();
+    echo.join();
+
+    PrintResult( "track volume round trip", variant, totalNs, iterations, "round trip" );
+
+    delete echoTransmitSocket;
+    delete transmitSocket;
+    delete receiveSocket;
+    delete echoReceiveSocket;
+}
+
+
+// echoes each packet back through another socket
+class EchoListener : public PacketListener{
+    UdpSocket& echoSocket_;
+public:
+    EchoListener( UdpSocket& echoSocket ) : echoSocket_( echoSocket ) {}
+
+    virtual void ProcessPacket( const char *data, int size, const IpEndpointName& remoteEndpoint )
+    {
+        (void)remoteEndpoint;
+        echoSocket_.Send( data, size );
+    }
+};
+
+
+static const char *WaitStrategyName( SocketReceiveMultiplexer::WaitStrategy strategy )
+{
+    switch( strategy ){
+        case SocketReceiveMultiplexer::SPIN_THEN_BLOCK_WAIT: return "spin";
+        case SocketReceiveMultiplexer::BUSY_POLL_WAIT: return "busy";
+        default: return "block";
+    }
+}
+
+
+// like BenchmarkRoundTrip(), with the echo side run by a multiplexer with
+// the given wait strategy. the packets arrive at intervals, as fader moves
+// would, so a blocking multiplexer has gone to sleep before each one.
+static void BenchmarkWaitStrategy( const std::vector<char>& message,
+        SocketReceiveMultiplexer::Backend backend, SocketReceiveMultiplexer::WaitStrategy strategy )
+{
+    // spinning or busy polling on the only processor would starve the
+    // sending thread
+    if( strategy != SocketReceiveMultiplexer::BLOCKING_WAIT && std::thread::hardware_concurrency() < 2 )
+        return;
+
+    IpEndpointName there( "127.0.0.1", BASE_PORT + SUBSCRIBER_COUNT );
+    IpEndpointName back( "127.0.0.1", BASE_PORT + SUBSCRIBER_COUNT + 1 );
+    UdpReceiveSocket echoReceiveSocket( there );
+    UdpReceiveSocket receiveSocket( back );
+    UdpTransmitSocket transmitSocket( there );
+    UdpTransmitSocket echoTransmitSocket( back );
+
+    SocketReceiveMultiplexer mux( backend );
+    mux.SetWaitStrategy( strategy, 200 );
+    EchoListener echoListener( echoTransmitSocket );
+    mux.AttachSocketListener( &echoReceiveSocket, &echoListener );
+    std::thread echo( [&]{ mux.Run(); } );
+
+    const int iterations = ITERATIONS / 4;
+    char buffer[ 256 ];
+    IpEndpointName remoteEndpoint;
+    double totalNs = 0;
+    for( int i=0; i < iterations; ++i ){
+        std::this_thread::sleep_for( std::chrono::microseconds( 100 ) );
+
+        BenchmarkTimer t;
+        transmitSocket.Send( &message[0], message.size() );
+        receiveSocket.ReceiveFrom( remoteEndpoint, buffer, sizeof(buffer) );
+        totalNs += t.ElapsedNanoseconds();
+    }
+
+    mux.AsynchronousBreak();
+    echo.join();
+    mux.DetachSocketListener( &echoReceiveSocket, &echoListener );
+
+    char variant[32];
+    std::sprintf( variant, "%s/%s", BackendName( mux.GetBackend() ), WaitStrategyName( strategy ) );
+    PrintResult( "multiplexer echo round trip", variant, totalNs, iterations, "round trip" );
+}
+
+
+#ifdef __linux__
+
+// counts the packets from a shared memory ring, and optionally echoes
+// them into another ring or breaks once one has arrived
+class RingListener : public PacketListener{
+public:
+    RingListener()
+        : receiver( 0 ), echoTransmitter( 0 ), breakOnPacket( false ), received( 0 ) {}
+
+    SharedMemoryRingReceiver *receiver;
+    SharedMemoryRingTransmitter *echoTransmitter;
+    bool breakOnPacket;
+    int received;
+
+    virtual void ProcessPacket( const char *data, int size, const IpEndpointName& remoteEndpoint )
+    {
+        (void)remoteEndpoint;
+        ++received;
+        if( echoTransmitter )
+            echoTransmitter->Send( data, size );
+        if( breakOnPacket )
+            receiver->Break();
+    }
+};
+
+
+// the track volumes sent through a ring and received on the same thread,
+// a burst at a time so that the ring doesn't overrun
+static void BenchmarkSharedMemoryRing( const std::vector< std::vector<char> >& messages )
+{
+    SharedMemoryRingTransmitter transmitter;
+    RingListener listener;
+    SharedMemoryRingReceiver receiver( transmitter.FileDescriptor(), &listener );
+
+    double sendNs = 0;
+    double receiveNs = 0;
+    for( int j=0; j < ITERATIONS; ++j ){
+        BenchmarkTimer st;
+        for( std::size_t i=0; i < messages.size(); ++i )
+            transmitter.Send( &messages[i][0], messages[i].size() );
+        sendNs += st.ElapsedNanoseconds();
+
+        BenchmarkTimer rt;
+        receiver.ReceivePackets();
+        receiveNs += rt.ElapsedNanoseconds();
+    }
+
+    int count = ITERATIONS * (int)messages.size();
+    PrintResult( "track volumes through shared memory", "send", sendNs, count );
+    PrintResult( "track volumes through shared memory", "receive", receiveNs, listener.received );
+}
+
+
+// like BenchmarkRoundTrip(), with a ring each way
+static void BenchmarkSharedMemoryRoundTrip( const std::vector<char>& message )
+{
+    SharedMemoryRingTransmitter there;
+    SharedMemoryRingTransmitter back;
+
+    RingListener echoListener;
+    SharedMemoryRingReceiver echoReceiver( there.FileDescriptor(), &echoListener );
+    echoListener.echoTransmitter = &back;
+
+    RingListener listener;
+    SharedMemoryRingReceiver receiver( back.FileDescriptor(), &listener );
+    listener.receiver = &receiver;
+    listener.breakOnPacket = true;
+
+    std::thread echo( [&]{ echoReceiver.Run(); } );
+
+    const int iterations = ITERATIONS;
+    BenchmarkTimer t;
+    for( int i=0; i < iterations; ++i ){
+        there.Send( &message[0], message.size() );
+        receiver.Run();
+    }
+    double totalNs = t.ElapsedNanoseconds();
+
+    echoReceiver.AsynchronousBreak();
+    echo.join();
+
+    PrintResult( "track volume round trip", "shm", totalNs, iterations, "round trip" );
+}
+
+#endif /* __linux__ */
+
+
+// the multiplexer's timer bookkeeping, on a simulated clock that advances
+// by STEP_NS per wait. "sort" is the sorted vector that the timer wheel
+// replaced.
+static const int TIMER_COUNT = 500;
+static const uint64_t TIMER_STEP_NS = 100000;
+static const int TIMER_STEPS = 100000;
+
+static int TimerPeriodMs( int i )
+{
+    return 1 + (i * 37) % 500;
+}
+
+
+static void BenchmarkTimerWheel()
+{
+    TimerWheel wheel;
+    std::vector<TimerWheel::Timer*> timers;
+    uint64_t now = 0;
+    wheel.Clear( now );
+    for( int i=0; i < TIMER_COUNT; ++i ){
+        timers.push_back( new TimerWheel::Timer( TimerPeriodMs( i ), TimerPeriodMs( i ), 0 ) );
+        timers.back()->expiryNs = (uint64_t)TimerPeriodMs( i ) * 1000000;
+        wheel.Schedule( timers.back() );
+    }
+
+    int expiries = 0;
+    int64_t timeoutNs = 0;
+    BenchmarkTimer t;
+    for( int j=0; j < TIMER_STEPS; ++j ){
+        now += TIMER_STEP_NS;
+        wheel.CollectExpired( now );
+        for( TimerWheel::Timer *timer = wheel.PopExpired(); timer != 0; timer = wheel.PopExpired() ){
+            timer->expiryNs += (uint64_t)timer->periodMs * 1000000;
+            wheel.Schedule( timer );
+            ++expiries;
+        }
+        timeoutNs += wheel.NanosecondsUntilNextExpiry( now );
+    }
+    PrintResult( "500 periodic timers", "wheel", t.ElapsedNanoseconds(), expiries, "expiry" );
+
+    for( std::size_t i=0; i < timers.size(); ++i )
+        delete timers[i];
+}
+
+
+static void BenchmarkTimerSort()
+{
+    // expiry time ns, period ms
+    std::vector< std::pair< uint64_t, int > > queue;
+    uint64_t now = 0;
+    for( int i=0; i < TIMER_COUNT; ++i )
+        queue.push_back( std::make_pair( (uint64_t)TimerPeriodMs( i ) * 1000000, TimerPeriodMs( i ) ) );
+    std::sort( queue.begin(), queue.end() );
+
+    int expiries = 0;
+    int64_t timeoutNs = 0;
+    BenchmarkTimer t;
+    for( int j=0; j < TIMER_STEPS; ++j ){
+        now += TIMER_STEP_NS;
+        bool resort = false;
+        for( std::vector< std::pair< uint64_t, int > >::iterator i = queue.begin();
+                i != queue.end() && i->first <= now; ++i ){
+            i->first += (uint64_t)i->second * 1000000;
+            resort = true;
+            ++expiries;
+        }
+        if( resort )
+            std::sort( queue.begin(), queue.end() );
+        timeoutNs += (int64_t)(queue.front().first - now);
+    }
+    PrintResult( "500 periodic timers", "sort", t.ElapsedNanoseconds(), expiries, "expiry" );
+}
+
+
+void RunSocketBenchmarks()
+{
+    std::vector< std::vector<char> > messages;
+    BuildTrackMessages( messages );
+
+    // the receivers are never read, so once their buffers are full the
+    // packets are dropped. the sends still go through the whole stack.
+    std::vector<UdpReceiveSocket*> receivers;
+    std::vector<IpEndpointName> subscribers;
+    for( int i=0; i < SUBSCRIBER_COUNT; ++i ){
+        IpEndpointName endpoint( "127.0.0.1", BASE_PORT + i );
+        receivers.push_back( new UdpReceiveSocket( endpoint ) );
+        subscribers.push_back( endpoint );
+    }
+
+    std::cout << TRACK_COUNT << " tracks, " << SUBSCRIBER_COUNT << " subscribers\n\n";
+
+    BenchmarkSendTo( messages, subscribers );
+    BenchmarkSendBatch( messages, subscribers );
+    BenchmarkConnectedSend( messages, subscribers[0] );
+
+    std::cout << "\n";
+
+    const SocketReceiveMultiplexer::Backend backends[] = {
+            SocketReceiveMultiplexer::SELECT_BACKEND, SocketReceiveMultiplexer::EPOLL_BACKEND,
+            SocketReceiveMultiplexer::IO_URING_BACKEND };
+    const int batchSizes[] = { 1, 8, 64 };
+    for( int idleSocketCount=0; idleSocketCount <= 256; idleSocketCount += 256 ){
+        for( std::size_t i=0; i < sizeof(backends) / sizeof(backends[0]); ++i ){
+            for( std::size_t j=0; j < sizeof(batchSizes) / sizeof(batchSizes[0]); ++j )
+                BenchmarkReceiveBurst( messages, backends[i], batchSizes[j], idleSocketCount );
+        }
+    }
+
+    std::cout << "\n";
+
+    for( std::size_t i=0; i < sizeof(backends) / sizeof(backends[0]); ++i ){
+        for( std::size_t j=0; j < sizeof(batchSizes) / sizeof(batchSizes[0]); j += 2 )
+            BenchmarkQueueingDelay( messages, backends[i], batchSizes[j] );
+    }
+
+    std::cout << "\n";
+
+    for( std::size_t i=0; i < sizeof(backends) / sizeof(backends[0]); ++i ){
+        BenchmarkKeepPackets( messages, backends[i], false );
+        BenchmarkKeepPackets( messages, backends[i], true );
+    }
+
+    std::cout << "\n";
+
+    BenchmarkTimerSort();
+    BenchmarkTimerWheel();
+
+    std::cout << "\n";
+
+    char there[32];
+    char back[32];
+    std::sprintf( there, "udp:127.0.0.1:%d", BASE_PORT + SUBSCRIBER_COUNT );
+    std::sprintf( back, "udp:127.0.0.1:%d", BASE_PORT + SUBSCRIBER_COUNT + 1 );
+    BenchmarkRoundTrip( messages[0], there, back, "udp" );
+
+    const SocketReceiveMultiplexer::WaitStrategy strategies[] = {
+            SocketReceiveMultiplexer::BLOCKING_WAIT, SocketReceiveMultiplexer::SPIN_THEN_BLOCK_WAIT,
+            SocketReceiveMultiplexer::BUSY_POLL_WAIT };
+    for( std::size_t i=0; i < sizeof(backends) / sizeof(backends[0]); ++i ){
+        for( std::size_t j=0; j < sizeof(strategies) / sizeof(strategies[0]); ++j )
+            BenchmarkWaitStrategy( messages[0], backends[i], strategies[j] );
+    }
+#if defined(__linux__)
+    BenchmarkRoundTrip( messages[0], "local:@oscpack-benchmark-there",
+            "local:@oscpack-benchmark-back", "local" );
+    BenchmarkSharedMemoryRoundTrip( messages[0] );
+
+    std::cout << "\n";
+
+    BenchmarkSharedMemoryRing( messages );
+#elif !defined(WIN32)
+    BenchmarkRoundTrip( messages[0], "local:/tmp/oscpack-benchmark-there",
+            "local:/tmp/oscpack-benchmark-back", "local" );
+#endif
+
+    for( std::size_t i=0; i < receivers.size(); ++i )
+        delete receivers[i];
+}
+
+} // namespace osc
+
+
+#ifndef NO_OSC_TEST_MAIN
+
+int main(int argc, char* argv[])
+{
+    (void)argc;
+    (void)argv;
+
+    osc::RunSocketBenchmarks();
+}
+
+#endif
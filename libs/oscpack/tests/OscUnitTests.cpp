@@ -36,13 +36,42 @@
 */
 #include "OscUnitTests.h"
 
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdio>
 #include <cstring>
 #include <iomanip>
 #include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include "osc/OscReceivedElements.h"
+#include "osc/OscReceivedBatch.h"
+#include "osc/OscAddressInternTable.h"
+#include "osc/OscAddressPatternMatcher.h"
+#include "osc/MessageMappingOscPacketListener.h"
+#include "osc/OscRouteDispatcher.h"
 #include "osc/OscPrintReceivedElements.h"
 #include "osc/OscOutboundPacketStream.h"
+#include "osc/OscMessageTemplate.h"
+#include "osc/OscStaticAddress.h"
+#include "osc/OscMessageDecoder.h"
+#include "osc/OscSimd.h"
+#include "osc/OscTimeTag.h"
+#include "osc/ScheduledOscPacketListener.h"
+
+#include "ip/UdpSocket.h"
+#include "ip/LocalDatagramSocket.h"
+#include "ip/DatagramEndpoint.h"
+#include "ip/PacketBuffer.h"
+#include "ip/SharedMemoryRing.h"
+#include "ip/PacketListener.h"
+#include "ip/TimerListener.h"
+#include "ip/TimerWheel.h"
 
 #if defined(__BORLANDC__) // workaround for BCB4 release build intrinsics bug
 namespace std {
@@ -435,12 +464,2586 @@ void test3()
     }
 }
 
+//-----------------------------------------------------------------------
+
+// check that every available FindStr4End kernel agrees with the scalar one
+// for terminators at every position within and across vector blocks
+
+void test4()
+{
+    static const SimdInstructionSet sets[] = { SIMD_SCALAR, SIMD_SSE2, SIMD_AVX2 };
+
+    const int bufferSize = 96;
+    char *buffer = AllocateAligned4( bufferSize );
+
+    for( std::size_t i=0; i < sizeof(sets) / sizeof(sets[0]); ++i ){
+        FindStr4EndFunction f = FindStr4EndFunctionFor( sets[i] );
+        if( !f )
+            continue;
+
+        std::cout << "testing FindStr4End kernel: " << SimdInstructionSetName( sets[i] ) << "\n";
+
+        bool allCorrect = true;
+        for( int length = 1; length < bufferSize; ++length ){
+            // a correctly padded string of the given length
+            std::memset( buffer, 'x', bufferSize );
+            int paddedLength = (length + 4) & ~0x03;
+            std::memset( buffer + length, 0, (paddedLength <= bufferSize ? paddedLength : bufferSize) - length );
+
+            const char *expected = ( paddedLength <= bufferSize ) ? buffer + paddedLength : 0;
+            if( f( buffer, buffer + bufferSize ) != expected )
+                allCorrect = false;
+
+            // the same string must be rejected if end cuts off the terminator
+            int truncatedEnd = length & ~0x03;
+            if( truncatedEnd > 0 && f( buffer, buffer + truncatedEnd ) != 0 )
+                allCorrect = false;
+
+            // non-zero bytes in the padding must be rejected
+            if( paddedLength <= bufferSize && paddedLength - length > 1 ){
+                buffer[ paddedLength - 1 ] = 'y';
+                if( f( buffer, buffer + bufferSize ) != 0 )
+                    allCorrect = false;
+            }
+        }
+        assertEqual( allCorrect, true );
+
+        // supercollider integer address patterns begin with '\0'
+        std::memset( buffer, 0, bufferSize );
+        buffer[3] = 0x01;
+        assertEqual( (f( buffer, buffer + bufferSize ) == buffer + 4), true );
+        assertEqual( (f( buffer, buffer ) == 0), true );
+    }
+
+    bool exceptionThrown = false;
+    try{
+        //            0123012 3 012 3 0 1 2 3
+        const char s[] = "/bad\0x\0\0,i\0\0\0\0\0\x1";
+        ReceivedMessage m( ReceivedPacket( NewMessageBuffer( s, sizeof(s)-1 ), sizeof(s)-1 ) );
+    }catch( MalformedMessageException& ){
+        exceptionThrown = true;
+    }
+    assertEqual( exceptionThrown, true );
+}
+
+
+//-----------------------------------------------------------------------
+
+// random access to arguments through ReceivedMessage::ArgumentAt
+
+void test5()
+{
+    int bufferSize = 1000;
+    char *buffer = AllocateAligned4( bufferSize );
+
+    // enough arguments to exceed the inline argument index
+    for( int argumentCount = 1; argumentCount < 40; argumentCount += 19 ){
+        OutboundPacketStream ps( buffer, bufferSize );
+        ps << BeginMessage( "/indexed" );
+        for( int i=0; i < argumentCount; ++i ){
+            if( i % 3 == 0 )
+                ps << (int32)i;
+            else if( i % 3 == 1 )
+                ps << "a string argument";
+            else
+                ps << (double)i;
+        }
+        ps << EndMessage;
+
+        ReceivedMessage original( ReceivedPacket(ps.Data(), ps.Size()) );
+        ReceivedMessage m( original ); // the index must survive copying
+        assertEqual( m.ArgumentCount(), (uint32)argumentCount );
+
+        bool allEqual = true;
+        uint32 j = 0;
+        for( ReceivedMessage::const_iterator i = m.ArgumentsBegin(); i != m.ArgumentsEnd(); ++i, ++j ){
+            ReceivedMessageArgument a = m.ArgumentAt( j );
+            if( a.TypeTag() != i->TypeTag() )
+                allEqual = false;
+            else if( a.IsInt32() && a.AsInt32() != i->AsInt32() )
+                allEqual = false;
+            else if( a.IsString() && std::strcmp( a.AsString(), i->AsString() ) != 0 )
+                allEqual = false;
+            else if( a.IsDouble() && a.AsDouble() != i->AsDouble() )
+                allEqual = false;
+        }
+        assertEqual( allEqual, true );
+        assertEqual( j, (uint32)argumentCount );
+
+        bool exceptionThrown = false;
+        try{
+            m.ArgumentAt( m.ArgumentCount() );
+        }catch( MissingArgumentException& ){
+            exceptionThrown = true;
+        }
+        assertEqual( exceptionThrown, true );
+    }
+}
+
+
+//-----------------------------------------------------------------------
+
+// typed decoding with TryDecode and Decode
+
+void test6()
+{
+    int bufferSize = 1000;
+    char *buffer = AllocateAligned4( bufferSize );
+
+    assertEqual( std::strcmp( TypeTagString<int32, float, const char*, double>::value, "ifsd" ), 0 );
+
+    OutboundPacketStream ps( buffer, bufferSize );
+    ps << BeginMessage( "/track/3/volume" ) << (int32)3 << 0.75f << "name" << 2.5 << EndMessage;
+    ReceivedMessage m( ReceivedPacket(ps.Data(), ps.Size()) );
+
+    int32 track = 0;
+    float volume = 0.f;
+    const char *name = 0;
+    double d = 0.;
+    assertEqual( TryDecode( m, track, volume, name, d ), true );
+    assertEqual( track, (int32)3 );
+    assertEqual( volume, 0.75f );
+    assertEqual( std::strcmp( name, "name" ), 0 );
+    assertEqual( d, 2.5 );
+
+    // wrong types or argument count leave the outputs unchanged
+    float f1 = 1.f, f2 = 2.f;
+    assertEqual( TryDecode( m, f1, f2 ), false );
+    assertEqual( f1, 1.f );
+    assertEqual( TryDecode( m, track, volume, name, f1 ), false );
+
+    std::tuple<int32, float, const char*, double> t = Decode<int32, float, const char*, double>( m );
+    assertEqual( std::get<0>( t ), (int32)3 );
+    assertEqual( std::get<1>( t ), 0.75f );
+
+    bool exceptionThrown = false;
+    try{
+        Decode<int32, float, const char*>( m );
+    }catch( ExcessArgumentException& ){
+        exceptionThrown = true;
+    }
+    assertEqual( exceptionThrown, true );
+
+    exceptionThrown = false;
+    try{
+        Decode<int32, float, const char*, float>( m );
+    }catch( WrongArgumentTypeException& ){
+        exceptionThrown = true;
+    }
+    assertEqual( exceptionThrown, true );
+
+    // repeated types and a message without arguments
+    ps.Clear();
+    ps << BeginMessage( "/pair" ) << 1.f << 2.f << EndMessage;
+    ReceivedMessage pair( ReceivedPacket(ps.Data(), ps.Size()) );
+    std::tuple<float, float> p = Decode<float, float>( pair );
+    assertEqual( std::get<1>( p ), 2.f );
+
+    ps.Clear();
+    ps << BeginMessage( "/empty" ) << EndMessage;
+    ReceivedMessage empty( ReceivedPacket(ps.Data(), ps.Size()) );
+    assertEqual( TryDecode( empty ), true );
+    assertEqual( TryDecode( empty, f1 ), false );
+}
+
+
+//-----------------------------------------------------------------------
+
+// the non-throwing TryParse interface
+
+#define TEST_TRY_PARSE_MESSAGE( ss, expectedError )\
+    {\
+        const char s[] = ss;\
+        ReceivedPacket p;\
+        assertEqual( ReceivedPacket::TryParse( NewMessageBuffer( s, sizeof(s)-1 ), sizeof(s)-1, p ), PARSE_OK );\
+        ReceivedMessage m;\
+        assertEqual( ReceivedMessage::TryParse( p, m ), expectedError );\
+    }
+
+void test7()
+{
+    //                      01230123 012 3 0 1 2 3
+    TEST_TRY_PARSE_MESSAGE( "/an_int\0,i\0\0\0\0\0A", PARSE_OK );
+    TEST_TRY_PARSE_MESSAGE( "/a_char\0,x\0\0\0\0\0A", PARSE_UNKNOWN_TYPE_TAG );
+    TEST_TRY_PARSE_MESSAGE( "/an_int\0,ii\0\0\0\0A", PARSE_ARGUMENTS_EXCEED_MESSAGE_SIZE );
+    TEST_TRY_PARSE_MESSAGE( "/unterminated123", PARSE_UNTERMINATED_ADDRESS_PATTERN );
+    TEST_TRY_PARSE_MESSAGE( "/no_tags\0\0\0\0fi\0\0", PARSE_TYPE_TAGS_NOT_PRESENT );
+    TEST_TRY_PARSE_MESSAGE( "/array\0\0,[i\0\0\0\0\x1", PARSE_UNTERMINATED_ARRAY );
+    TEST_TRY_PARSE_MESSAGE( "/string\0,s\0\0abcd", PARSE_UNTERMINATED_STRING_ARGUMENT );
+    // a blob whose size would wrap around when rounded up to a multiple of 4
+    TEST_TRY_PARSE_MESSAGE( "/a_blob\0,b\0\0\xFF\xFF\xFF\xFF", PARSE_ARGUMENTS_EXCEED_MESSAGE_SIZE );
+    TEST_TRY_PARSE_MESSAGE( "/a_blob\0,b\0\0\0\0\0\x8\0\0\0\0", PARSE_ARGUMENTS_EXCEED_MESSAGE_SIZE );
+
+    // packets
+    {
+        ReceivedPacket p;
+        char buffer[8] = "#bundle";
+        assertEqual( ReceivedPacket::TryParse( buffer, 0, p ), PARSE_ZERO_LENGTH_ELEMENT );
+        assertEqual( ReceivedPacket::TryParse( buffer, 7, p ), PARSE_ELEMENT_SIZE_NOT_MULTIPLE_OF_4 );
+        assertEqual( ReceivedPacket::TryParse( buffer, (std::size_t)OSC_BUNDLE_ELEMENT_SIZE_MAX + 4, p ), PARSE_INVALID_PACKET_SIZE );
+        assertEqual( p.Contents() == 0, true );
+        assertEqual( ReceivedPacket::TryParse( buffer, 8, p ), PARSE_OK );
+
+        ReceivedBundle b;
+        assertEqual( ReceivedBundle::TryParse( p, b ), PARSE_BUNDLE_TOO_SHORT );
+    }
+
+    // bundles
+    {
+        int bufferSize = 1000;
+        char *buffer = AllocateAligned4( bufferSize );
+        OutboundPacketStream ps( buffer, bufferSize );
+        ps << BeginBundle( 1234 )
+            << BeginMessage( "/a" ) << 1.f << EndMessage
+            << BeginMessage( "/b" ) << 2.f << EndMessage
+            << EndBundle;
+
+        ReceivedPacket p;
+        assertEqual( ReceivedPacket::TryParse( ps.Data(), ps.Size(), p ), PARSE_OK );
+        ReceivedBundle b;
+        assertEqual( ReceivedBundle::TryParse( p, b ), PARSE_OK );
+        assertEqual( b.ElementCount(), (uint32)2 );
+        assertEqual( b.TimeTag(), (uint64)1234 );
+
+        ReceivedMessage m;
+        assertEqual( ReceivedMessage::TryParse( *b.ElementsBegin(), m ), PARSE_OK );
+        assertEqual( std::strcmp( m.AddressPattern(), "/a" ), 0 );
+
+        // corrupt the size of the first element
+        buffer[19] = 0x7C;
+        assertEqual( ReceivedBundle::TryParse( p, b ), PARSE_BUNDLE_TOO_SHORT_FOR_ELEMENT );
+        assertEqual( b.ElementCount(), (uint32)0 );
+
+        // the throwing constructor reports the same condition
+        bool exceptionThrown = false;
+        try{
+            ReceivedBundle thrown( p );
+        }catch( MalformedBundleException& e ){
+            exceptionThrown = ( std::strcmp( e.what(), ParseErrorString( PARSE_BUNDLE_TOO_SHORT_FOR_ELEMENT ) ) == 0 );
+        }
+        assertEqual( exceptionThrown, true );
+    }
+}
+
+
+//-----------------------------------------------------------------------
+
+// single-pass decoding of whole packets with ReceivedBatch
+
+void test8()
+{
+    int bufferSize = 1000;
+    char *buffer = AllocateAligned4( bufferSize );
+    OutboundPacketStream ps( buffer, bufferSize );
+    ps << BeginBundle( 100 )
+        << BeginMessage( "/track/1/volume" ) << 0.5f << EndMessage
+        << BeginBundle( 200 )
+            << BeginMessage( "/abc" ) << (int32)7 << "str" << Blob( "xyz", 3 ) << 1.5 << EndMessage
+            << BeginMessage( "/empty" ) << EndMessage
+        << EndBundle
+        << BeginMessage( "/last" ) << BeginArray << true << Nil << EndArray << EndMessage
+        << EndBundle;
+
+    ReceivedBatch batch;
+    assertEqual( batch.Decode( ps.Data(), ps.Size() ), PARSE_OK );
+    assertEqual( batch.MessageCount(), (uint32)4 );
+    assertEqual( batch.TotalArgumentCount(), (uint32)9 );
+
+    assertEqual( std::strcmp( batch.AddressPattern( 0 ), "/track/1/volume" ), 0 );
+    assertEqual( batch.AddressLengths()[0], (uint32)15 );
+    assertEqual( batch.TimeTags()[0], (uint64)100 );
+    assertEqual( batch.ArgumentCount( 0 ), (uint32)1 );
+    assertEqual( batch.ArgumentAt( 0, 0 ).AsFloat(), 0.5f );
+
+    assertEqual( std::strcmp( batch.AddressPattern( 1 ), "/abc" ), 0 );
+    assertEqual( batch.AddressLengths()[1], (uint32)4 );
+    assertEqual( batch.TimeTags()[1], (uint64)200 );
+    assertEqual( std::strcmp( batch.TypeTags( 1 ), "isbd" ), 0 );
+    assertEqual( batch.ArgumentAt( 1, 0 ).AsInt32(), (int32)7 );
+    assertEqual( std::strcmp( batch.ArgumentAt( 1, 1 ).AsString(), "str" ), 0 );
+    const void *blob;
+    osc_bundle_element_size_t blobSize;
+    batch.ArgumentAt( 1, 2 ).AsBlob( blob, blobSize );
+    assertEqual( blobSize, (osc_bundle_element_size_t)3 );
+    assertEqual( batch.ArgumentAt( 1, 3 ).AsDouble(), 1.5 );
+
+    assertEqual( std::strcmp( batch.AddressPattern( 2 ), "/empty" ), 0 );
+    assertEqual( batch.TypeTags( 2 ) == 0, true );
+    assertEqual( batch.ArgumentCount( 2 ), (uint32)0 );
+    assertEqual( batch.TimeTags()[2], (uint64)200 );
+
+    assertEqual( std::strcmp( batch.AddressPattern( 3 ), "/last" ), 0 );
+    assertEqual( batch.TimeTags()[3], (uint64)100 );
+    assertEqual( batch.ArgumentCount( 3 ), (uint32)4 );
+    assertEqual( batch.ArgumentsBegin()[4], (uint32)9 );
+
+    // the offsets agree with those recorded by ReceivedMessage
+    ReceivedBundle outer( ReceivedPacket( ps.Data(), ps.Size() ) );
+    ReceivedBundle::const_iterator e = outer.ElementsBegin();
+    ++e;
+    ReceivedBundle inner( *e );
+    ReceivedMessage m( *inner.ElementsBegin() );
+    for( uint32 j=0; j < m.ArgumentCount(); ++j )
+        assertEqual( m.ArgumentDataUnchecked( j ) == batch.Data() + batch.ArgumentOffsets()[ batch.ArgumentsBegin()[1] + j ], true );
+
+    // a single message has an immediate time tag
+    ps.Clear();
+    ps << BeginMessage( "/single" ) << 1.f << 2.f << EndMessage;
+    assertEqual( batch.Decode( ps.Data(), ps.Size() ), PARSE_OK );
+    assertEqual( batch.MessageCount(), (uint32)1 );
+    assertEqual( batch.TimeTags()[0], (uint64)1 );
+    assertEqual( batch.ArgumentAt( 0, 1 ).AsFloat(), 2.f );
+
+    // errors in nested elements are reported and leave the batch empty
+    ps.Clear();
+    ps << BeginBundle( 1 )
+        << BeginBundle( 2 ) << BeginMessage( "/a" ) << 1.f << EndMessage << EndBundle
+        << EndBundle;
+    buffer[45] = 'x'; // type tag of /a
+    assertEqual( batch.Decode( ps.Data(), ps.Size() ), PARSE_UNKNOWN_TYPE_TAG );
+    assertEqual( batch.MessageCount(), (uint32)0 );
+
+    buffer[45] = 'f';
+    buffer[19] = 0x7C; // size of the nested bundle
+    assertEqual( batch.Decode( ps.Data(), ps.Size() ), PARSE_BUNDLE_TOO_SHORT_FOR_ELEMENT );
+    buffer[19] = 32;
+    assertEqual( batch.Decode( ps.Data(), ps.Size() ), PARSE_OK );
+    assertEqual( batch.TimeTags()[0], (uint64)2 );
+    buffer[21] = '!'; // nested bundle marker
+    assertEqual( batch.Decode( ps.Data(), ps.Size() ), PARSE_BAD_BUNDLE_ADDRESS_PATTERN );
+}
+
+
+//-----------------------------------------------------------------------
+
+// time tag scheduling with ScheduledOscPacketListener
+
+// records the address of each message it receives, using a clock
+// controlled by the test
+class TestScheduledListener : public ScheduledOscPacketListener{
+public:
+    uint64 now;
+    std::vector<std::string> received;
+
+    TestScheduledListener() : now( (uint64)3900000000UL << 32 ) {}
+
+protected:
+    virtual uint64 CurrentTime() const { return now; }
+
+    virtual void ProcessMessage( const osc::ReceivedMessage& m, const IpEndpointName& remoteEndpoint )
+    {
+        (void)remoteEndpoint;
+        received.push_back( m.AddressPattern() );
+    }
+};
+
+
+static void SendBundle( TestScheduledListener& listener, uint64 timeTag, const char *addressPattern )
+{
+    char buffer[64];
+    OutboundPacketStream ps( buffer, sizeof(buffer) );
+    ps << BeginBundle( timeTag ) << BeginMessage( addressPattern ) << EndMessage << EndBundle;
+    listener.ProcessPacket( ps.Data(), (int)ps.Size(), IpEndpointName() );
+}
+
+
+void test9()
+{
+    assertEqual( MicrosecondsToTimeTagInterval( 1000000 ), (uint64)1 << 32 );
+    assertEqual( MicrosecondsToTimeTagInterval( 2500000 ), ((uint64)5 << 32) / 2 );
+    assertEqual( TimeTagIntervalToMicroseconds( MicrosecondsToTimeTagInterval( 1234567 ) ) + 1 >= 1234567, true );
+    assertEqual( (CurrentTimeTag() >> 32) > NTP_UNIX_EPOCH_OFFSET_SECONDS, true );
+
+    TestScheduledListener listener;
+    listener.SetSpinThresholdMicroseconds( 0 );
+    const uint64 ms = MicrosecondsToTimeTagInterval( 1000 );
+    const uint64 start = listener.now;
+
+    // immediate and past bundles are dispatched straight away
+    SendBundle( listener, IMMEDIATE_TIME_TAG, "/immediate" );
+    SendBundle( listener, start - 10 * ms, "/late" );
+    assertEqual( listener.received.size(), (std::size_t)2 );
+    assertEqual( listener.ScheduledBundleCount(), (std::size_t)0 );
+    assertEqual( listener.NextDueTime(), (uint64)0 );
+    listener.received.clear();
+
+    // future bundles are released in time tag order, equal tags in arrival order
+    SendBundle( listener, start + 5 * ms, "/c" );
+    SendBundle( listener, start + 2 * ms, "/a" );
+    SendBundle( listener, start + 5 * ms, "/d" );
+    SendBundle( listener, start + 3 * ms, "/b" );
+    SendBundle( listener, start + 3000 * ms, "/far" ); // beyond the wheel
+    assertEqual( listener.ScheduledBundleCount(), (std::size_t)5 );
+    assertEqual( listener.received.size(), (std::size_t)0 );
+    assertEqual( listener.NextDueTime(), start + 2 * ms );
+
+    listener.ReleaseDueBundles( start + 2 * ms - 1 );
+    assertEqual( listener.received.size(), (std::size_t)0 );
+
+    listener.ReleaseDueBundles( start + 2 * ms );
+    assertEqual( listener.received.size(), (std::size_t)1 );
+    assertEqual( listener.received[0], std::string( "/a" ) );
+
+    listener.ReleaseDueBundles( start + 10 * ms );
+    assertEqual( listener.received.size(), (std::size_t)4 );
+    assertEqual( listener.received[1], std::string( "/b" ) );
+    assertEqual( listener.received[2], std::string( "/c" ) );
+    assertEqual( listener.received[3], std::string( "/d" ) );
+    assertEqual( listener.NextDueTime(), start + 3000 * ms );
+
+    listener.ReleaseDueBundles( start + 2999 * ms );
+    assertEqual( listener.received.size(), (std::size_t)4 );
+    listener.ReleaseDueBundles( start + 3000 * ms );
+    assertEqual( listener.received.size(), (std::size_t)5 );
+    assertEqual( listener.received[4], std::string( "/far" ) );
+    assertEqual( listener.ScheduledBundleCount(), (std::size_t)0 );
+
+    // a later nested bundle inside an immediate bundle is scheduled, and
+    // the timer releases it once the clock reaches its time tag
+    listener.received.clear();
+    listener.now = start + 4000 * ms;
+    char buffer[128];
+    OutboundPacketStream ps( buffer, sizeof(buffer) );
+    ps << BeginBundleImmediate
+        << BeginMessage( "/now" ) << EndMessage
+        << BeginBundle( listener.now + 20 * ms ) << BeginMessage( "/later" ) << EndMessage << EndBundle
+        << EndBundle;
+    listener.ProcessPacket( ps.Data(), (int)ps.Size(), IpEndpointName() );
+    assertEqual( listener.received.size(), (std::size_t)1 );
+    assertEqual( listener.ScheduledBundleCount(), (std::size_t)1 );
+
+    listener.now += 19 * ms;
+    listener.TimerExpired();
+    assertEqual( listener.received.size(), (std::size_t)1 );
+    listener.now += ms;
+    listener.TimerExpired();
+    assertEqual( listener.received.size(), (std::size_t)2 );
+    assertEqual( listener.received[1], std::string( "/later" ) );
+}
+
+
+//-----------------------------------------------------------------------
+
+// bulk decoding of homogeneous arrays, with every available byte swap kernel
+
+void test10()
+{
+    static const SimdInstructionSet sets[] = { SIMD_SCALAR, SIMD_SSE2, SIMD_AVX2 };
+
+    // odd lengths so that the vector kernels also run their scalar tails
+    const std::size_t count = 37;
+    char source[count * 8];
+    for( std::size_t i=0; i < sizeof(source); ++i )
+        source[i] = (char)(i * 7 + 1);
+
+    char expected32[count * 4], expected64[count * 8];
+    CopyBigEndian32Scalar( expected32, source, count );
+    CopyBigEndian64Scalar( expected64, source, count );
+    assertEqual( (unsigned char)expected32[0], (unsigned char)source[3] );
+    assertEqual( (unsigned char)expected64[0], (unsigned char)source[7] );
+
+    for( std::size_t i=0; i < sizeof(sets) / sizeof(sets[0]); ++i ){
+        CopyBigEndianFunction f32 = CopyBigEndian32FunctionFor( sets[i] );
+        CopyBigEndianFunction f64 = CopyBigEndian64FunctionFor( sets[i] );
+        if( !f32 || !f64 )
+            continue;
+
+        std::cout << "testing CopyBigEndian kernels: " << SimdInstructionSetName( sets[i] ) << "\n";
+
+        bool allCorrect = true;
+        for( std::size_t n = 0; n <= count; ++n ){
+            char result[count * 8 + 1];
+            // unaligned source and destination
+            std::memset( result, 0, sizeof(result) );
+            f32( result + 1, source, n );
+            if( std::memcmp( result + 1, expected32, n * 4 ) != 0 || result[n * 4 + 1] != 0 )
+                allCorrect = false;
+
+            std::memset( result, 0, sizeof(result) );
+            f64( result + 1, source, n );
+            if( std::memcmp( result + 1, expected64, n * 8 ) != 0 )
+                allCorrect = false;
+        }
+        assertEqual( allCorrect, true );
+    }
+
+    int bufferSize = 2000;
+    char *buffer = AllocateAligned4( bufferSize );
+    OutboundPacketStream ps( buffer, bufferSize );
+    ps << BeginMessage( "/meters" ) << BeginArray;
+    for( std::size_t i=0; i < count; ++i )
+        ps << (float)i * 0.25f;
+    ps << EndArray << BeginArray;
+    for( std::size_t i=0; i < count; ++i )
+        ps << (int32)i - 10;
+    ps << EndArray << BeginArray;
+    for( std::size_t i=0; i < count; ++i )
+        ps << (int64)( (int64)i * 10000000000LL );
+    ps << EndArray << BeginArray;
+    for( std::size_t i=0; i < count; ++i )
+        ps << (double)i / 3.;
+    ps << EndArray << BeginArray << EndArray << BeginArray << 1.f << (int32)2 << EndArray << 1.f << EndMessage;
+
+    ReceivedMessage m( ReceivedPacket( ps.Data(), ps.Size() ) );
+    ReceivedMessageArgument arg = m.ArgumentAt( 0 );
+
+    float floats[count];
+    assertEqual( arg.AsFloatArray( floats, 0 ), count );
+    assertEqual( arg.AsFloatArray( floats, count ), count );
+    bool allCorrect = true;
+    for( std::size_t i=0; i < count; ++i )
+        allCorrect = allCorrect && floats[i] == (float)i * 0.25f;
+    assertEqual( allCorrect, true );
+
+    // a short buffer is filled and the full count is still returned
+    floats[3] = -1.f;
+    assertEqual( arg.AsFloatArray( floats, 3 ), count );
+    assertEqual( floats[3], -1.f );
+
+    // the wrong item type is rejected
+    bool exceptionThrown = false;
+    try{
+        int32 ints[count];
+        arg.AsInt32Array( ints, count );
+    }catch( WrongArgumentTypeException& ){
+        exceptionThrown = true;
+    }
+    assertEqual( exceptionThrown, true );
+
+    arg = m.ArgumentAt( count + 2 );
+    int32 ints[count];
+    assertEqual( arg.AsInt32Array( ints, count ), count );
+    allCorrect = true;
+    for( std::size_t i=0; i < count; ++i )
+        allCorrect = allCorrect && ints[i] == (int32)i - 10;
+    assertEqual( allCorrect, true );
+
+    arg = m.ArgumentAt( 2 * (count + 2) );
+    int64 int64s[count];
+    assertEqual( arg.AsInt64Array( int64s, count ), count );
+    allCorrect = true;
+    for( std::size_t i=0; i < count; ++i )
+        allCorrect = allCorrect && int64s[i] == (int64)( (int64)i * 10000000000LL );
+    assertEqual( allCorrect, true );
+
+    arg = m.ArgumentAt( 3 * (count + 2) );
+    double doubles[count];
+    assertEqual( arg.AsDoubleArray( doubles, count ), count );
+    allCorrect = true;
+    for( std::size_t i=0; i < count; ++i )
+        allCorrect = allCorrect && doubles[i] == (double)i / 3.;
+    assertEqual( allCorrect, true );
+
+    // empty array
+    arg = m.ArgumentAt( 4 * (count + 2) );
+    assertEqual( arg.AsFloatArray( floats, count ), (std::size_t)0 );
+
+    // mixed array
+    arg = m.ArgumentAt( 4 * (count + 2) + 2 );
+    exceptionThrown = false;
+    try{
+        arg.AsFloatArray( floats, count );
+    }catch( WrongArgumentTypeException& ){
+        exceptionThrown = true;
+    }
+    assertEqual( exceptionThrown, true );
+
+    // not an array
+    arg = m.ArgumentAt( m.ArgumentCount() - 1 );
+    exceptionThrown = false;
+    try{
+        arg.AsFloatArray( floats, count );
+    }catch( WrongArgumentTypeException& ){
+        exceptionThrown = true;
+    }
+    assertEqual( exceptionThrown, true );
+}
+
+
+//-----------------------------------------------------------------------
+
+// hashing address patterns during the terminator scan, and AddressInternTable
+
+void test11()
+{
+    static const SimdInstructionSet sets[] = { SIMD_SCALAR, SIMD_SSE2, SIMD_AVX2 };
+
+    const int bufferSize = 96;
+    char *buffer = AllocateAligned4( bufferSize );
+
+    for( std::size_t i=0; i < sizeof(sets) / sizeof(sets[0]); ++i ){
+        FindStr4EndFunction f = FindStr4EndFunctionFor( sets[i] );
+        FindStr4EndHashFunction fh = FindStr4EndHashFunctionFor( sets[i] );
+        if( !f || !fh )
+            continue;
+
+        std::cout << "testing FindStr4EndHash kernel: " << SimdInstructionSetName( sets[i] ) << "\n";
+
+        bool allCorrect = true;
+        for( int length = 1; length < bufferSize; ++length ){
+            for( int j=0; j < bufferSize; ++j )
+                buffer[j] = (char)('a' + (j * 5) % 26);
+            int paddedLength = (length + 4) & ~0x03;
+            std::memset( buffer + length, 0, (paddedLength <= bufferSize ? paddedLength : bufferSize) - length );
+
+            // same result as FindStr4End, and the hash of the padded string
+            uint32 hash = 0;
+            const char *result = fh( buffer, buffer + bufferSize, &hash );
+            if( result != f( buffer, buffer + bufferSize ) )
+                allCorrect = false;
+            if( result && hash != HashStr4( buffer, paddedLength ) )
+                allCorrect = false;
+
+            // the hash only depends on the string, not on what follows it
+            if( paddedLength + 4 <= bufferSize ){
+                buffer[ paddedLength ] ^= 0x55;
+                uint32 hash2 = 0;
+                fh( buffer, buffer + bufferSize, &hash2 );
+                if( hash2 != hash )
+                    allCorrect = false;
+            }
+
+            // must be rejected if end cuts off the terminator
+            int truncatedEnd = length & ~0x03;
+            if( truncatedEnd > 0 && fh( buffer, buffer + truncatedEnd, &hash ) != 0 )
+                allCorrect = false;
+        }
+        assertEqual( allCorrect, true );
+    }
+
+    // strings differing in one character hash differently
+    assertEqual( (AddressInternTable::HashAddressPattern( "/track/1/volume" )
+            != AddressInternTable::HashAddressPattern( "/track/2/volume" )), true );
+
+    AddressInternTable table;
+    assertEqual( table.Size(), (uint32)0 );
+    assertEqual( table.Find( "/a" ), INVALID_ADDRESS_ID );
+
+    // enough addresses to grow the table a few times
+    const int count = 100;
+    std::vector<uint32> ids;
+    for( int i=0; i < count; ++i ){
+        std::string address = "/track/" + std::to_string( i ) + "/volume";
+        ids.push_back( table.Intern( address.c_str() ) );
+    }
+    assertEqual( table.Size(), (uint32)count );
+
+    bool allCorrect = true;
+    for( int i=0; i < count; ++i ){
+        std::string address = "/track/" + std::to_string( i ) + "/volume";
+        allCorrect = allCorrect && ids[i] == (uint32)i
+                && table.Intern( address.c_str() ) == ids[i]
+                && table.Find( address.c_str() ) == ids[i]
+                && address == table.AddressPattern( ids[i] );
+    }
+    assertEqual( allCorrect, true );
+    assertEqual( table.Size(), (uint32)count );
+
+    // a long address, hashed from a heap copy
+    std::string longAddress( 300, 'x' );
+    longAddress[0] = '/';
+    uint32 longId = table.Intern( longAddress.c_str() );
+    assertEqual( table.Find( longAddress.c_str() ), longId );
+
+    // received messages are looked up using the hash computed while parsing
+    char messageBuffer[1024];
+    {
+        OutboundPacketStream ps( messageBuffer, sizeof(messageBuffer) );
+        ps << BeginMessage( "/track/42/volume" ) << 0.5f << EndMessage;
+        ReceivedMessage m( ReceivedPacket( ps.Data(), ps.Size() ) );
+        assertEqual( m.AddressPatternHash(),
+                AddressInternTable::HashAddressPattern( "/track/42/volume" ) );
+        assertEqual( m.AddressPatternId( table ), ids[42] );
+    }
+    {
+        OutboundPacketStream ps( messageBuffer, sizeof(messageBuffer) );
+        ps << BeginMessage( longAddress.c_str() ) << EndMessage;
+        ReceivedMessage m( ReceivedPacket( ps.Data(), ps.Size() ) );
+        assertEqual( m.AddressPatternId( table ), longId );
+    }
+    {
+        OutboundPacketStream ps( messageBuffer, sizeof(messageBuffer) );
+        ps << BeginMessage( "/unknown" ) << EndMessage;
+        ReceivedMessage m( ReceivedPacket( ps.Data(), ps.Size() ) );
+        assertEqual( m.AddressPatternId( table ), INVALID_ADDRESS_ID );
+
+        uint32 id = table.Intern( m );
+        assertEqual( id, table.Size() - 1 );
+        assertEqual( m.AddressPatternId( table ), id );
+        assertEqual( table.Find( "/unknown" ), id );
+    }
+}
+
+
+//-----------------------------------------------------------------------
+
+// OSC address pattern matching, and dispatch by MessageMappingOscPacketListener
+
+class TestMappingListener : public MessageMappingOscPacketListener<TestMappingListener>{
+public:
+    int mute1Count, mute2Count, volume1Count;
+
+    TestMappingListener()
+        : mute1Count( 0 ), mute2Count( 0 ), volume1Count( 0 )
+    {
+        RegisterMessageFunction( "/track/1/mute", &TestMappingListener::Mute1 );
+        RegisterMessageFunction( "/track/2/mute", &TestMappingListener::Mute2 );
+        RegisterMessageFunction( "/track/1/volume", &TestMappingListener::Volume1 );
+    }
+
+    void Receive( const char *addressPattern )
+    {
+        char buffer[256];
+        OutboundPacketStream ps( buffer, sizeof(buffer) );
+        ps << BeginMessage( addressPattern ) << EndMessage;
+        ProcessPacket( ps.Data(), ps.Size(), IpEndpointName() );
+    }
+
+private:
+    void Mute1( const ReceivedMessage&, const IpEndpointName& ) { ++mute1Count; }
+    void Mute2( const ReceivedMessage&, const IpEndpointName& ) { ++mute2Count; }
+    void Volume1( const ReceivedMessage&, const IpEndpointName& ) { ++volume1Count; }
+};
+
+
+// a function that processes another message and registers a function
+// while the matches of its own message are being dispatched
+class ReentrantMappingListener : public MessageMappingOscPacketListener<ReentrantMappingListener>{
+public:
+    int mute1Count, mute2Count, mute3Count, volumeCount;
+
+    ReentrantMappingListener()
+        : mute1Count( 0 ), mute2Count( 0 ), mute3Count( 0 ), volumeCount( 0 )
+    {
+        RegisterMessageFunction( "/track/1/mute", &ReentrantMappingListener::Mute1 );
+        RegisterMessageFunction( "/track/2/mute", &ReentrantMappingListener::Mute2 );
+        RegisterMessageFunction( "/track/1/volume", &ReentrantMappingListener::Volume );
+        RegisterMessageFunction( "/track/2/volume", &ReentrantMappingListener::Volume );
+    }
+
+    void Receive( const char *addressPattern )
+    {
+        char buffer[256];
+        OutboundPacketStream ps( buffer, sizeof(buffer) );
+        ps << BeginMessage( addressPattern ) << EndMessage;
+        ProcessPacket( ps.Data(), ps.Size(), IpEndpointName() );
+    }
+
+private:
+    void Mute1( const ReceivedMessage&, const IpEndpointName& )
+    {
+        if( ++mute1Count == 1 ){
+            Receive( "/track/?/volume" );
+            RegisterMessageFunction( "/track/3/mute", &ReentrantMappingListener::Mute3 );
+        }
+    }
+    void Mute2( const ReceivedMessage&, const IpEndpointName& ) { ++mute2Count; }
+    void Mute3( const ReceivedMessage&, const IpEndpointName& ) { ++mute3Count; }
+    void Volume( const ReceivedMessage&, const IpEndpointName& ) { ++volumeCount; }
+};
+
+
+void test12()
+{
+    assertEqual( AddressPatternMatcher::PatternMatches( "/a/b", "/a/b" ), true );
+    assertEqual( AddressPatternMatcher::PatternMatches( "/a/b", "/a/bc" ), false );
+    assertEqual( AddressPatternMatcher::PatternMatches( "/a/b", "/a/b/c" ), false );
+    assertEqual( AddressPatternMatcher::PatternMatches( "/a/?", "/a/b" ), true );
+    assertEqual( AddressPatternMatcher::PatternMatches( "/a/?", "/a/" ), false );
+    assertEqual( AddressPatternMatcher::PatternMatches( "/a/*", "/a/" ), true );
+    assertEqual( AddressPatternMatcher::PatternMatches( "/a/*", "/a/bcd" ), true );
+    assertEqual( AddressPatternMatcher::PatternMatches( "/a/*", "/a/b/c" ), false ); // * doesn't match '/'
+    assertEqual( AddressPatternMatcher::PatternMatches( "/*/*", "/a/b" ), true );
+    assertEqual( AddressPatternMatcher::PatternMatches( "/a/b*d*f", "/a/bcdef" ), true );
+    assertEqual( AddressPatternMatcher::PatternMatches( "/a/b*d*f", "/a/bcdeg" ), false );
+    assertEqual( AddressPatternMatcher::PatternMatches( "/a/**x", "/a/yyx" ), true );
+    assertEqual( AddressPatternMatcher::PatternMatches( "/a/[bc]", "/a/c" ), true );
+    assertEqual( AddressPatternMatcher::PatternMatches( "/a/[bc]", "/a/d" ), false );
+    assertEqual( AddressPatternMatcher::PatternMatches( "/a/[!bc]", "/a/d" ), true );
+    assertEqual( AddressPatternMatcher::PatternMatches( "/a/[!bc]", "/a/b" ), false );
+    assertEqual( AddressPatternMatcher::PatternMatches( "/a/[0-9]x", "/a/5x" ), true );
+    assertEqual( AddressPatternMatcher::PatternMatches( "/a/[0-9]x", "/a/ax" ), false );
+    assertEqual( AddressPatternMatcher::PatternMatches( "/a/[a-]", "/a/-" ), true );
+    assertEqual( AddressPatternMatcher::PatternMatches( "/a/[bc", "/a/b" ), false ); // unterminated
+    assertEqual( AddressPatternMatcher::PatternMatches( "/a/{foo,bar}", "/a/bar" ), true );
+    assertEqual( AddressPatternMatcher::PatternMatches( "/a/{foo,bar}", "/a/baz" ), false );
+    assertEqual( AddressPatternMatcher::PatternMatches( "/a/{fo,foo}d", "/a/food" ), true ); // backtracks
+    assertEqual( AddressPatternMatcher::PatternMatches( "/a/x{,y}", "/a/x" ), true );
+    assertEqual( AddressPatternMatcher::PatternMatches( "/a/{foo", "/a/foo" ), false ); // unterminated
+
+    assertEqual( AddressPatternMatcher::HasWildcards( "/a/b" ), false );
+    assertEqual( AddressPatternMatcher::HasWildcards( "/a/{b,c}" ), true );
+
+    AddressPatternMatcher matcher;
+    const int trackCount = 16;
+    for( int i=1; i <= trackCount; ++i ){
+        std::string track = "/track/" + std::to_string( i );
+        assertEqual( matcher.AddMethod( (track + "/mute").c_str() ), (uint32)(2 * (i - 1)) );
+        assertEqual( matcher.AddMethod( (track + "/volume").c_str() ), (uint32)(2 * (i - 1) + 1) );
+    }
+    assertEqual( matcher.AddMethod( "/track/3/mute" ), (uint32)4 );
+    assertEqual( matcher.MethodCount(), (uint32)(2 * trackCount) );
+    assertEqual( matcher.MethodAddress( 4 ), "/track/3/mute" );
+
+    // exact matches, including an address with no method
+    assertEqual( matcher.Match( "/track/3/volume" ).size(), (std::size_t)1 );
+    assertEqual( matcher.Match( "/track/3/volume" )[0], (uint32)5 );
+    assertEqual( matcher.Match( "/track/3" ).size(), (std::size_t)0 );
+    assertEqual( matcher.Match( "/track/99/volume" ).size(), (std::size_t)0 );
+
+    // wildcards. results are in id order, and are the same when cached
+    for( int pass=0; pass < 2; ++pass ){
+        const std::vector<uint32>& all = matcher.Match( "/track/*/mute" );
+        assertEqual( all.size(), (std::size_t)trackCount );
+        bool allCorrect = true;
+        for( std::size_t i=0; i < all.size(); ++i )
+            allCorrect = allCorrect && all[i] == 2 * i;
+        assertEqual( allCorrect, true );
+
+        const std::vector<uint32>& some = matcher.Match( "/track/{1,10,11}/{mute,volume}" );
+        assertEqual( some.size(), (std::size_t)6 );
+        assertEqual( some[0], (uint32)0 );
+        assertEqual( some[2], (uint32)18 );
+
+        assertEqual( matcher.Match( "/track/[!0-9]/mute" ).size(), (std::size_t)0 );
+        assertEqual( matcher.Match( "/*" ).size(), (std::size_t)0 );
+        assertEqual( matcher.Match( "/track/?/*" ).size(), (std::size_t)18 );
+    }
+
+    // adding a method updates the cached results
+    matcher.AddMethod( "/track/extra/mute" );
+    assertEqual( matcher.Match( "/track/*/mute" ).size(), (std::size_t)(trackCount + 1) );
+
+    // wildcard parts are only tested against the children in the ranges
+    // selected by their literal prefix and a set following it. they match
+    // the same methods as PatternMatches() does.
+    const char *narrowedPatterns[] = {
+        "/track/1*/mute", "/track/1?/*", "/track/[12]/mute", "/track/1[0-2]/*",
+        "/track/[1-35]/volume", "/track/[3-51-2]/mute", "/track/[1-21]/mute", "/track/[2-11]/mute",
+        "/track/[9-1]/mute", "/track/[!1]/mute", "/track/[1/mute", "/track/e[x]tra/mute",
+        "/track/ex*/mute", "/t*/1/mute", "/[t]rack/1[6]/volume", "/track/1[]/mute" };
+    int wrongMatches = 0;
+    for( std::size_t i=0; i < sizeof(narrowedPatterns) / sizeof(narrowedPatterns[0]); ++i ){
+        std::vector<uint32> expected;
+        for( uint32 id=0; id < matcher.MethodCount(); ++id ){
+            if( AddressPatternMatcher::PatternMatches( narrowedPatterns[i], matcher.MethodAddress( id ) ) )
+                expected.push_back( id );
+        }
+        if( matcher.Match( narrowedPatterns[i] ) != expected )
+            ++wrongMatches;
+    }
+    assertEqual( wrongMatches, 0 );
+    assertEqual( matcher.Match( "/track/[12]/mute" ).size(), (std::size_t)2 );
+    assertEqual( matcher.Match( "/track/1[0-2]/*" ).size(), (std::size_t)6 );
+
+    // a matcher without a cache, and one with a cache smaller than the
+    // number of patterns in use, give the same results
+    for( std::size_t capacity=0; capacity < 2; ++capacity ){
+        AddressPatternMatcher small( capacity );
+        small.AddMethod( "/a/x" );
+        small.AddMethod( "/b/x" );
+        for( int pass=0; pass < 2; ++pass ){
+            assertEqual( small.Match( "/?/x" ).size(), (std::size_t)2 );
+            assertEqual( small.Match( "/[a]/x" ).size(), (std::size_t)1 );
+            assertEqual( small.Match( "/[b]/x" )[0], (uint32)1 );
+        }
+    }
+
+    // dispatch
+    TestMappingListener listener;
+    listener.Receive( "/track/1/mute" );
+    assertEqual( listener.mute1Count, 1 );
+    assertEqual( listener.mute2Count, 0 );
+    listener.Receive( "/track/*/mute" );
+    assertEqual( listener.mute1Count, 2 );
+    assertEqual( listener.mute2Count, 1 );
+    assertEqual( listener.volume1Count, 0 );
+    listener.Receive( "/track/1/*" );
+    assertEqual( listener.mute1Count, 3 );
+    assertEqual( listener.volume1Count, 1 );
+    listener.Receive( "/track/3/mute" );
+    assertEqual( listener.mute1Count + listener.mute2Count + listener.volume1Count, 5 );
+
+    // the functions matched when a message arrived are all called once,
+    // even if one of them re-enters the listener
+    ReentrantMappingListener reentrant;
+    reentrant.Receive( "/track/*/mute" );
+    assertEqual( reentrant.mute1Count, 1 );
+    assertEqual( reentrant.mute2Count, 1 );
+    assertEqual( reentrant.volumeCount, 2 );
+    assertEqual( reentrant.mute3Count, 0 );
+    reentrant.Receive( "/track/*/mute" );
+    assertEqual( reentrant.mute1Count, 2 );
+    assertEqual( reentrant.mute2Count, 2 );
+    assertEqual( reentrant.mute3Count, 1 );
+}
+
+
+//-----------------------------------------------------------------------
+
+// RouteDispatcher: typed captures and route precedence
+
+class TestRouteHandlers{
+public:
+    int calls;
+    std::string lastRoute;
+    int32 lastInt, lastInt2;
+    std::string lastString;
+
+    TestRouteHandlers() : calls( 0 ), lastInt( 0 ), lastInt2( 0 ) {}
+
+    void Master( const ReceivedMessage&, const IpEndpointName& )
+        { ++calls; lastRoute = "master"; }
+    void TrackVolume( const ReceivedMessage& m, const IpEndpointName&, int32 track )
+    {
+        ++calls; lastRoute = "volume"; lastInt = track;
+        float volume;
+        assertEqual( TryDecode( m, volume ), true );
+    }
+    void TrackSolo( const ReceivedMessage&, const IpEndpointName&, int32 track )
+        { ++calls; lastRoute = "solo"; lastInt = track; }
+    void TrackName( const ReceivedMessage&, const IpEndpointName&, const char *name )
+        { ++calls; lastRoute = "name"; lastString = name; }
+    void TrackAny( const ReceivedMessage&, const IpEndpointName&, const char *track )
+        { ++calls; lastRoute = "any"; lastString = track; }
+    void Send( const ReceivedMessage&, const IpEndpointName&, int32 track, int32 send, const char *parameter )
+        { ++calls; lastRoute = "send"; lastInt = track; lastInt2 = send; lastString = parameter; }
+};
+
+
+static bool DispatchTestMessage( RouteDispatcher& routes, const char *address )
+{
+    char buffer[256];
+    OutboundPacketStream ps( buffer, sizeof(buffer) );
+    ps << BeginMessage( address ) << 0.5f << EndMessage;
+    return routes.Dispatch( ReceivedMessage( ReceivedPacket( ps.Data(), ps.Size() ) ), IpEndpointName() );
+}
+
+
+void test13()
+{
+    TestRouteHandlers h;
+    RouteDispatcher routes;
+    routes.AddRoute( "/master/volume", &h, &TestRouteHandlers::Master );
+    routes.AddRoute( "/track/{int}/volume", &h, &TestRouteHandlers::TrackVolume );
+    routes.AddRoute( "/track/{int}/solo", &h, &TestRouteHandlers::TrackSolo );
+    routes.AddRoute( "/track/{string}/volume", &h, &TestRouteHandlers::TrackAny );
+    routes.AddRoute( "/track/{string}/name", &h, &TestRouteHandlers::TrackAny );
+    routes.AddRoute( "/track/{int}/send/{int}/{string}", &h, &TestRouteHandlers::Send );
+    assertEqual( routes.RouteCount(), (uint32)6 );
+
+    assertEqual( DispatchTestMessage( routes, "/master/volume" ), true );
+    assertEqual( h.lastRoute, std::string( "master" ) );
+
+    assertEqual( DispatchTestMessage( routes, "/track/17/volume" ), true );
+    assertEqual( h.lastRoute, std::string( "volume" ) );
+    assertEqual( h.lastInt, (int32)17 );
+
+    assertEqual( DispatchTestMessage( routes, "/track/-2147483648/volume" ), true );
+    assertEqual( h.lastInt, (int32)-2147483647 - 1 );
+
+    // not an int32, so matched by {string} instead
+    assertEqual( DispatchTestMessage( routes, "/track/2147483648/volume" ), true );
+    assertEqual( h.lastRoute, std::string( "any" ) );
+    assertEqual( DispatchTestMessage( routes, "/track/master/volume" ), true );
+    assertEqual( h.lastRoute, std::string( "any" ) );
+    assertEqual( h.lastString, std::string( "master" ) );
+
+    assertEqual( DispatchTestMessage( routes, "/track/4/solo" ), true );
+    assertEqual( h.lastRoute, std::string( "solo" ) );
+    assertEqual( h.lastInt, (int32)4 );
+
+    // the {int} part matches but nothing follows it, so the {string}
+    // route is tried instead
+    assertEqual( DispatchTestMessage( routes, "/track/3/name" ), true );
+    assertEqual( h.lastRoute, std::string( "any" ) );
+    assertEqual( h.lastString, std::string( "3" ) );
+
+    assertEqual( DispatchTestMessage( routes, "/track/12/send/3/level" ), true );
+    assertEqual( h.lastRoute, std::string( "send" ) );
+    assertEqual( h.lastInt, (int32)12 );
+    assertEqual( h.lastInt2, (int32)3 );
+    assertEqual( h.lastString, std::string( "level" ) );
+
+    int calls = h.calls;
+    assertEqual( DispatchTestMessage( routes, "/track/1" ), false );
+    assertEqual( DispatchTestMessage( routes, "/track//volume" ), false );
+    assertEqual( DispatchTestMessage( routes, "/track/1/volume/x" ), false );
+    assertEqual( DispatchTestMessage( routes, "/track/1/mute" ), false );
+    assertEqual( DispatchTestMessage( routes, "/master" ), false );
+    assertEqual( h.calls, calls );
+
+    // malformed routes and mismatched handler arguments
+    bool exceptionThrown = false;
+    try{
+        routes.AddRoute( "/track/{float}/volume", &h, &TestRouteHandlers::Master );
+    }catch( MalformedRouteException& ){
+        exceptionThrown = true;
+    }
+    assertEqual( exceptionThrown, true );
+
+    exceptionThrown = false;
+    try{
+        routes.AddRoute( "/bus/{string}/volume", &h, &TestRouteHandlers::TrackVolume );
+    }catch( MalformedRouteException& ){
+        exceptionThrown = true;
+    }
+    assertEqual( exceptionThrown, true );
+    assertEqual( routes.RouteCount(), (uint32)6 );
+
+    // replacing a handler
+    routes.AddRoute( "/track/{string}/name", &h, &TestRouteHandlers::TrackName );
+    assertEqual( routes.RouteCount(), (uint32)6 );
+    assertEqual( DispatchTestMessage( routes, "/track/main/name" ), true );
+    assertEqual( h.lastRoute, std::string( "name" ) );
+    assertEqual( h.lastString, std::string( "main" ) );
+}
+
+
+//-----------------------------------------------------------------------
+
+// GrowableOutboundPacketStream produces the same packets as OutboundPacketStream
+
+static void WriteTestPacket( OutboundPacketStream& p, int messageCount )
+{
+    static const char blobData[] = "blob data";
+
+    p << BeginBundleImmediate;
+    for( int i=0; i < messageCount; ++i ){
+        p << BeginBundle( 1234 + i )
+            << BeginMessage( "/a/long/enough/address/pattern/to/cross/a/chunk" )
+                << true << (int32)i << (float)i << 'c' << RgbaColor( 0x11223344 )
+                << MidiMessage( 0x55667788 ) << (int64)i << TimeTag( 5678 ) << (double)i
+                << "a string argument" << Symbol( "symbol" ) << Nil << Infinitum
+                << Blob( blobData, sizeof(blobData) - 1 )
+                << BeginArray << 1.f << 2.f << 3.f << EndArray
+            << EndMessage
+            << BeginMessage( "/empty" ) << EndMessage
+        << EndBundle;
+    }
+    p << EndBundle;
+}
+
+
+void test14()
+{
+    const std::size_t capacity = 65536;
+    char *buffer = new char[capacity];
+    OutboundPacketStream fixed( buffer, capacity );
+    WriteTestPacket( fixed, 20 );
+
+    // a tiny initial capacity and chunk size make the stream grow in every
+    // kind of element, including part way through a message
+    GrowableOutboundPacketStream growable( 4, 4 );
+    WriteTestPacket( growable, 20 );
+
+    assertEqual( growable.IsReady(), true );
+    assertEqual( growable.Size(), fixed.Size() );
+    assertEqual( std::memcmp( growable.Data(), fixed.Data(), fixed.Size() ), 0 );
+    assertEqual( (growable.Capacity() >= growable.Size()), true );
+
+    // the capacity is kept, so writing the same packet again doesn't grow
+    std::size_t grownCapacity = growable.Capacity();
+    const char *grownData = growable.Data();
+    growable.Clear();
+    assertEqual( growable.Size(), (std::size_t)0 );
+    WriteTestPacket( growable, 20 );
+    assertEqual( growable.Capacity(), grownCapacity );
+    assertEqual( (growable.Data() == grownData), true );
+    assertEqual( std::memcmp( growable.Data(), fixed.Data(), fixed.Size() ), 0 );
+
+    // Reserve() keeps the contents
+    growable.Reserve( grownCapacity * 2 );
+    assertEqual( growable.Capacity(), grownCapacity * 2 );
+    assertEqual( std::memcmp( growable.Data(), fixed.Data(), fixed.Size() ), 0 );
+
+    // the packet parses
+    ReceivedBundle b( ReceivedPacket( growable.Data(), growable.Size() ) );
+    assertEqual( b.ElementCount(), (uint32)20 );
+
+    // the fixed stream still throws when it's full
+    OutboundPacketStream small( buffer, 16 );
+    bool exceptionThrown = false;
+    try{
+        small << BeginMessage( "/address" ) << 1.f << 2.f << 3.f << EndMessage;
+    }catch( OutOfBufferMemoryException& ){
+        exceptionThrown = true;
+    }
+    assertEqual( exceptionThrown, true );
+
+    delete [] buffer;
+}
+
+
+//-----------------------------------------------------------------------
+
+// MessageTemplate produces the same packets as OutboundPacketStream
+
+void test15()
+{
+    char buffer[1024];
+
+    for( int inBundle=0; inBundle < 2; ++inBundle ){
+        MessageTemplate t( "/track/1/volume", "ifTcrmhtd[fN]I", inBundle != 0 );
+        assertEqual( t.IsInBundle(), inBundle != 0 );
+        assertEqual( t.ArgumentCount(), (std::size_t)14 );
+
+        for( int pass=0; pass < 3; ++pass ){
+            OutboundPacketStream p( buffer, sizeof(buffer) );
+            if( inBundle )
+                p << BeginBundle( 1000 + pass );
+            p << BeginMessage( "/track/1/volume" )
+                    << (int32)(-pass) << (float)pass / 3.f << (pass % 2 == 0) << (char)('a' + pass)
+                    << RgbaColor( 0x01020304 + pass ) << MidiMessage( 0x0A0B0C0D + pass )
+                    << (int64)( (int64)pass * -10000000000LL ) << TimeTag( 0x0102030405060708ULL + pass )
+                    << (double)pass / 7.
+                    << BeginArray << -(float)pass << OscNil << EndArray << Infinitum
+                << EndMessage;
+            if( inBundle )
+                p << EndBundle;
+
+            if( inBundle )
+                t.SetBundleTimeTag( 1000 + pass );
+            t.SetInt32( 0, -pass );
+            t.SetFloat( 1, (float)pass / 3.f );
+            t.SetBool( 2, pass % 2 == 0 );
+            t.SetChar( 3, (char)('a' + pass) );
+            t.SetRgbaColor( 4, 0x01020304 + pass );
+            t.SetMidiMessage( 5, 0x0A0B0C0D + pass );
+            t.SetInt64( 6, (int64)( (int64)pass * -10000000000LL ) );
+            t.SetTimeTag( 7, 0x0102030405060708ULL + pass );
+            t.SetDouble( 8, (double)pass / 7. );
+            t.SetFloat( 10, -(float)pass );
+
+            assertEqual( t.Size(), p.Size() );
+            assertEqual( std::memcmp( t.Data(), p.Data(), p.Size() ), 0 );
+        }
+
+        bool exceptionThrown = false;
+        try{
+            t.SetFloat( 0, 1.f );
+        }catch( WrongArgumentTypeException& ){
+            exceptionThrown = true;
+        }
+        assertEqual( exceptionThrown, true );
+
+        exceptionThrown = false;
+        try{
+            t.SetInt32( 14, 1 );
+        }catch( MissingArgumentException& ){
+            exceptionThrown = true;
+        }
+        assertEqual( exceptionThrown, true );
+
+        exceptionThrown = false;
+        try{
+            t.SetBundleTimeTag( 1 );
+        }catch( BundleNotInProgressException& ){
+            exceptionThrown = true;
+        }
+        assertEqual( exceptionThrown, inBundle == 0 );
+    }
+
+    // a message without arguments
+    MessageTemplate empty( "/ping", "" );
+    OutboundPacketStream p( buffer, sizeof(buffer) );
+    p << BeginMessage( "/ping" ) << EndMessage;
+    assertEqual( empty.Size(), p.Size() );
+    assertEqual( std::memcmp( empty.Data(), p.Data(), p.Size() ), 0 );
+
+    // variable length arguments can't be patched
+    bool exceptionThrown = false;
+    try{
+        MessageTemplate t( "/name", "s" );
+    }catch( WrongArgumentTypeException& ){
+        exceptionThrown = true;
+    }
+    assertEqual( exceptionThrown, true );
+}
+
+
+//-----------------------------------------------------------------------
+
+// static addresses and message headers produce the same packets as BeginMessage
+
+static constexpr auto staticPlay = MakeStaticAddress( "/transport/play" );
+static constexpr auto staticStats = MakeMessageHeader( "/hub/stats", "ihs[f]T" );
+static constexpr auto staticPing = MakeMessageHeader( "/ping", "" );
+
+static_assert( staticPlay.Size() == 16, "static address is padded" );
+static_assert( staticStats.Size() == 12 + 12, "static header includes type tags" );
+static_assert( staticStats.MinimumMessageSize() == 24 + 4 + 8 + 4 + 4, "static header argument sizes" );
+static_assert( staticPing.MinimumMessageSize() == 12, "static header without arguments" );
+
+
+void test16()
+{
+    char buffer[1024];
+    char expected[1024];
+
+    for( int inBundle=0; inBundle < 2; ++inBundle ){
+        OutboundPacketStream e( expected, sizeof(expected) );
+        OutboundPacketStream p( buffer, sizeof(buffer) );
+        if( inBundle ){
+            e << BeginBundle( 1234 );
+            p << BeginBundle( 1234 );
+        }
+
+        e << BeginMessage( "/transport/play" ) << EndMessage
+            << BeginMessage( "/transport/play" ) << 1.f << "two" << EndMessage
+            << BeginMessage( "/hub/stats" ) << (int32)3 << (int64)( (int64)4 * 10000000000LL )
+                << "clients" << BeginArray << 5.f << EndArray << true << EndMessage
+            << BeginMessage( "/ping" ) << EndMessage;
+
+        p << staticPlay << EndMessage
+            << staticPlay << 1.f << "two" << EndMessage
+            << staticStats << (int32)3 << (int64)( (int64)4 * 10000000000LL )
+                << "clients" << BeginArray << 5.f << EndArray << true << EndMessage
+            << staticPing << EndMessage;
+
+        if( inBundle ){
+            e << EndBundle;
+            p << EndBundle;
+        }
+
+        assertEqual( p.IsReady(), true );
+        assertEqual( p.Size(), e.Size() );
+        assertEqual( std::memcmp( p.Data(), e.Data(), e.Size() ), 0 );
+    }
+
+    // Size() doesn't count the encoded type tags twice
+    OutboundPacketStream p( buffer, sizeof(buffer) );
+    p << staticStats;
+    assertEqual( p.Size(), staticStats.Size() );
+    p << (int32)3;
+    assertEqual( p.Size(), staticStats.Size() + 4 );
+    p << (int64)5 << "" << BeginArray << 1.f << EndArray << true << EndMessage;
+    assertEqual( p.Size(), staticStats.MinimumMessageSize() );
+
+    // arguments that don't match the type tags
+    bool exceptionThrown = false;
+    p.Clear();
+    try{
+        p << staticStats << (int32)3 << 4.f << EndMessage;
+    }catch( MessageTypeTagsMismatchException& ){
+        exceptionThrown = true;
+    }
+    assertEqual( exceptionThrown, true );
+
+    exceptionThrown = false;
+    p.Clear();
+    try{
+        p << staticPing << (int32)1 << EndMessage;
+    }catch( MessageTypeTagsMismatchException& ){
+        exceptionThrown = true;
+    }
+    assertEqual( exceptionThrown, true );
+
+    // the stream grows to fit a static header
+    GrowableOutboundPacketStream growable( 4, 4 );
+    growable << BeginBundleImmediate << staticStats << (int32)3 << (int64)4
+        << "clients" << BeginArray << 5.f << EndArray << true << EndMessage << EndBundle;
+    ReceivedBundle b( ReceivedPacket( growable.Data(), growable.Size() ) );
+    ReceivedMessage m( *b.ElementsBegin() );
+    assertEqual( m.AddressPattern(), "/hub/stats" );
+    assertEqual( m.TypeTags(), "ihs[f]T" );
+
+    // a fixed stream without room for the header throws
+    OutboundPacketStream small( buffer, 16 );
+    exceptionThrown = false;
+    try{
+        small << staticStats;
+    }catch( OutOfBufferMemoryException& ){
+        exceptionThrown = true;
+    }
+    assertEqual( exceptionThrown, true );
+
+    // malformed headers throw when they aren't constexpr
+    exceptionThrown = false;
+    try{
+        MakeMessageHeader( "/bad", "iz" );
+    }catch( MalformedStaticHeaderException& ){
+        exceptionThrown = true;
+    }
+    assertEqual( exceptionThrown, true );
+
+    exceptionThrown = false;
+    try{
+        MakeStaticAddress( "bad" );
+    }catch( MalformedStaticHeaderException& ){
+        exceptionThrown = true;
+    }
+    assertEqual( exceptionThrown, true );
+}
+
+
+//-----------------------------------------------------------------------
+
+// external blobs are referenced by the stream, and its io vectors are the
+// same packet as when the blobs are copied
+
+static void WriteBlobPacket( OutboundPacketStream& p, bool external,
+        const char *blobData, const std::size_t *blobSizes, int count )
+{
+    p << BeginBundle( 1234 );
+    for( int i=0; i < count; ++i ){
+        p << BeginMessage( "/meters" ) << (int32)i;
+        if( external )
+            p << ExternalBlob( blobData, (osc_bundle_element_size_t)blobSizes[i] );
+        else
+            p << Blob( blobData, (osc_bundle_element_size_t)blobSizes[i] );
+        p << 1.f << EndMessage;
+    }
+    p << BeginBundleImmediate << BeginMessage( "/chunk" );
+    if( external )
+        p << ExternalBlob( blobData, 7 );
+    else
+        p << Blob( blobData, 7 );
+    p << EndMessage << EndBundle << EndBundle;
+}
+
+
+void test17()
+{
+    char blobData[64];
+    for( std::size_t i=0; i < sizeof(blobData); ++i )
+        blobData[i] = (char)i;
+    const std::size_t blobSizes[] = { 64, 0, 5, 2, 13, 1 };
+    const int count = 6;
+
+    char expected[2048];
+    OutboundPacketStream e( expected, sizeof(expected) );
+    WriteBlobPacket( e, false, blobData, blobSizes, count );
+
+    char buffer[2048];
+    OutboundPacketStream p( buffer, sizeof(buffer) );
+    WriteBlobPacket( p, true, blobData, blobSizes, count );
+
+    assertEqual( e.HasExternalBlobs(), false );
+    assertEqual( e.IoVectorCount(), (std::size_t)1 );
+    assertEqual( e.PacketSize(), e.Size() );
+
+    assertEqual( p.IsReady(), true );
+    assertEqual( p.HasExternalBlobs(), true );
+    assertEqual( p.PacketSize(), e.Size() );
+    // only the whole words of each blob are referenced, blobs of less than
+    // four bytes are copied
+    assertEqual( p.Size(), e.Size() - (64 + 4 + 12 + 4) );
+    assertEqual( p.IoVectorCount(), (std::size_t)(2 * 4 + 1) );
+
+    // the referenced blob data isn't copied
+    std::vector<IoVector> v( p.IoVectorCount() );
+    p.GetIoVectors( &v[0] );
+    for( std::size_t i=1; i < v.size(); i += 2 )
+        assertEqual( (v[i].data == blobData), true );
+
+    std::string packet;
+    for( std::size_t i=0; i < v.size(); ++i )
+        packet.append( (const char*)v[i].data, v[i].size );
+    assertEqual( packet.size(), e.Size() );
+    assertEqual( std::memcmp( packet.data(), e.Data(), e.Size() ), 0 );
+
+    // the same packet from a stream that grows while writing it
+    GrowableOutboundPacketStream growable( 4, 4 );
+    WriteBlobPacket( growable, true, blobData, blobSizes, count );
+    v.resize( growable.IoVectorCount() );
+    growable.GetIoVectors( &v[0] );
+    packet.clear();
+    for( std::size_t i=0; i < v.size(); ++i )
+        packet.append( (const char*)v[i].data, v[i].size );
+    assertEqual( packet.size(), e.Size() );
+    assertEqual( std::memcmp( packet.data(), e.Data(), e.Size() ), 0 );
+
+    // a message that isn't in a bundle
+    OutboundPacketStream single( buffer, sizeof(buffer) );
+    single << BeginMessage( "/snapshot" ) << ExternalBlob( blobData, 64 ) << EndMessage;
+    assertEqual( single.IoVectorCount(), (std::size_t)3 );
+    single.GetIoVectors( &v[0] );
+    packet.clear();
+    for( std::size_t i=0; i < 3; ++i )
+        packet.append( (const char*)v[i].data, v[i].size );
+    ReceivedMessage m( ReceivedPacket( packet.data(), packet.size() ) );
+    const void *data;
+    osc_bundle_element_size_t size;
+    m.ArgumentsBegin()->AsBlob( data, size );
+    assertEqual( size, (osc_bundle_element_size_t)64 );
+    assertEqual( std::memcmp( data, blobData, 64 ), 0 );
+
+    // Clear() drops the references
+    single.Clear();
+    assertEqual( single.HasExternalBlobs(), false );
+}
+
+
+// records the packet ids it receives, from the thread of its group member
+class GroupCountingListener : public PacketListener{
+    std::vector<int>& seen_;
+public:
+    GroupCountingListener( std::vector<int>& seen ) : seen_( seen ), received( 0 ) {}
+
+    int received;
+
+    virtual void ProcessPacket( const char *data, int size, const IpEndpointName& remoteEndpoint )
+    {
+        (void)remoteEndpoint;
+        if( size != 4 )
+            return;
+        int id;
+        std::memcpy( &id, data, 4 );
+        if( id >= 0 && id < (int)seen_.size() )
+            __atomic_add_fetch( &seen_[id], 1, __ATOMIC_RELAXED );
+        __atomic_add_fetch( &received, 1, __ATOMIC_RELAXED );
+    }
+};
+
+
+class ThrowingTimerListener : public TimerListener{
+public:
+    virtual void TimerExpired() { throw std::runtime_error("timer failed\n"); }
+};
+
+
+static int GroupReceivedCount( const std::vector<GroupCountingListener*>& listeners )
+{
+    int result = 0;
+    for( std::size_t i=0; i < listeners.size(); ++i )
+        result += __atomic_load_n( &listeners[i]->received, __ATOMIC_RELAXED );
+    return result;
+}
+
+
+void test18()
+{
+    // a UdpReceiveGroup on loopback passes every packet to one of its
+    // listeners, and can be started again after Stop()
+    const int SENDER_COUNT = 4;
+    const int PACKETS_PER_ROUND = 64;
+    const int ROUNDS = 3;
+    IpEndpointName endpoint( "127.0.0.1", 7210 );
+
+    const UdpReceiveGroup::Steering steerings[] = {
+        UdpReceiveGroup::HASH_STEERING,
+        UdpReceiveGroup::SOURCE_ADDRESS_STEERING,
+        UdpReceiveGroup::CPU_STEERING };
+
+    for( int s=0; s < 3; ++s ){
+        std::vector<int> seen( ROUNDS * PACKETS_PER_ROUND, 0 );
+        std::vector<GroupCountingListener*> listeners;
+        std::vector<PacketListener*> packetListeners;
+        for( int i=0; i < 3; ++i ){
+            listeners.push_back( new GroupCountingListener( seen ) );
+            packetListeners.push_back( listeners.back() );
+        }
+
+        {
+            UdpReceiveGroup group( endpoint, packetListeners, steerings[s] );
+            group.SetPinThreads( s == 2 );
+
+            // several sources, so that hashing spreads them over the sockets
+            std::vector<UdpTransmitSocket*> senders;
+            for( int i=0; i < SENDER_COUNT; ++i )
+                senders.push_back( new UdpTransmitSocket( endpoint ) );
+
+            for( int round=0; round < ROUNDS; ++round ){
+                group.Start();
+                for( int i=0; i < PACKETS_PER_ROUND; ++i ){
+                    int id = round * PACKETS_PER_ROUND + i;
+                    senders[i % SENDER_COUNT]->Send( (const char*)&id, 4 );
+                }
+
+                int expected = (round + 1) * PACKETS_PER_ROUND;
+                std::chrono::steady_clock::time_point deadline =
+                        std::chrono::steady_clock::now() + std::chrono::seconds( 5 );
+                while( GroupReceivedCount( listeners ) < expected
+                        && std::chrono::steady_clock::now() < deadline )
+                    std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+
+                group.Stop();
+                assertEqual( GroupReceivedCount( listeners ), expected );
+            }
+
+            int missingOrRepeated = 0;
+            for( std::size_t i=0; i < seen.size(); ++i ){
+                if( seen[i] != 1 )
+                    ++missingOrRepeated;
+            }
+            assertEqual( missingOrRepeated, 0 );
+
+            for( std::size_t i=0; i < senders.size(); ++i )
+                delete senders[i];
+        }
+
+        for( std::size_t i=0; i < listeners.size(); ++i )
+            delete listeners[i];
+    }
+
+    // an exception from a multiplexer is rethrown by Start() or Stop(),
+    // rather than terminating the program or leaving them waiting
+    std::vector<int> seen( 1, 0 );
+    GroupCountingListener listener( seen );
+    std::vector<PacketListener*> packetListeners( 1, &listener );
+    UdpReceiveGroup group( endpoint, packetListeners );
+    ThrowingTimerListener throwing;
+    group.Multiplexer( 0 ).AttachPeriodicTimerListener( 0, INT_MAX, &throwing );
+
+    std::string error;
+    try{
+        group.Start();
+        group.Stop();
+    }catch( std::runtime_error& e ){
+        error = e.what();
+    }
+    assertEqual( error, std::string("timer failed\n") );
+
+    group.Multiplexer( 0 ).DetachPeriodicTimerListener( &throwing );
+    error.clear();
+    try{
+        group.Start();
+        group.Stop();
+    }catch( std::runtime_error& e ){
+        error = e.what();
+    }
+    assertEqual( error, std::string() );
+}
+
+
+// a random delay whose size ranges over all the wheel's levels and past
+// its span, from less than a tick to about 2^46 ns
+static uint64_t RandomTimerDelay( std::mt19937_64& random )
+{
+    int bits = (int)(random() % 47);
+    return 1 + random() % ((uint64_t)1 << bits);
+}
+
+
+void test19()
+{
+    // TimerWheel against a list of expiry times: timers are driven the way
+    // SocketReceiveMultiplexer does, with steps of the current time from
+    // less than a tick to hours, and the expired timers' callbacks
+    // rescheduling or cancelling timers.
+    const int TIMER_COUNT = 200;
+    const int STEPS = 20000;
+
+    std::mt19937_64 random( 19 );
+    TimerWheel wheel;
+    std::vector<TimerWheel::Timer*> timers;
+    std::vector<bool> scheduled( TIMER_COUNT, false );
+    std::vector<int> scheduledLevel( TIMER_COUNT, 0 );
+    std::vector<bool> scheduledPastSpan( TIMER_COUNT, false );
+    for( int i=0; i < TIMER_COUNT; ++i )
+        timers.push_back( new TimerWheel::Timer( 0, 0, 0 ) );
+
+    uint64_t now = (uint64_t)1 << 40;
+    wheel.Clear( now );
+
+    int early = 0, missed = 0, cancelledExpired = 0, lateHint = 0;
+    int expiredCount = 0, expiredFromLevel3 = 0, expiredPastSpan = 0;
+
+    for( int step=0; step < STEPS; ++step ){
+        // schedule, move or cancel some timers
+        for( int k=0; k < 4; ++k ){
+            int i = (int)(random() % TIMER_COUNT);
+            if( random() % 16 == 0 ){
+                wheel.Cancel( timers[i] );
+                scheduled[i] = false;
+            }else if( !scheduled[i] || random() % 4 == 0 ){
+                uint64_t delay = RandomTimerDelay( random );
+                timers[i]->expiryNs = now + delay;
+                wheel.Schedule( timers[i] );
+                scheduled[i] = true;
+                scheduledLevel[i] = timers[i]->level;
+                scheduledPastSpan[i] = ( delay >> 20 ) >= ((uint64_t)1 << 24);
+            }
+        }
+
+        // the wait before the next collection may be early but never late
+        uint64_t next = ~(uint64_t)0;
+        for( int i=0; i < TIMER_COUNT; ++i ){
+            if( scheduled[i] && timers[i]->expiryNs < next )
+                next = timers[i]->expiryNs;
+        }
+        int64_t wait = wheel.NanosecondsUntilNextExpiry( now );
+        if( next == ~(uint64_t)0 ){
+            if( wait != -1 )
+                ++lateHint;
+        }else if( wait < 0 || now + (uint64_t)wait > next ){
+            ++lateHint;
+        }
+
+        // mostly steps within the lower levels, sometimes hours
+        uint64_t r = random() % 32;
+        if( r == 0 )
+            now += random() % ((uint64_t)1 << 46);
+        else if( r < 11 )
+            now += random() % ((uint64_t)2 << 20);
+        else if( r < 21 )
+            now += random() % ((uint64_t)1 << 27);
+        else if( r < 27 )
+            now += random() % ((uint64_t)1 << 34);
+        else if( wait > 0 )
+            now += (uint64_t)wait - random() % 2; // to the wait, or just before it
+
+        wheel.CollectExpired( now );
+        for( TimerWheel::Timer *timer = wheel.PopExpired(); timer != 0; timer = wheel.PopExpired() ){
+            int i = 0;
+            while( timers[i] != timer )
+                ++i;
+
+            if( !scheduled[i] )
+                ++cancelledExpired;
+            if( timer->expiryNs > now )
+                ++early;
+            scheduled[i] = false;
+            ++expiredCount;
+            if( scheduledLevel[i] == 3 )
+                ++expiredFromLevel3;
+            if( scheduledPastSpan[i] )
+                ++expiredPastSpan;
+
+            // the callback
+            int j = (int)(random() % TIMER_COUNT);
+            switch( random() % 4 ){
+                case 0:
+                    // cancel another timer, which may be expired and not
+                    // yet popped
+                    wheel.Cancel( timers[j] );
+                    scheduled[j] = false;
+                    break;
+                case 1:
+                    // move another timer
+                    timers[j]->expiryNs = now + RandomTimerDelay( random );
+                    wheel.Schedule( timers[j] );
+                    scheduled[j] = true;
+                    scheduledLevel[j] = timers[j]->level;
+                    scheduledPastSpan[j] = false;
+                    break;
+                case 2:
+                    // periodic
+                    timer->expiryNs = now + RandomTimerDelay( random );
+                    wheel.Schedule( timer );
+                    scheduled[i] = true;
+                    scheduledLevel[i] = timer->level;
+                    scheduledPastSpan[i] = false;
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        for( int i=0; i < TIMER_COUNT; ++i ){
+            if( scheduled[i] && timers[i]->expiryNs <= now )
+                ++missed;
+        }
+    }
+
+    assertEqual( early, 0 );
+    assertEqual( missed, 0 );
+    assertEqual( cancelledExpired, 0 );
+    assertEqual( lateHint, 0 );
+
+    // the timers were cascaded through every level, and from past the span
+    assertEqual( expiredCount > STEPS, true );
+    assertEqual( expiredFromLevel3 > 0, true );
+    assertEqual( expiredPastSpan > 0, true );
+
+    wheel.Clear( now );
+    assertEqual( wheel.Empty(), true );
+    for( int i=0; i < TIMER_COUNT; ++i )
+        delete timers[i];
+}
+
+
+// records the packets a SocketReceiveMultiplexer passes it, and breaks
+// the multiplexer once expected packets have arrived
+class RecordingListener : public PacketListener{
+    SocketReceiveMultiplexer *mux_;
+public:
+    RecordingListener( SocketReceiveMultiplexer *mux=0, int expected_=0 )
+        : mux_( mux ), expected( expected_ ) {}
+
+    int expected;
+    std::vector<std::string> packets;
+    std::vector<IpEndpointName> senders;
+    std::vector<PacketTimestamp> timestamps;
+    std::vector<int> batchSizes;
+
+    // called directly by receivers without batches
+    virtual void ProcessPacket( const char *data, int size, const IpEndpointName& remoteEndpoint )
+    {
+        packets.push_back( std::string( data, size ) );
+        senders.push_back( remoteEndpoint );
+        timestamps.push_back( PacketTimestamp() );
+    }
+
+    virtual void ProcessPacketBatch( const ReceivedDatagram *datagrams, int count )
+    {
+        batchSizes.push_back( count );
+        for( int i=0; i < count; ++i ){
+            packets.push_back( std::string( datagrams[i].data, datagrams[i].size ) );
+            senders.push_back( datagrams[i].remoteEndpoint );
+            timestamps.push_back( datagrams[i].timestamp );
+        }
+        if( mux_ && (int)packets.size() >= expected )
+            mux_->Break();
+    }
+};
+
+
+// breaks a multiplexer when it expires, so that a lost packet fails a
+// test rather than hanging it
+class BreakingTimerListener : public TimerListener{
+    SocketReceiveMultiplexer& mux_;
+public:
+    BreakingTimerListener( SocketReceiveMultiplexer& mux ) : mux_( mux ), expiredCount( 0 ) {}
+
+    int expiredCount;
+
+    virtual void TimerExpired()
+    {
+        ++expiredCount;
+        mux_.Break();
+    }
+};
+
+
+// run mux until it is broken, or for at most timeoutMs. returns true if
+// the time ran out.
+static bool RunWithTimeout( SocketReceiveMultiplexer& mux, int timeoutMs )
+{
+    BreakingTimerListener timeout( mux );
+    mux.AttachPeriodicTimerListener( timeoutMs, &timeout );
+    mux.Run();
+    mux.DetachPeriodicTimerListener( &timeout );
+    return timeout.expiredCount > 0;
+}
+
+
+void test20()
+{
+#if !(defined(__WIN32__) || defined(WIN32) || defined(_WIN32))
+    // sends to a local receiver that isn't reading don't block when its
+    // queue is full, the packets are dropped as with udp
+    LocalEndpointName name( "/tmp/oscpack-unit-test" );
+    {
+        LocalReceiveSocket receiver( name );
+        LocalDatagramSocket sender;
+        LocalTransmitSocket connectedSender( name );
+
+        const int COUNT = 5000;
+        char packet[64];
+        std::memset( packet, 0, sizeof(packet) );
+        for( int i=0; i < COUNT; ++i ){
+            sender.SendTo( name, packet, sizeof(packet) );
+            connectedSender.Send( packet, sizeof(packet) );
+        }
+
+        SocketReceiveMultiplexer mux;
+        RecordingListener listener;
+        mux.AttachSocketListener( &receiver, &listener );
+        RunWithTimeout( mux, 100 );
+        mux.DetachSocketListener( &receiver, &listener );
+
+        assertEqual( listener.packets.empty(), false );
+        assertEqual( (int)listener.packets.size() < 2 * COUNT, true );
+
+        // binding the name of a live socket fails, and leaves it working
+        bool bindFailed = false;
+        try{
+            LocalReceiveSocket second( name );
+        }catch( std::runtime_error& ){
+            bindFailed = true;
+        }
+        assertEqual( bindFailed, true );
+
+        RecordingListener reachedFirst( &mux, 1 );
+        mux.AttachSocketListener( &receiver, &reachedFirst );
+        sender.SendTo( name, "/ok", 4 );
+        assertEqual( RunWithTimeout( mux, 1000 ), false );
+        mux.DetachSocketListener( &receiver, &reachedFirst );
+        assertEqual( reachedFirst.packets.size(), (std::size_t)1 );
+    }
+
+    // a file left by a socket that no longer exists is replaced. moving
+    // the file away while the socket is destroyed leaves one behind.
+    {
+        std::string keptPath = name.path + "-kept";
+        LocalDatagramSocket *stale = new LocalDatagramSocket;
+        stale->Bind( name );
+        std::rename( name.path.c_str(), keptPath.c_str() );
+        delete stale;
+        std::rename( keptPath.c_str(), name.path.c_str() );
+
+        bool bindFailed = false;
+        try{
+            LocalReceiveSocket replacement( name );
+        }catch( std::runtime_error& ){
+            bindFailed = true;
+        }
+        assertEqual( bindFailed, false );
+    }
+
+    // a socket of the wrong transport, or an ip endpoint used with a local
+    // socket, is an error rather than a send that fails quietly
+    {
+        DatagramEndpoint local = DatagramEndpoint::FromString( "local:/tmp/oscpack-unit-test" );
+        DatagramEndpoint udp = DatagramEndpoint::FromString( "udp:127.0.0.1:7211" );
+        LocalDatagramSocket localSocket;
+        UdpSocket udpSocket;
+        UdpSocket& localAsUdp = localSocket;
+
+        int errors = 0;
+        try{ local.SendTo( udpSocket, "/x", 3 ); }catch( std::runtime_error& ){ ++errors; }
+        try{ udp.SendTo( localSocket, "/x", 3 ); }catch( std::runtime_error& ){ ++errors; }
+        try{ localAsUdp.SendTo( udp.ipEndpoint, "/x", 3 ); }catch( std::runtime_error& ){ ++errors; }
+        try{ localAsUdp.Bind( udp.ipEndpoint ); }catch( std::runtime_error& ){ ++errors; }
+        try{ localAsUdp.Connect( udp.ipEndpoint ); }catch( std::runtime_error& ){ ++errors; }
+        assertEqual( errors, 5 );
+
+        local.SendTo( localSocket, "/x", 3 );
+        udp.SendTo( udpSocket, "/x", 3 );
+    }
+#endif
+}
+
+
+void test21()
+{
+    // a SocketReceiveMultiplexer receiving in batches passes every packet
+    // with its size and sender, skips empty datagrams, and truncates
+    // packets to the socket's MaxPacketSize()
+    const int MAX_PACKET_SIZE = 64;
+    const int PACKET_COUNT = 40;
+    IpEndpointName receiverEndpoint( "127.0.0.1", 7212 );
+    UdpReceiveSocket receiver( receiverEndpoint );
+    receiver.SetMaxPacketSize( MAX_PACKET_SIZE );
+
+    IpEndpointName senderEndpoints[2] = {
+        IpEndpointName( "127.0.0.1", 7213 ), IpEndpointName( "127.0.0.1", 7214 ) };
+    UdpReceiveSocket sender0( senderEndpoints[0] );
+    UdpReceiveSocket sender1( senderEndpoints[1] );
+    UdpSocket *senders[2] = { &sender0, &sender1 };
+
+    const int batchSizes[] = { 1, 8 };
+    for( int b=0; b < 2; ++b ){
+        std::vector<std::string> expected;
+        std::vector<int> expectedSenders;
+        char data[100];
+        for( int i=0; i < PACKET_COUNT; ++i ){
+            int size = 1 + (i * 37) % 100;
+            std::memset( data, 'a' + i % 26, size );
+            senders[i % 2]->SendTo( receiverEndpoint, data, size );
+            expected.push_back( std::string( data, std::min( size, MAX_PACKET_SIZE ) ) );
+            expectedSenders.push_back( i % 2 );
+
+            if( i % 5 == 0 )
+                senders[i % 2]->SendTo( receiverEndpoint, data, 0 );
+        }
+
+        SocketReceiveMultiplexer mux;
+        mux.SetReceiveBatchSize( batchSizes[b] );
+        RecordingListener listener( &mux, PACKET_COUNT );
+        mux.AttachSocketListener( &receiver, &listener );
+        assertEqual( RunWithTimeout( mux, 2000 ), false );
+        mux.DetachSocketListener( &receiver, &listener );
+
+        assertEqual( (int)listener.packets.size(), PACKET_COUNT );
+        int wrongPackets = 0;
+        for( std::size_t i=0; i < listener.packets.size() && i < expected.size(); ++i ){
+            if( listener.packets[i] != expected[i]
+                    || listener.senders[i] != senderEndpoints[ expectedSenders[i] ] )
+                ++wrongPackets;
+        }
+        assertEqual( wrongPackets, 0 );
+
+        int largestBatch = 0;
+        for( std::size_t i=0; i < listener.batchSizes.size(); ++i )
+            largestBatch = std::max( largestBatch, listener.batchSizes[i] );
+        if( batchSizes[b] == 1 )
+            assertEqual( largestBatch, 1 );
+        else
+            assertEqual( largestBatch > 1 && largestBatch <= batchSizes[b], true );
+    }
+}
+
+
+// records the ids of the packets it receives. received is read by other
+// threads.
+class SequenceListener : public PacketListener{
+public:
+    SequenceListener() : received( 0 ) {}
+
+    int received;
+    std::vector<int> ids;
+
+    virtual void ProcessPacket( const char *data, int size, const IpEndpointName& remoteEndpoint )
+    {
+        (void)remoteEndpoint;
+        int id = -1;
+        if( size == 4 )
+            std::memcpy( &id, data, 4 );
+        ids.push_back( id );
+        __atomic_add_fetch( &received, 1, __ATOMIC_RELEASE );
+    }
+
+    // the number of ids that aren't one more than the one before, from
+    // firstId
+    int OutOfSequenceCount( int firstId ) const
+    {
+        int result = 0;
+        for( std::size_t i=0; i < ids.size(); ++i ){
+            if( ids[i] != firstId + (int)i )
+                ++result;
+        }
+        return result;
+    }
+};
+
+
+class CountingTimerListener : public TimerListener{
+public:
+    CountingTimerListener() : expiredCount( 0 ) {}
+
+    int expiredCount;
+
+    virtual void TimerExpired() { __atomic_add_fetch( &expiredCount, 1, __ATOMIC_RELEASE ); }
+};
+
+
+// the scenario of the backend and wait strategy tests. another thread
+// sends count packets, with ids from firstId, to a socket attached to mux
+// with listener. it calls AsynchronousBreak() once listener has received
+// expectedTotal packets and a 5 ms periodic timer has expired a few times,
+// or after a few seconds. returns the number of timer expirations.
+static int RunReceiveScenario( SocketReceiveMultiplexer& mux, UdpSocket& sender,
+        const IpEndpointName& receiverEndpoint, SequenceListener& listener,
+        int firstId, int count, int expectedTotal )
+{
+    CountingTimerListener timer;
+    mux.AttachPeriodicTimerListener( 5, &timer );
+
+    std::thread senderThread( [&](){
+        for( int i=0; i < count; ++i ){
+            int id = firstId + i;
+            sender.SendTo( receiverEndpoint, (const char*)&id, 4 );
+            if( i % 50 == 49 )
+                std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+        }
+
+        std::chrono::steady_clock::time_point deadline =
+                std::chrono::steady_clock::now() + std::chrono::seconds( 3 );
+        while( ( __atomic_load_n( &listener.received, __ATOMIC_ACQUIRE ) < expectedTotal
+                    || __atomic_load_n( &timer.expiredCount, __ATOMIC_ACQUIRE ) < 3 )
+                && std::chrono::steady_clock::now() < deadline )
+            std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+
+        mux.AsynchronousBreak();
+    } );
+
+    mux.Run();
+    senderThread.join();
+
+    mux.DetachPeriodicTimerListener( &timer );
+    return timer.expiredCount;
+}
+
+
+void test22()
+{
+    // each backend receives packets, runs timers and returns from Run()
+    // after AsynchronousBreak()
+    IpEndpointName receiverEndpoint( "127.0.0.1", 7215 );
+    UdpReceiveSocket receiver( receiverEndpoint );
+    UdpSocket sender;
+    const int COUNT = 200;
+
+#if defined(__WIN32__) || defined(WIN32) || defined(_WIN32)
+    SocketReceiveMultiplexer::Backend backends[] = { SocketReceiveMultiplexer::DEFAULT_BACKEND };
+    SocketReceiveMultiplexer::Backend expectedBackends[] = { SocketReceiveMultiplexer::DEFAULT_BACKEND };
+#else
+    SocketReceiveMultiplexer::Backend backends[] = {
+        SocketReceiveMultiplexer::SELECT_BACKEND,
+        SocketReceiveMultiplexer::EPOLL_BACKEND,
+        SocketReceiveMultiplexer::DEFAULT_BACKEND };
+#if defined(__linux__)
+    SocketReceiveMultiplexer::Backend expectedBackends[] = {
+        SocketReceiveMultiplexer::SELECT_BACKEND,
+        SocketReceiveMultiplexer::EPOLL_BACKEND,
+        SocketReceiveMultiplexer::EPOLL_BACKEND };
+#else
+    // epoll is only available on Linux
+    SocketReceiveMultiplexer::Backend expectedBackends[] = {
+        SocketReceiveMultiplexer::SELECT_BACKEND,
+        SocketReceiveMultiplexer::SELECT_BACKEND,
+        SocketReceiveMultiplexer::SELECT_BACKEND };
+#endif
+#endif
+
+    for( std::size_t i=0; i < sizeof(backends) / sizeof(backends[0]); ++i ){
+        SocketReceiveMultiplexer mux( backends[i] );
+        assertEqual( mux.GetBackend(), expectedBackends[i] );
+
+        SequenceListener listener;
+        mux.AttachSocketListener( &receiver, &listener );
+        int timerCount = RunReceiveScenario( mux, sender, receiverEndpoint, listener, 0, COUNT, COUNT );
+        mux.DetachSocketListener( &receiver, &listener );
+
+        assertEqual( (int)listener.ids.size(), COUNT );
+        assertEqual( listener.OutOfSequenceCount( 0 ), 0 );
+        assertEqual( timerCount >= 3, true );
+    }
+}
+
+
+void test23()
+{
+#if defined(__linux__)
+    // the io_uring backend, when the kernel supports it
+    SocketReceiveMultiplexer mux( SocketReceiveMultiplexer::IO_URING_BACKEND );
+    if( mux.GetBackend() != SocketReceiveMultiplexer::IO_URING_BACKEND ){
+        std::cout << "io_uring backend isn't supported, skipping its test\n";
+        return;
+    }
+
+    IpEndpointName receiverEndpoint( "127.0.0.1", 7216 );
+    UdpReceiveSocket receiver( receiverEndpoint );
+    UdpSocket sender;
+    SequenceListener listener;
+    mux.SetReceiveBatchSize( 16 );
+    mux.AttachSocketListener( &receiver, &listener );
+
+    const int COUNT = 100;
+    int firstTimerCount = RunReceiveScenario( mux, sender, receiverEndpoint, listener, 0, COUNT, COUNT );
+    assertEqual( (int)listener.ids.size(), COUNT );
+    assertEqual( firstTimerCount >= 3, true );
+
+    // packets that arrive between runs complete into the ring's buffers
+    // and are kept for the next Run(). there are more of them than the
+    // ring has buffers (256), so the multishot receive stops when they run
+    // out and is armed again once they are returned. the rest wait in the
+    // socket.
+    const int QUEUED_COUNT = 300;
+    for( int i=0; i < QUEUED_COUNT; ++i ){
+        int id = COUNT + i;
+        sender.SendTo( receiverEndpoint, (const char*)&id, 4 );
+    }
+
+    const int total = COUNT + QUEUED_COUNT + COUNT;
+    int secondTimerCount = RunReceiveScenario( mux, sender, receiverEndpoint, listener,
+            COUNT + QUEUED_COUNT, COUNT, total );
+    mux.DetachSocketListener( &receiver, &listener );
+
+    assertEqual( (int)listener.ids.size(), total );
+    assertEqual( listener.OutOfSequenceCount( 0 ), 0 );
+    assertEqual( secondTimerCount >= 3, true );
+#endif
+}
+
+
+void test24()
+{
+#if defined(__linux__)
+    const std::size_t CAPACITY = 4096;
+    SharedMemoryRingTransmitter transmitter( CAPACITY );
+    assertEqual( transmitter.MaxPacketSize(), CAPACITY / 4 );
+
+    // the packets arrive in order and intact across the end of the ring.
+    // a record of 1008 bytes doesn't fit after four others, so the rest
+    // of the ring is skipped with a padding record.
+    {
+        RecordingListener listener;
+        SharedMemoryRingReceiver receiver( transmitter.FileDescriptor(), &listener );
+
+        std::vector<std::string> expected;
+        for( int i=0; i < 60; ++i ){
+            std::size_t size = ( i < 10 ) ? 1000 : 1 + (i * 97) % transmitter.MaxPacketSize();
+            std::string packet( size, (char)('a' + i % 26) );
+            packet[0] = (char)i;
+            transmitter.Send( packet.data(), packet.size() );
+            expected.push_back( packet );
+
+            if( i % 3 == 2 )
+                receiver.ReceivePackets();
+        }
+        receiver.ReceivePackets();
+
+        assertEqual( listener.packets.size(), expected.size() );
+        assertEqual( listener.packets == expected, true );
+        assertEqual( receiver.OverrunCount(), (uint64_t)0 );
+    }
+
+    // a receiver that falls a whole ring behind counts an overrun, drops
+    // the packets it missed and carries on from the latest. the records
+    // are 512 bytes, so the receiver's position holds the start of a
+    // newer record, which only the seqlock shows was overwritten.
+    {
+        SharedMemoryRingTransmitter lappingTransmitter( CAPACITY );
+        RecordingListener listener;
+        SharedMemoryRingReceiver receiver( lappingTransmitter.FileDescriptor(), &listener );
+
+        std::string packet( 512 - 8, 'x' );
+        for( int i=0; i < 10; ++i )
+            lappingTransmitter.Send( packet.data(), packet.size() );
+        assertEqual( receiver.ReceivePackets(), 0 );
+        assertEqual( receiver.OverrunCount(), (uint64_t)1 );
+
+        lappingTransmitter.Send( "/after", 7 );
+        assertEqual( receiver.ReceivePackets(), 1 );
+        assertEqual( listener.packets.size(), (std::size_t)1 );
+        assertEqual( listener.packets.back(), std::string( "/after", 7 ) );
+        assertEqual( receiver.OverrunCount(), (uint64_t)1 );
+    }
+
+    // packets larger than MaxPacketSize() are refused
+    {
+        std::string packet( transmitter.MaxPacketSize() + 1, 'x' );
+        bool refused = false;
+        try{
+            transmitter.Send( packet.data(), packet.size() );
+        }catch( std::runtime_error& ){
+            refused = true;
+        }
+        assertEqual( refused, true );
+        transmitter.Send( packet.data(), transmitter.MaxPacketSize() );
+    }
+
+    // a file that isn't a ring is refused
+    {
+        std::FILE *file = std::tmpfile();
+        std::vector<char> zeros( 3 * CAPACITY, 0 );
+        std::fwrite( &zeros[0], 1, zeros.size(), file );
+        std::fflush( file );
+
+        RecordingListener listener;
+        bool refused = false;
+        try{
+            SharedMemoryRingReceiver receiver( fileno( file ), &listener );
+        }catch( std::runtime_error& ){
+            refused = true;
+        }
+        assertEqual( refused, true );
+        std::fclose( file );
+    }
+
+    // AsynchronousBreak() wakes a receiver that is asleep in Run()
+    {
+        SequenceListener listener;
+        SharedMemoryRingReceiver receiver( transmitter.FileDescriptor(), &listener );
+        int running = 1;
+        std::thread receiverThread( [&](){
+            receiver.Run();
+            __atomic_store_n( &running, 0, __ATOMIC_RELEASE );
+        } );
+
+        int id = 0;
+        transmitter.Send( (const char*)&id, 4 );
+        std::chrono::steady_clock::time_point deadline =
+                std::chrono::steady_clock::now() + std::chrono::seconds( 3 );
+        while( __atomic_load_n( &listener.received, __ATOMIC_ACQUIRE ) == 0
+                && std::chrono::steady_clock::now() < deadline )
+            std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+
+        // give it time to go to sleep again. the break is repeated, since
+        // one made before Run() started would be lost.
+        std::this_thread::sleep_for( std::chrono::milliseconds( 20 ) );
+        while( __atomic_load_n( &running, __ATOMIC_ACQUIRE )
+                && std::chrono::steady_clock::now() < deadline ){
+            receiver.AsynchronousBreak();
+            std::this_thread::sleep_for( std::chrono::milliseconds( 5 ) );
+        }
+        bool stopped = ( __atomic_load_n( &running, __ATOMIC_ACQUIRE ) == 0 );
+        if( !stopped ){
+            // let the thread finish rather than abort the tests
+            transmitter.Send( (const char*)&id, 4 );
+            receiver.AsynchronousBreak();
+        }
+        receiverThread.join();
+
+        assertEqual( stopped, true );
+        assertEqual( (int)listener.ids.size(), 1 );
+    }
+#endif
+}
+
+
+// keeps a PacketHandle for each packet if keep is set, and breaks the
+// multiplexer once it has received expected packets
+class HandleKeepingListener : public PacketListener{
+    SocketReceiveMultiplexer& mux_;
+public:
+    HandleKeepingListener( SocketReceiveMultiplexer& mux ) : mux_( mux ), keep( false ), expected( 0 ) {}
+
+    bool keep;
+    std::size_t expected;
+    std::vector<PacketHandle> handles;
+    std::vector<const char*> dataPointers;
+
+    virtual void ProcessPacket( const char *data, int size, const IpEndpointName& remoteEndpoint )
+    {
+        (void) data;
+        (void) size;
+        (void) remoteEndpoint;
+    }
+
+    virtual void ProcessPacketBatch( const ReceivedDatagram *datagrams, int count )
+    {
+        for( int i=0; i < count; ++i ){
+            dataPointers.push_back( datagrams[i].data );
+            if( keep )
+                handles.push_back( PacketHandle( datagrams[i] ) );
+        }
+        if( dataPointers.size() >= expected )
+            mux_.Break();
+    }
+};
+
+
+void test25()
+{
+    // a buffer released on another thread goes back to its pool, and the
+    // pool is deleted by the last release after ReleaseOwnership()
+    {
+        PacketBufferPool *pool = new PacketBufferPool( 16, 1 );
+        PacketBuffer *first = pool->Acquire();
+        first->AddReference();
+        assertEqual( first->IsShared(), true );
+        first->Release();
+        assertEqual( first->IsShared(), false );
+
+        std::thread releaser( [first]{ first->Release(); } );
+        releaser.join();
+
+        PacketBuffer *second = pool->Acquire();
+        PacketBuffer *third = pool->Acquire();
+        assertEqual( second == first, true );
+        assertEqual( third != first, true );
+
+        pool->ReleaseOwnership();
+        std::memset( second->Storage(), 0, second->StorageSize() );
+        second->Release();
+        third->Release();
+    }
+
+    // a packet that isn't in a pooled buffer is copied by the first
+    // handle, and shared by the handles made from the copy
+    {
+        char data[] = "/copied";
+        ReceivedDatagram datagram;
+        datagram.data = data;
+        datagram.size = sizeof(data);
+        datagram.remoteEndpoint = IpEndpointName( "127.0.0.1", 7000 );
+        datagram.timestamp.softwareNs = 42;
+
+        PacketHandle handle( datagram );
+        std::memset( data, 0, sizeof(data) );
+        assertEqual( handle.Data() != data, true );
+        assertEqual( handle.Datagram().buffer != 0, true );
+        assertEqual( std::strcmp( handle.Data(), "/copied" ), 0 );
+        assertEqual( handle.Size(), (int)sizeof(data) );
+        assertEqual( handle.RemoteEndpoint() == IpEndpointName( "127.0.0.1", 7000 ), true );
+        assertEqual( handle.Timestamp().softwareNs, (uint64_t)42 );
+
+        PacketHandle shared( handle.Datagram() );
+        assertEqual( shared.Data() == handle.Data(), true );
+        handle.Release();
+        assertEqual( handle.IsNull(), true );
+        assertEqual( std::strcmp( shared.Data(), "/copied" ), 0 );
+    }
+
+#if !(defined(__WIN32__) || defined(WIN32) || defined(_WIN32))
+    // the multiplexer receives into the same buffer until a listener keeps
+    // a packet with a handle, then replaces it. the kept packets stay
+    // valid after the multiplexer is destroyed, and can be released on
+    // another thread.
+    IpEndpointName receiverEndpoint( "127.0.0.1", 7217 );
+    UdpReceiveSocket receiver( receiverEndpoint );
+    UdpSocket sender;
+    std::vector<PacketHandle> handles;
+    {
+        SocketReceiveMultiplexer mux;
+        mux.SetReceiveBatchSize( 1 );
+        HandleKeepingListener listener( mux );
+        mux.AttachSocketListener( &receiver, &listener );
+
+        // each phase receives its three packets in one Run(), one at a time
+        const char *packets[] = { "/reused", "/reused", "/reused", "/kept0", "/kept1", "/kept2" };
+        for( int phase=0; phase < 2; ++phase ){
+            listener.keep = ( phase == 1 );
+            listener.expected += 3;
+            for( int i=0; i < 3; ++i ){
+                const char *packet = packets[ phase * 3 + i ];
+                sender.SendTo( receiverEndpoint, packet, (int)std::strlen( packet ) + 1 );
+            }
+            assertEqual( RunWithTimeout( mux, 1000 ), false );
+        }
+        mux.DetachSocketListener( &receiver, &listener );
+
+        assertEqual( listener.dataPointers.size(), (std::size_t)6 );
+        assertEqual( listener.handles.size(), (std::size_t)3 );
+        if( listener.dataPointers.size() == 6 ){
+            assertEqual( listener.dataPointers[1] == listener.dataPointers[0], true );
+            assertEqual( listener.dataPointers[2] == listener.dataPointers[0], true );
+            assertEqual( listener.dataPointers[4] != listener.dataPointers[3], true );
+            assertEqual( listener.dataPointers[5] != listener.dataPointers[4], true );
+            for( std::size_t i=0; i < listener.handles.size(); ++i )
+                assertEqual( listener.handles[i].Data() == listener.dataPointers[i + 3], true );
+        }
+        handles = listener.handles;
+    }
+
+    assertEqual( handles.size(), (std::size_t)3 );
+    int wrongPackets = 0;
+    for( std::size_t i=0; i < handles.size(); ++i ){
+        char expected[] = "/kept0";
+        expected[5] = (char)('0' + i);
+        if( std::strcmp( handles[i].Data(), expected ) != 0 || handles[i].Datagram().buffer == 0 )
+            ++wrongPackets;
+    }
+    assertEqual( wrongPackets, 0 );
+
+    std::thread releaser( [&handles]{ handles.clear(); } );
+    releaser.join();
+#endif
+}
+
+
+// records the timestamps passed to ProcessTimestampedPacket(), and breaks
+// the multiplexer once it has received expected packets
+class TimestampListener : public PacketListener{
+    SocketReceiveMultiplexer& mux_;
+public:
+    TimestampListener( SocketReceiveMultiplexer& mux, std::size_t expected_ )
+        : mux_( mux ), expected( expected_ ) {}
+
+    std::size_t expected;
+    std::vector<uint64_t> softwareNs;
+
+    virtual void ProcessPacket( const char *data, int size, const IpEndpointName& remoteEndpoint )
+    {
+        (void) data;
+        (void) size;
+        (void) remoteEndpoint;
+    }
+
+    virtual void ProcessTimestampedPacket( const char *data, int size,
+            const IpEndpointName& remoteEndpoint, const PacketTimestamp& timestamp )
+    {
+        (void) data;
+        (void) size;
+        (void) remoteEndpoint;
+        softwareNs.push_back( timestamp.softwareNs );
+        if( softwareNs.size() >= expected )
+            mux_.Break();
+    }
+};
+
+
+// nanoseconds since the Unix epoch, the clock the receive timestamps use
+static uint64_t RealTimeNs()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch() ).count();
+}
+
+
+void test26()
+{
+    // with timestamps enabled, the kernel's receive time is passed to
+    // ReceiveFrom() and to ProcessTimestampedPacket(), for single and
+    // batched receives. without them, or on Windows, the times are 0.
+    IpEndpointName receiverEndpoint( "127.0.0.1", 7218 );
+    UdpReceiveSocket receiver( receiverEndpoint );
+    UdpSocket sender;
+
+    // the kernel reads the clock at a coarser point than clock_gettime()
+    const uint64_t SLACK_NS = 1000000;
+
+    for( int enabled=0; enabled < 2; ++enabled ){
+        receiver.SetEnableTimestamps( enabled != 0 );
+#if defined(__WIN32__) || defined(WIN32) || defined(_WIN32)
+        const bool expectTimestamps = false;
+#else
+        const bool expectTimestamps = ( enabled != 0 );
+#endif
+
+        uint64_t beforeNs = RealTimeNs();
+        sender.SendTo( receiverEndpoint, "/ts", 4 );
+        IpEndpointName remoteEndpoint;
+        char data[16];
+        PacketTimestamp timestamp;
+        timestamp.softwareNs = 1;
+        assertEqual( receiver.ReceiveFrom( remoteEndpoint, data, sizeof(data), timestamp ), (std::size_t)4 );
+        uint64_t afterNs = RealTimeNs();
+        if( expectTimestamps ){
+            assertEqual( timestamp.softwareNs + SLACK_NS >= beforeNs, true );
+            assertEqual( timestamp.softwareNs <= afterNs + SLACK_NS, true );
+        }else{
+            assertEqual( timestamp.softwareNs, (uint64_t)0 );
+        }
+
+        const int batchSizes[] = { 1, 8 };
+        for( int b=0; b < 2; ++b ){
+            SocketReceiveMultiplexer mux;
+            mux.SetReceiveBatchSize( batchSizes[b] );
+            TimestampListener listener( mux, 3 );
+            mux.AttachSocketListener( &receiver, &listener );
+
+            beforeNs = RealTimeNs();
+            for( int i=0; i < 3; ++i )
+                sender.SendTo( receiverEndpoint, "/ts", 4 );
+            assertEqual( RunWithTimeout( mux, 1000 ), false );
+            afterNs = RealTimeNs();
+            mux.DetachSocketListener( &receiver, &listener );
+
+            assertEqual( listener.softwareNs.size(), (std::size_t)3 );
+            int wrongTimestamps = 0;
+            for( std::size_t i=0; i < listener.softwareNs.size(); ++i ){
+                uint64_t t = listener.softwareNs[i];
+                if( expectTimestamps ){
+                    if( t + SLACK_NS < beforeNs || t > afterNs + SLACK_NS )
+                        ++wrongTimestamps;
+                }else if( t != 0 ){
+                    ++wrongTimestamps;
+                }
+            }
+            assertEqual( wrongTimestamps, 0 );
+        }
+    }
+}
+
+
+void test27()
+{
+    // with each backend, the spinning wait strategies receive packets, run
+    // the timers and return from Run() after AsynchronousBreak(). the
+    // spin is longer than the scenario, so the timers have to fire while
+    // Run() is spinning.
+    IpEndpointName receiverEndpoint( "127.0.0.1", 7219 );
+    UdpReceiveSocket receiver( receiverEndpoint );
+    UdpSocket sender;
+    const int COUNT = 200;
+
+#if defined(__WIN32__) || defined(WIN32) || defined(_WIN32)
+    SocketReceiveMultiplexer::Backend backends[] = { SocketReceiveMultiplexer::DEFAULT_BACKEND };
+#else
+    SocketReceiveMultiplexer::Backend backends[] = {
+        SocketReceiveMultiplexer::SELECT_BACKEND,
+        SocketReceiveMultiplexer::EPOLL_BACKEND,
+        SocketReceiveMultiplexer::IO_URING_BACKEND };
+#endif
+    SocketReceiveMultiplexer::WaitStrategy strategies[] = {
+        SocketReceiveMultiplexer::SPIN_THEN_BLOCK_WAIT,
+        SocketReceiveMultiplexer::BUSY_POLL_WAIT };
+    const int SPIN_MICROSECONDS = 10000000;
+
+    for( std::size_t i=0; i < sizeof(backends) / sizeof(backends[0]); ++i ){
+        for( int j=0; j < 2; ++j ){
+            SocketReceiveMultiplexer mux( backends[i] );
+            mux.SetWaitStrategy( strategies[j], SPIN_MICROSECONDS );
+
+            SequenceListener listener;
+            mux.AttachSocketListener( &receiver, &listener );
+            int timerCount = RunReceiveScenario( mux, sender, receiverEndpoint, listener, 0, COUNT, COUNT );
+            mux.DetachSocketListener( &receiver, &listener );
+
+            assertEqual( (int)listener.ids.size(), COUNT );
+            assertEqual( listener.OutOfSequenceCount( 0 ), 0 );
+            assertEqual( timerCount >= 3, true );
+        }
+    }
+}
+
+
+void test28()
+{
+#if !(defined(__WIN32__) || defined(WIN32) || defined(_WIN32))
+    // a batch mixing packets for the connected endpoint with packets for
+    // other endpoints is sent in order. a packet that can't be sent (a
+    // broadcast, without SO_BROADCAST) records its error, and the rest of
+    // the batch is still sent.
+    IpEndpointName connectedEndpoint( "127.0.0.1", 7220 );
+    IpEndpointName otherEndpoints[2] = {
+        IpEndpointName( "127.0.0.1", 7221 ), IpEndpointName( "127.0.0.1", 7222 ) };
+    UdpReceiveSocket connectedReceiver( connectedEndpoint );
+    UdpReceiveSocket otherReceiver0( otherEndpoints[0] );
+    UdpReceiveSocket otherReceiver1( otherEndpoints[1] );
+    UdpTransmitSocket sender( connectedEndpoint );
+
+    const char *packets[] = { "/c0", "/o1", "/unreachable", "/p3", "/c4", "/o5-longer" };
+    UdpSendBatch batch;
+    batch.Add( packets[0], 4 );
+    batch.Add( otherEndpoints[0], packets[1], 4 );
+    batch.Add( IpEndpointName( 255, 255, 255, 255, 7223 ), packets[2], 13 );
+    batch.Add( otherEndpoints[1], packets[3], 4 );
+    batch.Add( packets[4], 4 );
+    batch.Add( otherEndpoints[0], packets[5], 10 );
+
+    assertEqual( sender.SendBatch( batch ), (std::size_t)5 );
+    for( std::size_t i=0; i < batch.Size(); ++i ){
+        if( i == 2 ){
+            assertEqual( batch[i].error != 0, true );
+            assertEqual( batch[i].bytesSent, (std::size_t)0 );
+        }else{
+            assertEqual( batch[i].error, 0 );
+            assertEqual( batch[i].bytesSent, batch[i].size );
+        }
+    }
+
+    SocketReceiveMultiplexer mux;
+    RecordingListener connectedListener, otherListener0, otherListener1;
+    mux.AttachSocketListener( &connectedReceiver, &connectedListener );
+    mux.AttachSocketListener( &otherReceiver0, &otherListener0 );
+    mux.AttachSocketListener( &otherReceiver1, &otherListener1 );
+    RunWithTimeout( mux, 200 );
+    mux.DetachSocketListener( &connectedReceiver, &connectedListener );
+    mux.DetachSocketListener( &otherReceiver0, &otherListener0 );
+    mux.DetachSocketListener( &otherReceiver1, &otherListener1 );
+
+    assertEqual( connectedListener.packets.size(), (std::size_t)2 );
+    assertEqual( otherListener0.packets.size(), (std::size_t)2 );
+    assertEqual( otherListener1.packets.size(), (std::size_t)1 );
+    if( connectedListener.packets.size() == 2 && otherListener0.packets.size() == 2
+            && otherListener1.packets.size() == 1 ){
+        assertEqual( connectedListener.packets[0], std::string( packets[0], 4 ) );
+        assertEqual( connectedListener.packets[1], std::string( packets[4], 4 ) );
+        assertEqual( otherListener0.packets[0], std::string( packets[1], 4 ) );
+        assertEqual( otherListener0.packets[1], std::string( packets[5], 10 ) );
+        assertEqual( otherListener1.packets[0], std::string( packets[3], 4 ) );
+    }
+#endif
+}
+
 
 void RunUnitTests()
 {
     test1();
     test2();
     test3();
+    test4();
+    test5();
+    test6();
+    test7();
+    test8();
+    test9();
+    test10();
+    test11();
+    test12();
+    test13();
+    test14();
+    test15();
+    test16();
+    test17();
+    test18();
+    test19();
+    test20();
+    test21();
+    test22();
+    test23();
+    test24();
+    test25();
+    test26();
+    test27();
+    test28();
     PrintTestSummary();
 }
 